@@ -10,6 +10,7 @@
 #include <HardwareSerial.h>
 #include "pin_definitions.h"
 #include "config.h"
+#include "util/wall_clock.h"
 
 class CellularModem {
 public:
@@ -75,10 +76,12 @@ public:
      * @param data POST data
      * @param response Response buffer
      * @param responseSize Response buffer size
+     * @param contentType Content-Type header
      * @return true if successful
      */
     bool sendHTTPPost(const char* url, const char* data,
-                      char* response = nullptr, size_t responseSize = 0);
+                      char* response = nullptr, size_t responseSize = 0,
+                      const char* contentType = "application/json");
 
     /**
      * Send HTTP GET request
@@ -97,6 +100,13 @@ public:
      */
     bool sendSMS(const char* phoneNumber, const char* message);
 
+    /**
+     * Get network time (NITZ, enabled with AT+CTZU=1 on connect)
+     * @param unixTime Output UTC seconds since 1970-01-01
+     * @return false if the modem has no network time yet
+     */
+    bool getNetworkTime(uint32_t& unixTime);
+
     /**
      * Put modem in low power mode
      */
@@ -11,6 +11,7 @@
 #include <WiFi.h>
 #include "config.h"
 #include "data/weather_data.h"
+#include "data/event_detector.h"
 
 // Callback types
 typedef void (*ESPNowSendCallback)(const uint8_t* mac, bool success);
@@ -55,6 +56,13 @@ public:
      */
     bool sendData(const uint8_t* macAddress, const uint8_t* data, size_t length);
 
+    /**
+     * Set the position sent with every weather packet
+     * @param latitude Degrees north (0 with longitude 0 = unknown)
+     * @param longitude Degrees east
+     */
+    void setLocation(float latitude, float longitude);
+
     /**
      * Send weather data to peer
      * @param macAddress Destination MAC address
@@ -63,6 +71,14 @@ public:
      */
     bool sendWeatherData(const uint8_t* macAddress, const WeatherReading& reading);
 
+    /**
+     * Send an event to peer at once (priority lane)
+     * @param macAddress Destination MAC address
+     * @param event Detected event
+     * @return true if send initiated
+     */
+    bool sendEvent(const uint8_t* macAddress, const WeatherEvent& event);
+
     /**
      * Broadcast data to all peers
      * @param data Pointer to data buffer
@@ -80,6 +96,32 @@ public:
      */
     bool parseWeatherPacket(const uint8_t* data, size_t length, ESPNowPacket& packet);
 
+    /**
+     * Parse received event packet
+     * @param data Received data buffer
+     * @param length Data length
+     * @param event Output event (stationId of the sender)
+     * @return true if parsing successful
+     */
+    bool parseEventPacket(const uint8_t* data, size_t length, WeatherEvent& event);
+
+    /**
+     * Convert a received packet back to engineering units
+     * @param packet Parsed weather packet
+     * @param reading Output reading (isValid from packet flags)
+     * @return Mask of the fields the packet carries (FIELD_BIT); a version 1
+     *         packet lacks the fields added since
+     */
+    static uint32_t unpackWeatherPacket(const ESPNowPacket& packet, WeatherReading& reading);
+
+    /**
+     * Get the sender position of a received packet
+     * @param packet Parsed weather packet
+     * @param latitude Output degrees north
+     * @param longitude Output degrees east (both 0 if the sender has none)
+     */
+    static void unpackPosition(const ESPNowPacket& packet, float& latitude, float& longitude);
+
     /**
      * Set callback for send status
      * @param callback Function to call when send completes
@@ -113,6 +155,8 @@ public:
 private:
     bool _initialized;
     uint8_t _peerCount;
+    int32_t _latitude;            // Own position, 1e-5 degrees
+    int32_t _longitude;
 
     // Peer storage
     esp_now_peer_info_t _peers[ESPNOW_MAX_PEERS];
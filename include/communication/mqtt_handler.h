@@ -11,6 +11,7 @@
 #include <PubSubClient.h>
 #include "config.h"
 #include "data/weather_data.h"
+#include "util/output_sink.h"
 
 // MQTT message callback type
 typedef void (*MQTTCallback)(const char* topic, const char* message);
@@ -58,6 +59,38 @@ public:
      */
     bool publish(const char* topic, const char* payload, bool retained = false);
 
+    /**
+     * Publish binary payload to topic (not limited by MQTT_MAX_PACKET_SIZE)
+     * @param topic MQTT topic
+     * @param payload Payload bytes
+     * @param length Payload length
+     * @param retained Whether to retain message
+     * @return true if publish successful
+     */
+    bool publish(const char* topic, const uint8_t* payload, size_t length,
+                 bool retained = false);
+
+    /**
+     * Publish a payload written by a formatter straight into the client
+     * (no payload buffer, not limited by MQTT_MAX_PACKET_SIZE).
+     * format(OutputSink&) runs twice - into a CountingSink for the length
+     * MQTT sends first, then into the connection - and must write the
+     * same bytes both times.
+     * @param topic MQTT topic
+     * @param format Callable writing the payload, e.g. a DataFormatter
+     *               sink overload in a lambda
+     * @param retained Whether to retain message
+     * @return true if publish successful
+     */
+    template <typename Format>
+    bool publishStreamed(const char* topic, Format format, bool retained = false) {
+        CountingSink counter;
+        format(counter);
+        if (!beginPublish(topic, counter.length(), retained)) return false;
+        format(_publishSink);
+        return endPublish(topic);
+    }
+
     /**
      * Publish weather data for a station
      * @param stationId Station identifier
@@ -74,6 +107,14 @@ public:
      */
     bool publishStatus(const char* stationId, const char* status);
 
+    /**
+     * Publish an event at once (priority lane, outside the report schedule)
+     * @param stationId Station identifier
+     * @param payload Event payload (DataFormatter::toEventPayload)
+     * @return true if publish successful
+     */
+    bool publishEvent(const char* stationId, const char* payload);
+
     /**
      * Subscribe to a topic
      * @param topic MQTT topic
@@ -107,8 +148,26 @@ public:
     const char* getStateString();
 
 private:
+    // Writes one message into the client, counting bytes so that a short
+    // write or a payload of the wrong length is caught at the end
+    class PublishSink : public OutputSink {
+    public:
+        explicit PublishSink(PubSubClient& client)
+            : _client(client), _expected(0), _written(0), _failed(false) {}
+        void begin(size_t length);
+        void write(const uint8_t* data, size_t length) override;
+        bool flush() override;
+
+    private:
+        PubSubClient& _client;
+        size_t _expected;
+        size_t _written;              // Bytes the client accepted
+        bool _failed;
+    };
+
     WiFiClient _wifiClient;
     PubSubClient _client;
+    PublishSink _publishSink;
     bool _connected;
 
     char _broker[64];
@@ -130,6 +189,16 @@ private:
      */
     void handleCallback(char* topic, byte* payload, unsigned int length);
 
+    /**
+     * Start a message of known length; the payload goes to _publishSink
+     */
+    bool beginPublish(const char* topic, size_t length, bool retained);
+
+    /**
+     * Complete the message started by beginPublish
+     */
+    bool endPublish(const char* topic);
+
     /**
      * Format weather reading as JSON payload
      */
@@ -19,6 +19,7 @@
 #define TRANSMIT_INTERVAL_MS 300000    // Transmit data every 5 minutes
 #define AGGREGATION_WINDOW_MS 300000   // Aggregation window (same as transmit)
 #define ESPNOW_TRANSMIT_INTERVAL_MS 300000 // Microstation transmit interval (5 min, matches main station)
+#define WIND_SAMPLE_INTERVAL_MS 250    // 4 Hz wind sampling for gusts (WMO-No. 8)
 #define SENSOR_WARMUP_MS 2000          // Sensor warmup time after init
 #define WARMUP_TIME_MS 15000           // SGP30 warmup time
 #define MODEM_TIMEOUT_MS 30000         // Cellular modem timeout
@@ -36,8 +37,20 @@
 #define MQTT_CLIENT_ID_PREFIX "cowbois_"
 #define MQTT_QOS 1
 #define MQTT_RETAIN false
-#define MQTT_MAX_PACKET_SIZE 1024
+#define MQTT_MAX_PACKET_SIZE 2048      // Client buffer: commands and buffered publishes (reports stream)
 #define MQTT_RECONNECT_INTERVAL 5000
+#define MQTT_CBOR_WEATHER 0            // Station window reports as CBOR (JSON ~1 KB -> ~0.3 KB)
+#define MQTT_CBOR_MICROSTATIONS 0      // Forwarded microstation windows as CBOR
+#define MQTT_CBOR_ROLLUPS 0            // Hourly / daily rollups as CBOR
+#define MQTT_CBOR_SUFFIX "/cbor"       // CBOR reports go to <topic>/cbor
+#define MQTT_BACKLOG_BATCH 1           // Keep unsent windows as a delta batch, send on reconnect
+#define MQTT_BACKLOG_BYTES 8192        // Batch buffer (~50 B per window, ~12 h of 5-min windows)
+
+// InfluxDB upload: every station's window in one line-protocol POST
+// through the modem (write URL in secrets.h as INFLUX_WRITE_URL)
+#define INFLUX_BATCH 0                 // POST windows to InfluxDB each transmit interval
+#define INFLUX_BATCH_BYTES 16384       // One POST (~0.8 KB per window, 20 windows; more are split)
+#define INFLUX_MEASUREMENT "weather"   // Measurement; tags are site and station
 
 // ============================================
 // ESP-NOW Configuration
@@ -48,6 +61,18 @@
 #define ESPNOW_RETRY_DELAY_MS 100
 #define ESPNOW_MAX_PACKET_SIZE 250     // ESP-NOW max payload
 
+// Main station per-microstation aggregation
+#define STATION_TABLE_SIZE 64          // Open-addressed slots (power of two)
+#define STATION_TABLE_MAX_STATIONS 56  // Load factor <= 7/8 keeps probe sequences short
+#define STATION_STALE_FLUSHES 12       // Forget a station after 12 empty flushes (1 hour)
+#define STATION_QUEUE_SIZE 16          // Readings waiting between the ESP-NOW callback and loop()
+
+// Network-wide (spatial) summary across all stations, main station only
+#define SPATIAL_AGGREGATION 1          // Publish <prefix>/<id>/site each window
+#define SPATIAL_MIN_STATIONS 2         // Stations needed for a site summary
+#define SPATIAL_MIN_GRADIENT_STATIONS 3  // Positioned stations needed for a gradient
+#define SPATIAL_COLLINEAR_RATIO 0.01   // det / trace^2 of the station spread below this = one line
+
 // ============================================
 // Sensor Accuracy Thresholds (Mesonet standards)
 // ============================================
@@ -60,12 +85,83 @@
 #define SOLAR_ACCURACY_PCT 5.0f        // ±5%
 #define SOLAR_RESOLUTION_WM2 0.2f      // 0.2 W/m²
 #define PRECIP_RESOLUTION_MM 0.254f    // 0.254mm
+#define AIR_QUALITY_ACCURACY_PCT 15.0f // SGP30 eCO2/TVOC, BME680 gas: ±15%
 
 // ============================================
 // Data Aggregation
 // ============================================
 #define MAX_SAMPLES_PER_INTERVAL 100   // 5 min / 3 sec = 100 samples
 #define DATA_BUFFER_SIZE 10            // Store last 10 aggregated readings
+#define AGGREGATION_HIGH_RATE 1        // Kahan-compensated Welford accumulators (1-10 Hz sampling)
+#define AGGREGATION_SAMPLE_BUFFER 1    // Keep raw samples of the current window (SoA ring buffer)
+#define SAMPLE_BUFFER_MAX_BYTES 8192   // RAM budget for the raw sample buffer (checked at compile time)
+#define AGGREGATION_DOUBLE_BUFFER 0    // Ping-pong windows for separate sampling / transmit tasks
+                                       // (needs AGGREGATION_SAMPLE_BUFFER 0)
+#define AGGREGATION_FIXED_POINT 0      // Integer accumulators in packet units (wireScale)
+                                       // (needs AGGREGATION_SAMPLE_BUFFER 0)
+
+// Quality control (limits per field in weather_fields.h)
+#define QC_MIN_STEP_MS 1000            // Step check never allows less than 1 s of change
+#define QC_CALM_WIND_MS 0.5f           // Below this speed the wind vane may stay still
+
+// Spike filter (Hampel) on the flex-sensor wind speed and load-cell channels
+#define SPIKE_FILTER 1                 // Replace isolated spikes before QC and aggregation
+#define HAMPEL_MAX_WINDOW 15           // Largest window (RAM: 8 bytes per value)
+#define HAMPEL_THRESHOLD 3.0f          // Reject beyond 3 robust sigmas of the window median
+#define WIND_SPIKE_WINDOW 5            // 4-Hz gust sampling: 1.25 s, spikes up to 2 readings long
+#define WIND_SAMPLE_SPIKE_WINDOW 5     // Sample interval readings: 15 s at 3 s
+#define WIND_SPIKE_MIN_MS 2.0f         // Never reject a change below 2 m/s
+#define PRECIP_SPIKE_WINDOW 5          // 15 s at the 3-s sample interval
+#define PRECIP_SPIKE_MIN_MM 0.5f       // Never reject a change below 0.5 mm
+
+// Wind products (WMO-No. 8): gust = max 3-s running mean, 2- and 10-min means
+#define WIND_GUST_WINDOW_MS 3000       // Gust averaging time
+#define WIND_BLOCK_MS 10000            // Mean resolution: 10-s sub-averages
+#define WIND_MEAN_SHORT_MS 120000      // 2-minute mean
+#define WIND_MEAN_LONG_MS 600000       // 10-minute mean and gust reporting period
+
+// Rolling (sliding) window statistics for dashboards and local display
+#define AGGREGATION_ROLLING 1          // Maintain a rolling window alongside the tumbling one
+#define ROLLING_WINDOW_MS 600000       // 10-minute rolling window
+#define ROLLING_WINDOW_SAMPLES 200     // Capacity: 10 min / 3 sec
+
+// Rollup tiers (each tier merges records from the tier below)
+#define ROLLUP_BASE_WINDOW_MS 60000    // 1-minute tier, fed directly by samples
+#define ROLLUP_5MIN_RECORDS 5          // 5 x 1-minute = 5-minute tier
+#define ROLLUP_HOURLY_RECORDS 12       // 12 x 5-minute = hourly tier
+#define ROLLUP_DAILY_RECORDS 24        // 24 x hourly = daily tier
+
+// Report compression: fields whose values stay within the dead-band
+// (weather_fields.h, from the accuracy thresholds above) are left out
+#define REPORT_COMPRESSION 0           // Send only changed fields in MQTT reports
+#define REPORT_KEYFRAME_INTERVAL 12    // Full report every 12 reports (hourly at 5 min)
+
+// Event lane: rules checked on every sample, events sent at once
+#define EVENT_GUST_MS 20.0f            // Wind speed at or above (upper Beaufort 8, gale)
+#define EVENT_RAIN_ONSET_MM PRECIP_RESOLUTION_MM  // Rain onset: first 0.254 mm...
+#define EVENT_RAIN_DRY_MS 3600000      // ...after an hour without rain
+#define EVENT_HEAVY_RAIN_MM 0.63f      // Heavy rain: 7.6 mm/h...
+#define EVENT_HEAVY_RAIN_MS 300000     // ...sustained over 5 minutes
+#define EVENT_PRESSURE_JUMP_HPA 1.5f   // Pressure jump (squall line, gust front)...
+#define EVENT_PRESSURE_JUMP_MS 900000  // ...within 15 minutes
+#define EVENT_TEMP_DROP_C 5.0f         // Temperature drop (outflow)...
+#define EVENT_TEMP_DROP_MS 900000      // ...within 15 minutes
+#define EVENT_HOLDOFF_MS 600000        // A rule stays silent for 10 minutes after firing
+#define EVENT_BUCKET_SIZE 4            // Events sent back to back...
+#define EVENT_BUCKET_REFILL_MS 60000   // ...then one per minute
+#define EVENT_QUEUE_SIZE 8             // Events waiting for the main loop
+#define EVENT_HISTORY_SLOTS 8          // Snapshots per rate-of-change window
+
+// Agronomic products (FAO-56 ET0, growing degree days) from hourly rollups
+#define AGRO_PRODUCTS 1                // Publish daily ET0 / GDD on <prefix>/<id>/agro
+#define AGRO_UTC_OFFSET_AUTO 1         // Day boundaries in the nominal zone of the longitude (15 deg/h)
+#define AGRO_UTC_OFFSET_MIN -360       // Local standard time if not derived or no position (CST)
+#define AGRO_MIN_HOURS 20              // Hours with data for a valid daily product
+#define WIND_SENSOR_HEIGHT_M 2.0f      // Anemometer height (ET0 uses wind at 2 m)
+#define GDD_BASE_C 10.0f               // Growing degree days: base (corn, 50 F)...
+#define GDD_CAP_C 30.0f                // ...and upper cutoff (86 F)
+#define TIME_SYNC_INTERVAL_MS 21600000 // Resync the clock with network time every 6 hours
+#define TIME_SYNC_RETRY_MS 60000       // Until the first sync, retry every minute
 
 // ============================================
 // Power Management
@@ -83,6 +179,7 @@
 #define LUX_TO_WM2 0.0079f             // Lux to W/m² conversion factor
 #define PRECIP_CALIBRATION_FACTOR 420.0f  // HX711 calibration factor
 #define PRECIP_COLLECTOR_AREA 50.0f    // Rain gauge collector area (cm²)
+#define SGP30_COMPENSATION_INTERVAL_MS 60000  // Humidity compensation refresh (not per sample)
 
 // ============================================
 // Cellular Modem Configuration
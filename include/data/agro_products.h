@@ -0,0 +1,139 @@
+/**
+ * COW-Bois Weather Station - Agronomic Products
+ * FAO-56 reference evapotranspiration (ET0) and growing degree days,
+ * accumulated on the station from hourly rollups
+ */
+
+#ifndef AGRO_PRODUCTS_H
+#define AGRO_PRODUCTS_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "data/weather_data.h"
+
+// ============================================
+// Daily Agronomic Product
+// ============================================
+struct AgroDaily {
+    int32_t day;                  // Local day, days since 1970-01-01
+    float et0;                    // mm, FAO-56 daily Penman-Monteith (eq. 6)
+    float et0Hourly;              // mm, sum of hourly Penman-Monteith (eq. 53)
+    float gdd;                    // C-days, capped min/max method
+    float gddHourly;              // C-days, integrated hourly means
+    float gddSeason;              // C-days, sum of gdd since boot / resetSeason()
+    float tempMin;                // C
+    float tempMax;                // C
+    float solar;                  // MJ/m2, measured global radiation
+    uint8_t hours;                // Hours with every ET0 input
+    bool valid;                   // At least AGRO_MIN_HOURS hours
+
+    AgroDaily()
+        : day(0), et0(0), et0Hourly(0), gdd(0), gddHourly(0), gddSeason(0),
+          tempMin(0), tempMax(0), solar(0), hours(0), valid(false) {}
+};
+
+// ============================================
+// Agronomic Products
+// Fed one closed hourly rollup at a time (RollupEngine::HOURLY) together
+// with the UTC time of its end (WallClock); hours are assigned to the
+// local standard day of their midpoint (zone from the longitude, or
+// AGRO_UTC_OFFSET_MIN). A day
+// closes with the hour that reaches local midnight and is then held for
+// getDaily(). Solar position uses the station's latitude / longitude;
+// the psychrometric constant uses measured station pressure, falling
+// back to the FAO-56 elevation formula.
+// Hourly rollups follow boot time, not clock hours; radiation terms are
+// integrated over each record's actual span, so this only shifts which
+// day a record lands in by at most half an hour.
+// ============================================
+class AgroProducts {
+public:
+    AgroProducts();
+
+    /**
+     * Set station location
+     * @param latitude Degrees north
+     * @param longitude Degrees east
+     * @param elevationM Elevation in meters
+     */
+    void setLocation(float latitude, float longitude, int elevationM);
+
+    /**
+     * Add a closed hourly record
+     * @param hour Hourly rollup
+     * @param unixTime UTC seconds at the end of the record (0 = clock not set,
+     *                 the record is skipped)
+     * @return true if a local day closed; getDaily() returns it
+     */
+    bool addHour(const AggregatedData& hour, uint32_t unixTime);
+
+    /**
+     * Get the last closed day
+     * @param daily Output product
+     * @return true if a day has closed
+     */
+    bool getDaily(AgroDaily& daily) const;
+
+    /**
+     * Get ET0 of the last hour added
+     * @return mm, 0 if its inputs were incomplete
+     */
+    float getLastHourET0() const { return _lastHourET0; }
+
+    /**
+     * Get the offset of the local standard day
+     * @return Minutes east of UTC
+     */
+    int16_t getUtcOffsetMin() const { return _utcOffsetMin; }
+
+    /**
+     * Restart the seasonal GDD total (e.g. at planting)
+     */
+    void resetSeason() { _gddSeason = 0; }
+
+    // FAO-56 formulas (uncached; temperatures in C, pressures in kPa)
+    static float saturationVapor(float tempC);
+    static float windAt2m(float speed, float heightM);
+    static float extraterrestrialDaily(float latitudeRad, uint16_t dayOfYear);
+    static float extraterrestrialPeriod(float latitudeRad, float longitudeDeg,
+                                        uint16_t dayOfYear, float utcHours, float spanHours);
+    static float hourlyET0(float tempC, float relHumidity, float windSpeed2m,
+                           float solarMJ, float clearSkyMJ, float pressureKPa,
+                           float& cloudRatio, float spanHours);
+    static float dailyET0(float tempMin, float tempMax, float humidityMin, float humidityMax,
+                          float windSpeed2m, float solarMJ, float clearSkyMJ, float pressureKPa);
+    static float degreeDays(float tempMin, float tempMax);
+
+private:
+    float _latitude;              // Radians
+    float _longitude;             // Degrees east
+    int _elevation;
+    int16_t _utcOffsetMin;        // Local standard time, minutes east of UTC
+
+    // Open day
+    int32_t _day;
+    bool _open;
+    uint8_t _hours;
+    float _et0Hourly;
+    float _gddHourly;
+    float _solar;                 // MJ/m2
+    float _tempMin, _tempMax;
+    float _humidityMin, _humidityMax;
+    double _windSum;
+    double _pressureSum;
+    uint8_t _windHours;
+    uint8_t _pressureHours;
+
+    float _cloudRatio;            // Rs/Rso of the last daylight hour, used at night
+    float _lastHourET0;
+    float _gddSeason;
+
+    AgroDaily _daily;
+    bool _hasDaily;
+
+    float defaultPressure() const;
+    void openDay(int32_t day);
+    void closeDay();
+};
+
+#endif // AGRO_PRODUCTS_H
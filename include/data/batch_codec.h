@@ -0,0 +1,166 @@
+/**
+ * COW-Bois Weather Station - Batch Codec
+ * Delta-compressed batches of aggregated windows for backlog uploads
+ */
+
+#ifndef BATCH_CODEC_H
+#define BATCH_CODEC_H
+
+#include "config.h"
+#include "data/weather_data.h"
+
+// ============================================
+// Batch Format
+// Header: version, WEATHER_FIELD_COUNT, record count (uint16 LE),
+// station id (length byte + text), then one bit stream of records.
+//
+// Each record is a fixed list of integer columns, each predicted from
+// the same column of the previous record (Gorilla-style, but with the
+// registry's fixed-point values instead of float XOR):
+//   timestamp      delta-of-delta (ms)
+//   samples, window length
+//   every field    value * wireScale (STATS avg/min/max/std, quantiles,
+//                  CIRCULAR / LATEST value), the ESP-NOW resolution
+//   QC             rejected per field, flag counts
+//   wind rose      calm and every sector / speed class cell
+// A column's zigzag delta is written as '0' if unchanged, otherwise a
+// prefix of 1s choosing 7, 12, 20 or 32 payload bits. Slowly varying
+// windows cost a bit for most columns. Non-finite values are stored as
+// INT32_MIN and decoded as NaN.
+//
+// Columns are predicted independently but interleaved per record, so
+// records can be appended to a bounded buffer one at a time.
+// ============================================
+static const uint8_t BATCH_FORMAT_VERSION = 1;
+
+// Columns per record besides the timestamp
+#define BATCH_COLUMNS_STATS 4
+#define BATCH_COLUMNS_CIRCULAR 1
+#define BATCH_COLUMNS_LATEST 1
+#define BATCH_COLUMNS_QUANTILES 3
+#define BATCH_COLUMNS_NONE 0
+#define BATCH_FIELD_COLUMNS(id, member, prefix, type, kind, quant, ...) \
+    + BATCH_COLUMNS_##kind + BATCH_COLUMNS_##quant
+static const uint16_t BATCH_COLUMNS =
+    2 + WEATHER_FIELD_COUNT + QC_CHECK_COUNT + 1 + WindRose::SECTORS * WindRose::SPEED_CLASSES
+    WEATHER_FIELDS(BATCH_FIELD_COLUMNS);
+#undef BATCH_FIELD_COLUMNS
+
+// ============================================
+// Batch Encoder
+// Appends windows to a caller's buffer until it is full. add() is
+// all-or-nothing: a window that does not fit leaves the batch intact.
+// ============================================
+class BatchEncoder {
+public:
+    /**
+     * @param buffer Batch storage
+     * @param size Size of storage (bytes)
+     */
+    BatchEncoder(uint8_t* buffer, size_t size);
+
+    /**
+     * Start a new, empty batch
+     * @param stationId Station identifier stored in the header
+     */
+    void begin(const char* stationId);
+
+    /**
+     * Append a window
+     * @param data Aggregated window (oldest first)
+     * @return false if the window did not fit (batch unchanged)
+     */
+    bool add(const AggregatedData& data);
+
+    /**
+     * Get number of windows in the batch
+     * @return Record count
+     */
+    uint16_t getRecordCount() const { return _records; }
+
+    /**
+     * Get encoded batch size
+     * @return Bytes to send (header included)
+     */
+    size_t length() const { return (_bitPosition + 7) / 8; }
+
+    /**
+     * Get encoded batch
+     * @return Start of the batch (the buffer passed in)
+     */
+    const uint8_t* data() const { return _buffer; }
+
+    /**
+     * Largest possible encoded record
+     * @return Bytes
+     */
+    static size_t maxRecordBytes();
+
+private:
+    uint8_t* _buffer;
+    size_t _size;
+    size_t _bitPosition;
+    uint16_t _records;
+    uint32_t _previousTime;
+    int32_t _previousInterval;
+    int32_t _previous[BATCH_COLUMNS];
+
+    bool writeBits(uint32_t value, uint8_t bits);
+    bool writeDelta(int32_t delta);
+};
+
+// ============================================
+// Batch Decoder
+// Reverses BatchEncoder for tests and host-side tools. Records come
+// back in order; fields hold the stored fixed-point values.
+// ============================================
+class BatchDecoder {
+public:
+    /**
+     * @param batch Encoded batch
+     * @param length Batch length in bytes
+     */
+    BatchDecoder(const uint8_t* batch, size_t length);
+
+    /**
+     * Check the header
+     * @return true if the batch has a known version and field count
+     */
+    bool isValid() const { return _valid; }
+
+    /**
+     * Get number of windows in the batch
+     * @return Record count from the header
+     */
+    uint16_t getRecordCount() const { return _records; }
+
+    /**
+     * Get station identifier
+     * @return NUL-terminated station id
+     */
+    const char* getStationId() const { return _stationId; }
+
+    /**
+     * Decode the next window
+     * @param data Output aggregated window
+     * @return false after the last record or on a damaged batch
+     */
+    bool next(AggregatedData& data);
+
+private:
+    const uint8_t* _batch;
+    size_t _length;
+    size_t _bitPosition;
+    uint16_t _records;
+    uint16_t _decoded;
+    bool _valid;
+    char _stationId[STATION_ID_LENGTH + 1];
+    uint32_t _previousTime;
+    int32_t _previousInterval;
+    int32_t _previous[BATCH_COLUMNS];
+
+    bool readBits(uint8_t bits, uint32_t& value);
+    bool readDelta(int32_t& delta);
+};
+
+#endif // BATCH_CODEC_H
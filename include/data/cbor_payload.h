@@ -0,0 +1,86 @@
+/**
+ * COW-Bois Weather Station - CBOR Payload
+ * Integer-keyed binary report schema and its decoder
+ */
+
+#ifndef CBOR_PAYLOAD_H
+#define CBOR_PAYLOAD_H
+
+#include "config.h"
+#include "data/weather_data.h"
+#include "data/wind_products.h"
+#include "data/derived_variables.h"
+
+// ============================================
+// Report Schema
+// The same content as the JSON MQTT payload, without key strings or
+// units: a map with integer keys (CborKey), values as integers.
+//   FIELDS       map DataField index -> value * wireScale, rounded
+//                  STATS     [avg, min, max, std(, p05, p50, p95)]
+//                  CIRCULAR / LATEST  a single integer
+//   WIND_GUST    [gust * 100, direction]
+//   WIND_2MIN /  [scalar * 100, vector * 100, direction]
+//   WIND_10MIN
+//   DERIVED      map DerivedField index -> value * 100
+//   WIND_ROSE    [calm, [sector 0 classes], ..., [sector 15 classes]]
+//                (trailing zero classes trimmed, empty sectors [])
+//   QC           [missing, range, step, persistence, consistency]
+//   REJECTED     map DataField index -> samples rejected (non-zero only)
+// Fields, wind products and derived values follow the same rules as
+// DataFormatter::toMQTTPayload. Non-finite values are sent as null.
+// Decoders skip keys they do not know, so keys can be added.
+// ============================================
+enum class CborKey : uint8_t {
+    STATION_ID,                   // Text
+    TIMESTAMP,                    // Window end (millis)
+    SAMPLES,
+    WINDOW_MS,
+    KEYFRAME,                     // Only with report compression
+    FIELDS,
+    WIND_GUST,
+    WIND_2MIN,
+    WIND_10MIN,
+    DERIVED,
+    WIND_ROSE,
+    QC,
+    REJECTED
+};
+
+// Scale of wind speeds and derived values (0.01, as the JSON payload)
+static const float CBOR_VALUE_SCALE = 100.0f;
+
+// ============================================
+// Decoded Report
+// ============================================
+struct CborReport {
+    char stationId[STATION_ID_LENGTH + 1];
+    AggregatedData data;          // Fields not in fieldMask are left at 0
+    uint32_t fieldMask;           // FIELD_BIT(id) set for each field present
+    bool hasKeyframe;             // Report carried KEYFRAME
+    bool keyframe;
+    WindProductsData wind;        // Validity flags set for the products present
+    DerivedData derived;
+
+    CborReport() : stationId(), fieldMask(0), hasKeyframe(false), keyframe(false) {}
+};
+
+// ============================================
+// CBOR Payload Decoder
+// Reverses DataFormatter::toCBORPayload for tests and host-side tools.
+// Uses no hardware or library code beyond the data structures (the
+// Arduino header only supplies integer types and math), so it builds
+// with a host compiler and a stub Arduino.h.
+// ============================================
+class CborPayload {
+public:
+    /**
+     * Decode a report
+     * @param payload Encoded report
+     * @param length Payload length in bytes
+     * @param report Output decoded report
+     * @return true if the payload is a well-formed report
+     */
+    static bool decode(const uint8_t* payload, size_t length, CborReport& report);
+};
+
+#endif // CBOR_PAYLOAD_H
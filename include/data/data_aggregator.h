@@ -9,25 +9,16 @@
 #include <Arduino.h>
 #include "config.h"
 #include "data/weather_data.h"
-
-// Data field enumeration for getCurrentAverage
-enum class DataField {
-    TEMPERATURE,
-    HUMIDITY,
-    PRESSURE,
-    GAS_RESISTANCE,
-    WIND_SPEED,
-    WIND_DIRECTION,
-    PRECIPITATION,
-    LUX,
-    SOLAR_IRRADIANCE,
-    CO2,
-    TVOC
-};
+#include "data/running_stats.h"
+#include "data/streaming_quantile.h"
+#include "data/sample_buffer.h"
 
 class DataAggregator {
 public:
-    DataAggregator();
+    /**
+     * @param windowMs Length of the tumbling aggregation window
+     */
+    explicit DataAggregator(uint32_t windowMs = AGGREGATION_WINDOW_MS);
 
     /**
      * Add a sensor reading to the aggregation
@@ -35,6 +26,15 @@ public:
      */
     void addSample(const WeatherReading& reading);
 
+    /**
+     * Add a quality-controlled reading
+     * Flagged fields are left out of their statistics and counted in
+     * AggregatedData::qcRejected / qcFlagCounts.
+     * @param reading Weather reading to add
+     * @param qc Result of QualityControl::check() for this reading
+     */
+    void addSample(const WeatherReading& reading, const QCResult& qc);
+
     /**
      * Check if aggregation window is complete
      * @return true if ready to transmit
@@ -62,7 +62,7 @@ public:
      * Get number of samples collected
      * @return Sample count
      */
-    uint16_t getSampleCount() const;
+    uint32_t getSampleCount() const;
 
     /**
      * Get elapsed time in current window
@@ -77,46 +77,80 @@ public:
      */
     float getCurrentAverage(DataField field) const;
 
-private:
-    uint16_t _sampleCount;
-    uint32_t _windowStartTime;
-
-    // Running sums for averaging
-    float _tempSum;
-    float _tempMin;
-    float _tempMax;
-
-    float _humiditySum;
-    float _humidityMin;
-    float _humidityMax;
-
-    float _pressureSum;
-    float _pressureMin;
-    float _pressureMax;
-
-    float _gasResistanceSum;
-    float _gasResistanceMin;
-    float _gasResistanceMax;
-
-    float _windSpeedSum;
-    float _windSpeedMax;
-
-    // Wind direction circular averaging
-    float _windDirSinSum;
-    float _windDirCosSum;
+    /**
+     * Keep raw samples of the current window in a ring buffer
+     * The buffer is filled by addSample() and cleared by reset().
+     * @param buffer Sample buffer, or nullptr to detach
+     */
+    void attachBuffer(SampleBuffer* buffer);
 
-    float _precipTotal;
+    /**
+     * Get the attached sample buffer
+     * @return Buffer, or nullptr if none attached
+     */
+    const SampleBuffer* getBuffer() const { return _buffer; }
 
-    uint32_t _luxSum;
-    uint32_t _luxMax;
+    /**
+     * Rebuild the window statistics from the attached buffer
+     * Use after invalidating samples (late QC decision). Window start
+     * time and sample count are kept; if the buffer overflowed, the
+     * statistics cover its latest SampleBuffer::CAPACITY samples only.
+     * @return true if the buffer held every sample of the window
+     */
+    bool recompute();
 
-    float _solarSum;
+    /**
+     * Merge a later aggregated record into an earlier one
+     * Means and standard deviations are combined exactly from the
+     * per-window, per-field counts (samples less QC rejections); quantiles and wind direction are combined as
+     * sample-weighted averages of the window values (approximation).
+     * Wind rose counts are added (exact).
+     * @param target Earlier record, updated in place
+     * @param later Record for the window following target
+     */
+    static void merge(AggregatedData& target, const AggregatedData& later);
 
-    uint32_t _co2Sum;
-    uint16_t _co2Max;
+    /**
+     * Convert an aggregated record to a single representative reading
+     * (averages, circular mean direction, latest cumulative values)
+     * @param data Aggregated weather data
+     * @return WeatherReading marked valid
+     */
+    static WeatherReading toReading(const AggregatedData& data);
 
-    uint32_t _tvocSum;
-    uint16_t _tvocMax;
+private:
+    uint32_t _windowMs;
+    uint32_t _sampleCount;
+    uint32_t _windowStartTime;
+    SampleBuffer* _buffer;        // Optional raw sample store (not owned)
+    uint32_t _qcRejected[WEATHER_FIELD_COUNT];
+    uint32_t _qcFlagCounts[QC_CHECK_COUNT];
+    WindRose _windRose;           // Samples with valid wind speed and direction
+
+    void clearAccumulators();
+    void accumulate(const WeatherReading& reading, uint32_t validMask);
+    template <bool ALL_VALID>
+    void addFields(const WeatherReading& reading, uint32_t validMask);
+
+    // Per-field accumulators, generated from WEATHER_FIELDS:
+    //   STATS     RunningStats _<prefix> (mean, variance, min, max)
+    //   CIRCULAR  int64_t _<prefix>Sin / _<prefix>Cos (Q15 unit-vector sums)
+    //   LATEST    float _<prefix>
+    //   QUANTILES WindowQuantiles _<prefix>Quantiles (fixed memory)
+#define AGG_STATE_STATS(p) RunningStats _##p;
+#define AGG_STATE_CIRCULAR(p) int64_t _##p##Sin; int64_t _##p##Cos;
+#define AGG_STATE_LATEST(p) float _##p;
+#define AGG_STATE_QUANTILES(p) WindowQuantiles _##p##Quantiles;
+#define AGG_STATE_NONE(p)
+#define AGG_STATE(id, member, prefix, type, kind, quant, ...) \
+    AGG_STATE_##kind(prefix) AGG_STATE_##quant(prefix)
+    WEATHER_FIELDS(AGG_STATE)
+#undef AGG_STATE_STATS
+#undef AGG_STATE_CIRCULAR
+#undef AGG_STATE_LATEST
+#undef AGG_STATE_QUANTILES
+#undef AGG_STATE_NONE
+#undef AGG_STATE
 };
 
 #endif // DATA_AGGREGATOR_H
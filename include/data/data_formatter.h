@@ -1,6 +1,7 @@
 /**
  * COW-Bois Weather Station - Data Formatter
  * JSON and CSV formatting for weather data
+ * Field lists come from the WEATHER_FIELDS registry (weather_fields.h)
  */
 
 #ifndef DATA_FORMATTER_H
@@ -9,6 +10,15 @@
 #include <Arduino.h>
 #include "data/weather_data.h"
 
+struct WindProductsData;
+struct DerivedData;
+struct ReportSelection;
+struct WeatherEvent;
+struct EventRule;
+struct AgroDaily;
+class SpatialAggregator;
+class OutputSink;
+
 class DataFormatter {
 public:
     /**
@@ -53,27 +63,181 @@ public:
 
     /**
      * Format aggregated data as MQTT payload
+     * Includes the window's wind rose when it holds wind samples.
      * @param stationId Station identifier
      * @param data Aggregated weather data
      * @param buffer Output buffer
      * @param bufferSize Size of output buffer
+     * @param wind Optional WMO wind products (gust, 2-min and 10-min means)
+     * @param derived Optional derived values (dew point, heat index, ...)
+     * @param selection Optional report compression: only the selected
+     *        fields are written, derived values and the wind rose only on
+     *        keyframes, and meta gains "keyframe"
      * @return Number of characters written
      */
     static size_t toMQTTPayload(const char* stationId, const AggregatedData& data,
+                                char* buffer, size_t bufferSize,
+                                const WindProductsData* wind = nullptr,
+                                const DerivedData* derived = nullptr,
+                                const ReportSelection* selection = nullptr);
+
+    /**
+     * Stream aggregated data as MQTT payload into a sink (no payload buffer)
+     * Same output and options as the buffer version; the sink is not flushed.
+     * @param stationId Station identifier
+     * @param data Aggregated weather data
+     * @param sink Destination
+     * @param wind Optional WMO wind products
+     * @param derived Optional derived values
+     * @param selection Optional report compression
+     * @return Number of characters written
+     */
+    static size_t toMQTTPayload(const char* stationId, const AggregatedData& data,
+                                OutputSink& sink, const WindProductsData* wind = nullptr,
+                                const DerivedData* derived = nullptr,
+                                const ReportSelection* selection = nullptr);
+
+    /**
+     * Encode aggregated data as a binary (CBOR) MQTT payload
+     * Same content and options as toMQTTPayload, with integer keys and
+     * scaled integers instead of text (schema in cbor_payload.h).
+     * @param stationId Station identifier
+     * @param data Aggregated weather data
+     * @param buffer Output buffer
+     * @param bufferSize Size of output buffer
+     * @param wind Optional WMO wind products
+     * @param derived Optional derived values
+     * @param selection Optional report compression
+     * @return Encoded length; larger than bufferSize if it did not fit
+     */
+    static size_t toCBORPayload(const char* stationId, const AggregatedData& data,
+                                uint8_t* buffer, size_t bufferSize,
+                                const WindProductsData* wind = nullptr,
+                                const DerivedData* derived = nullptr,
+                                const ReportSelection* selection = nullptr);
+
+    /**
+     * Stream aggregated data as CBOR into a sink (the sink is not flushed)
+     * @param stationId Station identifier
+     * @param data Aggregated weather data
+     * @param sink Destination
+     * @param wind Optional WMO wind products
+     * @param derived Optional derived values
+     * @param selection Optional report compression
+     * @return Encoded length
+     */
+    static size_t toCBORPayload(const char* stationId, const AggregatedData& data,
+                                OutputSink& sink, const WindProductsData* wind = nullptr,
+                                const DerivedData* derived = nullptr,
+                                const ReportSelection* selection = nullptr);
+
+    /**
+     * Format a single reading as MQTT payload (forwarded microstation data)
+     * @param stationId Station identifier
+     * @param reading Weather reading
+     * @param buffer Output buffer
+     * @param bufferSize Size of output buffer
+     * @return Number of characters written
+     */
+    static size_t toMQTTPayload(const char* stationId, const WeatherReading& reading,
+                                char* buffer, size_t bufferSize);
+
+    /**
+     * Format an event for the priority lane
+     * @param stationId Station identifier
+     * @param event Detected or forwarded event
+     * @param rule Rule that raised it (EventDetector::getRule)
+     * @param buffer Output buffer
+     * @param bufferSize Size of output buffer
+     * @return Number of characters written
+     */
+    static size_t toEventPayload(const char* stationId, const WeatherEvent& event,
+                                 const EventRule& rule, char* buffer, size_t bufferSize);
+
+    /**
+     * Stream an event into a sink (the sink is not flushed)
+     * @param stationId Station identifier
+     * @param event Detected or forwarded event
+     * @param rule Rule that raised it
+     * @param sink Destination
+     * @return Number of characters written
+     */
+    static size_t toEventPayload(const char* stationId, const WeatherEvent& event,
+                                 const EventRule& rule, OutputSink& sink);
+
+    /**
+     * Format station health (battery, uptime, spike filter and event
+     * lane counters since boot)
+     * @param stationId Station identifier
+     * @param health Current counters
+     * @param buffer Output buffer
+     * @param bufferSize Size of output buffer
+     * @return Number of characters written
+     */
+    static size_t toStatusPayload(const char* stationId, const StationHealth& health,
+                                  char* buffer, size_t bufferSize);
+
+    /**
+     * Format a daily agronomic product
+     * ET0 in mm, degree days in C-days, solar radiation in MJ/m2
+     * @param stationId Station identifier
+     * @param daily Closed day (AgroProducts::getDaily)
+     * @param buffer Output buffer
+     * @param bufferSize Size of output buffer
+     * @return Number of characters written
+     */
+    static size_t toAgroPayload(const char* stationId, const AgroDaily& daily,
                                 char* buffer, size_t bufferSize);
 
     /**
-     * Format data as InfluxDB line protocol
-     * @param measurement Measurement name
-     * @param stationId Station identifier (tag)
+     * Stream a daily agronomic product into a sink (the sink is not flushed)
+     * @param stationId Station identifier
+     * @param daily Closed day
+     * @param sink Destination
+     * @return Number of characters written
+     */
+    static size_t toAgroPayload(const char* stationId, const AgroDaily& daily,
+                                OutputSink& sink);
+
+    /**
+     * Format a site summary across all stations
+     * Per field: station count, mean and spread of the station means,
+     * extremes with their station, and the gradient (units/km, direction
+     * of increase) when the station layout allows one
+     * @param siteId Main station identifier
+     * @param site Aggregator fed with this window's stations
+     * @param buffer Output buffer
+     * @param bufferSize Size of output buffer
+     * @return Number of characters written
+     */
+    static size_t toSpatialPayload(const char* siteId, const SpatialAggregator& site,
+                                   char* buffer, size_t bufferSize);
+
+    /**
+     * Stream a site summary into a sink (the sink is not flushed)
+     * @param siteId Main station identifier
+     * @param site Aggregator fed with this window's stations
+     * @param sink Destination
+     * @return Number of characters written
+     */
+    static size_t toSpatialPayload(const char* siteId, const SpatialAggregator& site,
+                                   OutputSink& sink);
+
+    /**
+     * Format data as InfluxDB line protocol (one line, no newline)
+     * @param measurement Measurement name, optionally followed by tags
+     *                    sorting before "station" (e.g. "weather,site=X")
+     * @param stationId Station identifier (tag, escaped by the caller)
      * @param data Aggregated weather data
      * @param buffer Output buffer
      * @param bufferSize Size of output buffer
+     * @param epochMs Window end, ms since 1970-01-01, written in ns;
+     *                0 leaves the timestamp to the server
      * @return Number of characters written
      */
     static size_t toInfluxLineProtocol(const char* measurement, const char* stationId,
                                        const AggregatedData& data, char* buffer,
-                                       size_t bufferSize);
+                                       size_t bufferSize, uint64_t epochMs = 0);
 
     /**
      * Print weather reading to Serial (debug)
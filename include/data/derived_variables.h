@@ -0,0 +1,122 @@
+/**
+ * COW-Bois Weather Station - Derived Variables
+ * Dew point, heat index, wind chill, absolute humidity and sea-level
+ * pressure, computed on demand from window averages and memoized
+ */
+
+#ifndef DERIVED_VARIABLES_H
+#define DERIVED_VARIABLES_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "data/weather_data.h"
+
+// ============================================
+// Derived Data
+// ============================================
+enum class DerivedField : uint8_t {
+    DEW_POINT,
+    HEAT_INDEX,
+    WIND_CHILL,
+    ABSOLUTE_HUMIDITY,
+    SEA_LEVEL_PRESSURE,
+    COUNT
+};
+
+struct DerivedData {
+    float dewPoint;               // C
+    float heatIndex;              // C (air temperature outside the NWS range)
+    float windChill;              // C (air temperature outside the valid range)
+    float absoluteHumidity;       // g/m3
+    float seaLevelPressure;       // hPa
+    uint8_t validMask;            // Bit (1 << DerivedField) set if inputs were available
+
+    DerivedData()
+        : dewPoint(0), heatIndex(0), windChill(0), absoluteHumidity(0),
+          seaLevelPressure(0), validMask(0) {}
+
+    bool isValid(DerivedField field) const {
+        return validMask & (1 << (uint8_t)field);
+    }
+};
+
+// ============================================
+// Derived Variables
+// Inputs are set once per window (or on demand); each value is only
+// computed when first requested and cached until an input it depends
+// on changes. Nothing here belongs on the per-sample path.
+// ============================================
+class DerivedVariables {
+public:
+    DerivedVariables();
+
+    /**
+     * Set inputs from a window's averages
+     * Fields without any QC-passed sample are treated as unavailable.
+     * @param data Aggregated weather data
+     */
+    void update(const AggregatedData& data);
+
+    /**
+     * Set inputs directly
+     * @param tempC Air temperature (C)
+     * @param relHumidity Relative humidity (%)
+     * @param pressureHpa Station pressure (hPa)
+     * @param windSpeedMps Wind speed (m/s)
+     */
+    void update(float tempC, float relHumidity, float pressureHpa, float windSpeedMps);
+
+    /**
+     * Set station elevation for the sea-level reduction
+     * @param elevationM Elevation in meters
+     */
+    void setElevation(int elevationM);
+
+    /**
+     * Get one derived value (computed and cached on first request)
+     * @param field Derived field
+     * @return Value, 0 if its inputs are unavailable
+     */
+    float get(DerivedField field);
+
+    /**
+     * Get all derived values
+     * @return Derived data with validity bits
+     */
+    DerivedData getAll();
+
+    /**
+     * Check if a value is cached (for tests and benchmarks)
+     * @param field Derived field
+     * @return true if no recomputation is needed
+     */
+    bool isCached(DerivedField field) const {
+        return _cached & (1 << (uint8_t)field);
+    }
+
+    // Formulas (uncached)
+    static float vaporPressure(float tempC, float relHumidity);
+    static float dewPoint(float tempC, float relHumidity);
+    static float heatIndex(float tempC, float relHumidity);
+    static float windChill(float tempC, float windSpeedMps);
+    static float absoluteHumidity(float tempC, float relHumidity);
+    static float seaLevelPressure(float pressureHpa, float tempC, int elevationM);
+
+private:
+    float _temp;
+    float _humidity;
+    float _pressure;
+    float _windSpeed;
+    int _elevation;
+    uint8_t _available;           // Bit per DataField-derived input (see .cpp)
+
+    float _values[(uint8_t)DerivedField::COUNT];
+    float _vaporPressure;         // Shared by dew point and absolute humidity
+    uint8_t _cached;              // Bit (1 << DerivedField) set if _values is current
+    bool _vaporCached;
+
+    void invalidate(uint8_t inputs);
+    float vapor();
+};
+
+#endif // DERIVED_VARIABLES_H
@@ -0,0 +1,105 @@
+/**
+ * COW-Bois Weather Station - Double-Buffered Aggregator
+ * Window handoff between a sampling task and a transmitting task
+ */
+
+#ifndef DOUBLE_BUFFERED_AGGREGATOR_H
+#define DOUBLE_BUFFERED_AGGREGATOR_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "data/weather_data.h"
+#include "data/data_aggregator.h"
+#include "util/ping_pong.h"
+
+// ============================================
+// Double-Buffered Aggregator
+// Two DataAggregators in a PingPong buffer. addSample() (producer) goes
+// to the active one; close() (consumer) swaps and keeps the closed one
+// until release(), so the consumer can format and transmit at its own
+// pace while sampling continues. Window start and end times are taken
+// at the swap, not when the closed window is read.
+// One producer and one consumer; either may be its own FreeRTOS task.
+// Raw sample buffers (attachBuffer) are not supported here.
+// ============================================
+class DoubleBufferedAggregator {
+public:
+    /**
+     * @param windowMs Nominal window length (reported by isWindowComplete)
+     */
+    explicit DoubleBufferedAggregator(uint32_t windowMs = AGGREGATION_WINDOW_MS);
+
+    /**
+     * Producer: add a reading to the active window
+     * @param reading Weather reading to add
+     */
+    void addSample(const WeatherReading& reading);
+
+    /**
+     * Producer: add a quality-controlled reading to the active window
+     * @param reading Weather reading to add
+     * @param qc Result of QualityControl::check() for this reading
+     */
+    void addSample(const WeatherReading& reading, const QCResult& qc);
+
+    /**
+     * Consumer: close the active window (atomic swap)
+     * @return false if the previous closed window was not released
+     */
+    bool close();
+
+    /**
+     * Consumer: statistics of the closed window
+     * @return AggregatedData stamped with the window's close time
+     */
+    AggregatedData getClosed();
+
+    /**
+     * Consumer: the closed window itself (e.g. for merge or recompute)
+     * @return Aggregator holding the closed window
+     */
+    DataAggregator& closedWindow() { return _windows.standby(); }
+
+    /**
+     * Consumer: clear the closed window for reuse
+     */
+    void release();
+
+    /**
+     * Consumer: close, read and release in one call
+     * Drop-in for DataAggregator::getAndReset().
+     * @return AggregatedData of the window just closed
+     */
+    AggregatedData getAndReset();
+
+    /**
+     * Consumer: check if the active window has run its nominal length
+     * @return true if ready to close
+     */
+    bool isWindowComplete() const;
+
+    /**
+     * Get number of samples in the active window
+     * A sample in flight during close() may land in either count; for
+     * status output only.
+     * @return Sample count
+     */
+    uint32_t getSampleCount() const { return _activeSamples.load(std::memory_order_relaxed); }
+
+    /**
+     * Get number of closes that waited for a sample in flight
+     * @return Wait count
+     */
+    uint32_t getSwapWaits() const { return _windows.getSwapWaits(); }
+
+private:
+    PingPong<DataAggregator> _windows;
+    std::atomic<uint32_t> _activeSamples;
+    uint32_t _windowMs;
+    uint32_t _windowStart;        // Active window, set by the consumer at each swap
+    uint32_t _closedStart;
+    uint32_t _closedEnd;
+    bool _hasClosed;
+};
+
+#endif // DOUBLE_BUFFERED_AGGREGATOR_H
@@ -0,0 +1,151 @@
+/**
+ * COW-Bois Weather Station - Event Detector
+ * Per-sample threshold, rate-of-change and onset rules feeding a
+ * rate-limited priority lane next to the periodic reports
+ */
+
+#ifndef EVENT_DETECTOR_H
+#define EVENT_DETECTOR_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "data/weather_data.h"
+#include "util/token_bucket.h"
+
+// ============================================
+// Event Rules
+// ============================================
+enum class EventRuleType : uint8_t {
+    THRESHOLD,                    // Value reaches limit
+    RISE,                         // Increase of at least limit within windowMs
+    DROP,                         // Decrease of at least limit within windowMs
+    CHANGE,                       // Rise or drop of at least limit within windowMs
+    ONSET                         // Increase of at least limit after windowMs without one
+};
+
+struct EventRule {
+    const char* name;             // Event name in payloads
+    DataField field;
+    EventRuleType type;
+    float limit;                  // Field units
+    uint32_t windowMs;            // Rate / quiet period (unused for THRESHOLD)
+};
+
+// ============================================
+// Weather Event
+// ============================================
+struct WeatherEvent {
+    uint32_t timestamp;
+    char stationId[9];            // Originating microstation, empty for this station
+    uint8_t rule;                 // Index into the detector's rule table
+    float value;                  // Field value at detection
+    float change;                 // Change over the rule window (0 for THRESHOLD)
+    uint16_t suppressed;          // Events dropped by the rate limit before this one
+
+    WeatherEvent()
+        : timestamp(0), stationId(), rule(0), value(0), change(0), suppressed(0) {}
+};
+
+// ============================================
+// Event Detector
+// check() runs on every quality-controlled sample; events go to a small
+// queue drained by the main loop and sent at once. A token bucket
+// (EVENT_BUCKET_SIZE burst, one per EVENT_BUCKET_REFILL_MS) limits the
+// whole lane, forwarded microstation events included, and each rule is
+// edge-triggered with an EVENT_HOLDOFF_MS holdoff. Dropped events are
+// counted in the next one sent. An event stays queued (peek()) until
+// its link takes it, so an outage fills the queue and the overflow is
+// counted rather than lost silently.
+// enqueue() may be called from the ESP-NOW receive callback (WiFi task)
+// while check() / pop() run in loop(); the queue is guarded by a spinlock.
+// ============================================
+class EventDetector {
+public:
+    static const uint8_t MAX_RULES = 8;
+
+    /**
+     * @param rules Rule table (nullptr = built-in rules from config.h)
+     * @param ruleCount Number of rules (at most MAX_RULES)
+     */
+    explicit EventDetector(const EventRule* rules = nullptr, uint8_t ruleCount = 0);
+
+    /**
+     * Check a sample against every rule
+     * @param reading Weather reading
+     * @param validMask Fields that passed QC (QCResult::validMask)
+     * @param now Current time (millis)
+     * @return Number of events raised (queued or dropped)
+     */
+    uint8_t check(const WeatherReading& reading, uint32_t validMask, uint32_t now);
+
+    /**
+     * Queue an event from elsewhere (forwarded from a microstation)
+     * @param event Event to send
+     * @param now Current time (millis)
+     * @return false if the rate limit dropped it
+     */
+    bool enqueue(const WeatherEvent& event, uint32_t now);
+
+    /**
+     * Take the next event to send
+     * @param event Output event
+     * @return false if the queue is empty
+     */
+    bool pop(WeatherEvent& event);
+
+    /**
+     * Read the next event to send, leaving it queued until it is sent
+     * @param event Output event
+     * @return false if the queue is empty
+     */
+    bool peek(WeatherEvent& event);
+
+    /**
+     * Get a rule of the table
+     * @param index Rule index (WeatherEvent::rule)
+     * @return Rule, or nullptr if out of range
+     */
+    const EventRule* getRule(uint8_t index) const;
+
+    /**
+     * Get number of events dropped by the rate limit or a full queue
+     * @return Dropped event count since construction
+     */
+    uint32_t getDroppedCount() const { return _dropped; }
+
+    /**
+     * Clear rule state and the queue (rate limit is kept)
+     */
+    void reset();
+
+private:
+    struct RuleState {
+        float history[EVENT_HISTORY_SLOTS];   // Snapshots windowMs / slots apart
+        uint32_t lastSnapshot;
+        uint8_t head;                         // Oldest snapshot
+        uint8_t count;
+        bool active;                          // Condition held at the last sample
+        bool fired;
+        uint32_t lastFired;
+        float base;                           // ONSET: value after the last increase
+        uint32_t lastRise;
+        bool primed;                          // ONSET: base is set
+    };
+
+    const EventRule* _rules;
+    uint8_t _ruleCount;
+    RuleState _state[MAX_RULES];
+
+    WeatherEvent _queue[EVENT_QUEUE_SIZE];
+    uint8_t _queueHead;
+    uint8_t _queueCount;
+    TokenBucket _bucket;
+    uint16_t _suppressed;         // Dropped since the last queued event
+    uint32_t _dropped;
+    portMUX_TYPE _lock;
+
+    bool evaluate(uint8_t index, float value, uint32_t now, float& change);
+    bool emit(const WeatherEvent& event, uint32_t now);
+};
+
+#endif // EVENT_DETECTOR_H
@@ -0,0 +1,136 @@
+/**
+ * COW-Bois Weather Station - Fixed-Point Aggregator
+ * Window statistics from scaled-integer accumulators
+ */
+
+#ifndef FIXED_POINT_AGGREGATOR_H
+#define FIXED_POINT_AGGREGATOR_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "data/weather_data.h"
+#include "data/running_stats.h"
+#include "data/streaming_quantile.h"
+
+// ============================================
+// Fixed-Point Aggregator
+// Drop-in for DataAggregator (AGGREGATION_FIXED_POINT). Each reading is
+// converted once to packet units (ScaledReading, the rounding toWire()
+// applies to ESP-NOW packets); from there min / max / sums, wind
+// direction sums, latest values and the wind rose are integer only.
+// Statistics are converted back to AggregatedData when the window is
+// read, so rollups, QC reporting and formatters are unchanged, and the
+// result matches the float path to within field resolution.
+// Exception: the streaming quantile markers (QUANTILES fields) stay
+// float, as P-square interpolates between them.
+// Raw sample buffers (attachBuffer / recompute) are not supported.
+// ============================================
+class FixedPointAggregator {
+public:
+    /**
+     * @param windowMs Length of the tumbling aggregation window
+     */
+    explicit FixedPointAggregator(uint32_t windowMs = AGGREGATION_WINDOW_MS);
+
+    /**
+     * Add a sensor reading (scaled to packet units first)
+     * @param reading Weather reading to add
+     */
+    void addSample(const WeatherReading& reading);
+
+    /**
+     * Add a quality-controlled reading
+     * @param reading Weather reading to add
+     * @param qc Result of QualityControl::check() for this reading
+     */
+    void addSample(const WeatherReading& reading, const QCResult& qc);
+
+    /**
+     * Add a reading already in packet units
+     * @param reading Scaled reading to add
+     * @param validMask Fields that passed QC (QC_ALL_FIELDS if unchecked)
+     */
+    void addSample(const ScaledReading& reading, uint32_t validMask = QC_ALL_FIELDS);
+
+    /**
+     * Check if aggregation window is complete
+     * @return true if ready to transmit
+     */
+    bool isWindowComplete() const;
+
+    /**
+     * Get aggregated data (does not reset)
+     * @return AggregatedData with calculated statistics
+     */
+    AggregatedData getAggregatedData();
+
+    /**
+     * Get aggregated data and reset for new window
+     * @return AggregatedData with calculated statistics
+     */
+    AggregatedData getAndReset();
+
+    /**
+     * Reset aggregation (start new window)
+     */
+    void reset();
+
+    /**
+     * Get number of samples collected
+     * @return Sample count
+     */
+    uint32_t getSampleCount() const { return _sampleCount; }
+
+    /**
+     * Get elapsed time in current window
+     * @return Elapsed time in milliseconds
+     */
+    uint32_t getWindowElapsedMs() const;
+
+    /**
+     * Get current average for a specific field
+     * @param field Data field to query
+     * @return Current average value (engineering units)
+     */
+    float getCurrentAverage(DataField field) const;
+
+    /**
+     * Convert a reading to packet units
+     * Rounds and clamps like the ESP-NOW packet (toWire)
+     * @param reading Weather reading
+     * @param scaled Output scaled reading
+     */
+    static void scale(const WeatherReading& reading, ScaledReading& scaled);
+
+private:
+    uint32_t _windowMs;
+    uint32_t _sampleCount;
+    uint32_t _windowStartTime;
+    uint32_t _qcRejected[WEATHER_FIELD_COUNT];
+    uint32_t _qcFlagCounts[QC_CHECK_COUNT];
+    WindRose _windRose;
+
+    void countRejections(const QCResult& qc);
+
+    // Per-field accumulators, generated from WEATHER_FIELDS:
+    //   STATS     FixedStats _<prefix>
+    //   CIRCULAR  int64_t _<prefix>Sin / _<prefix>Cos (Q15 unit-vector sums)
+    //   LATEST    int32_t _<prefix>
+    //   QUANTILES WindowQuantiles _<prefix>Quantiles
+#define FIXED_STATE_STATS(p) FixedStats _##p;
+#define FIXED_STATE_CIRCULAR(p) int64_t _##p##Sin; int64_t _##p##Cos;
+#define FIXED_STATE_LATEST(p) int32_t _##p;
+#define FIXED_STATE_QUANTILES(p) WindowQuantiles _##p##Quantiles;
+#define FIXED_STATE_NONE(p)
+#define FIXED_STATE(id, member, prefix, type, kind, quant, ...) \
+    FIXED_STATE_##kind(prefix) FIXED_STATE_##quant(prefix)
+    WEATHER_FIELDS(FIXED_STATE)
+#undef FIXED_STATE_STATS
+#undef FIXED_STATE_CIRCULAR
+#undef FIXED_STATE_LATEST
+#undef FIXED_STATE_QUANTILES
+#undef FIXED_STATE_NONE
+#undef FIXED_STATE
+};
+
+#endif // FIXED_POINT_AGGREGATOR_H
@@ -0,0 +1,77 @@
+/**
+ * COW-Bois Weather Station - Hampel Filter
+ * Streaming sliding-median spike filter for noisy sensor channels
+ */
+
+#ifndef HAMPEL_FILTER_H
+#define HAMPEL_FILTER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// ============================================
+// Hampel Filter
+// Keeps the last windowSize raw values in arrival order and in sorted
+// order. A value further than HAMPEL_THRESHOLD scaled MADs (1.4826 x
+// median absolute deviation, a robust sigma) from the window median -
+// and further than minDeviation - is replaced by the median and counted.
+// Raw values always enter the window, so a real step is accepted once
+// it fills half the window.
+// O(windowSize) per value: one binary-search insert and delete in the
+// sorted copy, and the MAD from a merge of the deviations on each side
+// of the median (already sorted), no second sort.
+// ============================================
+class HampelFilter {
+public:
+    /**
+     * @param windowSize Values in the sliding window (odd, 3..HAMPEL_MAX_WINDOW)
+     * @param minDeviation Changes up to this size are never rejected
+     *                     (channel units; keeps a flat signal from
+     *                     rejecting its own noise when MAD is 0)
+     * @param threshold Rejection limit in robust sigmas
+     */
+    HampelFilter(uint8_t windowSize, float minDeviation,
+                 float threshold = HAMPEL_THRESHOLD);
+
+    /**
+     * Filter one value
+     * @param x Raw value
+     * @return x, or the window median if x is a spike
+     */
+    float filter(float x);
+
+    /**
+     * Get number of values replaced by the median
+     * @return Rejected count since construction or reset()
+     */
+    uint32_t getRejectedCount() const { return _rejected; }
+
+    /**
+     * Get number of values filtered
+     * @return Value count since construction or reset()
+     */
+    uint32_t getCount() const { return _total; }
+
+    /**
+     * Clear the window and counters
+     */
+    void reset();
+
+private:
+    float _ring[HAMPEL_MAX_WINDOW];       // Arrival order
+    float _sorted[HAMPEL_MAX_WINDOW];     // Same values, ascending
+    uint8_t _windowSize;
+    uint8_t _head;                        // Oldest value in _ring
+    uint8_t _count;
+    float _minDeviation;
+    float _threshold;
+    uint32_t _rejected;
+    uint32_t _total;
+
+    void insertSorted(float x);
+    void removeSorted(float x);
+    float median() const;
+    float medianAbsDeviation(float med) const;
+};
+
+#endif // HAMPEL_FILTER_H
@@ -0,0 +1,77 @@
+/**
+ * COW-Bois Weather Station - InfluxDB Batch
+ * Many windows in one line-protocol body for a single HTTP POST
+ */
+
+#ifndef INFLUX_BATCH_H
+#define INFLUX_BATCH_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "data/weather_data.h"
+
+// Escaped tag value: every character may need a backslash
+static const size_t INFLUX_TAG_LENGTH = 2 * STATION_ID_LENGTH;
+
+// ============================================
+// InfluxDB Batch
+// Appends one line per window (own station and microstations) to a
+// caller's buffer. The measurement and site tag are escaped once in
+// begin() and shared by every line; the station tag follows, keeping
+// tag keys in the sorted order InfluxDB parses fastest. Timestamps are
+// epoch nanoseconds. add() is all-or-nothing, so a full batch can be
+// posted and the window added to the next one.
+// ============================================
+class InfluxBatch {
+public:
+    /**
+     * @param buffer Body storage (stays NUL-terminated)
+     * @param size Size of storage (bytes)
+     */
+    InfluxBatch(char* buffer, size_t size);
+
+    /**
+     * Start a new, empty batch
+     * @param measurement Measurement name (not escaped)
+     * @param siteId Main station identifier (site tag)
+     */
+    void begin(const char* measurement, const char* siteId);
+
+    /**
+     * Append a window
+     * @param stationId Station identifier (station tag)
+     * @param data Aggregated window
+     * @param epochMs Window end, ms since 1970-01-01 (0 = server time)
+     * @return false if the line did not fit (batch unchanged)
+     */
+    bool add(const char* stationId, const AggregatedData& data, uint64_t epochMs);
+
+    /**
+     * Get number of lines in the batch
+     * @return Record count
+     */
+    uint16_t getRecordCount() const { return _records; }
+
+    /**
+     * Get body length
+     * @return Characters, without the terminating NUL
+     */
+    size_t length() const { return _length; }
+
+    /**
+     * Get body
+     * @return NUL-terminated line protocol (the buffer passed in)
+     */
+    const char* data() const { return _buffer; }
+
+private:
+    char* _buffer;
+    size_t _size;
+    size_t _length;
+    uint16_t _records;
+    char _series[32 + 6 + INFLUX_TAG_LENGTH + 1];  // "<measurement>,site=<id>"
+
+    static size_t escapeTag(const char* value, char* out, size_t size);
+};
+
+#endif // INFLUX_BATCH_H
@@ -0,0 +1,49 @@
+/**
+ * COW-Bois Weather Station - Quality Control
+ * Streaming range, step, persistence and consistency checks
+ */
+
+#ifndef QUALITY_CONTROL_H
+#define QUALITY_CONTROL_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "data/weather_data.h"
+
+// ============================================
+// Quality Control
+// Runs between SensorManager::readAll() and DataAggregator::addSample().
+// Limits come from the qcMin/qcMax/qcStep/qcPersist registry columns
+// (weather_fields.h). Constant time per sample: each check compares
+// against the previous value of the field only.
+// ============================================
+class QualityControl {
+public:
+    QualityControl();
+
+    /**
+     * Check a reading
+     * @param reading Weather reading
+     * @param sensorMask Bit (1 << DataField) set for each field the
+     *                   sensors delivered (from SensorManager::readAll)
+     * @return Per-field flags and the mask of fields that passed
+     */
+    QCResult check(const WeatherReading& reading, uint32_t sensorMask);
+
+    /**
+     * Forget previous values (step and persistence history)
+     */
+    void reset();
+
+private:
+    float _last[WEATHER_FIELD_COUNT];             // Last in-range value
+    uint32_t _lastTime[WEATHER_FIELD_COUNT];
+    uint32_t _unchangedSince[WEATHER_FIELD_COUNT];
+    uint32_t _seen;                               // Bit set once a field has history
+
+    uint8_t checkField(uint8_t field, float value, uint32_t timestamp,
+                       float qcMin, float qcMax, float qcStep, uint32_t qcPersist);
+    void checkConsistency(const WeatherReading& reading, QCResult& result);
+};
+
+#endif // QUALITY_CONTROL_H
@@ -0,0 +1,68 @@
+/**
+ * COW-Bois Weather Station - Report Compressor
+ * Dead-band selection of the fields worth sending in each MQTT report
+ */
+
+#ifndef REPORT_COMPRESSOR_H
+#define REPORT_COMPRESSOR_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "data/weather_data.h"
+
+// ============================================
+// Report Selection
+// Which registry fields a report carries
+// ============================================
+struct ReportSelection {
+    uint32_t fieldMask;           // FIELD_BIT(id) set for each field to send
+    bool keyframe;                // Full report; receivers resynchronize
+
+    ReportSelection() : fieldMask(QC_ALL_FIELDS), keyframe(true) {}
+};
+
+// ============================================
+// Report Compressor
+// Keeps the values last sent for each field. A field is sent again once
+// any of its level values (average, min, max, quantiles, or the value of
+// a direction/cumulative field) moves past the field's dead-band, so a
+// receiver holding the last sent values stays within the dead-band of
+// every level value. Standard deviations ride along with their field.
+// Every keyframeInterval reports carry all fields.
+// ============================================
+class ReportCompressor {
+public:
+    /**
+     * @param keyframeInterval Reports per full report (1 = never compress)
+     */
+    explicit ReportCompressor(uint8_t keyframeInterval = REPORT_KEYFRAME_INTERVAL);
+
+    /**
+     * Choose the fields of the next report and remember them as sent
+     * @param data Aggregated window to report
+     * @return Fields to send and whether this is a keyframe
+     */
+    ReportSelection select(const AggregatedData& data);
+
+    /**
+     * Make the next report a keyframe
+     * Call when a report was not delivered - the receiver no longer
+     * holds the values select() assumed.
+     */
+    void reset();
+
+    /**
+     * Dead-band of a field around a reference value
+     * @param field Data field
+     * @param reference Last sent value
+     * @return Largest change that is not reported
+     */
+    static float tolerance(DataField field, float reference);
+
+private:
+    uint8_t _keyframeInterval;
+    uint8_t _sinceKeyframe;       // Reports since the last keyframe
+    AggregatedData _sent;         // Values the receiver holds
+};
+
+#endif // REPORT_COMPRESSOR_H
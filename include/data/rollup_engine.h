@@ -0,0 +1,111 @@
+/**
+ * COW-Bois Weather Station - Rollup Engine
+ * Multi-resolution (1-min / 5-min / hourly / daily) summaries from one sample stream
+ */
+
+#ifndef ROLLUP_ENGINE_H
+#define ROLLUP_ENGINE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "data/weather_data.h"
+#include "data/data_aggregator.h"
+#if AGGREGATION_FIXED_POINT
+#include "data/fixed_point_aggregator.h"
+#endif
+
+// Rollup resolutions, finest first
+enum class RollupTier : uint8_t {
+    MINUTE_1 = 0,
+    MINUTE_5,
+    HOURLY,
+    DAILY,
+    COUNT
+};
+
+// The 1-minute tier takes every sample, so it uses the same accumulator
+// type as the main window; higher tiers merge closed records
+#if AGGREGATION_FIXED_POINT
+typedef FixedPointAggregator RollupBaseAggregator;
+#else
+typedef DataAggregator RollupBaseAggregator;
+#endif
+
+class RollupEngine {
+public:
+    RollupEngine();
+
+    /**
+     * Add a sensor reading (feeds the 1-minute tier only)
+     * @param reading Weather reading to add
+     */
+    void addSample(const WeatherReading& reading);
+
+    /**
+     * Add a quality-controlled reading (feeds the 1-minute tier only)
+     * @param reading Weather reading to add
+     * @param qc Result of QualityControl::check() for this reading
+     */
+    void addSample(const WeatherReading& reading, const QCResult& qc);
+
+    /**
+     * Close any completed windows and cascade them into higher tiers
+     * Call regularly from loop().
+     * @return Bitmask of tiers closed by this call (bit = RollupTier index)
+     */
+    uint8_t update();
+
+    /**
+     * Get the most recently closed record for a tier
+     * @param tier Rollup tier
+     * @param data Output record
+     * @return true if the tier has closed at least one window
+     */
+    bool getLatest(RollupTier tier, AggregatedData& data) const;
+
+    /**
+     * Check whether a tier bit is set in an update() result
+     * @param closedMask Value returned by update()
+     * @param tier Rollup tier
+     * @return true if the tier closed
+     */
+    static bool closed(uint8_t closedMask, RollupTier tier) {
+        return closedMask & (1 << (uint8_t)tier);
+    }
+
+    /**
+     * Get tier name (used in MQTT topics)
+     * @param tier Rollup tier
+     * @return Short name ("1min", "5min", "hourly", "daily")
+     */
+    static const char* tierName(RollupTier tier);
+
+    /**
+     * Discard all partial and closed records
+     */
+    void reset();
+
+private:
+    static const uint8_t TIER_COUNT = (uint8_t)RollupTier::COUNT;
+
+    // Base tier is a regular tumbling-window aggregator
+    RollupBaseAggregator _base;
+
+    // Partial (open) records for the merged tiers, indexed by RollupTier
+    AggregatedData _partial[TIER_COUNT];
+    uint8_t _partialRecords[TIER_COUNT];
+
+    // Last closed record per tier
+    AggregatedData _latest[TIER_COUNT];
+    bool _hasLatest[TIER_COUNT];
+
+    /**
+     * Merge a closed record into the next tier up, closing it when full
+     * @param tier Tier the record belongs to
+     * @param record Closed record
+     * @return Bitmask of tiers closed
+     */
+    uint8_t cascade(RollupTier tier, const AggregatedData& record);
+};
+
+#endif // ROLLUP_ENGINE_H
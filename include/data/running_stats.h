@@ -0,0 +1,180 @@
+/**
+ * COW-Bois Weather Station - Running Statistics
+ * Numerically stable single-pass accumulators for window aggregation
+ */
+
+#ifndef RUNNING_STATS_H
+#define RUNNING_STATS_H
+
+#include <Arduino.h>
+#include <float.h>
+#include <math.h>
+#include "config.h"
+
+// ============================================
+// Compensated Sum
+// Kahan summation for long-running float sums
+// ============================================
+struct CompensatedSum {
+    float sum;
+    float comp;                   // Running compensation (lost low-order bits)
+
+    CompensatedSum() : sum(0), comp(0) {}
+
+    void reset() {
+        sum = 0;
+        comp = 0;
+    }
+
+    void add(float x) {
+#if AGGREGATION_HIGH_RATE
+        float y = x - comp;
+        float t = sum + y;
+        comp = (t - sum) - y;
+        sum = t;
+#else
+        sum += x;
+#endif
+    }
+};
+
+// ============================================
+// Running Statistics
+// Welford mean/variance with min/max tracking
+// ============================================
+struct RunningStats {
+    uint32_t count;               // Samples accumulated (32-bit for 1-10 Hz rates)
+    float mean;                   // Running mean
+    float m2;                     // Sum of squared deviations from the mean
+    float min;
+    float max;
+
+#if AGGREGATION_HIGH_RATE
+    float meanComp;               // Kahan compensation for mean updates
+    float m2Comp;                 // Kahan compensation for m2 updates
+#endif
+
+    RunningStats() { reset(); }
+
+    void reset() {
+        count = 0;
+        mean = 0;
+        m2 = 0;
+        min = FLT_MAX;
+        max = -FLT_MAX;
+#if AGGREGATION_HIGH_RATE
+        meanComp = 0;
+        m2Comp = 0;
+#endif
+    }
+
+    /**
+     * Add a sample
+     * @param x Sample value
+     */
+    void add(float x) {
+        count++;
+        float delta = x - mean;
+
+#if AGGREGATION_HIGH_RATE
+        // Each update is tiny relative to the accumulated value at high
+        // sample counts, so carry the rounding error forward (Kahan)
+        float y = delta / (float)count - meanComp;
+        float t = mean + y;
+        meanComp = (t - mean) - y;
+        mean = t;
+
+        y = delta * (x - mean) - m2Comp;
+        t = m2 + y;
+        m2Comp = (t - m2) - y;
+        m2 = t;
+#else
+        mean += delta / (float)count;
+        m2 += delta * (x - mean);
+#endif
+
+        if (x < min) min = x;
+        if (x > max) max = x;
+    }
+
+    /**
+     * Get sample variance (n - 1 denominator)
+     * @return Variance, or 0 with fewer than two samples
+     */
+    float variance() const {
+        if (count < 2 || m2 <= 0) return 0;
+        return m2 / (float)(count - 1);
+    }
+
+    /**
+     * Get sample standard deviation
+     * @return Standard deviation, or 0 with fewer than two samples
+     */
+    float stddev() const {
+        return sqrtf(variance());
+    }
+};
+
+// ============================================
+// Fixed-Point Statistics
+// Integer sums of a scaled field (packet units). Sums are taken about
+// the first sample of the window, so the 64-bit sum of squares holds a
+// day of 1 Hz samples of any registry field without overflow and the
+// variance needs no cancellation-prone float subtraction. Floating point
+// is only used when the window is finalized.
+// ============================================
+struct FixedStats {
+    uint32_t count;
+    int32_t offset;               // First sample of the window
+    int64_t sum;                  // Sum of (x - offset)
+    uint64_t sumSq;               // Sum of (x - offset)^2
+    int32_t min;
+    int32_t max;
+
+    FixedStats() { reset(); }
+
+    void reset() {
+        count = 0;
+        offset = 0;
+        sum = 0;
+        sumSq = 0;
+        min = INT32_MAX;
+        max = INT32_MIN;
+    }
+
+    /**
+     * Add a sample
+     * @param x Sample in packet units
+     */
+    void add(int32_t x) {
+        if (count == 0) offset = x;
+        count++;
+        int64_t d = (int64_t)x - offset;
+        sum += d;
+        sumSq += (uint64_t)(d * d);
+        if (x < min) min = x;
+        if (x > max) max = x;
+    }
+
+    /**
+     * Get the mean
+     * @return Mean in packet units, 0 if empty
+     */
+    double mean() const {
+        if (count == 0) return 0;
+        return offset + (double)sum / count;
+    }
+
+    /**
+     * Get sample standard deviation (n - 1 denominator)
+     * @return Standard deviation in packet units, 0 with fewer than two samples
+     */
+    double stddev() const {
+        if (count < 2) return 0;
+        double s = (double)sum;
+        double m2 = (double)sumSq - s * s / count;
+        return m2 > 0 ? sqrt(m2 / (count - 1)) : 0;
+    }
+};
+
+#endif // RUNNING_STATS_H
@@ -0,0 +1,177 @@
+/**
+ * COW-Bois Weather Station - Raw Sample Buffer
+ * Fixed-capacity structure-of-arrays ring buffer of the current window
+ */
+
+#ifndef SAMPLE_BUFFER_H
+#define SAMPLE_BUFFER_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "data/weather_data.h"
+
+// ============================================
+// Sample Buffer
+// One contiguous array per WEATHER_FIELDS channel plus one validity
+// bit per field per sample. Scans over a single field touch only that
+// field's array, so statistics, QC re-runs and dumps are tight loops.
+// When full, the oldest sample is overwritten.
+// ============================================
+class SampleBuffer {
+public:
+    static const size_t CAPACITY = MAX_SAMPLES_PER_INTERVAL;
+    static const size_t VALID_WORDS = (CAPACITY + 31) / 32;
+
+    SampleBuffer();
+
+    /**
+     * Append a reading (all fields valid if reading.isValid)
+     * @param reading Weather reading
+     */
+    void push(const WeatherReading& reading);
+
+    /**
+     * Append a reading with per-field validity
+     * @param reading Weather reading
+     * @param validMask Bit (1 << DataField) set for each valid field
+     */
+    void push(const WeatherReading& reading, uint32_t validMask);
+
+    /**
+     * Remove all samples
+     */
+    void clear();
+
+    /**
+     * Get number of samples held
+     * @return Sample count (at most CAPACITY)
+     */
+    size_t size() const { return _count; }
+
+    /**
+     * Check if samples have been overwritten since the last clear()
+     * @return true if more than CAPACITY samples were pushed
+     */
+    bool hasOverflowed() const { return _overflowed; }
+
+    /**
+     * Get timestamp of a sample
+     * @param index Sample index (0 = oldest)
+     * @return millis() timestamp
+     */
+    uint32_t getTimestamp(size_t index) const;
+
+    /**
+     * Get a field value
+     * @param field Data field
+     * @param index Sample index (0 = oldest)
+     * @return Value converted to float
+     */
+    float getValue(DataField field, size_t index) const;
+
+    /**
+     * Check field validity of a sample
+     * @param field Data field
+     * @param index Sample index (0 = oldest)
+     * @return true if the value is valid
+     */
+    bool isValid(DataField field, size_t index) const;
+
+    /**
+     * Mark a field of a sample invalid (late QC decision)
+     * @param field Data field
+     * @param index Sample index (0 = oldest)
+     */
+    void invalidate(DataField field, size_t index);
+
+    /**
+     * Rebuild a full reading from the buffer
+     * @param index Sample index (0 = oldest)
+     * @param reading Output reading (isValid if any field is valid)
+     * @return true if index is in range
+     */
+    bool getReading(size_t index, WeatherReading& reading) const;
+
+    /**
+     * Copy the last valid values of a field, oldest first
+     * @param field Data field
+     * @param n Maximum number of values
+     * @param out Output array (at least n entries)
+     * @return Number of values copied
+     */
+    size_t getLatest(DataField field, size_t n, float* out) const;
+
+    /**
+     * Call fn(value) for every valid value of a field, oldest first
+     * @param field Data field
+     * @param fn Callable taking a float
+     */
+    template <typename F>
+    void forEachValid(DataField field, F fn) const;
+
+    /**
+     * Write all samples as CSV (empty cell for invalid values)
+     * @param out Output stream (e.g. Serial)
+     */
+    void dump(Print& out) const;
+
+private:
+    // Field arrays, generated from WEATHER_FIELDS
+    uint32_t _timestamp[CAPACITY];
+#define SAMPLE_ARRAY(id, member, prefix, type, ...) type _##member[CAPACITY];
+    WEATHER_FIELDS(SAMPLE_ARRAY)
+#undef SAMPLE_ARRAY
+
+    uint32_t _valid[WEATHER_FIELD_COUNT][VALID_WORDS];
+
+    size_t _head;                 // Slot of the oldest sample
+    size_t _count;
+    bool _overflowed;
+
+    size_t slot(size_t index) const {
+        size_t s = _head + index;
+        return s < CAPACITY ? s : s - CAPACITY;
+    }
+
+    bool validAt(uint8_t field, size_t s) const {
+        return (_valid[field][s >> 5] >> (s & 31)) & 1;
+    }
+
+    template <typename T, typename F>
+    void scan(const T* values, uint8_t field, F& fn) const;
+};
+
+// Compile-time memory report
+static_assert(SampleBuffer::CAPACITY > 0, "MAX_SAMPLES_PER_INTERVAL must be positive");
+static_assert(sizeof(SampleBuffer) <= SAMPLE_BUFFER_MAX_BYTES,
+              "SampleBuffer exceeds SAMPLE_BUFFER_MAX_BYTES - lower MAX_SAMPLES_PER_INTERVAL");
+
+// ============================================
+// Template Implementation
+// ============================================
+
+template <typename T, typename F>
+void SampleBuffer::scan(const T* values, uint8_t field, F& fn) const {
+    // The ring is at most two linear runs: [head, end) then [0, rest)
+    size_t first = _count < CAPACITY - _head ? _count : CAPACITY - _head;
+    for (size_t s = _head; s < _head + first; s++) {
+        if (validAt(field, s)) fn((float)values[s]);
+    }
+    for (size_t s = 0; s < _count - first; s++) {
+        if (validAt(field, s)) fn((float)values[s]);
+    }
+}
+
+template <typename F>
+void SampleBuffer::forEachValid(DataField field, F fn) const {
+    switch (field) {
+#define SAMPLE_SCAN(id, member, ...) \
+        case DataField::id: scan(_##member, (uint8_t)field, fn); break;
+        WEATHER_FIELDS(SAMPLE_SCAN)
+#undef SAMPLE_SCAN
+        default:
+            break;
+    }
+}
+
+#endif // SAMPLE_BUFFER_H
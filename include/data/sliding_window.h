@@ -0,0 +1,221 @@
+/**
+ * COW-Bois Weather Station - Sliding Window Aggregator
+ * Rolling statistics that update every sample in O(1) amortized time
+ */
+
+#ifndef SLIDING_WINDOW_H
+#define SLIDING_WINDOW_H
+
+#include <Arduino.h>
+#include <type_traits>
+#include "config.h"
+#include "data/weather_data.h"
+
+// Ring slot index (one byte while the window holds at most 256 samples)
+typedef std::conditional<(ROLLING_WINDOW_SAMPLES <= 256), uint8_t, uint16_t>::type RollingSlot;
+
+// ============================================
+// Rolling Statistics (one STATS field)
+// Shifted running sums with subtraction on eviction, plus monotonic
+// deques of ring slots for min and max. The sums are rebuilt from the
+// ring once per ROLLING_WINDOW_SAMPLES evictions to stop float drift.
+// Samples where QC flagged the field hold NAN and are skipped.
+// ============================================
+struct RollingStats {
+    static const size_t CAPACITY = ROLLING_WINDOW_SAMPLES;
+
+    float values[CAPACITY];       // Raw values by ring slot (NAN = flagged)
+    float shift;                  // Reference value subtracted before summing
+    float sum;                    // Sum of (value - shift)
+    float sumSq;                  // Sum of (value - shift)^2
+    uint16_t count;               // Valid values in the window
+    uint16_t evictions;           // Evictions since the last rebuild
+
+    RollingSlot minQ[CAPACITY];   // Slots with increasing values (front = min)
+    RollingSlot maxQ[CAPACITY];   // Slots with decreasing values (front = max)
+    uint16_t minHead, minCount;
+    uint16_t maxHead, maxCount;
+
+    RollingStats() { reset(); }
+
+    void reset() {
+        shift = 0;
+        sum = 0;
+        sumSq = 0;
+        count = 0;
+        evictions = 0;
+        minHead = minCount = 0;
+        maxHead = maxCount = 0;
+    }
+
+    /**
+     * Add the newest sample
+     * @param x Sample value
+     * @param slot Ring slot of the sample
+     */
+    void add(float x, size_t slot);
+
+    /**
+     * Hold the slot of a sample where QC flagged the field
+     * @param slot Ring slot of the sample
+     */
+    void skip(size_t slot) { values[slot] = NAN; }
+
+    /**
+     * Remove the oldest sample
+     * @param slot Ring slot of the evicted sample
+     * @param head Ring slot of the oldest remaining sample
+     * @param samples Samples remaining in the ring
+     */
+    void evict(size_t slot, size_t head, size_t samples);
+
+    float mean() const {
+        return count ? shift + sum / (float)count : 0;
+    }
+
+    float stddev() const;
+
+    float min() const { return minCount ? values[minQ[minHead]] : 0; }
+    float max() const { return maxCount ? values[maxQ[maxHead]] : 0; }
+
+    /**
+     * Exact quantiles of the window (nearest rank, like P2Quantile's
+     * startup samples): O(count) selections over a copy of the ring
+     * @param head Ring slot of the oldest sample
+     * @param samples Samples in the ring
+     * @param scratch Work array of CAPACITY values
+     * @param p05 Output 5th percentile
+     * @param p50 Output median
+     * @param p95 Output 95th percentile
+     */
+    void quantiles(size_t head, size_t samples, float* scratch,
+                   float& p05, float& p50, float& p95) const;
+
+private:
+    void rebuild(size_t head, size_t samples);
+};
+
+// ============================================
+// Rolling Circular Mean (wind direction)
+// Exact integer sums of Q15 unit vectors
+// ============================================
+struct RollingCircular {
+    static const size_t CAPACITY = ROLLING_WINDOW_SAMPLES;
+    static const uint16_t SKIPPED = 0xFFFF;   // Slot of a QC-flagged sample
+
+    uint16_t values[CAPACITY];
+    int64_t sinSum;
+    int64_t cosSum;
+
+    RollingCircular() { reset(); }
+
+    void reset() {
+        sinSum = 0;
+        cosSum = 0;
+    }
+
+    void add(uint16_t degrees, size_t slot);
+    void skip(size_t slot) { values[slot] = SKIPPED; }
+    void evict(size_t slot);
+    float mean() const;
+};
+
+// ============================================
+// Sliding Window Aggregator
+// Same WeatherReading in / AggregatedData out as DataAggregator, but the
+// window ends at the newest sample and never resets. Samples older than
+// windowMs, or beyond ROLLING_WINDOW_SAMPLES, are evicted; fields
+// flagged by QC are left out of that field's statistics. Quantiles
+// of QUANTILES fields are selected from the ring in getAggregatedData()
+// rather than kept per sample, since P2 markers cannot forget a value.
+// The rings are the window's own: the SampleBuffer holds only the
+// current tumbling window and is cleared at its end.
+// ============================================
+class SlidingWindow {
+public:
+    static const size_t CAPACITY = ROLLING_WINDOW_SAMPLES;
+
+    /**
+     * @param windowMs Window length in milliseconds
+     */
+    explicit SlidingWindow(uint32_t windowMs = ROLLING_WINDOW_MS);
+
+    /**
+     * Add a sensor reading (evicts expired samples first)
+     * @param reading Weather reading (uses reading.timestamp)
+     */
+    void addSample(const WeatherReading& reading);
+
+    /**
+     * Add a sensor reading, leaving out fields that failed QC
+     * @param reading Weather reading (uses reading.timestamp)
+     * @param qc Quality control result for the reading
+     */
+    void addSample(const WeatherReading& reading, const QCResult& qc);
+
+    /**
+     * Remove all samples
+     */
+    void reset();
+
+    /**
+     * Change the window length (removes all samples)
+     * @param windowMs Window length in milliseconds
+     */
+    void setWindowMs(uint32_t windowMs);
+
+    /**
+     * Get number of samples in the window
+     * @return Sample count
+     */
+    size_t getSampleCount() const { return _count; }
+
+    /**
+     * Get rolling statistics for the current window
+     * @return AggregatedData (timestamp = newest sample)
+     */
+    AggregatedData getAggregatedData() const;
+
+    /**
+     * Get rolling average of a field
+     * @param field Data field
+     * @return Current average (latest value for cumulative fields)
+     */
+    float getAverage(DataField field) const;
+
+    /**
+     * Get rolling minimum of a field
+     * @param field Data field (STATS fields only)
+     * @return Minimum, or 0 if not tracked
+     */
+    float getMin(DataField field) const;
+
+    /**
+     * Get rolling maximum of a field
+     * @param field Data field (STATS fields only)
+     * @return Maximum, or 0 if not tracked
+     */
+    float getMax(DataField field) const;
+
+private:
+    uint32_t _windowMs;
+    uint32_t _timestamps[CAPACITY];
+    size_t _head;                 // Slot of the oldest sample
+    size_t _count;
+
+    // Per-field state, generated from WEATHER_FIELDS
+#define ROLLING_STATE_STATS(p) RollingStats _##p;
+#define ROLLING_STATE_CIRCULAR(p) RollingCircular _##p;
+#define ROLLING_STATE_LATEST(p) float _##p;
+#define ROLLING_STATE(id, member, prefix, type, kind, ...) ROLLING_STATE_##kind(prefix)
+    WEATHER_FIELDS(ROLLING_STATE)
+#undef ROLLING_STATE_STATS
+#undef ROLLING_STATE_CIRCULAR
+#undef ROLLING_STATE_LATEST
+#undef ROLLING_STATE
+
+    void evictOldest();
+    void add(const WeatherReading& reading, uint32_t validMask);
+};
+
+#endif // SLIDING_WINDOW_H
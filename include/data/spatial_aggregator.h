@@ -0,0 +1,145 @@
+/**
+ * COW-Bois Weather Station - Spatial Aggregator
+ * Network-wide statistics across all stations for one report window
+ */
+
+#ifndef SPATIAL_AGGREGATOR_H
+#define SPATIAL_AGGREGATOR_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "data/weather_data.h"
+
+// ============================================
+// Spatial Field Summary
+// ============================================
+struct SpatialField {
+    uint16_t stations;            // Stations reporting the field this window
+    float mean;                   // Mean of the station window means (equal weight)
+    float spread;                 // Std dev of the station means (0 with one station)
+    float min;                    // Lowest window minimum in the network
+    float max;                    // Highest window maximum in the network
+    char minStation[9];           // Station with the minimum
+    char maxStation[9];           // Station with the maximum
+    bool hasExtremes;             // false for directions (CIRCULAR)
+    bool hasGradient;             // Plane fit possible (see SpatialAggregator)
+    float gradient;               // Field units per km, toward increasing values
+    float gradientDir;            // Degrees clockwise from north
+
+    SpatialField()
+        : stations(0), mean(0), spread(0), min(0), max(0), hasExtremes(false),
+          hasGradient(false), gradient(0), gradientDir(0) {
+        minStation[0] = '\0';
+        maxStation[0] = '\0';
+    }
+};
+
+// ============================================
+// Spatial Aggregator
+// Fed once per station with its closed window (the main station's own
+// window and every StationTable::flush() callback). Each field keeps
+// only sums - count, sum and sum of squares of the station means, the
+// extremes, and the moments of a least-squares plane v = a + b*x + c*y
+// over station positions (local east/north km from the reference) - so
+// adding a station is O(fields) and two aggregators merge exactly.
+// A gradient needs SPATIAL_MIN_GRADIENT_STATIONS positioned stations
+// that are not all on one line; stations without a position (0, 0)
+// still count toward mean / min / max.
+// ============================================
+class SpatialAggregator {
+public:
+    SpatialAggregator();
+
+    /**
+     * Set the origin of the local coordinates (usually the main station)
+     * Without one, the first positioned station of the window is used.
+     * @param latitude Degrees north
+     * @param longitude Degrees east
+     */
+    void setReference(float latitude, float longitude);
+
+    /**
+     * Start a new window (keeps the reference)
+     */
+    void reset();
+
+    /**
+     * Add one station's window
+     * Fields without a valid sample (all rejected by QC) are skipped.
+     * @param stationId Station identifier
+     * @param data Closed window of the station
+     * @param latitude Station latitude (0 with longitude 0 = unknown)
+     * @param longitude Station longitude
+     */
+    void addStation(const char* stationId, const AggregatedData& data,
+                    float latitude, float longitude);
+
+    /**
+     * Add the stations of another aggregator
+     * Plane sums are relative to the reference, so both must use the same
+     * one (or one has none yet).
+     * @param other Aggregator to merge in
+     * @return false if the references differ or the station count would
+     *         overflow (nothing merged)
+     */
+    bool merge(const SpatialAggregator& other);
+
+    /**
+     * Get number of stations added this window
+     * @return Station count
+     */
+    uint16_t getStationCount() const { return _stations; }
+
+    /**
+     * Get total samples over all stations
+     * @return Sample count
+     */
+    uint32_t getSampleCount() const { return _samples; }
+
+    /**
+     * Get latest window end of the stations added
+     * @return Timestamp in ms
+     */
+    uint32_t getTimestamp() const { return _timestamp; }
+
+    /**
+     * Get the network summary of a field
+     * @param field Field
+     * @param summary Output summary
+     * @return false if no station reported the field
+     */
+    bool getField(DataField field, SpatialField& summary) const;
+
+private:
+    struct FieldState {
+        uint16_t count;           // Stations with the field
+        double sum;               // Station means (sin for CIRCULAR)
+        double sumSq;             // Squared station means (cos for CIRCULAR)
+        float min, max;
+        char minStation[9];
+        char maxStation[9];
+
+        // Plane fit moments over positioned stations
+        uint16_t planeCount;
+        double sx, sy, sxx, sxy, syy;
+        double sv, sxv, syv;
+    };
+
+    FieldState _fields[WEATHER_FIELD_COUNT];
+    uint16_t _stations;
+    uint32_t _samples;
+    uint32_t _timestamp;
+
+    float _refLatitude;
+    float _refLongitude;
+    float _kmPerDegLon;           // Scale of longitude at the reference latitude
+    bool _refFixed;               // Set by setReference()
+    bool _refValid;
+
+    void useReference(float latitude, float longitude);
+    void addValue(FieldState& state, const char* stationId, float mean,
+                  float min, float max, bool positioned, double x, double y);
+    void addDirection(FieldState& state, uint16_t direction);
+};
+
+#endif // SPATIAL_AGGREGATOR_H
@@ -0,0 +1,130 @@
+/**
+ * COW-Bois Weather Station - Microstation Table
+ * Per-microstation aggregation on the main station, keyed by MAC address
+ */
+
+#ifndef STATION_TABLE_H
+#define STATION_TABLE_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "data/weather_data.h"
+#include "data/data_aggregator.h"
+
+// Called once per station with samples when the table is flushed
+// (position from the station's packets, 0 / 0 if it sends none)
+typedef void (*StationFlushCallback)(const uint8_t* mac, const char* stationId,
+                                     const AggregatedData& data,
+                                     float latitude, float longitude);
+
+static_assert((STATION_TABLE_SIZE & (STATION_TABLE_SIZE - 1)) == 0,
+              "STATION_TABLE_SIZE must be a power of two");
+static_assert(STATION_TABLE_MAX_STATIONS < STATION_TABLE_SIZE,
+              "Station table needs at least one free slot");
+
+// ============================================
+// Station Table
+// Fixed-size open-addressed hash table (linear probing, backward-shift
+// deletion) holding one DataAggregator per microstation. addReading()
+// runs in the ESP-NOW receive callback (WiFi task) and only copies the
+// raw reading into a small queue under a spinlock; drain() (from loop(),
+// and at the start of flush()) does the lookup and aggregation, so the
+// table itself is touched by loop() alone.
+// ============================================
+class StationTable {
+public:
+    StationTable();
+
+    /**
+     * Queue a reading received from a microstation
+     * @param mac Sender MAC address (6 bytes)
+     * @param stationId Station identifier from the packet
+     * @param reading Unpacked weather reading
+     * @param latitude Station latitude from the packet (0 = unknown)
+     * @param longitude Station longitude from the packet (0 = unknown)
+     * @param fieldMask Fields the packet carries (FIELD_BIT); the rest
+     *                  count as missing
+     * @return false if the queue is full (reading dropped)
+     */
+    bool addReading(const uint8_t* mac, const char* stationId, const WeatherReading& reading,
+                    float latitude = 0, float longitude = 0,
+                    uint32_t fieldMask = QC_ALL_FIELDS);
+
+    /**
+     * Aggregate the queued readings into their stations
+     * Call from loop(); readings of a new station are dropped if the
+     * table is full.
+     * @return Number of readings aggregated
+     */
+    size_t drain();
+
+    /**
+     * Close the window of every station and report the ones with samples
+     * Queued readings are drained first. Stations silent for STATION_STALE_FLUSHES flushes are removed.
+     * @param callback Function called per station with data
+     * @return Number of stations reported
+     */
+    size_t flush(StationFlushCallback callback);
+
+    /**
+     * Get number of stations tracked
+     * @return Station count
+     */
+    size_t getStationCount() const { return _count; }
+
+    /**
+     * Get number of readings dropped because the queue or table was full
+     * @return Dropped reading count
+     */
+    uint32_t getDroppedCount() const { return _dropped; }
+
+    /**
+     * Get average probe length of the last lookups (diagnostics)
+     * @return Slots inspected per lookup
+     */
+    float getAverageProbes() const;
+
+    /**
+     * Remove all stations
+     */
+    void clear();
+
+private:
+    struct Entry {
+        uint64_t key;                 // MAC address, 0 = empty slot
+        char stationId[9];
+        float latitude;
+        float longitude;
+        uint8_t emptyFlushes;         // Consecutive flushes without samples
+        DataAggregator aggregator;
+    };
+
+    // Raw reading as received, waiting for drain()
+    struct Pending {
+        uint64_t key;
+        char stationId[9];
+        float latitude;
+        float longitude;
+        uint32_t fieldMask;
+        WeatherReading reading;
+    };
+
+    Entry _entries[STATION_TABLE_SIZE];
+    size_t _count;
+    Pending _pending[STATION_QUEUE_SIZE];
+    uint8_t _pendingHead;
+    uint8_t _pendingCount;
+    uint32_t _dropped;
+    uint32_t _lookups;
+    uint32_t _probes;
+    portMUX_TYPE _lock;           // Guards the pending queue and _dropped
+
+    static uint64_t macToKey(const uint8_t* mac);
+    static void keyToMac(uint64_t key, uint8_t* mac);
+    static size_t home(uint64_t key);
+
+    int find(uint64_t key, bool insert);
+    void remove(size_t slot);
+};
+
+#endif // STATION_TABLE_H
@@ -0,0 +1,81 @@
+/**
+ * COW-Bois Weather Station - Streaming Quantile Estimator
+ * Constant-memory P-square (Jain & Chlamtac) quantile estimation
+ */
+
+#ifndef STREAMING_QUANTILE_H
+#define STREAMING_QUANTILE_H
+
+#include <Arduino.h>
+
+// ============================================
+// P-square Quantile Estimator
+// Tracks a single quantile with 5 markers (68 bytes),
+// independent of the number of samples
+// ============================================
+class P2Quantile {
+public:
+    /**
+     * @param quantile Target quantile in (0, 1), e.g. 0.5 for the median
+     */
+    explicit P2Quantile(float quantile = 0.5f);
+
+    /**
+     * Clear all markers (keeps the target quantile)
+     */
+    void reset();
+
+    /**
+     * Add a sample to the estimate
+     * @param x Sample value
+     */
+    void add(float x);
+
+    /**
+     * Get current quantile estimate
+     * @return Estimated quantile, exact for up to 5 samples, 0 if empty
+     */
+    float getValue() const;
+
+    /**
+     * Get number of samples seen
+     * @return Sample count
+     */
+    uint32_t getCount() const { return _count; }
+
+private:
+    float _p;                     // Target quantile
+    uint32_t _count;
+    float _heights[5];            // Marker heights (q)
+    int32_t _positions[5];        // Actual marker positions (n)
+    float _desired[5];            // Desired marker positions (n')
+
+    float parabolic(int i, int d) const;
+    float linear(int i, int d) const;
+};
+
+// ============================================
+// Window Quantiles
+// 5th percentile, median and 95th percentile of one field
+// ============================================
+struct WindowQuantiles {
+    P2Quantile p05;
+    P2Quantile p50;
+    P2Quantile p95;
+
+    WindowQuantiles() : p05(0.05f), p50(0.50f), p95(0.95f) {}
+
+    void reset() {
+        p05.reset();
+        p50.reset();
+        p95.reset();
+    }
+
+    void add(float x) {
+        p05.add(x);
+        p50.add(x);
+        p95.add(x);
+    }
+};
+
+#endif // STREAMING_QUANTILE_H
@@ -7,131 +7,207 @@
 #define WEATHER_DATA_H
 
 #include <Arduino.h>
+#include "config.h"
+#include "data/weather_fields.h"
+#include "data/wind_rose.h"
 
 // ============================================
 // Single Sensor Reading
+// Members are generated from WEATHER_FIELDS (weather_fields.h)
 // ============================================
 struct WeatherReading {
     uint32_t timestamp;           // millis() timestamp
 
-    // Temperature, Humidity, Pressure, Gas (BME680)
-    float temperature;            // °C
-    float humidity;               // % RH
-    float pressure;               // hPa (mb)
-    float gasResistance;          // KOhms (air quality indicator)
+#define READING_MEMBER(id, member, prefix, type, ...) type member;
+    WEATHER_FIELDS(READING_MEMBER)
+#undef READING_MEMBER
 
-    // Solar Radiation (TSL2591)
-    uint32_t lux;                 // Raw lux value
-    float solarIrradiance;        // W/m²
+    // Data validity flag
+    bool isValid;
 
-    // Air Quality (SGP30)
-    uint16_t co2;                 // ppm (equivalent CO2)
-    uint16_t tvoc;                // ppb (Total VOC)
+    // Default constructor
+#define READING_INIT(id, member, ...) , member(0)
+    WeatherReading() :
+        timestamp(0)
+        WEATHER_FIELDS(READING_INIT),
+        isValid(false) {}
+#undef READING_INIT
+};
 
-    // Wind (Flex sensors)
-    float windSpeed;              // m/s
-    uint16_t windDirection;       // degrees (0-359)
+// ============================================
+// Scaled Reading
+// The same fields as integers in ESP-NOW packet units (value * wireScale,
+// rounded), for the fixed-point aggregation path
+// ============================================
+struct ScaledReading {
+    uint32_t timestamp;
 
-    // Precipitation (HX711 load cell)
-    float precipitation;          // mm
+#define SCALED_MEMBER(id, member, ...) int32_t member;
+    WEATHER_FIELDS(SCALED_MEMBER)
+#undef SCALED_MEMBER
 
-    // Data validity flag
     bool isValid;
 
-    // Default constructor
-    WeatherReading() :
-        timestamp(0),
-        temperature(0), humidity(0), pressure(0), gasResistance(0),
-        lux(0), solarIrradiance(0),
-        co2(0), tvoc(0),
-        windSpeed(0), windDirection(0),
-        precipitation(0),
+#define SCALED_INIT(id, member, ...) , member(0)
+    ScaledReading() :
+        timestamp(0)
+        WEATHER_FIELDS(SCALED_INIT),
         isValid(false) {}
+#undef SCALED_INIT
+};
+
+// ============================================
+// Quality Control Flags
+// One bitmap per field per reading (see QualityControl)
+// ============================================
+enum QCFlag : uint8_t {
+    QC_MISSING     = 1 << 0,      // Sensor read failed or sensor absent
+    QC_RANGE       = 1 << 1,      // Outside qcMin..qcMax
+    QC_STEP        = 1 << 2,      // Changed faster than qcStep per minute
+    QC_PERSISTENCE = 1 << 3,      // Unchanged for qcPersist minutes
+    QC_CONSISTENCY = 1 << 4       // Contradicts a related field
+};
+
+static const uint8_t QC_CHECK_COUNT = 5;
+
+// Bit (1 << DataField) set for every field
+static const uint32_t QC_ALL_FIELDS = (1UL << WEATHER_FIELD_COUNT) - 1;
+
+struct QCResult {
+    uint8_t flags[WEATHER_FIELD_COUNT];   // QCFlag bitmap per field
+    uint32_t validMask;                   // Bit (1 << DataField) set if unflagged
+
+    QCResult() : flags(), validMask(QC_ALL_FIELDS) {}
+
+    bool passed(DataField field) const {
+        return validMask & (1UL << (uint8_t)field);
+    }
 };
 
 // ============================================
 // Aggregated Data (5-minute interval)
+// Per-field members are generated from WEATHER_FIELDS:
+//   STATS     <prefix>Avg, <prefix>Min, <prefix>Max, <prefix>StdDev
+//   CIRCULAR  <prefix>Avg
+//   LATEST    <prefix>
+//   QUANTILES <prefix>P05, <prefix>Median, <prefix>P95
 // ============================================
+#define AGG_MEMBERS_STATS(type, p) type p##Avg; type p##Min; type p##Max; float p##StdDev;
+#define AGG_MEMBERS_CIRCULAR(type, p) type p##Avg;
+#define AGG_MEMBERS_LATEST(type, p) type p;
+#define AGG_MEMBERS_QUANTILES(p) float p##P05; float p##Median; float p##P95;
+#define AGG_MEMBERS_NONE(p)
+#define AGG_MEMBER(id, member, prefix, type, kind, quant, ...) \
+    AGG_MEMBERS_##kind(type, prefix) AGG_MEMBERS_##quant(prefix)
+
+#define AGG_INIT_STATS(p) , p##Avg(0), p##Min(0), p##Max(0), p##StdDev(0)
+#define AGG_INIT_CIRCULAR(p) , p##Avg(0)
+#define AGG_INIT_LATEST(p) , p(0)
+#define AGG_INIT_QUANTILES(p) , p##P05(0), p##Median(0), p##P95(0)
+#define AGG_INIT_NONE(p)
+#define AGG_INIT(id, member, prefix, type, kind, quant, ...) \
+    AGG_INIT_##kind(prefix) AGG_INIT_##quant(prefix)
+
 struct AggregatedData {
     uint32_t timestamp;           // End timestamp
     uint32_t windowDurationMs;    // Duration of aggregation window
-    uint16_t sampleCount;         // Number of samples averaged
-
-    // Temperature
-    float tempAvg;
-    float tempMin;
-    float tempMax;
-
-    // Humidity
-    float humidityAvg;
-    float humidityMin;
-    float humidityMax;
-
-    // Pressure
-    float pressureAvg;
-    float pressureMin;
-    float pressureMax;
-
-    // Gas Resistance (BME680)
-    float gasResistanceAvg;
-    float gasResistanceMin;
-    float gasResistanceMax;
-
-    // Wind
-    float windSpeedAvg;
-    float windSpeedMax;           // Gust
-    uint16_t windDirAvg;          // Circular average
-
-    // Precipitation (cumulative)
-    float precipitation;
-
-    // Light
-    uint32_t luxAvg;
-    uint32_t luxMax;
-    float solarAvg;
-
-    // Air Quality
-    uint16_t co2Avg;
-    uint16_t co2Max;
-    uint16_t tvocAvg;
-    uint16_t tvocMax;
+    uint32_t sampleCount;         // Number of samples averaged
+
+    WEATHER_FIELDS(AGG_MEMBER)
+
+    // Quality control: samples left out of each field's statistics and
+    // how often each check fired (index = bit position in QCFlag)
+    uint32_t qcRejected[WEATHER_FIELD_COUNT];
+    uint32_t qcFlagCounts[QC_CHECK_COUNT];
+
+    // Direction x speed histogram of the window's wind samples
+    WindRose windRose;
 
     // Default constructor
     AggregatedData() :
-        timestamp(0), windowDurationMs(0), sampleCount(0),
-        tempAvg(0), tempMin(999), tempMax(-999),
-        humidityAvg(0), humidityMin(999), humidityMax(0),
-        pressureAvg(0), pressureMin(9999), pressureMax(0),
-        gasResistanceAvg(0), gasResistanceMin(9999), gasResistanceMax(0),
-        windSpeedAvg(0), windSpeedMax(0), windDirAvg(0),
-        precipitation(0),
-        luxAvg(0), luxMax(0), solarAvg(0),
-        co2Avg(0), co2Max(0), tvocAvg(0), tvocMax(0) {}
+        timestamp(0), windowDurationMs(0), sampleCount(0)
+        WEATHER_FIELDS(AGG_INIT),
+        qcRejected(), qcFlagCounts() {}
 };
 
+#undef AGG_MEMBERS_STATS
+#undef AGG_MEMBERS_CIRCULAR
+#undef AGG_MEMBERS_LATEST
+#undef AGG_MEMBERS_QUANTILES
+#undef AGG_MEMBERS_NONE
+#undef AGG_MEMBER
+#undef AGG_INIT_STATS
+#undef AGG_INIT_CIRCULAR
+#undef AGG_INIT_LATEST
+#undef AGG_INIT_QUANTILES
+#undef AGG_INIT_NONE
+#undef AGG_INIT
+
 // ============================================
 // ESP-NOW Packet Structure
 // Must fit in 250 bytes (ESP-NOW limit)
 // ============================================
+#define ESPNOW_PACKET_WEATHER 0x01     // Version 1: wireVer 1 fields only
+#define ESPNOW_PACKET_EVENT 0x02
+#define ESPNOW_PACKET_WEATHER_V2 0x03  // Version 2: every field and the position
+
+// Version 1 is the original layout and a prefix of version 2: fields added
+// later and the position follow the flags, so older microstations stay
+// readable (the newer fields arrive as absent)
 struct __attribute__((packed)) ESPNowPacket {
-    uint8_t packetType;           // 0x01 = weather data
+    uint8_t packetType;           // ESPNOW_PACKET_WEATHER or ESPNOW_PACKET_WEATHER_V2
     char stationId[9];            // Station identifier (null-terminated)
     uint32_t timestamp;
 
-    // Compressed sensor data (scaled integers)
-    int16_t temperature;          // °C * 100
-    uint16_t humidity;            // % * 100
-    uint16_t pressure;            // hPa * 10
-    uint16_t gasResistance;       // KOhms * 10
-    uint16_t windSpeed;           // m/s * 100
-    uint16_t windDirection;       // degrees
-    uint16_t precipitation;       // mm * 100
-    uint32_t lux;                 // raw lux
-    uint16_t co2;                 // ppm
-    uint16_t tvoc;                // ppb
-    uint16_t batteryVoltage;      // mV
+    // Compressed sensor data (scaled integers, see wireScale in WEATHER_FIELDS)
+#define PACKET_SELECT_1_1(wireType, member) wireType member;
+#define PACKET_SELECT_1_2(wireType, member)
+#define PACKET_SELECT_2_1(wireType, member)
+#define PACKET_SELECT_2_2(wireType, member) wireType member;
+#define PACKET_MEMBER(version, id, member, prefix, type, kind, quant, key, shortKey, unit, \
+                      wireType, wireScale, qcMin, qcMax, qcStep, qcPersist, deadband, \
+                      deadbandPct, extrema, mqttKey, wireVer, ...) \
+    PACKET_SELECT_##version##_##wireVer(wireType, member)
+#define PACKET_MEMBER_V1(...) PACKET_MEMBER(1, __VA_ARGS__)
+#define PACKET_MEMBER_V2(...) PACKET_MEMBER(2, __VA_ARGS__)
+    WEATHER_FIELDS(PACKET_MEMBER_V1)
 
+    uint16_t batteryVoltage;      // mV
     uint8_t flags;                // Bit flags (bit 0 = isValid)
+
+    // Version 2 only
+    WEATHER_FIELDS(PACKET_MEMBER_V2)
+    int32_t latitude;             // Station position, 1e-5 degrees (0, 0 = unknown)
+    int32_t longitude;
+
+    uint8_t checksum;             // Simple XOR checksum
+};
+
+#undef PACKET_SELECT_1_1
+#undef PACKET_SELECT_1_2
+#undef PACKET_SELECT_2_1
+#undef PACKET_SELECT_2_2
+#undef PACKET_MEMBER
+#undef PACKET_MEMBER_V1
+#undef PACKET_MEMBER_V2
+
+// A version 1 packet ends with its checksum right after the flags
+static const size_t ESPNOW_PACKET_V1_SIZE = offsetof(ESPNowPacket, flags) + 2;
+static_assert(ESPNOW_PACKET_V1_SIZE == 40,
+              "Version 1 layout changed - deployed microstations would be rejected");
+
+static_assert(sizeof(ESPNowPacket) <= ESPNOW_MAX_PACKET_SIZE,
+              "ESPNowPacket exceeds the ESP-NOW payload limit");
+
+// Microstation event, sent at once outside the report schedule
+struct __attribute__((packed)) ESPNowEventPacket {
+    uint8_t packetType;           // ESPNOW_PACKET_EVENT
+    char stationId[9];
+    uint32_t timestamp;
+    uint8_t rule;                 // Index into the event rule table
+    float value;
+    float change;
+    uint16_t suppressed;          // Events dropped by the sender's rate limit
     uint8_t checksum;             // Simple XOR checksum
 };
 
@@ -151,4 +227,20 @@ struct SensorStatus {
     }
 };
 
+// ============================================
+// Station Health (<prefix>/<id>/status)
+// ============================================
+struct StationHealth {
+    float batteryVoltage;
+    uint8_t batteryPercent;
+    uint32_t uptimeSec;
+    uint32_t windSpikes;          // Wind speed readings replaced by the spike filters
+    uint32_t precipSpikes;        // Gauge readings replaced by the spike filter
+    uint32_t eventsDropped;       // Events lost to the rate limit or a full queue
+
+    StationHealth()
+        : batteryVoltage(0), batteryPercent(0), uptimeSec(0),
+          windSpikes(0), precipSpikes(0), eventsDropped(0) {}
+};
+
 #endif // WEATHER_DATA_H
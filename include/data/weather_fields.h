@@ -0,0 +1,140 @@
+/**
+ * COW-Bois Weather Station - Weather Field Registry
+ * Single compile-time table describing every sensor channel
+ */
+
+#ifndef WEATHER_FIELDS_H
+#define WEATHER_FIELDS_H
+
+#include <Arduino.h>
+#include <limits>
+
+// ============================================
+// Field Registry
+// One line per sensor channel. Expanded (X-macro) to generate
+// WeatherReading, AggregatedData, ESPNowPacket, the DataAggregator
+// accumulate/finalize/merge code and every DataFormatter output.
+//
+// Columns:
+//   id         DataField enumerator
+//   member     WeatherReading / ESPNowPacket member name
+//   prefix     AggregatedData member prefix (tempAvg, tempMin, ...)
+//   type       Value type in WeatherReading and AggregatedData
+//   kind       STATS    - avg/min/max/std
+//              CIRCULAR - vector mean of a direction in degrees
+//              LATEST   - last value (sensor already accumulates)
+//   quant      QUANTILES adds streaming p05/median/p95, NONE otherwise
+//   key        JSON key / CSV reading column
+//   shortKey   CSV column / InfluxDB field prefix
+//   unit       Unit string for MQTT payloads
+//   wireType   ESP-NOW packet type
+//   wireScale  ESP-NOW scale (packet = value * scale, rounded and clamped)
+//   qcMin      QC range check lower limit
+//   qcMax      QC range check upper limit
+//   qcStep     QC step check: max change per minute (0 = off)
+//   qcPersist  QC persistence check: minutes a value may stay unchanged
+//              (0 = off; values at qcMin/qcMax are exempt)
+//   deadband   Report compression tolerance, absolute (field units)
+//   deadbandPct  Report compression tolerance, percent of the last sent
+//              value (the larger of the two applies)
+//   extrema    Extremes a STATS field reports besides avg/std in the text
+//              outputs: MINMAX, MAX or NONE (kept as first published)
+//   mqttKey    MQTT payload key ("" = not in the MQTT report)
+//   wireVer    ESP-NOW packet version that added the field: 1 = original
+//              layout, 2 = appended after it (see ESPNowPacket)
+//   group      Object of the aggregated JSON record that holds the field
+//              ("" = its own object under key; a group's fields are
+//              adjacent in the table)
+//   groupKey   Prefix of the field's statistics inside its group
+//              ("speed_" -> "speed_avg", "speed_max", ...)
+//
+// Consumers that only need the leading columns end their parameter
+// list with "..." so new columns can be appended without touching them.
+// ============================================
+#define WEATHER_FIELDS(X) \
+    /* id                member            prefix          type       kind       quant       key                  shortKey          unit      wireType   wireScale  qcMin    qcMax      qcStep  qcPersist  deadband                 deadbandPct                extrema  mqttKey             wireVer  group          groupKey */ \
+    X(TEMPERATURE,       temperature,      temp,           float,     STATS,     QUANTILES,  "temperature",       "temp",           "C",      int16_t,   100.0f,    -40.0f,  60.0f,     3.0f,   60,        TEMP_ACCURACY_C,         0.0f,                      MINMAX,  "temperature",      1,        "",            ""          ) \
+    X(HUMIDITY,          humidity,         humidity,       float,     STATS,     NONE,       "humidity",          "humidity",       "%",      uint16_t,  100.0f,    0.0f,    100.0f,    20.0f,  60,        HUMIDITY_ACCURACY_PCT,   0.0f,                      MINMAX,  "humidity",         1,        "",            ""          ) \
+    X(PRESSURE,          pressure,         pressure,       float,     STATS,     NONE,       "pressure",          "pressure",       "hPa",    uint16_t,  10.0f,     600.0f,  1100.0f,   1.0f,   60,        PRESSURE_ACCURACY_MB,    0.0f,                      MINMAX,  "pressure",         1,        "",            ""          ) \
+    X(GAS_RESISTANCE,    gasResistance,    gasResistance,  float,     STATS,     NONE,       "gas_resistance",    "gas",            "KOhms",  uint16_t,  10.0f,     0.0f,    50000.0f,  0.0f,   60,        0.0f,                    AIR_QUALITY_ACCURACY_PCT,  MINMAX,  "gas_resistance",   1,        "",            ""          ) \
+    X(WIND_SPEED,        windSpeed,        windSpeed,      float,     STATS,     QUANTILES,  "wind_speed",        "wind_speed",     "m/s",    uint16_t,  100.0f,    0.0f,    75.0f,     0.0f,   60,        WIND_SPEED_ACCURACY_MS,  0.0f,                      MAX,     "wind_speed",       1,        "wind",        "speed_"    ) \
+    X(WIND_DIRECTION,    windDirection,    windDir,        uint16_t,  CIRCULAR,  NONE,       "wind_direction",    "wind_dir",       "deg",    uint16_t,  1.0f,      0.0f,    359.0f,    0.0f,   60,        WIND_DIR_ACCURACY_DEG,   0.0f,                      NONE,    "wind_direction",   1,        "wind",        "direction_") \
+    X(PRECIPITATION,     precipitation,    precipitation,  float,     LATEST,    NONE,       "precipitation",     "precipitation",  "mm",     uint16_t,  100.0f,    0.0f,    1000.0f,   5.0f,   0,         PRECIP_RESOLUTION_MM,    PRECIP_ACCURACY_PCT,       NONE,    "precipitation",    1,        "",            ""          ) \
+    X(LUX,               lux,              lux,            uint32_t,  STATS,     NONE,       "lux",               "lux",            "lux",    uint32_t,  1.0f,      0.0f,    88000.0f,  0.0f,   0,         0.0f,                    SOLAR_ACCURACY_PCT,        MAX,     "",                 1,        "light",       "lux_"      ) \
+    X(SOLAR_IRRADIANCE,  solarIrradiance,  solar,          float,     STATS,     NONE,       "solar_irradiance",  "solar",          "W/m2",   uint16_t,  10.0f,     0.0f,    1500.0f,   0.0f,   60,        SOLAR_RESOLUTION_WM2,    SOLAR_ACCURACY_PCT,        NONE,    "solar_radiation",  2,        "light",       "solar_"    ) \
+    X(CO2,               co2,              co2,            uint16_t,  STATS,     NONE,       "co2",               "co2",            "ppm",    uint16_t,  1.0f,      400.0f,  60000.0f,  0.0f,   0,         0.0f,                    AIR_QUALITY_ACCURACY_PCT,  MAX,     "co2",              1,        "air_quality", "co2_"      ) \
+    X(TVOC,              tvoc,             tvoc,           uint16_t,  STATS,     NONE,       "tvoc",              "tvoc",           "ppb",    uint16_t,  1.0f,      0.0f,    60000.0f,  0.0f,   0,         0.0f,                    AIR_QUALITY_ACCURACY_PCT,  MAX,     "tvoc",             1,        "air_quality", "tvoc_"     )
+
+// Data field enumeration (registry order)
+enum class DataField : uint8_t {
+#define DATA_FIELD_ENUM(id, ...) id,
+    WEATHER_FIELDS(DATA_FIELD_ENUM)
+#undef DATA_FIELD_ENUM
+    COUNT
+};
+
+static const uint8_t WEATHER_FIELD_COUNT = (uint8_t)DataField::COUNT;
+
+// Bit of a field in per-field validity masks
+#define FIELD_BIT(id) (1UL << (uint8_t)DataField::id)
+static_assert(WEATHER_FIELD_COUNT < 32, "Per-field validity masks are 32-bit");
+
+// ============================================
+// Value Conversion Helpers
+// ============================================
+
+/**
+ * Convert a float statistic to a field's storage type
+ * Integer fields are rounded to nearest.
+ */
+template <typename T>
+inline T fieldCast(float value) {
+    if (value <= 0) return 0;
+    return (T)(value + 0.5f);
+}
+
+template <>
+inline float fieldCast<float>(float value) {
+    return value;
+}
+
+/**
+ * Convert a decoded value to a field's storage type
+ * Like fieldCast, but integer fields saturate and NaN reads as 0 - for
+ * values from payloads that may be damaged.
+ */
+template <typename T>
+inline T fieldClamp(float value) {
+    if (!(value > 0)) return 0;
+    if (value >= (float)std::numeric_limits<T>::max()) return std::numeric_limits<T>::max();
+    return fieldCast<T>(value);
+}
+
+template <>
+inline float fieldClamp<float>(float value) {
+    return value;
+}
+
+/**
+ * Scale a value to its ESP-NOW packet representation
+ * Rounds to nearest and clamps to the range of the wire type.
+ */
+template <typename W>
+inline W toWire(float value, float scale) {
+    float scaled = value * scale;
+    const float lo = (float)std::numeric_limits<W>::min();
+    const float hi = (float)std::numeric_limits<W>::max();
+    if (scaled <= lo) return std::numeric_limits<W>::min();
+    if (scaled >= hi) return std::numeric_limits<W>::max();
+    return (W)(scaled < 0 ? scaled - 0.5f : scaled + 0.5f);
+}
+
+/**
+ * Convert an ESP-NOW packet value back to engineering units
+ */
+template <typename T, typename W>
+inline T fromWire(W wire, float scale) {
+    return fieldCast<T>((float)wire / scale);
+}
+
+#endif // WEATHER_FIELDS_H
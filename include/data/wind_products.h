@@ -0,0 +1,106 @@
+/**
+ * COW-Bois Weather Station - Wind Products
+ * WMO-No. 8 gust and mean wind from 4 Hz wind samples
+ */
+
+#ifndef WIND_PRODUCTS_H
+#define WIND_PRODUCTS_H
+
+#include <Arduino.h>
+#include "config.h"
+
+static_assert(WIND_MEAN_SHORT_MS % WIND_BLOCK_MS == 0 && WIND_MEAN_LONG_MS % WIND_BLOCK_MS == 0,
+              "Wind mean periods must be whole numbers of WIND_BLOCK_MS blocks");
+static_assert(WIND_MEAN_SHORT_MS <= WIND_MEAN_LONG_MS, "Short wind mean must not exceed long mean");
+
+// ============================================
+// Wind Products Data
+// ============================================
+struct WindMean {
+    float scalarSpeed;            // Mean of speeds (m/s)
+    float vectorSpeed;            // Magnitude of the mean wind vector (m/s)
+    uint16_t direction;           // Direction of the mean wind vector (deg)
+    bool valid;                   // Full averaging period available
+
+    WindMean() : scalarSpeed(0), vectorSpeed(0), direction(0), valid(false) {}
+};
+
+struct WindProductsData {
+    float gust;                   // Max 3-s running mean over the long period (m/s)
+    uint16_t gustDirection;       // Mean direction of the gust's 3-s window (deg)
+    bool gustValid;
+    WindMean mean2min;
+    WindMean mean10min;
+
+    WindProductsData() : gust(0), gustDirection(0), gustValid(false) {}
+};
+
+// ============================================
+// Wind Products
+// Fixed memory: a GUST_SAMPLES ring for the 3-s running mean and
+// BLOCKS sub-averages (speed, vector components, peak gust) covering
+// the long period. O(1) per sample; getProducts() sums at most BLOCKS.
+// ============================================
+class WindProducts {
+public:
+    static const size_t GUST_SAMPLES = WIND_GUST_WINDOW_MS / WIND_SAMPLE_INTERVAL_MS;
+    static const size_t BLOCKS = WIND_MEAN_LONG_MS / WIND_BLOCK_MS;
+    static const size_t SHORT_BLOCKS = WIND_MEAN_SHORT_MS / WIND_BLOCK_MS;
+
+    WindProducts();
+
+    /**
+     * Add a wind sample (call every WIND_SAMPLE_INTERVAL_MS)
+     * @param speed Wind speed in m/s
+     * @param direction Wind direction in degrees
+     * @param timestamp millis() of the sample
+     */
+    void addSample(float speed, uint16_t direction, uint32_t timestamp);
+
+    /**
+     * Get gust and mean wind over the periods ending at the last
+     * completed block
+     * @return Wind products (fields invalid until enough data)
+     */
+    WindProductsData getProducts() const;
+
+    /**
+     * Clear all samples
+     */
+    void reset();
+
+private:
+    struct Block {
+        float speedSum;
+        float uSum;               // Sum of speed * sin(direction)
+        float vSum;               // Sum of speed * cos(direction)
+        uint16_t count;
+        float gust;               // Highest 3-s mean ending in this block
+        uint16_t gustDirection;
+    };
+
+    // 3-s running mean
+    float _gustSpeed[GUST_SAMPLES];
+    int16_t _gustSin[GUST_SAMPLES];
+    int16_t _gustCos[GUST_SAMPLES];
+    float _gustSum;
+    int32_t _gustSinSum;
+    int32_t _gustCosSum;
+    size_t _gustHead;
+    size_t _gustCount;
+    uint32_t _lastTimestamp;
+
+    // Completed blocks (ring) and the block being filled
+    Block _blocks[BLOCKS];
+    size_t _blockHead;            // Slot of the oldest completed block
+    size_t _blockCount;
+    Block _current;
+    uint32_t _currentIndex;       // timestamp / WIND_BLOCK_MS of _current
+    bool _started;
+
+    void closeBlock();
+    void clearBlock(Block& block);
+    WindMean mean(size_t blocks) const;
+};
+
+#endif // WIND_PRODUCTS_H
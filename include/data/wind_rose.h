@@ -0,0 +1,158 @@
+/**
+ * COW-Bois Weather Station - Wind Rose
+ * Constant-memory direction x speed histogram for aggregation windows
+ */
+
+#ifndef WIND_ROSE_H
+#define WIND_ROSE_H
+
+#include <Arduino.h>
+#include <string.h>
+#include "config.h"
+
+// A daily rollup of SAMPLE_INTERVAL_MS samples must fit one counter
+static_assert(86400000UL / SAMPLE_INTERVAL_MS <= 0xFFFF,
+              "Wind rose counters are 16-bit; a day of samples would saturate them");
+
+// ============================================
+// Wind Rose
+// 16 compass sectors (22.5 deg, sector 0 centred on N) x 6 speed classes:
+//   [0.5, 2.1) [2.1, 3.6) [3.6, 5.7) [5.7, 8.8) [8.8, 11.1) [11.1, inf) m/s
+// Speeds below QC_CALM_WIND_MS count as calm, without a sector.
+// Counters saturate rather than wrap; merging adds them.
+// ============================================
+struct WindRose {
+    static const uint8_t SECTORS = 16;
+    static const uint8_t SPEED_CLASSES = 6;
+
+    uint16_t calm;
+    uint16_t counts[SECTORS][SPEED_CLASSES];
+
+    WindRose() { reset(); }
+
+    void reset() {
+        calm = 0;
+        memset(counts, 0, sizeof(counts));
+    }
+
+    /**
+     * Add a sample
+     * @param speed Wind speed (m/s)
+     * @param direction Wind direction (degrees)
+     */
+    void add(float speed, uint16_t direction) {
+        if (speed < QC_CALM_WIND_MS) {
+            increment(calm, 1);
+        } else {
+            increment(counts[sectorOf(direction)][speedClass(speed)], 1);
+        }
+    }
+
+    /**
+     * Add a sample in packet units (fixed-point aggregation)
+     * @param speedCms Wind speed (cm/s)
+     * @param direction Wind direction (degrees)
+     */
+    void addScaled(int32_t speedCms, uint16_t direction) {
+        if (speedCms < (int32_t)(QC_CALM_WIND_MS * 100.0f)) {
+            increment(calm, 1);
+        } else {
+            increment(counts[sectorOf(direction)][speedClassScaled(speedCms)], 1);
+        }
+    }
+
+    /**
+     * Add the counts of another rose (later or parallel window)
+     * @param other Rose to add
+     */
+    void merge(const WindRose& other) {
+        increment(calm, other.calm);
+        for (uint8_t s = 0; s < SECTORS; s++) {
+            for (uint8_t c = 0; c < SPEED_CLASSES; c++) {
+                increment(counts[s][c], other.counts[s][c]);
+            }
+        }
+    }
+
+    /**
+     * Get number of samples in a sector (all speed classes)
+     * @param sector Sector index (0 = N, clockwise)
+     * @return Sample count
+     */
+    uint32_t sectorTotal(uint8_t sector) const {
+        uint32_t total = 0;
+        for (uint8_t c = 0; c < SPEED_CLASSES; c++) total += counts[sector][c];
+        return total;
+    }
+
+    /**
+     * Get number of samples in the rose, calm included
+     * @return Sample count
+     */
+    uint32_t total() const {
+        uint32_t total = calm;
+        for (uint8_t s = 0; s < SECTORS; s++) total += sectorTotal(s);
+        return total;
+    }
+
+    /**
+     * Sector of a direction
+     * @param degrees Direction in degrees (any value, reduced mod 360)
+     * @return Sector index (0 = N, clockwise)
+     */
+    static uint8_t sectorOf(uint16_t degrees) {
+        // Tenths of a degree, shifted by half a sector
+        return (uint8_t)((((uint32_t)(degrees % 360) * 10 + 112) % 3600) / 225);
+    }
+
+    /**
+     * Speed class of a non-calm speed
+     * @param speed Wind speed (m/s)
+     * @return Class index
+     */
+    static uint8_t speedClass(float speed) {
+        if (speed < 2.1f) return 0;
+        if (speed < 3.6f) return 1;
+        if (speed < 5.7f) return 2;
+        if (speed < 8.8f) return 3;
+        if (speed < 11.1f) return 4;
+        return 5;
+    }
+
+    /**
+     * Speed class of a non-calm speed in cm/s (same bounds as speedClass)
+     * @param speedCms Wind speed (cm/s)
+     * @return Class index
+     */
+    static uint8_t speedClassScaled(int32_t speedCms) {
+        if (speedCms < 210) return 0;
+        if (speedCms < 360) return 1;
+        if (speedCms < 570) return 2;
+        if (speedCms < 880) return 3;
+        if (speedCms < 1110) return 4;
+        return 5;
+    }
+
+    /**
+     * 16-point compass name of a sector
+     * @param sector Sector index (0 = N, clockwise)
+     * @return "N", "NNE", ... "NNW"
+     */
+    static const char* sectorName(uint8_t sector) {
+        static const char* const names[SECTORS] = {
+            "N", "NNE", "NE", "ENE",
+            "E", "ESE", "SE", "SSE",
+            "S", "SSW", "SW", "WSW",
+            "W", "WNW", "NW", "NNW"
+        };
+        return names[sector % SECTORS];
+    }
+
+private:
+    static void increment(uint16_t& counter, uint32_t by) {
+        uint32_t sum = (uint32_t)counter + by;
+        counter = sum > 0xFFFF ? 0xFFFF : (uint16_t)sum;
+    }
+};
+
+#endif // WIND_ROSE_H
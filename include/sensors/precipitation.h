@@ -10,6 +10,7 @@
 #include <HX711.h>
 #include "pin_definitions.h"
 #include "config.h"
+#include "data/hampel_filter.h"
 
 class PrecipitationSensor {
 public:
@@ -42,6 +43,12 @@ public:
      */
     float readPrecipitation();
 
+    /**
+     * Get number of readings replaced by the spike filter
+     * @return Rejected reading count since begin()
+     */
+    uint32_t getSpikeCount() const { return _spikeFilter.getRejectedCount(); }
+
     /**
      * Read raw weight in grams
      * @return Weight in grams
@@ -102,6 +109,7 @@ private:
     float _collectorArea;
     float _lastWeight;
     long _tareOffset;
+    HampelFilter _spikeFilter;    // Load-cell spikes, in mm (SPIKE_FILTER)
 
     uint8_t _dataPin;
     uint8_t _clockPin;
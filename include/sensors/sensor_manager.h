@@ -31,6 +31,15 @@ public:
      */
     bool readAll(WeatherReading& reading);
 
+    /**
+     * Read all sensors and report which fields were actually read
+     * Fields of failed or absent sensors are left at 0 with their bit clear.
+     * @param reading Reference to WeatherReading to populate
+     * @param validMask Set to bit (1 << DataField) for each field read
+     * @return true if at least critical sensors read successfully
+     */
+    bool readAll(WeatherReading& reading, uint32_t& validMask);
+
     /**
      * Get status of all sensors
      * @return SensorStatus struct with individual sensor states
@@ -64,6 +73,8 @@ private:
 
     SensorStatus _status;
     bool _initialized;
+    bool _compensated;            // SGP30 humidity compensation set at least once
+    uint32_t _lastCompensationTime;
 };
 
 #endif // SENSOR_MANAGER_H
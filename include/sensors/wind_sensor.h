@@ -8,6 +8,7 @@
 
 #include <Arduino.h>
 #include "pin_definitions.h"
+#include "data/hampel_filter.h"
 
 class WindSensor {
 public:
@@ -30,9 +31,19 @@ public:
 
     /**
      * Read wind speed
+     * @param fast true for the WIND_SAMPLE_INTERVAL_MS gust stream, false
+     *             for the sample-interval reading (separate spike filters)
      * @return Wind speed in m/s
      */
-    float readWindSpeed();
+    float readWindSpeed(bool fast = false);
+
+    /**
+     * Get number of speed readings replaced by the spike filters
+     * @return Rejected reading count since begin(), both streams
+     */
+    uint32_t getSpikeCount() const {
+        return _sampleFilter.getRejectedCount() + _fastFilter.getRejectedCount();
+    }
 
     /**
      * Read wind direction
@@ -44,9 +55,10 @@ public:
      * Read both speed and direction
      * @param speed Reference to store speed (m/s)
      * @param direction Reference to store direction (degrees)
+     * @param fast true for the gust stream (see readWindSpeed)
      * @return true if read successful
      */
-    bool readAll(float& speed, uint16_t& direction);
+    bool readAll(float& speed, uint16_t& direction, bool fast = false);
 
     /**
      * Get raw ADC values (for calibration)
@@ -95,6 +107,11 @@ private:
     // Last readings cache
     uint16_t _lastSpeedRaw;
     uint16_t _lastDirRaw;
+
+    // Flex-sensor spikes (SPIKE_FILTER); one filter per sample rate, so
+    // each window spans a fixed time
+    HampelFilter _sampleFilter;   // SAMPLE_INTERVAL_MS readings
+    HampelFilter _fastFilter;     // WIND_SAMPLE_INTERVAL_MS gust stream
 };
 
 #endif // WIND_SENSOR_H
@@ -0,0 +1,122 @@
+/**
+ * COW-Bois Weather Station - Buffer Writer
+ * Bounds-checked text output with a printf subset that avoids the C library
+ */
+
+#ifndef BUFFER_WRITER_H
+#define BUFFER_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include "util/output_sink.h"
+
+// ============================================
+// Buffer Writer
+// Appends to a caller's buffer; like snprintf, output past the end is
+// dropped, the buffer stays NUL-terminated and length() is the length
+// the output would have had if the buffer were large enough.
+//
+// printf() understands the conversions the formatters use - %s %c %d %i
+// %u %x %X %f with the 0 and - flags, a width, a precision and the l /
+// ll length modifiers, plus %% - and produces the same bytes as the C
+// library: %f is rounded exactly (round-half-even on the binary value)
+// with integer arithmetic instead of newlib's dtoa, so it is faster
+// and needs a fraction of the stack. Literal text between conversions
+// (the keys folded into each format string) is copied as one block.
+// Anything else (%e, %g, NaN, values beyond 64-bit fixed point) is
+// handed to vsnprintf one conversion at a time.
+//
+// Given a sink instead, output is staged in a small chunk and handed to
+// the sink whenever the chunk fills, and the rest when the writer goes
+// out of scope; nothing is dropped and there is no NUL. A C library
+// conversion longer than the chunk (never produced by the formatters)
+// is cut to fit, and setLibcFormatting() does not apply.
+// ============================================
+class BufferWriter {
+public:
+    BufferWriter(char* buffer, size_t size);
+
+    /**
+     * Stream into a sink
+     * @param sink Destination
+     * @param chunk Staging storage (SINK_CHUNK_BYTES is a good size)
+     * @param chunkSize Size of staging storage
+     */
+    BufferWriter(OutputSink& sink, char* chunk, size_t chunkSize);
+
+    ~BufferWriter();
+
+    /**
+     * Append formatted text
+     * @param format printf format string
+     */
+    void printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    /**
+     * Append formatted text
+     * @param format printf format string
+     * @param args Arguments
+     */
+    void vprintf(const char* format, va_list args);
+
+    /**
+     * Append raw text
+     * @param text Characters to copy
+     * @param length Number of characters
+     */
+    void append(const char* text, size_t length);
+
+    /**
+     * Append a NUL-terminated string
+     * @param text String to copy
+     */
+    void append(const char* text);
+
+    /**
+     * Append a decimal number with a fixed number of decimals (%.Nf)
+     * @param value Value
+     * @param decimals Digits after the point (0-9)
+     */
+    void appendFixed(double value, uint8_t decimals);
+
+    /**
+     * Append an unsigned integer (%u)
+     * @param value Value
+     */
+    void appendUnsigned(uint64_t value);
+
+    /**
+     * Append a signed integer (%d)
+     * @param value Value
+     */
+    void appendSigned(int64_t value);
+
+    /**
+     * Get output length
+     * @return Characters written (streamed), or that would have been written
+     */
+    size_t length() const { return _length; }
+
+    /**
+     * Format every printf() with vsnprintf instead
+     * Reference output for tests and benchmarks; off by default.
+     * @param enabled true to use the C library
+     */
+    static void setLibcFormatting(bool enabled) { _libc = enabled; }
+
+private:
+    char* _buffer;
+    size_t _size;
+    size_t _length;
+    OutputSink* _sink;
+    size_t _staged;                   // Bytes in the chunk not yet given to the sink
+
+    static bool _libc;
+
+    void drain();
+    void pad(char fill, size_t count);
+    void appendField(const char* text, size_t length, uint8_t width, bool left, bool zero);
+};
+
+#endif // BUFFER_WRITER_H
@@ -0,0 +1,186 @@
+/**
+ * COW-Bois Weather Station - CBOR
+ * Minimal RFC 8949 encoder and decoder for binary MQTT payloads
+ */
+
+#ifndef CBOR_H
+#define CBOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "util/output_sink.h"
+
+// ============================================
+// CBOR Writer
+// Definite-length maps and arrays, integers, text strings, booleans
+// and null - all the report schema uses. Like BufferWriter, output past
+// the end of the buffer is dropped and length() is the size the
+// encoding needs, so a caller can detect truncation. Given a sink, the
+// encoding is staged in a small chunk and streamed into it, the rest
+// when the writer goes out of scope.
+// ============================================
+class CborWriter {
+public:
+    CborWriter(uint8_t* buffer, size_t size);
+
+    /**
+     * Stream into a sink
+     * @param sink Destination
+     * @param chunk Staging storage
+     * @param chunkSize Size of staging storage
+     */
+    CborWriter(OutputSink& sink, uint8_t* chunk, size_t chunkSize);
+
+    ~CborWriter();
+
+    /**
+     * Start a map; the next 2 * pairs items are its keys and values
+     * @param pairs Number of key/value pairs
+     */
+    void beginMap(uint32_t pairs);
+
+    /**
+     * Start an array; the next count items are its elements
+     * @param count Number of elements
+     */
+    void beginArray(uint32_t count);
+
+    /**
+     * Write an unsigned integer
+     * @param value Value
+     */
+    void writeUnsigned(uint64_t value);
+
+    /**
+     * Write a signed integer
+     * @param value Value
+     */
+    void writeInt(int64_t value);
+
+    /**
+     * Write a UTF-8 text string
+     * @param text NUL-terminated string
+     */
+    void writeText(const char* text);
+
+    /**
+     * Write true or false
+     * @param value Value
+     */
+    void writeBool(bool value);
+
+    /**
+     * Write null
+     */
+    void writeNull();
+
+    /**
+     * Get encoded length
+     * @return Bytes written, or that would have been written
+     */
+    size_t length() const { return _length; }
+
+private:
+    uint8_t* _buffer;
+    size_t _size;
+    size_t _length;
+    OutputSink* _sink;
+    size_t _staged;                   // Bytes in the chunk not yet given to the sink
+
+    void drain();
+    void put(uint8_t byte);
+    void putBytes(const uint8_t* bytes, size_t length);
+    void writeHead(uint8_t major, uint64_t argument);
+};
+
+// ============================================
+// CBOR Reader
+// Pull decoder over a complete message. Every read checks the major
+// type and bounds; after the first error all reads fail and ok()
+// returns false. Indefinite lengths and tags are rejected; floats can
+// only be skipped.
+// ============================================
+class CborReader {
+public:
+    CborReader(const uint8_t* data, size_t length);
+
+    /**
+     * Read a map header
+     * @param pairs Output number of key/value pairs
+     * @return true if the next item is a map
+     */
+    bool readMap(uint32_t& pairs);
+
+    /**
+     * Read an array header
+     * @param count Output number of elements
+     * @return true if the next item is an array
+     */
+    bool readArray(uint32_t& count);
+
+    /**
+     * Read an unsigned integer
+     * @param value Output value
+     * @return true if the next item is an unsigned integer
+     */
+    bool readUnsigned(uint64_t& value);
+
+    /**
+     * Read a signed or unsigned integer
+     * @param value Output value
+     * @return true if the next item is an integer within int64_t
+     */
+    bool readInt(int64_t& value);
+
+    /**
+     * Read a text string
+     * @param text Output buffer (NUL-terminated, truncated to fit)
+     * @param size Size of output buffer
+     * @return true if the next item is a text string
+     */
+    bool readText(char* text, size_t size);
+
+    /**
+     * Read a boolean
+     * @param value Output value
+     * @return true if the next item is true or false
+     */
+    bool readBool(bool& value);
+
+    /**
+     * Consume the next item if it is null
+     * @return true if a null was consumed
+     */
+    bool readNull();
+
+    /**
+     * Skip the next item, including nested maps and arrays
+     * @return true if a complete item was skipped
+     */
+    bool skip();
+
+    /**
+     * Check for decoding errors
+     * @return true if every read so far succeeded
+     */
+    bool ok() const { return !_failed; }
+
+    /**
+     * Check if the whole message was consumed
+     * @return true at the end of the data
+     */
+    bool atEnd() const { return _position >= _length; }
+
+private:
+    const uint8_t* _data;
+    size_t _length;
+    size_t _position;
+    bool _failed;
+
+    bool readHead(uint8_t& major, uint64_t& argument);
+    bool expect(uint8_t major, uint64_t& argument);
+    bool fail();
+    bool skipItem(uint8_t depth);
+};
+
+#endif // CBOR_H
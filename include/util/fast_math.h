@@ -0,0 +1,193 @@
+/**
+ * COW-Bois Weather Station - Fast Math
+ * Table and polynomial replacements for libm calls on the sampling path
+ *
+ * Each kernel documents its maximum error, checked at compile time
+ * against the accuracy thresholds in config.h and measured against
+ * libm by test/test_fast_math. Header-only apart from the sine table
+ * in fast_math.cpp; no Arduino dependency so it also builds on the host.
+ */
+
+#ifndef FAST_MATH_H
+#define FAST_MATH_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "config.h"
+
+// ============================================
+// Fixed-Point Trigonometry
+// Whole-degree sine/cosine in Q15 (32767 = 1.0) from a quarter-wave table
+// Exact at whole degrees up to Q15 rounding (half an LSB).
+// ============================================
+#define FAST_TRIG_ONE 32767
+#define FAST_TRIG_MAX_ERROR (0.5f / FAST_TRIG_ONE)
+
+extern const int16_t SIN_Q15_TABLE[91];
+
+/**
+ * Sine and cosine of a whole-degree angle
+ * @param degrees Angle in degrees (any value, reduced mod 360)
+ * @param sinQ15 Output sine, Q15
+ * @param cosQ15 Output cosine, Q15
+ */
+inline void fastSinCosDeg(uint16_t degrees, int16_t& sinQ15, int16_t& cosQ15) {
+    uint16_t d = degrees % 360;
+    if (d < 90) {
+        sinQ15 = SIN_Q15_TABLE[d];
+        cosQ15 = SIN_Q15_TABLE[90 - d];
+    } else if (d < 180) {
+        sinQ15 = SIN_Q15_TABLE[180 - d];
+        cosQ15 = -SIN_Q15_TABLE[d - 90];
+    } else if (d < 270) {
+        sinQ15 = -SIN_Q15_TABLE[d - 180];
+        cosQ15 = -SIN_Q15_TABLE[270 - d];
+    } else {
+        sinQ15 = -SIN_Q15_TABLE[360 - d];
+        cosQ15 = SIN_Q15_TABLE[d - 270];
+    }
+}
+
+// ============================================
+// Fast atan2
+// Octant reduction plus the approximation
+//   atan(z) ~ pi/4 z - z (z - 1) (0.2447 + 0.0663 z),  0 <= z <= 1
+// (Rajan et al., IEEE Signal Processing Magazine, 2006).
+// Maximum error 0.0015 rad; verified by the test_aggregator sweep.
+// ============================================
+#define FAST_ATAN2_MAX_ERROR_DEG 0.1f
+
+static_assert(FAST_ATAN2_MAX_ERROR_DEG < WIND_DIR_ACCURACY_DEG,
+              "fastAtan2Deg error must stay below the wind direction sensor accuracy");
+
+/**
+ * Four-quadrant arctangent in compass degrees
+ * @param y Sine component
+ * @param x Cosine component
+ * @return Angle in [0, 360), 0 if both components are zero
+ */
+inline float fastAtan2Deg(float y, float x) {
+    float ax = fabsf(x);
+    float ay = fabsf(y);
+    if (ax == 0 && ay == 0) return 0;
+
+    bool steep = ay > ax;
+    float z = steep ? ax / ay : ay / ax;
+    float angle = z * (45.0f - (z - 1.0f) * (14.02028f + 3.79871f * z));  // Degrees
+
+    if (steep) angle = 90.0f - angle;
+    if (x < 0) angle = 180.0f - angle;
+    if (y < 0) angle = 360.0f - angle;
+    return angle >= 360.0f ? angle - 360.0f : angle;
+}
+
+// ============================================
+// Fast exp2 / log2
+// exp2: round-to-nearest range reduction, degree-4 minimax polynomial
+//       for 2^f on [-0.5, 0.5], exponent added to the float bits.
+// log2: exponent/mantissa split, mantissa in [sqrt(1/2), sqrt(2)),
+//       log2(m) = t * P(t^2) with t = (m - 1) / (m + 1), degree-2 minimax P.
+// Bounds include float rounding; see the test_fast_math sweep.
+// Used for the derived variables. The ESP32 FPU does float add/mul/madd
+// in one instruction, but a divide is a multi-instruction Newton
+// sequence, and the toolchain's expf/powf are generic newlib routines
+// (range reduction with a divide; powf adds an extended-precision log).
+// fastExp2 has no divide and fastLog2/fastPow have one. Host timings
+// (table-driven glibc, hardware divide) do not carry over;
+// test_fast_math times both on the target.
+// ============================================
+#define FAST_EXP_MAX_REL_ERROR 1e-5f       // exp2/exp for |x| <= 80, relative
+#define FAST_LOG_MAX_ABS_ERROR 2e-6f       // log for x in [1e-6, 1e6], absolute
+#define FAST_POW_MAX_REL_ERROR 1e-5f       // pow with |y * log2(x)| <= 8, relative
+
+// Sea-level pressure: 1100 hPa worst case
+static_assert(FAST_POW_MAX_REL_ERROR * 1100.0f < PRESSURE_ACCURACY_MB,
+              "fastPow error exceeds the pressure accuracy");
+// Absolute humidity tracks relative humidity one-to-one (%)
+static_assert(FAST_EXP_MAX_REL_ERROR * 100.0f < HUMIDITY_ACCURACY_PCT,
+              "fastExp error exceeds the humidity accuracy");
+// Dew point: dTd/dln(e) <= 27 C over the sensor range
+static_assert((FAST_LOG_MAX_ABS_ERROR + FAST_EXP_MAX_REL_ERROR) * 27.0f < TEMP_ACCURACY_C,
+              "fastExp/fastLog error exceeds the temperature accuracy");
+// Wind chill: (11.37 + 0.3965 * 50 C) * (100 km/h)^0.16 ~ 66 C per unit error
+static_assert(FAST_POW_MAX_REL_ERROR * 66.0f < TEMP_ACCURACY_C,
+              "fastPow error exceeds the temperature accuracy");
+
+/**
+ * Base-2 exponential
+ * @param x Exponent
+ * @return 2^x; subnormal down to -149, 0 below, +inf above 128
+ */
+inline float fastExp2(float x) {
+    if (x < -125.0f) {
+        // The exponent field cannot encode subnormals: scale up by 2^64,
+        // then let the float multiply round down into the subnormal range
+        if (x < -150.0f) return 0;
+        return fastExp2(x + 64.0f) * 5.42101086e-20f;  // 2^-64
+    }
+    if (x > 128.0f) return INFINITY;
+
+    int32_t n = (int32_t)(x + (x < 0 ? -0.5f : 0.5f));
+    float f = x - (float)n;
+    float p = 0.999999261f + f * (0.693121815f + f * (0.240247453f +
+              f * (0.0559178587f + f * 0.00957008128f)));
+
+    // Scale by 2^n through the exponent field
+    uint32_t bits;
+    memcpy(&bits, &p, sizeof(bits));
+    bits += (uint32_t)n << 23;
+    memcpy(&p, &bits, sizeof(p));
+    return p;
+}
+
+/**
+ * Base-2 logarithm
+ * @param x Argument (> 0, normal)
+ * @return log2(x); -inf for x <= 0
+ */
+inline float fastLog2(float x) {
+    if (x <= 0) return -INFINITY;
+
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    int32_t e = (int32_t)((bits >> 23) & 0xFF) - 127;
+    bits = (bits & 0x007FFFFF) | 0x3F800000;      // Mantissa in [1, 2)
+    float m;
+    memcpy(&m, &bits, sizeof(m));
+    if (m > 1.41421356f) {
+        m *= 0.5f;
+        e++;
+    }
+
+    float t = (m - 1.0f) / (m + 1.0f);
+    float s = t * t;
+    return (float)e + t * (2.88539129f + s * (0.96147081f + s * 0.598973846f));
+}
+
+/**
+ * Natural exponential
+ */
+inline float fastExp(float x) {
+    return fastExp2(x * 1.44269504f);
+}
+
+/**
+ * Natural logarithm
+ */
+inline float fastLog(float x) {
+    return fastLog2(x) * 0.693147181f;
+}
+
+/**
+ * Power for positive bases
+ * @param x Base (> 0)
+ * @param y Exponent
+ * @return x^y, 0 for x <= 0
+ */
+inline float fastPow(float x, float y) {
+    if (x <= 0) return 0;
+    return fastExp2(y * fastLog2(x));
+}
+
+#endif // FAST_MATH_H
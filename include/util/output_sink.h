@@ -0,0 +1,61 @@
+/**
+ * COW-Bois Weather Station - Output Sink
+ * Destination for payloads streamed straight into a transport
+ */
+
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Staging chunk of a writer streaming into a sink: one transport write
+// per chunk instead of one per number or key
+static const size_t SINK_CHUNK_BYTES = 256;
+
+// ============================================
+// Output Sink
+// Receives a payload in pieces, in order; flush() completes it. An MQTT
+// publish, the modem UART or a flash log implement write() with their
+// own transport call, so formatters need no payload buffer.
+// ============================================
+class OutputSink {
+public:
+    virtual ~OutputSink() {}
+
+    /**
+     * Append bytes to the payload
+     * @param data Bytes
+     * @param length Number of bytes
+     */
+    virtual void write(const uint8_t* data, size_t length) = 0;
+
+    /**
+     * Complete the payload
+     * @return true if every byte reached the transport
+     */
+    virtual bool flush() { return true; }
+};
+
+// ============================================
+// Counting Sink
+// Measures a payload without storing it - the length pass before a
+// transport that needs the size up front (MQTT, AT+HTTPDATA)
+// ============================================
+class CountingSink : public OutputSink {
+public:
+    CountingSink() : _length(0) {}
+
+    void write(const uint8_t*, size_t length) override { _length += length; }
+
+    /**
+     * Get payload length
+     * @return Bytes written so far
+     */
+    size_t length() const { return _length; }
+
+private:
+    size_t _length;
+};
+
+#endif // OUTPUT_SINK_H
@@ -0,0 +1,94 @@
+/**
+ * COW-Bois Weather Station - Ping-Pong Buffer
+ * Lock-free single-producer / single-consumer double buffer
+ */
+
+#ifndef PING_PONG_H
+#define PING_PONG_H
+
+#include <stdint.h>
+#include <atomic>
+
+// ============================================
+// Ping-Pong Buffer
+// The producer writes the active buffer between beginWrite() and
+// endWrite(); the consumer swap()s to take the other one. The swap is
+// one atomic store of the active index, so the producer never blocks.
+// A write already in flight on the old buffer is waited out by swap()
+// (consumer side only, at most one write long): the producer counts
+// every begin/end in _writes (odd = inside a write), and the consumer,
+// after publishing the new index, waits only if that count is odd and
+// only until it changes. Every write that starts after the store sees
+// the new index (both sides use sequentially consistent operations).
+// No heap, no locks; header-only so it builds without Arduino.h.
+// ============================================
+template <typename T>
+class PingPong {
+public:
+    PingPong() : _active(0), _writes(0), _swapWaits(0) {}
+
+    /**
+     * Producer: start writing
+     * @return Active buffer; valid until endWrite()
+     */
+    T& beginWrite() {
+        _writes.fetch_add(1, std::memory_order_seq_cst);
+        return _buffers[_active.load(std::memory_order_seq_cst)];
+    }
+
+    /**
+     * Producer: finish the write started by beginWrite()
+     */
+    void endWrite() {
+        _writes.fetch_add(1, std::memory_order_release);
+    }
+
+    /**
+     * Consumer: make the other buffer active and take this one
+     * The returned buffer belongs to the consumer until the next swap();
+     * leave it empty (reset) before then, the producer continues in it.
+     * @return Buffer the producer was writing
+     */
+    T& swap() {
+        uint32_t old = _active.load(std::memory_order_relaxed);
+        _active.store(old ^ 1, std::memory_order_seq_cst);
+
+        uint32_t writes = _writes.load(std::memory_order_seq_cst);
+        if (writes & 1) {
+            _swapWaits++;
+            while (_writes.load(std::memory_order_acquire) == writes) {
+                // One write, a few microseconds
+            }
+        }
+        return _buffers[old];
+    }
+
+    /**
+     * Consumer: the buffer the producer is not writing
+     * @return Buffer returned by the last swap()
+     */
+    T& standby() {
+        return _buffers[_active.load(std::memory_order_relaxed) ^ 1];
+    }
+
+    /**
+     * Consumer: direct access before any producer runs (setup only)
+     * @param index 0 or 1
+     * @return Buffer
+     */
+    T& buffer(uint8_t index) { return _buffers[index & 1]; }
+
+    /**
+     * Get number of swaps that had to wait for a write in flight
+     * @return Wait count (consumer side)
+     */
+    uint32_t getSwapWaits() const { return _swapWaits; }
+
+private:
+    T _buffers[2];
+    std::atomic<uint32_t> _active;    // Index the producer writes
+    std::atomic<uint32_t> _writes;    // begin + end count; odd while writing
+    uint32_t _swapWaits;              // Consumer only
+};
+
+#endif // PING_PONG_H
@@ -0,0 +1,73 @@
+/**
+ * COW-Bois Weather Station - Token Bucket
+ * Burst-then-steady rate limiter for outgoing messages
+ */
+
+#ifndef TOKEN_BUCKET_H
+#define TOKEN_BUCKET_H
+
+#include <stdint.h>
+
+// ============================================
+// Token Bucket
+// Up to capacity messages at once, then one per refillMs. Integer
+// arithmetic only; safe across millis() wraparound.
+// ============================================
+class TokenBucket {
+public:
+    /**
+     * @param capacity Largest burst (bucket starts full)
+     * @param refillMs Time to earn one token
+     */
+    TokenBucket(uint8_t capacity, uint32_t refillMs)
+        : _capacity(capacity), _tokens(capacity), _refillMs(refillMs),
+          _lastRefill(0), _started(false) {}
+
+    /**
+     * Take a token if one is available
+     * @param now Current time (millis)
+     * @return true if the message may be sent
+     */
+    bool take(uint32_t now) {
+        refill(now);
+        if (_tokens == 0) return false;
+        _tokens--;
+        return true;
+    }
+
+    /**
+     * Get tokens currently available
+     * @param now Current time (millis)
+     * @return Token count
+     */
+    uint8_t available(uint32_t now) {
+        refill(now);
+        return _tokens;
+    }
+
+private:
+    uint8_t _capacity;
+    uint8_t _tokens;
+    uint32_t _refillMs;
+    uint32_t _lastRefill;
+    bool _started;
+
+    void refill(uint32_t now) {
+        if (!_started) {
+            _started = true;
+            _lastRefill = now;
+            return;
+        }
+        uint32_t earned = (now - _lastRefill) / _refillMs;
+        if (earned == 0) return;
+        if (_tokens + earned >= _capacity) {
+            _tokens = _capacity;
+            _lastRefill = now;
+        } else {
+            _tokens += earned;
+            _lastRefill += earned * _refillMs;  // Keep the partial interval
+        }
+    }
+};
+
+#endif // TOKEN_BUCKET_H
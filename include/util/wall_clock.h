@@ -0,0 +1,113 @@
+/**
+ * COW-Bois Weather Station - Wall Clock
+ * UTC time from an occasional network sync plus millis()
+ */
+
+#ifndef WALL_CLOCK_H
+#define WALL_CLOCK_H
+
+#include <stdint.h>
+
+// ============================================
+// Wall Clock
+// Holds one (UTC, millis) pair from the last sync; unixTime() counts on
+// from there. Resync well within the 49-day millis() wrap (and often
+// enough to bound crystal drift, ~2 s/day).
+// Civil-date helpers: H. Hinnant, "chrono-compatible low-level date
+// algorithms" (proleptic Gregorian, days since 1970-01-01).
+// ============================================
+class WallClock {
+public:
+    WallClock() : _syncUnix(0), _syncMillis(0), _synced(false) {}
+
+    /**
+     * Set the clock
+     * @param unixTime UTC seconds since 1970-01-01
+     * @param nowMillis millis() at that instant
+     */
+    void sync(uint32_t unixTime, uint32_t nowMillis) {
+        _syncUnix = unixTime;
+        _syncMillis = nowMillis;
+        _synced = true;
+    }
+
+    /**
+     * Check whether the clock was ever set
+     * @return true after the first sync()
+     */
+    bool isSynced() const { return _synced; }
+
+    /**
+     * Get UTC time
+     * @param nowMillis Current millis()
+     * @return Seconds since 1970-01-01, 0 if never synced
+     */
+    uint32_t unixTime(uint32_t nowMillis) const {
+        if (!_synced) return 0;
+        return _syncUnix + (nowMillis - _syncMillis) / 1000;
+    }
+
+    /**
+     * Get UTC time of a millis() timestamp, before or after the sync
+     * @param atMillis millis() value (within 24 days of the sync)
+     * @return Milliseconds since 1970-01-01, 0 if never synced
+     */
+    uint64_t unixMillis(uint32_t atMillis) const {
+        if (!_synced) return 0;
+        return (uint64_t)_syncUnix * 1000 + (int32_t)(atMillis - _syncMillis);
+    }
+
+    /**
+     * Days since 1970-01-01 of a civil date
+     * @param year Year (e.g. 2026)
+     * @param month Month (1-12)
+     * @param day Day of month (1-31)
+     * @return Day number (negative before 1970)
+     */
+    static int32_t daysFromCivil(int32_t year, uint8_t month, uint8_t day) {
+        year -= month <= 2;
+        int32_t era = (year >= 0 ? year : year - 399) / 400;
+        uint32_t yoe = (uint32_t)(year - era * 400);
+        uint32_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + (int32_t)doe - 719468;
+    }
+
+    /**
+     * Civil date of a day number
+     * @param days Days since 1970-01-01
+     * @param year Output year
+     * @param month Output month (1-12)
+     * @param day Output day of month (1-31)
+     */
+    static void civilFromDays(int32_t days, int32_t& year, uint8_t& month, uint8_t& day) {
+        days += 719468;
+        int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+        uint32_t doe = (uint32_t)(days - era * 146097);
+        uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        uint32_t mp = (5 * doy + 2) / 153;
+        day = (uint8_t)(doy - (153 * mp + 2) / 5 + 1);
+        month = (uint8_t)(mp < 10 ? mp + 3 : mp - 9);
+        year = (int32_t)yoe + era * 400 + (month <= 2);
+    }
+
+    /**
+     * Day of year of a day number
+     * @param days Days since 1970-01-01
+     * @return 1 (1 January) to 366
+     */
+    static uint16_t dayOfYear(int32_t days) {
+        int32_t year;
+        uint8_t month, day;
+        civilFromDays(days, year, month, day);
+        return (uint16_t)(days - daysFromCivil(year, 1, 1) + 1);
+    }
+
+private:
+    uint32_t _syncUnix;
+    uint32_t _syncMillis;
+    bool _synced;
+};
+
+#endif // WALL_CLOCK_H
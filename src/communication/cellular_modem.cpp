@@ -167,6 +167,7 @@ bool CellularModem::connect(const char* apn, const char* user, const char* pass)
         DEBUG_PRINTLN("Modem: Connected to network");
         updateSignalQuality();
         getOperator();
+        sendATCommand("AT+CTZU=1", "OK", 1000);  // Take the clock from the network
     } else {
         DEBUG_PRINTLN("Modem: Failed to register on network");
     }
@@ -199,7 +200,8 @@ int CellularModem::getSignalQuality() {
     return _signalQuality;
 }
 
-bool CellularModem::sendHTTPPost(const char* url, const char* data, char* response, size_t responseSize) {
+bool CellularModem::sendHTTPPost(const char* url, const char* data, char* response, size_t responseSize,
+                                 const char* contentType) {
     if (!_connected) return false;
 
     DEBUG_PRINTF("Modem: HTTP POST to %s\n", url);
@@ -221,7 +223,8 @@ bool CellularModem::sendHTTPPost(const char* url, const char* data, char* respon
     }
 
     // Set content type
-    sendATCommand("AT+HTTPPARA=\"CONTENT\",\"application/json\"", "OK", 1000);
+    snprintf(cmd, sizeof(cmd), "AT+HTTPPARA=\"CONTENT\",\"%s\"", contentType);
+    sendATCommand(cmd, "OK", 1000);
 
     // Send data
     size_t dataLen = strlen(data);
@@ -412,6 +415,29 @@ void CellularModem::getOperator() {
     DEBUG_PRINTF("Modem: Operator: %s\n", _operatorName);
 }
 
+bool CellularModem::getNetworkTime(uint32_t& unixTime) {
+    // Wait for the final OK so the whole +CCLK line is in the buffer
+    if (!sendATCommand("AT+CCLK?", "OK", 2000)) return false;
+
+    // Format: +CCLK: "yy/MM/dd,hh:mm:ss+zz" (local time, zz in quarter hours)
+    char* ptr = strstr(_responseBuffer, "+CCLK:");
+    int year, month, day, hour, minute, second, zone;
+    if (!ptr || sscanf(ptr, "+CCLK: \"%d/%d/%d,%d:%d:%d%d\"",
+                       &year, &month, &day, &hour, &minute, &second, &zone) != 7) {
+        return false;
+    }
+
+    // Before NITZ arrives the modem counts from its default ("80/01/06")
+    if (year < 24 || year >= 80) return false;
+
+    int32_t days = WallClock::daysFromCivil(2000 + year, month, day);
+    int32_t local = days * 86400L + hour * 3600L + minute * 60L + second;
+    unixTime = (uint32_t)(local - zone * 900L);
+
+    DEBUG_PRINTF("Modem: Network time %lu\n", (unsigned long)unixTime);
+    return true;
+}
+
 void CellularModem::parseIMEI() {
     // IMEI is typically in the response after AT+CGSN
     // Look for a 15-digit number
@@ -9,9 +9,27 @@
 // Static instance for callbacks
 ESPNowHandler* ESPNowHandler::_instance = nullptr;
 
+// Station ID from the last four bytes of the WiFi MAC
+static void ownStationId(char* id, size_t size) {
+    uint8_t mac[6];
+    WiFi.macAddress(mac);
+    snprintf(id, size, "%02X%02X%02X%02X", mac[2], mac[3], mac[4], mac[5]);
+}
+
+// XOR of every byte except the trailing checksum byte
+static uint8_t xorChecksum(const uint8_t* bytes, size_t size) {
+    uint8_t checksum = 0;
+    for (size_t i = 0; i < size - 1; i++) {
+        checksum ^= bytes[i];
+    }
+    return checksum;
+}
+
 ESPNowHandler::ESPNowHandler()
     : _initialized(false)
     , _peerCount(0)
+    , _latitude(0)
+    , _longitude(0)
     , _sendCallback(nullptr)
     , _receiveCallback(nullptr) {
     _instance = this;
@@ -135,44 +153,53 @@ bool ESPNowHandler::sendData(const uint8_t* macAddress, const uint8_t* data, siz
     return true;
 }
 
+void ESPNowHandler::setLocation(float latitude, float longitude) {
+    _latitude = (int32_t)lroundf(latitude * 1e5f);
+    _longitude = (int32_t)lroundf(longitude * 1e5f);
+}
+
 bool ESPNowHandler::sendWeatherData(const uint8_t* macAddress, const WeatherReading& reading) {
     if (!_initialized) return false;
 
     // Pack weather data into ESP-NOW packet
     ESPNowPacket packet;
-    packet.packetType = 0x01;  // Weather data type
-
-    // Copy station ID from WiFi MAC
-    uint8_t mac[6];
-    WiFi.macAddress(mac);
-    snprintf(packet.stationId, sizeof(packet.stationId), "%02X%02X%02X%02X",
-             mac[2], mac[3], mac[4], mac[5]);
+    packet.packetType = ESPNOW_PACKET_WEATHER_V2;
+    ownStationId(packet.stationId, sizeof(packet.stationId));
 
     packet.timestamp = reading.timestamp;
-    packet.temperature = (int16_t)(reading.temperature * 100);  // 2 decimal places
-    packet.humidity = (uint16_t)(reading.humidity * 100);
-    packet.pressure = (uint16_t)(reading.pressure * 10);  // 1 decimal place
-    packet.gasResistance = (uint16_t)(min(reading.gasResistance * 10.0f, 65535.0f));  // 1 decimal place, clamped
-    packet.windSpeed = (uint16_t)(reading.windSpeed * 100);
-    packet.windDirection = reading.windDirection;
-    packet.precipitation = (uint16_t)(reading.precipitation * 100);
-    packet.lux = reading.lux;
-    packet.co2 = reading.co2;
-    packet.tvoc = reading.tvoc;
+
+    // Scale, round and clamp each field to its wire type
+#define PACK_FIELD(id, member, prefix, type, kind, quant, key, shortKey, unit, wireType, wireScale, ...) \
+    packet.member = toWire<wireType>((float)reading.member, wireScale);
+    WEATHER_FIELDS(PACK_FIELD)
+#undef PACK_FIELD
+
+    packet.latitude = _latitude;
+    packet.longitude = _longitude;
     packet.batteryVoltage = 0;  // To be filled by power manager
     packet.flags = reading.isValid ? 0x01 : 0x00;
 
-    // Calculate simple checksum
-    uint8_t* packetBytes = (uint8_t*)&packet;
-    uint8_t checksum = 0;
-    for (size_t i = 0; i < sizeof(ESPNowPacket) - 1; i++) {
-        checksum ^= packetBytes[i];
-    }
-    packet.checksum = checksum;
+    packet.checksum = xorChecksum((uint8_t*)&packet, sizeof(ESPNowPacket));
 
     return sendData(macAddress, (uint8_t*)&packet, sizeof(ESPNowPacket));
 }
 
+bool ESPNowHandler::sendEvent(const uint8_t* macAddress, const WeatherEvent& event) {
+    if (!_initialized) return false;
+
+    ESPNowEventPacket packet;
+    packet.packetType = ESPNOW_PACKET_EVENT;
+    ownStationId(packet.stationId, sizeof(packet.stationId));
+    packet.timestamp = event.timestamp;
+    packet.rule = event.rule;
+    packet.value = event.value;
+    packet.change = event.change;
+    packet.suppressed = event.suppressed;
+    packet.checksum = xorChecksum((uint8_t*)&packet, sizeof(ESPNowEventPacket));
+
+    return sendData(macAddress, (uint8_t*)&packet, sizeof(ESPNowEventPacket));
+}
+
 bool ESPNowHandler::broadcast(const uint8_t* data, size_t length) {
     // Broadcast address
     uint8_t broadcastAddr[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
@@ -232,27 +259,75 @@ void ESPNowHandler::setOnReceiveCallback(ESPNowReceiveCallback callback) {
 }
 
 bool ESPNowHandler::parseWeatherPacket(const uint8_t* data, size_t length, ESPNowPacket& packet) {
-    if (length != sizeof(ESPNowPacket)) {
+    // Version 1 (older microstation firmware) is the leading part of the
+    // current layout with its checksum after the flags
+    bool v1 = length == ESPNOW_PACKET_V1_SIZE && data[0] == ESPNOW_PACKET_WEATHER;
+    bool v2 = length == sizeof(ESPNowPacket) && data[0] == ESPNOW_PACKET_WEATHER_V2;
+    if (!v1 && !v2) {
         DEBUG_PRINTLN("ESP-NOW: Invalid packet size");
         return false;
     }
 
-    memcpy(&packet, data, sizeof(ESPNowPacket));
-
     // Verify checksum
-    uint8_t checksum = 0;
-    for (size_t i = 0; i < sizeof(ESPNowPacket) - 1; i++) {
-        checksum ^= data[i];
+    if (xorChecksum(data, length) != data[length - 1]) {
+        DEBUG_PRINTLN("ESP-NOW: Checksum mismatch");
+        return false;
+    }
+
+    // Fields a version 1 packet lacks read as zero (position unknown)
+    memset(&packet, 0, sizeof(ESPNowPacket));
+    memcpy(&packet, data, length - 1);
+    packet.checksum = data[length - 1];
+    return true;
+}
+
+bool ESPNowHandler::parseEventPacket(const uint8_t* data, size_t length, WeatherEvent& event) {
+    if (length != sizeof(ESPNowEventPacket) || data[0] != ESPNOW_PACKET_EVENT) {
+        DEBUG_PRINTLN("ESP-NOW: Invalid event packet");
+        return false;
     }
 
-    if (checksum != packet.checksum) {
+    ESPNowEventPacket packet;
+    memcpy(&packet, data, sizeof(ESPNowEventPacket));
+
+    if (xorChecksum(data, sizeof(ESPNowEventPacket)) != packet.checksum) {
         DEBUG_PRINTLN("ESP-NOW: Checksum mismatch");
         return false;
     }
 
+    event.timestamp = packet.timestamp;
+    memcpy(event.stationId, packet.stationId, sizeof(event.stationId));
+    event.stationId[sizeof(event.stationId) - 1] = '\0';
+    event.rule = packet.rule;
+    event.value = packet.value;
+    event.change = packet.change;
+    event.suppressed = packet.suppressed;
     return true;
 }
 
+uint32_t ESPNowHandler::unpackWeatherPacket(const ESPNowPacket& packet, WeatherReading& reading) {
+    bool v2 = packet.packetType == ESPNOW_PACKET_WEATHER_V2;
+    uint32_t fieldMask = 0;
+    reading.timestamp = packet.timestamp;
+
+#define UNPACK_FIELD(id, member, prefix, type, kind, quant, key, shortKey, unit, wireType, \
+                     wireScale, qcMin, qcMax, qcStep, qcPersist, deadband, deadbandPct, \
+                     extrema, mqttKey, wireVer, ...) \
+    reading.member = fromWire<type>(packet.member, wireScale); \
+    if (wireVer == 1 || v2) fieldMask |= FIELD_BIT(id);
+    WEATHER_FIELDS(UNPACK_FIELD)
+#undef UNPACK_FIELD
+
+    reading.isValid = (packet.flags & 0x01) != 0;
+    return fieldMask;
+}
+
+void ESPNowHandler::unpackPosition(const ESPNowPacket& packet, float& latitude,
+                                   float& longitude) {
+    latitude = packet.latitude * 1e-5f;
+    longitude = packet.longitude * 1e-5f;
+}
+
 void ESPNowHandler::getMacAddress(uint8_t* mac) {
     WiFi.macAddress(mac);
 }
@@ -4,10 +4,12 @@
 
 #include "communication/mqtt_handler.h"
 #include "config.h"
+#include "data/data_formatter.h"
 #include <WiFi.h>
 
 MQTTHandler::MQTTHandler()
     : _client(_wifiClient)
+    , _publishSink(_client)
     , _connected(false)
     , _port(MQTT_PORT)
     , _subscriptionCount(0)
@@ -120,6 +122,63 @@ bool MQTTHandler::publish(const char* topic, const char* payload, bool retained)
     return success;
 }
 
+bool MQTTHandler::publish(const char* topic, const uint8_t* payload, size_t length,
+                          bool retained) {
+    // Streamed, so payloads may exceed the client's packet buffer
+    if (!beginPublish(topic, length, retained)) return false;
+    _publishSink.write(payload, length);
+    return endPublish(topic);
+}
+
+bool MQTTHandler::beginPublish(const char* topic, size_t length, bool retained) {
+    if (!_client.connected()) {
+        DEBUG_PRINTLN("MQTT: Cannot publish - not connected");
+        return false;
+    }
+
+    _publishSink.begin(length);
+    if (!_client.beginPublish(topic, length, retained)) {
+        DEBUG_PRINTF("MQTT: Failed to publish to %s\n", topic);
+        return false;
+    }
+    return true;
+}
+
+bool MQTTHandler::endPublish(const char* topic) {
+    bool success = _publishSink.flush();
+    if (success) {
+        DEBUG_PRINTF("MQTT: Published to %s\n", topic);
+    } else {
+        DEBUG_PRINTF("MQTT: Failed to publish to %s\n", topic);
+    }
+
+    return success;
+}
+
+void MQTTHandler::PublishSink::begin(size_t length) {
+    _expected = length;
+    _written = 0;
+    _failed = false;
+}
+
+void MQTTHandler::PublishSink::write(const uint8_t* data, size_t length) {
+    if (_failed) return;
+
+    // Count only what the client took; nothing past the announced length
+    size_t accepted = _written + length <= _expected ? _client.write(data, length) : 0;
+    _written += accepted;
+    if (accepted != length) _failed = true;
+}
+
+bool MQTTHandler::PublishSink::flush() {
+    bool complete = _client.endPublish() && !_failed && _written == _expected;
+
+    // The header announced _expected bytes; after a short or failed write
+    // the broker reads the stream out of step, so start over
+    if (!complete) _client.disconnect();
+    return complete;
+}
+
 bool MQTTHandler::publishWeatherData(const char* stationId, const WeatherReading& reading) {
     char topic[64];
     snprintf(topic, sizeof(topic), "%s/%s/weather", MQTT_TOPIC_PREFIX, stationId);
@@ -137,6 +196,15 @@ bool MQTTHandler::publishStatus(const char* stationId, const char* status) {
     return publish(topic, status, true);  // Retain status messages
 }
 
+bool MQTTHandler::publishEvent(const char* stationId, const char* payload) {
+    char topic[64];
+    snprintf(topic, sizeof(topic), "%s/%s/event", MQTT_TOPIC_PREFIX, stationId);
+
+    // PubSubClient writes to the socket directly - nothing waits for the
+    // next report, so the event leaves on this call
+    return publish(topic, payload, false);
+}
+
 bool MQTTHandler::subscribe(const char* topic) {
     if (_subscriptionCount >= 10) {
         DEBUG_PRINTLN("MQTT: Max subscriptions reached");
@@ -177,36 +245,7 @@ void MQTTHandler::handleCallback(char* topic, byte* payload, unsigned int length
 }
 
 void MQTTHandler::formatWeatherPayload(const WeatherReading& reading, char* buffer, size_t bufferSize) {
-    snprintf(buffer, bufferSize,
-        "{"
-        "\"timestamp\":%lu,"
-        "\"temperature\":%.2f,"
-        "\"humidity\":%.2f,"
-        "\"pressure\":%.2f,"
-        "\"gas_resistance\":%.2f,"
-        "\"wind_speed\":%.2f,"
-        "\"wind_direction\":%u,"
-        "\"precipitation\":%.2f,"
-        "\"lux\":%lu,"
-        "\"solar_irradiance\":%.2f,"
-        "\"co2\":%u,"
-        "\"tvoc\":%u,"
-        "\"valid\":%s"
-        "}",
-        reading.timestamp,
-        reading.temperature,
-        reading.humidity,
-        reading.pressure,
-        reading.gasResistance,
-        reading.windSpeed,
-        reading.windDirection,
-        reading.precipitation,
-        reading.lux,
-        reading.solarIrradiance,
-        reading.co2,
-        reading.tvoc,
-        reading.isValid ? "true" : "false"
-    );
+    DataFormatter::toJSON(reading, buffer, bufferSize);
 }
 
 int MQTTHandler::getState() {
@@ -0,0 +1,307 @@
+/**
+ * COW-Bois Weather Station - Agronomic Products Implementation
+ *
+ * R. G. Allen et al., "Crop evapotranspiration", FAO Irrigation and
+ * Drainage Paper 56, 1998: saturation vapor pressure (eq. 11), slope
+ * (eq. 13), psychrometric constant (eq. 7-8), extraterrestrial radiation
+ * (eq. 21, 28), clear-sky radiation (eq. 37), net longwave (eq. 39),
+ * soil heat flux for hourly periods (eq. 45-46), wind height (eq. 47),
+ * daily and hourly Penman-Monteith (eq. 6, 53).
+ * Growing degree days: McMaster & Wilhelm (1997) method 2 (Tmin and
+ * Tmax limited to the corn 10-30 C thresholds before averaging,
+ * config.h).
+ */
+
+#include "data/agro_products.h"
+#include <math.h>
+#include "util/wall_clock.h"
+
+static const float SOLAR_CONSTANT = 0.0820f;          // MJ m-2 min-1
+static const float STEFAN_BOLTZMANN_DAY = 4.903e-9f;  // MJ K-4 m-2 day-1
+static const float STEFAN_BOLTZMANN_HOUR = 2.043e-10f; // MJ K-4 m-2 h-1
+static const float ALBEDO = 0.23f;                    // Grass reference
+static const float WM2_TO_MJ_HOUR = 0.0036f;
+
+// Inverse relative Earth-Sun distance and solar declination (eq. 23-24)
+static void solarGeometry(uint16_t dayOfYear, float& dr, float& declination) {
+    float angle = 2.0f * (float)M_PI * dayOfYear / 365.0f;
+    dr = 1.0f + 0.033f * cosf(angle);
+    declination = 0.409f * sinf(angle - 1.39f);
+}
+
+// Sunset hour angle (eq. 25), clamped for polar day / night
+static float sunsetAngle(float latitudeRad, float declination) {
+    float x = -tanf(latitudeRad) * tanf(declination);
+    if (x > 1.0f) x = 1.0f;
+    if (x < -1.0f) x = -1.0f;
+    return acosf(x);
+}
+
+// Net longwave cloudiness factor: Rs/Rso limited as in eq. 39
+static float cloudFactor(float ratio) {
+    if (ratio > 1.0f) ratio = 1.0f;
+    if (ratio < 0.3f) ratio = 0.3f;
+    return 1.35f * ratio - 0.35f;
+}
+
+static bool hasData(const AggregatedData& data, DataField field) {
+    return data.sampleCount > data.qcRejected[(uint8_t)field];
+}
+
+AgroProducts::AgroProducts()
+    : _latitude(0)
+    , _longitude(0)
+    , _elevation(0)
+    , _utcOffsetMin(AGRO_UTC_OFFSET_MIN)
+    , _day(0)
+    , _open(false)
+    , _cloudRatio(0.8f)
+    , _lastHourET0(0)
+    , _gddSeason(0)
+    , _hasDaily(false) {
+}
+
+void AgroProducts::setLocation(float latitude, float longitude, int elevationM) {
+    _latitude = latitude * (float)M_PI / 180.0f;
+    _longitude = longitude;
+    _elevation = elevationM;
+
+    // Standard zones are nominally 15 degrees of longitude per hour; real
+    // zone borders differ, so AGRO_UTC_OFFSET_AUTO 0 pins the configured one
+    _utcOffsetMin = AGRO_UTC_OFFSET_MIN;
+    #if AGRO_UTC_OFFSET_AUTO
+    if (latitude != 0 || longitude != 0) {
+        _utcOffsetMin = (int16_t)lroundf(longitude / 15.0f) * 60;
+    }
+    #endif
+}
+
+// ============================================
+// Formulas
+// ============================================
+
+float AgroProducts::saturationVapor(float tempC) {
+    return 0.6108f * expf(17.27f * tempC / (tempC + 237.3f));
+}
+
+float AgroProducts::windAt2m(float speed, float heightM) {
+    if (heightM == 2.0f) return speed;
+    return speed * 4.87f / logf(67.8f * heightM - 5.42f);
+}
+
+float AgroProducts::extraterrestrialDaily(float latitudeRad, uint16_t dayOfYear) {
+    float dr, declination;
+    solarGeometry(dayOfYear, dr, declination);
+    float ws = sunsetAngle(latitudeRad, declination);
+
+    return 24.0f * 60.0f / (float)M_PI * SOLAR_CONSTANT * dr *
+           (ws * sinf(latitudeRad) * sinf(declination) +
+            cosf(latitudeRad) * cosf(declination) * sinf(ws));
+}
+
+float AgroProducts::extraterrestrialPeriod(float latitudeRad, float longitudeDeg,
+                                           uint16_t dayOfYear, float utcHours,
+                                           float spanHours) {
+    float dr, declination;
+    solarGeometry(dayOfYear, dr, declination);
+    float ws = sunsetAngle(latitudeRad, declination);
+
+    // Seasonal correction for solar time (eq. 32-33)
+    float b = 2.0f * (float)M_PI * (dayOfYear - 81) / 364.0f;
+    float sc = 0.1645f * sinf(2.0f * b) - 0.1255f * cosf(b) - 0.025f * sinf(b);
+
+    // Solar time angle at the midpoint (eq. 31), from UTC and longitude
+    float solarHours = fmodf(utcHours + longitudeDeg / 15.0f + sc + 48.0f, 24.0f);
+    float w = (float)M_PI / 12.0f * (solarHours - 12.0f);
+    float w1 = w - (float)M_PI * spanHours / 24.0f;
+    float w2 = w + (float)M_PI * spanHours / 24.0f;
+
+    // Only the part of the period between sunrise and sunset counts
+    if (w1 < -ws) w1 = -ws;
+    if (w2 > ws) w2 = ws;
+    if (w1 >= w2) return 0;
+
+    return 12.0f * 60.0f / (float)M_PI * SOLAR_CONSTANT * dr *
+           ((w2 - w1) * sinf(latitudeRad) * sinf(declination) +
+            cosf(latitudeRad) * cosf(declination) * (sinf(w2) - sinf(w1)));
+}
+
+float AgroProducts::hourlyET0(float tempC, float relHumidity, float windSpeed2m,
+                              float solarMJ, float clearSkyMJ, float pressureKPa,
+                              float& cloudRatio, float spanHours) {
+    float es = saturationVapor(tempC);
+    float ea = es * relHumidity * 0.01f;
+    float slope = 4098.0f * es / ((tempC + 237.3f) * (tempC + 237.3f));
+    float gamma = 0.000665f * pressureKPa;
+
+    // Near and after sunset Rs/Rso is meaningless; keep the last daylight one
+    if (clearSkyMJ > 0.3f * spanHours) cloudRatio = solarMJ / clearSkyMJ;
+
+    float tk = tempC + 273.16f;
+    float rnl = STEFAN_BOLTZMANN_HOUR * spanHours * tk * tk * tk * tk *
+                (0.34f - 0.14f * sqrtf(ea)) * cloudFactor(cloudRatio);
+    float rn = (1.0f - ALBEDO) * solarMJ - rnl;
+    float g = rn > 0 ? 0.1f * rn : 0.5f * rn;
+
+    return (0.408f * slope * (rn - g) +
+            gamma * 37.0f * spanHours / (tempC + 273.0f) * windSpeed2m * (es - ea)) /
+           (slope + gamma * (1.0f + 0.34f * windSpeed2m));
+}
+
+float AgroProducts::dailyET0(float tempMin, float tempMax, float humidityMin,
+                             float humidityMax, float windSpeed2m, float solarMJ,
+                             float clearSkyMJ, float pressureKPa) {
+    float tempMean = 0.5f * (tempMin + tempMax);
+    float esMin = saturationVapor(tempMin);
+    float esMax = saturationVapor(tempMax);
+    float es = 0.5f * (esMin + esMax);
+    float ea = 0.005f * (esMin * humidityMax + esMax * humidityMin);
+    float esMean = saturationVapor(tempMean);
+    float slope = 4098.0f * esMean / ((tempMean + 237.3f) * (tempMean + 237.3f));
+    float gamma = 0.000665f * pressureKPa;
+
+    float kMin = tempMin + 273.16f, kMax = tempMax + 273.16f;
+    float ratio = clearSkyMJ > 0 ? solarMJ / clearSkyMJ : 0;
+    float rnl = STEFAN_BOLTZMANN_DAY * 0.5f * (kMax * kMax * kMax * kMax + kMin * kMin * kMin * kMin) *
+                (0.34f - 0.14f * sqrtf(ea)) * cloudFactor(ratio);
+    float rn = (1.0f - ALBEDO) * solarMJ - rnl;       // G ~ 0 for a day
+
+    float et0 = (0.408f * slope * rn +
+                 gamma * 900.0f / (tempMean + 273.0f) * windSpeed2m * (es - ea)) /
+                (slope + gamma * (1.0f + 0.34f * windSpeed2m));
+    return et0 > 0 ? et0 : 0;
+}
+
+float AgroProducts::degreeDays(float tempMin, float tempMax) {
+    if (tempMax > GDD_CAP_C) tempMax = GDD_CAP_C;
+    if (tempMin > GDD_CAP_C) tempMin = GDD_CAP_C;
+    if (tempMin < GDD_BASE_C) tempMin = GDD_BASE_C;
+    float gdd = 0.5f * (tempMin + tempMax) - GDD_BASE_C;
+    return gdd > 0 ? gdd : 0;
+}
+
+float AgroProducts::defaultPressure() const {
+    return 101.3f * powf((293.0f - 0.0065f * _elevation) / 293.0f, 5.26f);
+}
+
+// ============================================
+// Accumulation
+// ============================================
+
+void AgroProducts::openDay(int32_t day) {
+    _day = day;
+    _open = true;
+    _hours = 0;
+    _et0Hourly = 0;
+    _gddHourly = 0;
+    _solar = 0;
+    _tempMin = INFINITY;
+    _tempMax = -INFINITY;
+    _humidityMin = INFINITY;
+    _humidityMax = -INFINITY;
+    _windSum = 0;
+    _pressureSum = 0;
+    _windHours = 0;
+    _pressureHours = 0;
+}
+
+void AgroProducts::closeDay() {
+    AgroDaily& d = _daily;
+    d.day = _day;
+    d.hours = _hours;
+    d.valid = _hours >= AGRO_MIN_HOURS;
+    d.et0Hourly = _et0Hourly;
+    d.gddHourly = _gddHourly;
+    d.solar = _solar;
+    d.tempMin = _tempMin <= _tempMax ? _tempMin : 0;
+    d.tempMax = _tempMin <= _tempMax ? _tempMax : 0;
+    d.gdd = _tempMin <= _tempMax ? degreeDays(_tempMin, _tempMax) : 0;
+    d.et0 = 0;
+
+    if (d.valid) {
+        float clearSky = (0.75f + 2e-5f * _elevation) *
+                         extraterrestrialDaily(_latitude, WallClock::dayOfYear(_day));
+        float pressure = _pressureHours ? (float)(_pressureSum / _pressureHours)
+                                        : defaultPressure();
+        d.et0 = dailyET0(_tempMin, _tempMax, _humidityMin, _humidityMax,
+                         (float)(_windSum / _windHours), _solar, clearSky, pressure);
+        _gddSeason += d.gdd;
+    }
+    d.gddSeason = _gddSeason;
+
+    _open = false;
+    _hasDaily = true;
+}
+
+bool AgroProducts::addHour(const AggregatedData& hour, uint32_t unixTime) {
+    _lastHourET0 = 0;
+    if (unixTime == 0 || hour.sampleCount == 0) return false;
+
+    float span = hour.windowDurationMs > 0 ? hour.windowDurationMs / 3600000.0f : 1.0f;
+    int32_t mid = (int32_t)(unixTime - (uint32_t)(span * 1800.0f));
+    int32_t localMid = mid + _utcOffsetMin * 60L;
+    int32_t day = localMid / 86400;
+
+    // A gap (missed hours, clock step) can skip the closing hour
+    bool closed = false;
+    if (_open && day != _day) {
+        closeDay();
+        closed = true;
+    }
+    if (!_open) openDay(day);
+
+    bool temp = hasData(hour, DataField::TEMPERATURE);
+    bool humidity = hasData(hour, DataField::HUMIDITY);
+    bool wind = hasData(hour, DataField::WIND_SPEED);
+    bool solar = hasData(hour, DataField::SOLAR_IRRADIANCE);
+
+    if (temp) {
+        if (hour.tempMin < _tempMin) _tempMin = hour.tempMin;
+        if (hour.tempMax > _tempMax) _tempMax = hour.tempMax;
+        float t = hour.tempAvg;
+        if (t > GDD_CAP_C) t = GDD_CAP_C;
+        if (t > GDD_BASE_C) _gddHourly += (t - GDD_BASE_C) * span / 24.0f;
+    }
+    if (humidity) {
+        if (hour.humidityMin < _humidityMin) _humidityMin = hour.humidityMin;
+        if (hour.humidityMax > _humidityMax) _humidityMax = hour.humidityMax;
+    }
+    float wind2m = windAt2m(hour.windSpeedAvg, WIND_SENSOR_HEIGHT_M);
+    if (wind) {
+        _windSum += wind2m;
+        _windHours++;
+    }
+    float pressure = defaultPressure();
+    if (hasData(hour, DataField::PRESSURE)) {
+        pressure = hour.pressureAvg * 0.1f;
+        _pressureSum += pressure;
+        _pressureHours++;
+    }
+    float solarMJ = hour.solarAvg * WM2_TO_MJ_HOUR * span;
+    if (solar) _solar += solarMJ;
+
+    if (temp && humidity && wind && solar) {
+        float utcHours = (float)((uint32_t)mid % 86400) / 3600.0f;
+        float clearSky = (0.75f + 2e-5f * _elevation) *
+                         extraterrestrialPeriod(_latitude, _longitude,
+                                                WallClock::dayOfYear(day), utcHours, span);
+        _lastHourET0 = hourlyET0(hour.tempAvg, hour.humidityAvg, wind2m, solarMJ,
+                                 clearSky, pressure, _cloudRatio, span);
+        _et0Hourly += _lastHourET0;
+        _hours++;
+    }
+
+    // The day is complete once the next record's midpoint is past midnight
+    int32_t nextDay = (localMid + (int32_t)(span * 3600.0f)) / 86400;
+    if (nextDay != _day) {
+        closeDay();
+        closed = true;
+    }
+    return closed;
+}
+
+bool AgroProducts::getDaily(AgroDaily& daily) const {
+    if (!_hasDaily) return false;
+    daily = _daily;
+    return true;
+}
@@ -0,0 +1,273 @@
+/**
+ * COW-Bois Weather Station - Batch Codec Implementation
+ */
+
+#include "data/batch_codec.h"
+#include <math.h>
+#include <string.h>
+
+// Header: version, field count, record count (2), station id length
+static const uint8_t HEADER_FIXED_BYTES = 5;
+
+// Stored value of a non-finite statistic
+static const int32_t NOT_FINITE = INT32_MIN;
+
+// Delta codes: '0' for no change, else n leading 1s (then a 0 unless
+// it is the last bucket) and the zigzag value in BUCKET_BITS[n - 1]
+static const uint8_t BUCKET_BITS[] = {7, 12, 20, 32};
+static const uint8_t BUCKET_COUNT = sizeof(BUCKET_BITS);
+
+// ============================================
+// Columns
+// ============================================
+
+static int32_t toFixed(float value, float scale) {
+    if (!isfinite(value)) return NOT_FINITE;
+    int32_t fixed = toWire<int32_t>(value, scale);
+    return fixed == NOT_FINITE ? NOT_FINITE + 1 : fixed;
+}
+
+static float fromFixed(int32_t fixed, float scale) {
+    return fixed == NOT_FINITE ? NAN : (float)fixed / scale;
+}
+
+// Unsigned counters travel as their two's complement bit pattern
+static void toColumns(const AggregatedData& data, int32_t* column) {
+    *column++ = (int32_t)data.sampleCount;
+    *column++ = (int32_t)data.windowDurationMs;
+
+#define BATCH_GET_STATS(p, scale) \
+    *column++ = toFixed((float)data.p##Avg, scale); \
+    *column++ = toFixed((float)data.p##Min, scale); \
+    *column++ = toFixed((float)data.p##Max, scale); \
+    *column++ = toFixed(data.p##StdDev, scale);
+#define BATCH_GET_CIRCULAR(p, scale) *column++ = toFixed((float)data.p##Avg, scale);
+#define BATCH_GET_LATEST(p, scale) *column++ = toFixed((float)data.p, scale);
+#define BATCH_GET_QUANTILES(p, scale) \
+    *column++ = toFixed(data.p##P05, scale); \
+    *column++ = toFixed(data.p##Median, scale); \
+    *column++ = toFixed(data.p##P95, scale);
+#define BATCH_GET_NONE(p, scale)
+#define BATCH_GET_FIELD(id, member, prefix, type, kind, quant, key, shortKey, unit, wireType, wireScale, ...) \
+    BATCH_GET_##kind(prefix, wireScale) BATCH_GET_##quant(prefix, wireScale)
+    WEATHER_FIELDS(BATCH_GET_FIELD)
+
+    for (uint8_t f = 0; f < WEATHER_FIELD_COUNT; f++) *column++ = (int32_t)data.qcRejected[f];
+    for (uint8_t c = 0; c < QC_CHECK_COUNT; c++) *column++ = (int32_t)data.qcFlagCounts[c];
+    *column++ = data.windRose.calm;
+    for (uint8_t s = 0; s < WindRose::SECTORS; s++) {
+        for (uint8_t c = 0; c < WindRose::SPEED_CLASSES; c++) {
+            *column++ = data.windRose.counts[s][c];
+        }
+    }
+}
+
+static void fromColumns(const int32_t* column, AggregatedData& data) {
+    data.sampleCount = (uint32_t)*column++;
+    data.windowDurationMs = (uint32_t)*column++;
+
+#define BATCH_SET_STATS(type, p, scale) \
+    data.p##Avg = fieldClamp<type>(fromFixed(*column++, scale)); \
+    data.p##Min = fieldClamp<type>(fromFixed(*column++, scale)); \
+    data.p##Max = fieldClamp<type>(fromFixed(*column++, scale)); \
+    data.p##StdDev = fromFixed(*column++, scale);
+#define BATCH_SET_CIRCULAR(type, p, scale) \
+    data.p##Avg = fieldClamp<type>(fromFixed(*column++, scale));
+#define BATCH_SET_LATEST(type, p, scale) data.p = fieldClamp<type>(fromFixed(*column++, scale));
+#define BATCH_SET_QUANTILES(p, scale) \
+    data.p##P05 = fromFixed(*column++, scale); \
+    data.p##Median = fromFixed(*column++, scale); \
+    data.p##P95 = fromFixed(*column++, scale);
+#define BATCH_SET_NONE(p, scale)
+#define BATCH_SET_FIELD(id, member, prefix, type, kind, quant, key, shortKey, unit, wireType, wireScale, ...) \
+    BATCH_SET_##kind(type, prefix, wireScale) BATCH_SET_##quant(prefix, wireScale)
+    WEATHER_FIELDS(BATCH_SET_FIELD)
+
+    for (uint8_t f = 0; f < WEATHER_FIELD_COUNT; f++) data.qcRejected[f] = (uint32_t)*column++;
+    for (uint8_t c = 0; c < QC_CHECK_COUNT; c++) data.qcFlagCounts[c] = (uint32_t)*column++;
+    data.windRose.calm = (uint16_t)*column++;
+    for (uint8_t s = 0; s < WindRose::SECTORS; s++) {
+        for (uint8_t c = 0; c < WindRose::SPEED_CLASSES; c++) {
+            data.windRose.counts[s][c] = (uint16_t)*column++;
+        }
+    }
+}
+
+// Deltas wrap modulo 2^32, so every int32 column round-trips exactly
+static int32_t wrappingDelta(int32_t value, int32_t previous) {
+    return (int32_t)((uint32_t)value - (uint32_t)previous);
+}
+
+// ============================================
+// Encoder
+// ============================================
+
+BatchEncoder::BatchEncoder(uint8_t* buffer, size_t size)
+    : _buffer(buffer), _size(size), _bitPosition(0), _records(0),
+      _previousTime(0), _previousInterval(0) {
+    begin("");
+}
+
+void BatchEncoder::begin(const char* stationId) {
+    _bitPosition = 0;
+    _records = 0;
+    _previousTime = 0;
+    _previousInterval = 0;
+    memset(_previous, 0, sizeof(_previous));
+
+    size_t idLength = strnlen(stationId, STATION_ID_LENGTH);
+    writeBits(BATCH_FORMAT_VERSION, 8);
+    writeBits(WEATHER_FIELD_COUNT, 8);
+    writeBits(0, 16);                 // Record count, kept current by add()
+    writeBits((uint8_t)idLength, 8);
+    for (size_t i = 0; i < idLength; i++) writeBits((uint8_t)stationId[i], 8);
+}
+
+size_t BatchEncoder::maxRecordBytes() {
+    // Timestamp and every column in the largest bucket
+    uint32_t bits = (uint32_t)(BATCH_COLUMNS + 1) * (BUCKET_COUNT + BUCKET_BITS[BUCKET_COUNT - 1]);
+    return (bits + 7) / 8;
+}
+
+bool BatchEncoder::writeBits(uint32_t value, uint8_t bits) {
+    if (_bitPosition + bits > _size * 8) return false;
+
+    // MSB first; a byte is cleared when the stream first enters it
+    while (bits > 0) {
+        uint8_t* byte = _buffer + (_bitPosition >> 3);
+        uint8_t used = _bitPosition & 7;
+        if (used == 0) *byte = 0;
+        uint8_t room = 8 - used;
+        uint8_t take = bits < room ? bits : room;
+        uint8_t chunk = (uint8_t)((value >> (bits - take)) & ((1u << take) - 1));
+        *byte |= chunk << (room - take);
+        bits -= take;
+        _bitPosition += take;
+    }
+    return true;
+}
+
+bool BatchEncoder::writeDelta(int32_t delta) {
+    uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+    if (zigzag == 0) return writeBits(0, 1);
+
+    uint8_t bucket = 0;
+    while (bucket < BUCKET_COUNT - 1 && zigzag >= (1UL << BUCKET_BITS[bucket])) bucket++;
+
+    bool last = bucket == BUCKET_COUNT - 1;
+    uint32_t prefix = (1UL << (bucket + 1)) - 1;
+    if (!writeBits(last ? prefix : prefix << 1, last ? bucket + 1 : bucket + 2)) return false;
+    return writeBits(zigzag, BUCKET_BITS[bucket]);
+}
+
+bool BatchEncoder::add(const AggregatedData& data) {
+    if (_size < HEADER_FIXED_BYTES) return false;
+
+    int32_t columns[BATCH_COLUMNS];
+    toColumns(data, columns);
+
+    size_t start = _bitPosition;
+    int32_t interval = wrappingDelta((int32_t)data.timestamp, (int32_t)_previousTime);
+    bool fits = writeDelta(wrappingDelta(interval, _previousInterval));
+    for (uint16_t c = 0; fits && c < BATCH_COLUMNS; c++) {
+        fits = writeDelta(wrappingDelta(columns[c], _previous[c]));
+    }
+
+    if (!fits || _records == UINT16_MAX) {
+        // Roll back, clearing the tail of a partly written byte
+        _bitPosition = start;
+        uint8_t used = _bitPosition & 7;
+        if (used) _buffer[_bitPosition >> 3] &= (uint8_t)(0xFF << (8 - used));
+        return false;
+    }
+
+    _previousTime = data.timestamp;
+    _previousInterval = interval;
+    memcpy(_previous, columns, sizeof(_previous));
+    _records++;
+    _buffer[2] = (uint8_t)_records;
+    _buffer[3] = (uint8_t)(_records >> 8);
+    return true;
+}
+
+// ============================================
+// Decoder
+// ============================================
+
+BatchDecoder::BatchDecoder(const uint8_t* batch, size_t length)
+    : _batch(batch), _length(length), _bitPosition(0), _records(0), _decoded(0),
+      _valid(false), _stationId(), _previousTime(0), _previousInterval(0), _previous() {
+    if (length < HEADER_FIXED_BYTES) return;
+    if (batch[0] != BATCH_FORMAT_VERSION || batch[1] != WEATHER_FIELD_COUNT) return;
+
+    _records = (uint16_t)(batch[2] | (batch[3] << 8));
+    uint8_t idLength = batch[4];
+    if (idLength > STATION_ID_LENGTH || length < (size_t)HEADER_FIXED_BYTES + idLength) return;
+    memcpy(_stationId, batch + HEADER_FIXED_BYTES, idLength);
+    _stationId[idLength] = '\0';
+
+    _bitPosition = (HEADER_FIXED_BYTES + idLength) * 8;
+    _valid = true;
+}
+
+bool BatchDecoder::readBits(uint8_t bits, uint32_t& value) {
+    if (_bitPosition + bits > _length * 8) return false;
+
+    value = 0;
+    while (bits > 0) {
+        uint8_t byte = _batch[_bitPosition >> 3];
+        uint8_t used = _bitPosition & 7;
+        uint8_t room = 8 - used;
+        uint8_t take = bits < room ? bits : room;
+        uint8_t chunk = (uint8_t)((byte >> (room - take)) & ((1u << take) - 1));
+        value = (value << take) | chunk;
+        bits -= take;
+        _bitPosition += take;
+    }
+    return true;
+}
+
+bool BatchDecoder::readDelta(int32_t& delta) {
+    uint8_t ones = 0;
+    uint32_t bit;
+    while (ones < BUCKET_COUNT) {
+        if (!readBits(1, bit)) return false;
+        if (!bit) break;
+        ones++;
+    }
+    if (ones == 0) {
+        delta = 0;
+        return true;
+    }
+
+    uint32_t zigzag;
+    if (!readBits(BUCKET_BITS[ones - 1], zigzag)) return false;
+    delta = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+    return true;
+}
+
+bool BatchDecoder::next(AggregatedData& data) {
+    if (!_valid || _decoded >= _records) return false;
+
+    int32_t dod;
+    if (!readDelta(dod)) return false;
+    int32_t interval = (int32_t)((uint32_t)_previousInterval + (uint32_t)dod);
+    uint32_t timestamp = _previousTime + (uint32_t)interval;
+
+    int32_t columns[BATCH_COLUMNS];
+    for (uint16_t c = 0; c < BATCH_COLUMNS; c++) {
+        int32_t delta;
+        if (!readDelta(delta)) return false;
+        columns[c] = (int32_t)((uint32_t)_previous[c] + (uint32_t)delta);
+    }
+
+    _previousTime = timestamp;
+    _previousInterval = interval;
+    memcpy(_previous, columns, sizeof(_previous));
+    _decoded++;
+
+    data = AggregatedData();
+    data.timestamp = timestamp;
+    fromColumns(columns, data);
+    return true;
+}
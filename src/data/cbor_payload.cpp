@@ -0,0 +1,246 @@
+/**
+ * COW-Bois Weather Station - CBOR Payload Decoder Implementation
+ */
+
+#include "data/cbor_payload.h"
+#include "util/cbor.h"
+#include <math.h>
+
+// Values per STATS field, with and without quantiles
+static const uint8_t STATS_VALUES = 4;
+static const uint8_t QUANTILE_VALUES = 3;
+
+// Scaled integer (or null) back to engineering units
+static bool readScaled(CborReader& in, float scale, float& value) {
+    if (in.readNull()) {
+        value = NAN;
+        return true;
+    }
+    int64_t scaled;
+    if (!in.readInt(scaled)) return false;
+    value = (float)scaled / scale;
+    return true;
+}
+
+// Up to capacity values of an array; extra elements are skipped
+static bool readScaledArray(CborReader& in, float scale, float* values, uint8_t capacity,
+                            uint8_t& count) {
+    uint32_t length;
+    if (!in.readArray(length)) return false;
+    count = 0;
+    for (uint32_t i = 0; i < length; i++) {
+        if (i < capacity) {
+            if (!readScaled(in, scale, values[count++])) return false;
+        } else if (!in.skip()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool readField(CborReader& in, DataField field, AggregatedData& data) {
+    float values[STATS_VALUES + QUANTILE_VALUES];
+    uint8_t count;
+
+#define DECODE_STATS(type, p, scale) \
+    if (!readScaledArray(in, scale, values, STATS_VALUES + QUANTILE_VALUES, count) || \
+        count < STATS_VALUES) { \
+        return false; \
+    } \
+    data.p##Avg = fieldClamp<type>(values[0]); \
+    data.p##Min = fieldClamp<type>(values[1]); \
+    data.p##Max = fieldClamp<type>(values[2]); \
+    data.p##StdDev = values[3];
+#define DECODE_CIRCULAR(type, p, scale) \
+    if (!readScaled(in, scale, values[0])) return false; \
+    data.p##Avg = fieldClamp<type>(values[0]);
+#define DECODE_LATEST(type, p, scale) \
+    if (!readScaled(in, scale, values[0])) return false; \
+    data.p = fieldClamp<type>(values[0]);
+#define DECODE_QUANTILES(p) \
+    if (count < STATS_VALUES + QUANTILE_VALUES) return false; \
+    data.p##P05 = values[4]; \
+    data.p##Median = values[5]; \
+    data.p##P95 = values[6];
+#define DECODE_NONE(p)
+#define DECODE_FIELD(id, member, prefix, type, kind, quant, key, shortKey, unit, wireType, wireScale, ...) \
+    case DataField::id: { \
+        DECODE_##kind(type, prefix, wireScale) \
+        DECODE_##quant(prefix) \
+        return true; \
+    }
+
+    switch (field) {
+        WEATHER_FIELDS(DECODE_FIELD)
+        default:
+            return in.skip();
+    }
+}
+
+static bool readWindMean(CborReader& in, WindMean& mean) {
+    uint32_t length;
+    uint64_t direction;
+    if (!in.readArray(length) || length != 3) return false;
+    if (!readScaled(in, CBOR_VALUE_SCALE, mean.scalarSpeed) ||
+        !readScaled(in, CBOR_VALUE_SCALE, mean.vectorSpeed) || !in.readUnsigned(direction)) {
+        return false;
+    }
+    mean.direction = (uint16_t)direction;
+    mean.valid = true;
+    return true;
+}
+
+static bool readGust(CborReader& in, WindProductsData& wind) {
+    uint32_t length;
+    uint64_t direction;
+    if (!in.readArray(length) || length != 2) return false;
+    if (!readScaled(in, CBOR_VALUE_SCALE, wind.gust) || !in.readUnsigned(direction)) {
+        return false;
+    }
+    wind.gustDirection = (uint16_t)direction;
+    wind.gustValid = true;
+    return true;
+}
+
+static bool readDerived(CborReader& in, DerivedData& derived) {
+    float* const values[(uint8_t)DerivedField::COUNT] = {
+        &derived.dewPoint, &derived.heatIndex, &derived.windChill,
+        &derived.absoluteHumidity, &derived.seaLevelPressure
+    };
+    uint32_t pairs;
+    if (!in.readMap(pairs)) return false;
+    for (uint32_t i = 0; i < pairs; i++) {
+        uint64_t field;
+        if (!in.readUnsigned(field)) return false;
+        if (field >= (uint8_t)DerivedField::COUNT) {
+            if (!in.skip()) return false;
+            continue;
+        }
+        if (!readScaled(in, CBOR_VALUE_SCALE, *values[field])) return false;
+        derived.validMask |= 1 << field;
+    }
+    return true;
+}
+
+static bool readWindRose(CborReader& in, WindRose& rose) {
+    uint32_t length;
+    uint64_t count;
+    if (!in.readArray(length) || length != 1 + WindRose::SECTORS) return false;
+    if (!in.readUnsigned(count)) return false;
+    rose.calm = (uint16_t)count;
+    for (uint8_t s = 0; s < WindRose::SECTORS; s++) {
+        uint32_t classes;
+        if (!in.readArray(classes) || classes > WindRose::SPEED_CLASSES) return false;
+        for (uint8_t c = 0; c < classes; c++) {
+            if (!in.readUnsigned(count)) return false;
+            rose.counts[s][c] = (uint16_t)count;
+        }
+    }
+    return true;
+}
+
+static bool readQC(CborReader& in, AggregatedData& data) {
+    uint32_t length;
+    if (!in.readArray(length)) return false;
+    for (uint32_t c = 0; c < length; c++) {
+        uint64_t count;
+        if (c >= QC_CHECK_COUNT) {
+            if (!in.skip()) return false;
+        } else if (in.readUnsigned(count)) {
+            data.qcFlagCounts[c] = (uint32_t)count;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool readRejected(CborReader& in, AggregatedData& data) {
+    uint32_t pairs;
+    if (!in.readMap(pairs)) return false;
+    for (uint32_t i = 0; i < pairs; i++) {
+        uint64_t field, count;
+        if (!in.readUnsigned(field) || !in.readUnsigned(count)) return false;
+        if (field < WEATHER_FIELD_COUNT) data.qcRejected[field] = (uint32_t)count;
+    }
+    return true;
+}
+
+bool CborPayload::decode(const uint8_t* payload, size_t length, CborReport& report) {
+    report = CborReport();
+    CborReader in(payload, length);
+
+    uint32_t pairs;
+    if (!in.readMap(pairs)) return false;
+
+    for (uint32_t i = 0; i < pairs; i++) {
+        uint64_t key, value;
+        if (!in.readUnsigned(key)) return false;
+
+        bool ok;
+        switch ((CborKey)key) {
+            case CborKey::STATION_ID:
+                ok = in.readText(report.stationId, sizeof(report.stationId));
+                break;
+            case CborKey::TIMESTAMP:
+                ok = in.readUnsigned(value);
+                report.data.timestamp = (uint32_t)value;
+                break;
+            case CborKey::SAMPLES:
+                ok = in.readUnsigned(value);
+                report.data.sampleCount = (uint32_t)value;
+                break;
+            case CborKey::WINDOW_MS:
+                ok = in.readUnsigned(value);
+                report.data.windowDurationMs = (uint32_t)value;
+                break;
+            case CborKey::KEYFRAME:
+                ok = in.readBool(report.keyframe);
+                report.hasKeyframe = true;
+                break;
+            case CborKey::FIELDS: {
+                uint32_t fields;
+                ok = in.readMap(fields);
+                for (uint32_t f = 0; ok && f < fields; f++) {
+                    uint64_t field;
+                    ok = in.readUnsigned(field);
+                    if (!ok) break;
+                    if (field >= WEATHER_FIELD_COUNT) {
+                        ok = in.skip();
+                        continue;
+                    }
+                    ok = readField(in, (DataField)field, report.data);
+                    report.fieldMask |= 1UL << field;
+                }
+                break;
+            }
+            case CborKey::WIND_GUST:
+                ok = readGust(in, report.wind);
+                break;
+            case CborKey::WIND_2MIN:
+                ok = readWindMean(in, report.wind.mean2min);
+                break;
+            case CborKey::WIND_10MIN:
+                ok = readWindMean(in, report.wind.mean10min);
+                break;
+            case CborKey::DERIVED:
+                ok = readDerived(in, report.derived);
+                break;
+            case CborKey::WIND_ROSE:
+                ok = readWindRose(in, report.data.windRose);
+                break;
+            case CborKey::QC:
+                ok = readQC(in, report.data);
+                break;
+            case CborKey::REJECTED:
+                ok = readRejected(in, report.data);
+                break;
+            default:
+                ok = in.skip();
+                break;
+        }
+        if (!ok) return false;
+    }
+
+    return in.ok() && in.atEnd();
+}
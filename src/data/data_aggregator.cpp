@@ -1,115 +1,150 @@
 /**
  * COW-Bois Weather Station - Data Aggregator Implementation
+ *
+ * Per-field code is generated from the WEATHER_FIELDS registry
+ * (weather_fields.h). Each *_STATS / *_CIRCULAR / *_LATEST macro below
+ * is the accumulate, finalize or merge step for one aggregation kind.
  */
 
 #include "data/data_aggregator.h"
 #include "config.h"
+#include "util/fast_math.h"
 #include <math.h>
 #include <float.h>
 
-DataAggregator::DataAggregator()
-    : _sampleCount(0)
-    , _windowStartTime(0) {
+// Mean direction in degrees [0, 360) from summed unit-vector components
+// (error below FAST_ATAN2_MAX_ERROR_DEG)
+static float circularMeanDeg(float sinSum, float cosSum) {
+    return fastAtan2Deg(sinSum, cosSum);
+}
+
+// A wind rose sample needs speed and direction from the same reading
+static const uint32_t WIND_ROSE_FIELDS = FIELD_BIT(WIND_SPEED) | FIELD_BIT(WIND_DIRECTION);
+
+DataAggregator::DataAggregator(uint32_t windowMs)
+    : _windowMs(windowMs)
+    , _sampleCount(0)
+    , _windowStartTime(0)
+    , _buffer(nullptr) {
     reset();
 }
 
 void DataAggregator::reset() {
     _sampleCount = 0;
     _windowStartTime = millis();
+    clearAccumulators();
 
-    // Reset accumulated values
-    _tempSum = 0;
-    _tempMin = FLT_MAX;
-    _tempMax = -FLT_MAX;
-
-    _humiditySum = 0;
-    _humidityMin = FLT_MAX;
-    _humidityMax = 0;
-
-    _pressureSum = 0;
-    _pressureMin = FLT_MAX;
-    _pressureMax = 0;
-
-    _gasResistanceSum = 0;
-    _gasResistanceMin = FLT_MAX;
-    _gasResistanceMax = 0;
-
-    _windSpeedSum = 0;
-    _windSpeedMax = 0;
-
-    // Wind direction uses circular averaging
-    _windDirSinSum = 0;
-    _windDirCosSum = 0;
+    for (uint8_t f = 0; f < WEATHER_FIELD_COUNT; f++) _qcRejected[f] = 0;
+    for (uint8_t c = 0; c < QC_CHECK_COUNT; c++) _qcFlagCounts[c] = 0;
 
-    _precipTotal = 0;
-
-    _luxSum = 0;
-    _luxMax = 0;
+    if (_buffer) _buffer->clear();
+}
 
-    _solarSum = 0;
+void DataAggregator::clearAccumulators() {
+#define RESET_STATS(p) _##p.reset();
+#define RESET_CIRCULAR(p) _##p##Sin = 0; _##p##Cos = 0;
+#define RESET_LATEST(p) _##p = 0;
+#define RESET_QUANTILES(p) _##p##Quantiles.reset();
+#define RESET_NONE(p)
+#define RESET_FIELD(id, member, prefix, type, kind, quant, ...) \
+    RESET_##kind(prefix) RESET_##quant(prefix)
 
-    _co2Sum = 0;
-    _co2Max = 0;
+    WEATHER_FIELDS(RESET_FIELD)
 
-    _tvocSum = 0;
-    _tvocMax = 0;
+    _windRose.reset();
 }
 
 void DataAggregator::addSample(const WeatherReading& reading) {
     if (!reading.isValid) return;
+    accumulate(reading, QC_ALL_FIELDS);
+}
 
-    _sampleCount++;
-
-    // Temperature
-    _tempSum += reading.temperature;
-    if (reading.temperature < _tempMin) _tempMin = reading.temperature;
-    if (reading.temperature > _tempMax) _tempMax = reading.temperature;
+void DataAggregator::addSample(const WeatherReading& reading, const QCResult& qc) {
+    if (!reading.isValid) return;
 
-    // Humidity
-    _humiditySum += reading.humidity;
-    if (reading.humidity < _humidityMin) _humidityMin = reading.humidity;
-    if (reading.humidity > _humidityMax) _humidityMax = reading.humidity;
+    if (qc.validMask != QC_ALL_FIELDS) {
+        for (uint8_t f = 0; f < WEATHER_FIELD_COUNT; f++) {
+            if (qc.validMask & (1UL << f)) continue;
+            _qcRejected[f]++;
+            for (uint8_t c = 0; c < QC_CHECK_COUNT; c++) {
+                if (qc.flags[f] & (1 << c)) _qcFlagCounts[c]++;
+            }
+        }
+    }
 
-    // Pressure
-    _pressureSum += reading.pressure;
-    if (reading.pressure < _pressureMin) _pressureMin = reading.pressure;
-    if (reading.pressure > _pressureMax) _pressureMax = reading.pressure;
+    accumulate(reading, qc.validMask);
+}
 
-    // Gas Resistance
-    _gasResistanceSum += reading.gasResistance;
-    if (reading.gasResistance < _gasResistanceMin) _gasResistanceMin = reading.gasResistance;
-    if (reading.gasResistance > _gasResistanceMax) _gasResistanceMax = reading.gasResistance;
+void DataAggregator::accumulate(const WeatherReading& reading, uint32_t validMask) {
+    _sampleCount++;
+    if (_buffer) _buffer->push(reading, validMask);
 
-    // Wind speed
-    _windSpeedSum += reading.windSpeed;
-    if (reading.windSpeed > _windSpeedMax) _windSpeedMax = reading.windSpeed;
+    // Samples without QC flags (nearly all) skip the per-field mask tests
+    if (validMask == QC_ALL_FIELDS) {
+        addFields<true>(reading, validMask);
+    } else {
+        addFields<false>(reading, validMask);
+    }
+}
 
-    // Wind direction (circular average using vector components)
-    float dirRad = reading.windDirection * M_PI / 180.0f;
-    _windDirSinSum += sin(dirRad);
-    _windDirCosSum += cos(dirRad);
+#define ADD_STATS(p, v) _##p.add(v);
+    // Whole-degree unit vector from the Q15 table; integer sums are exact
+#define ADD_CIRCULAR(p, v) { \
+        int16_t sinQ15, cosQ15; \
+        fastSinCosDeg((uint16_t)(v), sinQ15, cosQ15); \
+        _##p##Sin += sinQ15; \
+        _##p##Cos += cosQ15; \
+    }
+#define ADD_LATEST(p, v) _##p = (v);  // Sensor value is already cumulative
+#define ADD_QUANTILES(p, v) _##p##Quantiles.add(v);
+#define ADD_NONE(p, v)
+
+template <bool ALL_VALID>
+void DataAggregator::addFields(const WeatherReading& reading, uint32_t validMask) {
+#define ADD_FIELD(id, member, prefix, type, kind, quant, ...) \
+    if (ALL_VALID || (validMask & (1UL << (uint8_t)DataField::id))) { \
+        ADD_##kind(prefix, (float)reading.member) ADD_##quant(prefix, (float)reading.member) \
+    }
 
-    // Precipitation (cumulative)
-    _precipTotal = reading.precipitation;  // Use latest value (cumulative from sensor)
+    WEATHER_FIELDS(ADD_FIELD)
 
-    // Light
-    _luxSum += reading.lux;
-    if (reading.lux > _luxMax) _luxMax = reading.lux;
+    if (ALL_VALID || (validMask & WIND_ROSE_FIELDS) == WIND_ROSE_FIELDS) {
+        _windRose.add(reading.windSpeed, reading.windDirection);
+    }
+}
 
-    // Solar irradiance
-    _solarSum += reading.solarIrradiance;
+void DataAggregator::attachBuffer(SampleBuffer* buffer) {
+    _buffer = buffer;
+    if (_buffer) _buffer->clear();
+}
 
-    // CO2
-    _co2Sum += reading.co2;
-    if (reading.co2 > _co2Max) _co2Max = reading.co2;
+bool DataAggregator::recompute() {
+    if (!_buffer) return false;
+
+    // _sampleCount keeps every sample of the window; after an overflow
+    // the statistics cover only the buffered (latest) ones
+    clearAccumulators();
+
+    // One pass over each field's contiguous array, skipping invalid values
+#define RECOMPUTE_FIELD(id, member, prefix, type, kind, quant, ...) \
+    _buffer->forEachValid(DataField::id, [this](float value) { \
+        ADD_##kind(prefix, value) ADD_##quant(prefix, value) \
+    });
+    WEATHER_FIELDS(RECOMPUTE_FIELD)
+
+    for (size_t i = 0; i < _buffer->size(); i++) {
+        if (_buffer->isValid(DataField::WIND_SPEED, i) &&
+            _buffer->isValid(DataField::WIND_DIRECTION, i)) {
+            _windRose.add(_buffer->getValue(DataField::WIND_SPEED, i),
+                          (uint16_t)_buffer->getValue(DataField::WIND_DIRECTION, i));
+        }
+    }
 
-    // TVOC
-    _tvocSum += reading.tvoc;
-    if (reading.tvoc > _tvocMax) _tvocMax = reading.tvoc;
+    return !_buffer->hasOverflowed();
 }
 
 bool DataAggregator::isWindowComplete() const {
-    return (millis() - _windowStartTime) >= AGGREGATION_WINDOW_MS;
+    return (millis() - _windowStartTime) >= _windowMs;
 }
 
 AggregatedData DataAggregator::getAggregatedData() {
@@ -119,73 +154,33 @@ AggregatedData DataAggregator::getAggregatedData() {
     data.sampleCount = _sampleCount;
     data.windowDurationMs = millis() - _windowStartTime;
 
-    if (_sampleCount == 0) {
-        // No data collected
-        data.tempAvg = 0;
-        data.tempMin = 0;
-        data.tempMax = 0;
-        data.humidityAvg = 0;
-        data.humidityMin = 0;
-        data.humidityMax = 0;
-        data.pressureAvg = 0;
-        data.pressureMin = 0;
-        data.pressureMax = 0;
-        data.gasResistanceAvg = 0;
-        data.gasResistanceMin = 0;
-        data.gasResistanceMax = 0;
-        data.windSpeedAvg = 0;
-        data.windSpeedMax = 0;
-        data.windDirAvg = 0;
-        data.precipitation = 0;
-        data.luxAvg = 0;
-        data.luxMax = 0;
-        data.solarAvg = 0;
-        data.co2Avg = 0;
-        data.co2Max = 0;
-        data.tvocAvg = 0;
-        data.tvocMax = 0;
-        return data;
-    }
-
-    // Calculate averages
-    data.tempAvg = _tempSum / _sampleCount;
-    data.tempMin = _tempMin;
-    data.tempMax = _tempMax;
-
-    data.humidityAvg = _humiditySum / _sampleCount;
-    data.humidityMin = _humidityMin;
-    data.humidityMax = _humidityMax;
-
-    data.pressureAvg = _pressureSum / _sampleCount;
-    data.pressureMin = _pressureMin;
-    data.pressureMax = _pressureMax;
-
-    data.gasResistanceAvg = _gasResistanceSum / _sampleCount;
-    data.gasResistanceMin = _gasResistanceMin;
-    data.gasResistanceMax = _gasResistanceMax;
+    for (uint8_t f = 0; f < WEATHER_FIELD_COUNT; f++) data.qcRejected[f] = _qcRejected[f];
+    for (uint8_t c = 0; c < QC_CHECK_COUNT; c++) data.qcFlagCounts[c] = _qcFlagCounts[c];
+    data.windRose = _windRose;
 
-    data.windSpeedAvg = _windSpeedSum / _sampleCount;
-    data.windSpeedMax = _windSpeedMax;
+    // No data collected - all fields stay zero
+    if (_sampleCount == 0) return data;
 
-    // Calculate average wind direction from vector components
-    float avgSin = _windDirSinSum / _sampleCount;
-    float avgCos = _windDirCosSum / _sampleCount;
-    float avgDir = atan2(avgSin, avgCos) * 180.0f / M_PI;
-    if (avgDir < 0) avgDir += 360.0f;
-    data.windDirAvg = (uint16_t)avgDir;
-
-    data.precipitation = _precipTotal;
-
-    data.luxAvg = _luxSum / _sampleCount;
-    data.luxMax = _luxMax;
-
-    data.solarAvg = _solarSum / _sampleCount;
-
-    data.co2Avg = _co2Sum / _sampleCount;
-    data.co2Max = _co2Max;
-
-    data.tvocAvg = _tvocSum / _sampleCount;
-    data.tvocMax = _tvocMax;
+    // Fields rejected for the whole window also stay zero
+#define FINAL_STATS(type, p) \
+    if (_##p.count > 0) { \
+        data.p##Avg = fieldCast<type>(_##p.mean); \
+        data.p##Min = fieldCast<type>(_##p.min); \
+        data.p##Max = fieldCast<type>(_##p.max); \
+        data.p##StdDev = _##p.stddev(); \
+    }
+#define FINAL_CIRCULAR(type, p) \
+    data.p##Avg = (type)circularMeanDeg((float)_##p##Sin, (float)_##p##Cos);
+#define FINAL_LATEST(type, p) data.p = fieldCast<type>(_##p);
+#define FINAL_QUANTILES(p) \
+    data.p##P05 = _##p##Quantiles.p05.getValue(); \
+    data.p##Median = _##p##Quantiles.p50.getValue(); \
+    data.p##P95 = _##p##Quantiles.p95.getValue();
+#define FINAL_NONE(p)
+#define FINAL_FIELD(id, member, prefix, type, kind, quant, ...) \
+    FINAL_##kind(type, prefix) FINAL_##quant(prefix)
+
+    WEATHER_FIELDS(FINAL_FIELD)
 
     return data;
 }
@@ -196,7 +191,7 @@ AggregatedData DataAggregator::getAndReset() {
     return data;
 }
 
-uint16_t DataAggregator::getSampleCount() const {
+uint32_t DataAggregator::getSampleCount() const {
     return _sampleCount;
 }
 
@@ -207,36 +202,113 @@ uint32_t DataAggregator::getWindowElapsedMs() const {
 float DataAggregator::getCurrentAverage(DataField field) const {
     if (_sampleCount == 0) return 0;
 
+#define CURRENT_STATS(p) _##p.mean
+#define CURRENT_CIRCULAR(p) circularMeanDeg((float)_##p##Sin, (float)_##p##Cos)
+#define CURRENT_LATEST(p) _##p
+#define CURRENT_FIELD(id, member, prefix, type, kind, ...) \
+    case DataField::id: return CURRENT_##kind(prefix);
+
     switch (field) {
-        case DataField::TEMPERATURE:
-            return _tempSum / _sampleCount;
-        case DataField::HUMIDITY:
-            return _humiditySum / _sampleCount;
-        case DataField::PRESSURE:
-            return _pressureSum / _sampleCount;
-        case DataField::GAS_RESISTANCE:
-            return _gasResistanceSum / _sampleCount;
-        case DataField::WIND_SPEED:
-            return _windSpeedSum / _sampleCount;
-        case DataField::WIND_DIRECTION: {
-            float avgSin = _windDirSinSum / _sampleCount;
-            float avgCos = _windDirCosSum / _sampleCount;
-            float avgDir = atan2(avgSin, avgCos) * 180.0f / M_PI;
-            if (avgDir < 0) avgDir += 360.0f;
-            return avgDir;
-        }
-        case DataField::PRECIPITATION:
-            return _precipTotal;
-        case DataField::LUX:
-            return (float)(_luxSum / _sampleCount);
-        case DataField::SOLAR_IRRADIANCE:
-            return _solarSum / _sampleCount;
-        case DataField::CO2:
-            return (float)(_co2Sum / _sampleCount);
-        case DataField::TVOC:
-            return (float)(_tvocSum / _sampleCount);
+        WEATHER_FIELDS(CURRENT_FIELD)
         default:
             return 0;
     }
 }
 
+// ============================================
+// Record Merging (used by rollup tiers)
+// ============================================
+
+// Combine mean and standard deviation of two disjoint sample sets
+static void mergeMoments(float& mean, float& stddev, uint32_t n,
+                         float laterMean, float laterStdDev, uint32_t m) {
+    float total = (float)(n + m);
+    float delta = laterMean - mean;
+
+    float m2 = stddev * stddev * (float)(n > 0 ? n - 1 : 0) +
+               laterStdDev * laterStdDev * (float)(m > 0 ? m - 1 : 0) +
+               delta * delta * (float)n * (float)m / total;
+
+    mean += delta * (float)m / total;
+    stddev = (n + m) > 1 ? sqrtf(m2 / (total - 1.0f)) : 0;
+}
+
+// Sample-weighted average for statistics that cannot be merged exactly
+static float weighted(float a, uint32_t n, float b, uint32_t m) {
+    return (a * (float)n + b * (float)m) / (float)(n + m);
+}
+
+void DataAggregator::merge(AggregatedData& target, const AggregatedData& later) {
+    uint32_t n = target.sampleCount;
+    uint32_t m = later.sampleCount;
+
+    target.windowDurationMs += later.windowDurationMs;
+    target.timestamp = later.timestamp;
+
+    if (m == 0) return;
+    if (n == 0) {
+        uint32_t duration = target.windowDurationMs;
+        target = later;
+        target.windowDurationMs = duration;
+        return;
+    }
+
+#define MERGE_STATS(type, p, n, m) { \
+        float avg = (float)target.p##Avg; \
+        mergeMoments(avg, target.p##StdDev, n, (float)later.p##Avg, later.p##StdDev, m); \
+        target.p##Avg = fieldCast<type>(avg); \
+        if (n == 0 || later.p##Min < target.p##Min) target.p##Min = later.p##Min; \
+        if (n == 0 || later.p##Max > target.p##Max) target.p##Max = later.p##Max; \
+    }
+    // Count-weighted unit vectors; rounded so repeated merges don't drift
+#define MERGE_CIRCULAR(type, p, n, m) { \
+        int16_t sinA, cosA, sinB, cosB; \
+        fastSinCosDeg((uint16_t)target.p##Avg, sinA, cosA); \
+        fastSinCosDeg((uint16_t)later.p##Avg, sinB, cosB); \
+        float avgDir = circularMeanDeg((float)sinA * n + (float)sinB * m, \
+                                       (float)cosA * n + (float)cosB * m); \
+        target.p##Avg = (type)((uint16_t)(avgDir + 0.5f) % 360); \
+    }
+    // Cumulative from the sensor - keep the latest value (weights unused)
+#define MERGE_LATEST(type, p, n, m) (void)(n); target.p = later.p;
+#define MERGE_QUANTILES(p, n, m) \
+    target.p##P05 = weighted(target.p##P05, n, later.p##P05, m); \
+    target.p##Median = weighted(target.p##Median, n, later.p##Median, m); \
+    target.p##P95 = weighted(target.p##P95, n, later.p##P95, m);
+#define MERGE_NONE(p, n, m)
+    // Weights are the samples that passed QC for each field
+#define MERGE_FIELD(id, member, prefix, type, kind, quant, ...) { \
+        const uint8_t f = (uint8_t)DataField::id; \
+        uint32_t nf = n > target.qcRejected[f] ? n - target.qcRejected[f] : 0; \
+        uint32_t mf = m > later.qcRejected[f] ? m - later.qcRejected[f] : 0; \
+        if (mf > 0) { \
+            MERGE_##kind(type, prefix, nf, mf) MERGE_##quant(prefix, nf, mf) \
+        } \
+        target.qcRejected[f] += later.qcRejected[f]; \
+    }
+
+    WEATHER_FIELDS(MERGE_FIELD)
+
+    for (uint8_t c = 0; c < QC_CHECK_COUNT; c++) {
+        target.qcFlagCounts[c] += later.qcFlagCounts[c];
+    }
+    target.windRose.merge(later.windRose);
+
+    target.sampleCount = n + m;
+}
+
+WeatherReading DataAggregator::toReading(const AggregatedData& data) {
+    WeatherReading reading;
+    reading.timestamp = data.timestamp;
+
+#define READING_STATS(p) p##Avg
+#define READING_CIRCULAR(p) p##Avg
+#define READING_LATEST(p) p
+#define READING_FIELD(id, member, prefix, type, kind, ...) \
+    reading.member = data.READING_##kind(prefix);
+
+    WEATHER_FIELDS(READING_FIELD)
+
+    reading.isValid = true;
+    return reading;
+}
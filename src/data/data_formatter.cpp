@@ -1,248 +1,743 @@
 /**
  * COW-Bois Weather Station - Data Formatter Implementation
+ *
+ * Every output is generated from the WEATHER_FIELDS registry
+ * (weather_fields.h), so a new sensor channel only needs a registry line.
+ * Keys are string literals, so each field's text is folded into a single
+ * format string; BufferWriter copies the literal runs and converts the
+ * numbers itself, without the C library's printf.
  */
 
 #include "data/data_formatter.h"
+#include "data/wind_products.h"
+#include "data/derived_variables.h"
+#include "data/report_compressor.h"
+#include "data/event_detector.h"
+#include "data/agro_products.h"
+#include "data/spatial_aggregator.h"
+#include "util/wall_clock.h"
+#include "util/buffer_writer.h"
+#include "util/cbor.h"
+#include "data/cbor_payload.h"
 #include "config.h"
 #include <Arduino.h>
+#include <math.h>
 
-size_t DataFormatter::toJSON(const WeatherReading& reading, char* buffer, size_t bufferSize) {
-    return snprintf(buffer, bufferSize,
-        "{"
-        "\"timestamp\":%lu,"
-        "\"temperature\":%.2f,"
-        "\"humidity\":%.2f,"
-        "\"pressure\":%.2f,"
-        "\"gas_resistance\":%.2f,"
-        "\"wind_speed\":%.2f,"
-        "\"wind_direction\":%u,"
-        "\"precipitation\":%.2f,"
-        "\"lux\":%lu,"
-        "\"solar_irradiance\":%.2f,"
-        "\"co2\":%u,"
-        "\"tvoc\":%u,"
-        "\"valid\":%s"
-        "}",
-        reading.timestamp,
-        reading.temperature,
-        reading.humidity,
-        reading.pressure,
-        reading.gasResistance,
-        reading.windSpeed,
-        reading.windDirection,
-        reading.precipitation,
-        reading.lux,
-        reading.solarIrradiance,
-        reading.co2,
-        reading.tvoc,
-        reading.isValid ? "true" : "false"
-    );
+// printf conversion and argument promotion for each registry value type
+#define FMT_float "%.2f"
+#define FMT_uint16_t "%u"
+#define FMT_uint32_t "%lu"
+#define ARG_float(v) (v)
+#define ARG_uint16_t(v) (v)
+#define ARG_uint32_t(v) (unsigned long)(v)
+
+// Copy a string literal without a format pass
+#define APPEND_LITERAL(out, text) (out).append(text, sizeof(text) - 1)
+
+namespace {
+
+// Field names in MQTT payloads (the JSON key where the report has none)
+// by DataField index
+#define FIELD_KEY(id, member, prefix, type, kind, quant, key, shortKey, unit, wireType, \
+                  wireScale, qcMin, qcMax, qcStep, qcPersist, deadband, deadbandPct, \
+                  extrema, mqttKey, ...) \
+    sizeof(mqttKey) > 1 ? mqttKey : key,
+const char* const FIELD_KEYS[WEATHER_FIELD_COUNT] = { WEATHER_FIELDS(FIELD_KEY) };
+#define FIELD_UNIT(id, member, prefix, type, kind, quant, key, shortKey, unit, ...) unit,
+const char* const FIELD_UNITS[WEATHER_FIELD_COUNT] = { WEATHER_FIELDS(FIELD_UNIT) };
+// "qc":{"missing":0,...,"rejected":{<field>:<count>,...}} - fields
+// without rejections are omitted. The check names (QCFlag bit order) are
+// folded into one format string.
+void writeQC(BufferWriter& out, const AggregatedData& data) {
+    static_assert(QC_CHECK_COUNT == 5, "writeQC lists every QC check");
+    out.printf(",\"qc\":{\"missing\":%lu,\"range\":%lu,\"step\":%lu,\"persistence\":%lu,"
+               "\"consistency\":%lu,\"rejected\":{",
+               (unsigned long)data.qcFlagCounts[0], (unsigned long)data.qcFlagCounts[1],
+               (unsigned long)data.qcFlagCounts[2], (unsigned long)data.qcFlagCounts[3],
+               (unsigned long)data.qcFlagCounts[4]);
+    const char* separator = "";
+    for (uint8_t f = 0; f < WEATHER_FIELD_COUNT; f++) {
+        if (data.qcRejected[f] == 0) continue;
+        out.printf("%s\"%s\":%lu", separator, FIELD_KEYS[f], (unsigned long)data.qcRejected[f]);
+        separator = ",";
+    }
+    APPEND_LITERAL(out, "}}");
 }
 
-size_t DataFormatter::toJSON(const AggregatedData& data, char* buffer, size_t bufferSize) {
-    return snprintf(buffer, bufferSize,
-        "{"
-        "\"timestamp\":%lu,"
-        "\"window_duration_ms\":%lu,"
-        "\"sample_count\":%u,"
-        "\"temperature\":{\"avg\":%.2f,\"min\":%.2f,\"max\":%.2f},"
-        "\"humidity\":{\"avg\":%.2f,\"min\":%.2f,\"max\":%.2f},"
-        "\"pressure\":{\"avg\":%.2f,\"min\":%.2f,\"max\":%.2f},"
-        "\"gas_resistance\":{\"avg\":%.2f,\"min\":%.2f,\"max\":%.2f},"
-        "\"wind\":{\"speed_avg\":%.2f,\"speed_max\":%.2f,\"direction_avg\":%u},"
-        "\"precipitation\":%.2f,"
-        "\"light\":{\"lux_avg\":%lu,\"lux_max\":%lu,\"solar_avg\":%.2f},"
-        "\"air_quality\":{\"co2_avg\":%u,\"co2_max\":%u,\"tvoc_avg\":%u,\"tvoc_max\":%u}"
-        "}",
-        data.timestamp,
-        data.windowDurationMs,
-        data.sampleCount,
-        data.tempAvg, data.tempMin, data.tempMax,
-        data.humidityAvg, data.humidityMin, data.humidityMax,
-        data.pressureAvg, data.pressureMin, data.pressureMax,
-        data.gasResistanceAvg, data.gasResistanceMin, data.gasResistanceMax,
-        data.windSpeedAvg, data.windSpeedMax, data.windDirAvg,
-        data.precipitation,
-        data.luxAvg, data.luxMax, data.solarAvg,
-        data.co2Avg, data.co2Max, data.tvocAvg, data.tvocMax
-    );
+// Objects inside "data" take the pending separator ("" before the first
+// member, "," after) since a compressed report may start with any of them
+
+void writeWindMean(BufferWriter& out, const char*& separator, const char* key,
+                   const WindMean& mean) {
+    if (!mean.valid) return;
+    out.printf("%s\"%s\":{\"scalar\":%.2f,\"vector\":%.2f,\"direction\":%u,\"unit\":\"m/s\"}",
+               separator, key, mean.scalarSpeed, mean.vectorSpeed, mean.direction);
+    separator = ",";
+}
+
+void writeDerivedValue(BufferWriter& out, const char*& separator, const DerivedData& derived,
+                       DerivedField field, const char* key, float value, const char* unit) {
+    if (!derived.isValid(field)) return;
+    out.printf("%s\"%s\":{\"value\":%.2f,\"unit\":\"%s\"}", separator, key, value, unit);
+    separator = ",";
+}
+
+void writeDerived(BufferWriter& out, const char*& separator, const DerivedData& d) {
+    writeDerivedValue(out, separator, d, DerivedField::DEW_POINT, "dew_point", d.dewPoint, "C");
+    writeDerivedValue(out, separator, d, DerivedField::HEAT_INDEX, "heat_index", d.heatIndex, "C");
+    writeDerivedValue(out, separator, d, DerivedField::WIND_CHILL, "wind_chill", d.windChill, "C");
+    writeDerivedValue(out, separator, d, DerivedField::ABSOLUTE_HUMIDITY, "absolute_humidity",
+                      d.absoluteHumidity, "g/m3");
+    writeDerivedValue(out, separator, d, DerivedField::SEA_LEVEL_PRESSURE, "sea_level_pressure",
+                      d.seaLevelPressure, "hPa");
+}
+
+// "wind_rose":{"calm":<n>,"sectors":{"N":[<class 0>,...],...}} - empty
+// sectors are omitted and trailing zero speed classes trimmed
+void writeWindRose(BufferWriter& out, const char*& dataSeparator, const WindRose& rose) {
+    out.printf("%s\"wind_rose\":{\"calm\":%u,\"sectors\":{", dataSeparator, rose.calm);
+    dataSeparator = ",";
+    const char* separator = "";
+    for (uint8_t s = 0; s < WindRose::SECTORS; s++) {
+        uint8_t used = WindRose::SPEED_CLASSES;
+        while (used > 0 && rose.counts[s][used - 1] == 0) used--;
+        if (used == 0) continue;
+
+        out.printf("%s\"%s\":[", separator, WindRose::sectorName(s));
+        for (uint8_t c = 0; c < used; c++) {
+            out.printf(c ? ",%u" : "%u", rose.counts[s][c]);
+        }
+        out.printf("]");
+        separator = ",";
+    }
+    out.printf("}}");
+}
+
+}  // namespace
+
+// ============================================
+// Single Reading
+// ============================================
+
+size_t DataFormatter::toJSON(const WeatherReading& reading, char* buffer, size_t bufferSize) {
+    BufferWriter out(buffer, bufferSize);
+
+    out.printf("{\"timestamp\":%lu", (unsigned long)reading.timestamp);
+#define JSON_READING_FIELD(id, member, prefix, type, kind, quant, key, ...) \
+    out.printf(",\"" key "\":" FMT_##type, ARG_##type(reading.member));
+    WEATHER_FIELDS(JSON_READING_FIELD)
+    out.printf(",\"valid\":%s}", reading.isValid ? "true" : "false");
+
+    return out.length();
 }
 
 size_t DataFormatter::toCSV(const WeatherReading& reading, char* buffer, size_t bufferSize,
                             bool includeHeader) {
-    size_t offset = 0;
+    BufferWriter out(buffer, bufferSize);
 
     if (includeHeader) {
-        offset += snprintf(buffer + offset, bufferSize - offset,
-            "timestamp,temperature,humidity,pressure,gas_resistance,wind_speed,wind_direction,"
-            "precipitation,lux,solar_irradiance,co2,tvoc,valid\n");
-    }
-
-    offset += snprintf(buffer + offset, bufferSize - offset,
-        "%lu,%.2f,%.2f,%.2f,%.2f,%.2f,%u,%.2f,%lu,%.2f,%u,%u,%d\n",
-        reading.timestamp,
-        reading.temperature,
-        reading.humidity,
-        reading.pressure,
-        reading.gasResistance,
-        reading.windSpeed,
-        reading.windDirection,
-        reading.precipitation,
-        reading.lux,
-        reading.solarIrradiance,
-        reading.co2,
-        reading.tvoc,
-        reading.isValid ? 1 : 0
-    );
-
-    return offset;
+#define CSV_READING_HEADER(id, member, prefix, type, kind, quant, key, ...) "," key
+        out.printf("timestamp" WEATHER_FIELDS(CSV_READING_HEADER) ",valid\n");
+    }
+
+    out.printf("%lu", (unsigned long)reading.timestamp);
+#define CSV_READING_FIELD(id, member, prefix, type, ...) \
+    out.printf("," FMT_##type, ARG_##type(reading.member));
+    WEATHER_FIELDS(CSV_READING_FIELD)
+    out.printf(",%d\n", reading.isValid ? 1 : 0);
+
+    return out.length();
 }
 
+size_t DataFormatter::toMQTTPayload(const char* stationId, const WeatherReading& reading,
+                                     char* buffer, size_t bufferSize) {
+    BufferWriter out(buffer, bufferSize);
+
+    out.printf("{\"station_id\":\"%s\",\"timestamp\":%lu",
+               stationId, (unsigned long)reading.timestamp);
+    WEATHER_FIELDS(JSON_READING_FIELD)
+    out.printf("}");
+
+    return out.length();
+}
+
+// ============================================
+// Aggregated Record
+// Each kind contributes a format fragment and its matching arguments;
+// the extrema and QUANTILES arguments carry their own leading comma so
+// NONE can be empty
+// ============================================
+
+#define EXTREMA_FMT_MINMAX(type, sep, min, max) sep min FMT_##type sep max FMT_##type
+#define EXTREMA_FMT_MAX(type, sep, min, max) sep max FMT_##type
+#define EXTREMA_FMT_NONE(type, sep, min, max)
+#define EXTREMA_ARGS_MINMAX(type, p) , ARG_##type(data.p##Min), ARG_##type(data.p##Max)
+#define EXTREMA_ARGS_MAX(type, p) , ARG_##type(data.p##Max)
+#define EXTREMA_ARGS_NONE(type, p)
+
+#define BASE_FMT(type, extrema, sep, avg, min, max) \
+    avg FMT_##type EXTREMA_FMT_##extrema(type, sep, min, max)
+#define STATS_FMT(type, extrema, sep, avg, min, max, std) \
+    BASE_FMT(type, extrema, sep, avg, min, max) sep std "%.2f"
+#define STATS_BASE_ARGS(type, extrema, p) ARG_##type(data.p##Avg) EXTREMA_ARGS_##extrema(type, p)
+#define STATS_ARGS(type, extrema, p) STATS_BASE_ARGS(type, extrema, p), data.p##StdDev
+#define CIRCULAR_ARGS(type, extrema, p) ARG_##type(data.p##Avg)
+#define LATEST_ARGS(type, extrema, p) ARG_##type(data.p)
+#define QUANT_ARGS_QUANTILES(p) , data.p##P05, data.p##Median, data.p##P95
+#define QUANT_ARGS_NONE(p)
+
+// JSON object members: {"avg":..[,"min":..],"max":..,"std":..[,"p05":..,"p50":..,"p95":..]}
+// Inside a group every key carries the field's groupKey ("speed_avg")
+#define JSON_STATS(type, extrema, pre, first) \
+    STATS_FMT(type, extrema, ",", "\"" pre first "\":", "\"" pre "min\":", \
+              "\"" pre "max\":", "\"" pre "std\":")
+#define JSON_CIRCULAR(type, extrema, pre, first) FMT_##type
+#define JSON_LATEST(type, extrema, pre, first) FMT_##type
+#define JSON_QUANT_QUANTILES(pre) \
+    ",\"" pre "p05\":%.2f,\"" pre "p50\":%.2f,\"" pre "p95\":%.2f"
+#define JSON_QUANT_NONE(pre) ""
+#define JSON_OPEN_STATS "{"
+#define JSON_OPEN_CIRCULAR ""
+#define JSON_OPEN_LATEST ""
+#define JSON_CLOSE_STATS "}"
+#define JSON_CLOSE_CIRCULAR ""
+#define JSON_CLOSE_LATEST ""
+#define GROUP_STATS(type, extrema, pre) JSON_STATS(type, extrema, pre, "avg")
+#define GROUP_CIRCULAR(type, extrema, pre) "\"" pre "avg\":" FMT_##type
+#define GROUP_LATEST(type, extrema, pre) "\"" pre "value\":" FMT_##type
+
+// Close the open group object and open the field's; true when a group
+// was opened (its first member takes no comma)
+static bool enterGroup(BufferWriter& out, const char*& open, const char* group) {
+    if (strcmp(open, group) == 0) return false;
+    if (*open) out.append("}", 1);
+    if (*group) out.printf(",\"%s\":{", group);
+    open = group;
+    return *group != '\0';
+}
+
+size_t DataFormatter::toJSON(const AggregatedData& data, char* buffer, size_t bufferSize) {
+    BufferWriter out(buffer, bufferSize);
+
+    out.printf("{\"timestamp\":%lu,\"window_duration_ms\":%lu,\"sample_count\":%lu",
+               (unsigned long)data.timestamp, (unsigned long)data.windowDurationMs,
+               (unsigned long)data.sampleCount);
+
+    // Grouped fields share one object ("wind":{"speed_avg":..,"direction_avg":..})
+    const char* open = "";
+#define JSON_AGG_FIELD(id, member, prefix, type, kind, quant, key, shortKey, unit, wireType, \
+                       wireScale, qcMin, qcMax, qcStep, qcPersist, deadband, deadbandPct, \
+                       extrema, mqttKey, wireVer, group, groupKey, ...) \
+    if (sizeof(group) > 1) { \
+        const char* separator = enterGroup(out, open, group) ? "" : ","; \
+        out.printf("%s" GROUP_##kind(type, extrema, groupKey) JSON_QUANT_##quant(groupKey), \
+                   separator, kind##_ARGS(type, extrema, prefix) QUANT_ARGS_##quant(prefix)); \
+    } else { \
+        enterGroup(out, open, ""); \
+        out.printf(",\"" key "\":" JSON_OPEN_##kind JSON_##kind(type, extrema, "", "avg") \
+                   JSON_QUANT_##quant("") JSON_CLOSE_##kind, \
+                   kind##_ARGS(type, extrema, prefix) QUANT_ARGS_##quant(prefix)); \
+    }
+    WEATHER_FIELDS(JSON_AGG_FIELD)
+    enterGroup(out, open, "");
+
+    out.printf("}");
+    return out.length();
+}
+
+// CSV columns and InfluxDB fields share the same <shortKey>_<stat> names
+// (a direction mean is "<shortKey>_avg" in CSV but plain in InfluxDB).
+// The original columns (avg and extremes) come first, in registry order;
+// std and quantile columns follow them, so column positions don't move.
+#define NAMES_STATS(k, extrema) BASE_NAMES_##extrema(k)
+#define BASE_NAMES_MINMAX(k) k "_avg," k "_min," k "_max"
+#define BASE_NAMES_MAX(k) k "_avg," k "_max"
+#define BASE_NAMES_NONE(k) k "_avg"
+#define NAMES_CIRCULAR(k, extrema) k "_avg"
+#define NAMES_LATEST(k, extrema) k
+#define NAMES_QUANTILES(k) "," k "_p05," k "_p50," k "_p95"
+#define NAMES_NONE(k)
+#define EXTRA_NAMES_STATS(k, quant) "," k "_std" NAMES_##quant(k)
+#define EXTRA_NAMES_CIRCULAR(k, quant)
+#define EXTRA_NAMES_LATEST(k, quant)
+
+#define CSV_STATS(type, extrema) BASE_FMT(type, extrema, ",", "", "", "")
+#define CSV_CIRCULAR(type, extrema) FMT_##type
+#define CSV_LATEST(type, extrema) FMT_##type
+#define CSV_QUANT_QUANTILES ",%.2f,%.2f,%.2f"
+#define CSV_QUANT_NONE ""
+#define CSV_EXTRA_STATS(quant, p) \
+    out.printf(",%.2f" CSV_QUANT_##quant, data.p##StdDev QUANT_ARGS_##quant(p));
+#define CSV_EXTRA_CIRCULAR(quant, p)
+#define CSV_EXTRA_LATEST(quant, p)
+
 size_t DataFormatter::toCSV(const AggregatedData& data, char* buffer, size_t bufferSize,
                             bool includeHeader) {
-    size_t offset = 0;
+    BufferWriter out(buffer, bufferSize);
 
     if (includeHeader) {
-        offset += snprintf(buffer + offset, bufferSize - offset,
-            "timestamp,window_ms,samples,"
-            "temp_avg,temp_min,temp_max,"
-            "humidity_avg,humidity_min,humidity_max,"
-            "pressure_avg,pressure_min,pressure_max,"
-            "gas_avg,gas_min,gas_max,"
-            "wind_speed_avg,wind_speed_max,wind_dir_avg,"
-            "precipitation,"
-            "lux_avg,lux_max,solar_avg,"
-            "co2_avg,co2_max,tvoc_avg,tvoc_max\n");
-    }
-
-    offset += snprintf(buffer + offset, bufferSize - offset,
-        "%lu,%lu,%u,"
-        "%.2f,%.2f,%.2f,"
-        "%.2f,%.2f,%.2f,"
-        "%.2f,%.2f,%.2f,"
-        "%.2f,%.2f,%.2f,"
-        "%.2f,%.2f,%u,"
-        "%.2f,"
-        "%lu,%lu,%.2f,"
-        "%u,%u,%u,%u\n",
-        data.timestamp,
-        data.windowDurationMs,
-        data.sampleCount,
-        data.tempAvg, data.tempMin, data.tempMax,
-        data.humidityAvg, data.humidityMin, data.humidityMax,
-        data.pressureAvg, data.pressureMin, data.pressureMax,
-        data.gasResistanceAvg, data.gasResistanceMin, data.gasResistanceMax,
-        data.windSpeedAvg, data.windSpeedMax, data.windDirAvg,
-        data.precipitation,
-        data.luxAvg, data.luxMax, data.solarAvg,
-        data.co2Avg, data.co2Max, data.tvocAvg, data.tvocMax
-    );
-
-    return offset;
+#define CSV_AGG_HEADER(id, member, prefix, type, kind, quant, key, shortKey, unit, wireType, \
+                       wireScale, qcMin, qcMax, qcStep, qcPersist, deadband, deadbandPct, \
+                       extrema, ...) \
+        "," NAMES_##kind(shortKey, extrema)
+#define CSV_EXTRA_HEADER(id, member, prefix, type, kind, quant, key, shortKey, ...) \
+        EXTRA_NAMES_##kind(shortKey, quant)
+        out.printf("timestamp,window_ms,samples" WEATHER_FIELDS(CSV_AGG_HEADER)
+                   WEATHER_FIELDS(CSV_EXTRA_HEADER) "\n");
+    }
+
+    out.printf("%lu,%lu,%lu", (unsigned long)data.timestamp,
+               (unsigned long)data.windowDurationMs, (unsigned long)data.sampleCount);
+#define CSV_BASE_ARGS_STATS(type, extrema, p) STATS_BASE_ARGS(type, extrema, p)
+#define CSV_BASE_ARGS_CIRCULAR(type, extrema, p) CIRCULAR_ARGS(type, extrema, p)
+#define CSV_BASE_ARGS_LATEST(type, extrema, p) LATEST_ARGS(type, extrema, p)
+#define CSV_AGG_FIELD(id, member, prefix, type, kind, quant, key, shortKey, unit, wireType, \
+                      wireScale, qcMin, qcMax, qcStep, qcPersist, deadband, deadbandPct, \
+                      extrema, ...) \
+    out.printf("," CSV_##kind(type, extrema), CSV_BASE_ARGS_##kind(type, extrema, prefix));
+#define CSV_EXTRA_FIELD(id, member, prefix, type, kind, quant, ...) \
+    CSV_EXTRA_##kind(quant, prefix)
+    WEATHER_FIELDS(CSV_AGG_FIELD)
+    WEATHER_FIELDS(CSV_EXTRA_FIELD)
+    out.printf("\n");
+
+    return out.length();
+}
+
+static void writeMQTTPayload(BufferWriter& out, const char* stationId, const AggregatedData& data,
+                             const WindProductsData* wind, const DerivedData* derived,
+                             const ReportSelection* selection) {
+    out.printf("{\"station_id\":\"%s\",\"timestamp\":%lu,\"data\":{",
+               stationId, (unsigned long)data.timestamp);
+
+    // Keys and units are literals and the numbers are converted directly,
+    // without a format pass. Fields without an MQTT key are skipped at
+    // compile time.
+    const char* separator = "";
+    uint32_t fieldMask = selection ? selection->fieldMask : QC_ALL_FIELDS;
+#define MQTT_WRITE_float(v) out.appendFixed((v), 2);
+#define MQTT_WRITE_uint16_t(v) out.appendUnsigned(v);
+#define MQTT_WRITE_uint32_t(v) out.appendUnsigned(v);
+#define MQTT_EXTREMA_MINMAX(type, p) \
+    APPEND_LITERAL(out, ",\"min\":"); MQTT_WRITE_##type(data.p##Min) MQTT_EXTREMA_MAX(type, p)
+#define MQTT_EXTREMA_MAX(type, p) APPEND_LITERAL(out, ",\"max\":"); MQTT_WRITE_##type(data.p##Max)
+#define MQTT_EXTREMA_NONE(type, p)
+#define MQTT_STATS(type, extrema, p) \
+    MQTT_WRITE_##type(data.p##Avg) MQTT_EXTREMA_##extrema(type, p) \
+    APPEND_LITERAL(out, ",\"std\":"); out.appendFixed(data.p##StdDev, 2);
+#define MQTT_CIRCULAR(type, extrema, p) MQTT_WRITE_##type(data.p##Avg)
+#define MQTT_LATEST(type, extrema, p) MQTT_WRITE_##type(data.p)
+#define MQTT_QUANTILES(p) \
+    APPEND_LITERAL(out, ",\"p05\":"); out.appendFixed(data.p##P05, 2); \
+    APPEND_LITERAL(out, ",\"p50\":"); out.appendFixed(data.p##Median, 2); \
+    APPEND_LITERAL(out, ",\"p95\":"); out.appendFixed(data.p##P95, 2);
+#define MQTT_NONE(p)
+#define MQTT_AGG_FIELD(id, member, prefix, type, kind, quant, key, shortKey, unit, wireType, \
+                       wireScale, qcMin, qcMax, qcStep, qcPersist, deadband, deadbandPct, \
+                       extrema, mqttKey, ...) \
+    if (sizeof(mqttKey) > 1 && (fieldMask & FIELD_BIT(id))) { \
+        if (*separator) { \
+            APPEND_LITERAL(out, ",\"" mqttKey "\":{\"value\":"); \
+        } else { \
+            APPEND_LITERAL(out, "\"" mqttKey "\":{\"value\":"); \
+        } \
+        MQTT_##kind(type, extrema, prefix) MQTT_##quant(prefix) \
+        APPEND_LITERAL(out, ",\"unit\":\"" unit "\"}"); \
+        separator = ","; \
+    }
+    WEATHER_FIELDS(MQTT_AGG_FIELD)
+
+    // Wind products are only written once their period is covered
+    if (wind && wind->gustValid) {
+        out.printf("%s\"wind_gust\":{\"value\":%.2f,\"direction\":%u,\"unit\":\"m/s\"}",
+                   separator, wind->gust, wind->gustDirection);
+        separator = ",";
+    }
+    if (wind) {
+        writeWindMean(out, separator, "wind_2min", wind->mean2min);
+        writeWindMean(out, separator, "wind_10min", wind->mean10min);
+    }
+
+    // Derived values can be recomputed from the fields and the rose is in
+    // the hourly rollups, so compressed reports send both on keyframes only
+    bool full = !selection || selection->keyframe;
+    if (derived && full) {
+        writeDerived(out, separator, *derived);
+    }
+    if (data.windRose.total() > 0 && full) {
+        writeWindRose(out, separator, data.windRose);
+    }
+
+    out.printf("},\"meta\":{\"samples\":%lu,\"window_ms\":%lu",
+               (unsigned long)data.sampleCount, (unsigned long)data.windowDurationMs);
+    if (selection) {
+        out.printf(",\"keyframe\":%s", selection->keyframe ? "true" : "false");
+    }
+    writeQC(out, data);
+    out.printf("}}");
 }
 
 size_t DataFormatter::toMQTTPayload(const char* stationId, const AggregatedData& data,
-                                     char* buffer, size_t bufferSize) {
-    return snprintf(buffer, bufferSize,
-        "{"
-        "\"station_id\":\"%s\","
-        "\"timestamp\":%lu,"
-        "\"data\":{"
-        "\"temperature\":{\"value\":%.2f,\"min\":%.2f,\"max\":%.2f,\"unit\":\"C\"},"
-        "\"humidity\":{\"value\":%.2f,\"min\":%.2f,\"max\":%.2f,\"unit\":\"%%\"},"
-        "\"pressure\":{\"value\":%.2f,\"min\":%.2f,\"max\":%.2f,\"unit\":\"hPa\"},"
-        "\"gas_resistance\":{\"value\":%.2f,\"min\":%.2f,\"max\":%.2f,\"unit\":\"KOhms\"},"
-        "\"wind_speed\":{\"value\":%.2f,\"max\":%.2f,\"unit\":\"m/s\"},"
-        "\"wind_direction\":{\"value\":%u,\"unit\":\"deg\"},"
-        "\"precipitation\":{\"value\":%.2f,\"unit\":\"mm\"},"
-        "\"solar_radiation\":{\"value\":%.2f,\"unit\":\"W/m2\"},"
-        "\"co2\":{\"value\":%u,\"max\":%u,\"unit\":\"ppm\"},"
-        "\"tvoc\":{\"value\":%u,\"max\":%u,\"unit\":\"ppb\"}"
-        "},"
-        "\"meta\":{\"samples\":%u,\"window_ms\":%lu}"
-        "}",
-        stationId,
-        data.timestamp,
-        data.tempAvg, data.tempMin, data.tempMax,
-        data.humidityAvg, data.humidityMin, data.humidityMax,
-        data.pressureAvg, data.pressureMin, data.pressureMax,
-        data.gasResistanceAvg, data.gasResistanceMin, data.gasResistanceMax,
-        data.windSpeedAvg, data.windSpeedMax,
-        data.windDirAvg,
-        data.precipitation,
-        data.solarAvg,
-        data.co2Avg, data.co2Max,
-        data.tvocAvg, data.tvocMax,
-        data.sampleCount,
-        data.windowDurationMs
-    );
+                                     char* buffer, size_t bufferSize,
+                                     const WindProductsData* wind,
+                                     const DerivedData* derived,
+                                     const ReportSelection* selection) {
+    BufferWriter out(buffer, bufferSize);
+    writeMQTTPayload(out, stationId, data, wind, derived, selection);
+    return out.length();
+}
+
+size_t DataFormatter::toMQTTPayload(const char* stationId, const AggregatedData& data,
+                                     OutputSink& sink, const WindProductsData* wind,
+                                     const DerivedData* derived,
+                                     const ReportSelection* selection) {
+    char chunk[SINK_CHUNK_BYTES];
+    BufferWriter out(sink, chunk, sizeof(chunk));
+    writeMQTTPayload(out, stationId, data, wind, derived, selection);
+    return out.length();
+}
+
+// ============================================
+// Binary Report
+// Map sizes come first in CBOR, so optional entries are counted before
+// anything is written
+// ============================================
+
+namespace {
+
+// Scaled integer, or null for NaN / inf
+void writeScaled(CborWriter& out, float value, float scale) {
+    if (isfinite(value)) {
+        out.writeInt(toWire<int32_t>(value, scale));
+    } else {
+        out.writeNull();
+    }
+}
+
+void writeWindMean(CborWriter& out, CborKey key, const WindMean& mean) {
+    out.writeUnsigned((uint8_t)key);
+    out.beginArray(3);
+    writeScaled(out, mean.scalarSpeed, CBOR_VALUE_SCALE);
+    writeScaled(out, mean.vectorSpeed, CBOR_VALUE_SCALE);
+    out.writeUnsigned(mean.direction);
+}
+
+void writeDerived(CborWriter& out, const DerivedData& d) {
+    const float values[(uint8_t)DerivedField::COUNT] = {
+        d.dewPoint, d.heatIndex, d.windChill, d.absoluteHumidity, d.seaLevelPressure
+    };
+    out.writeUnsigned((uint8_t)CborKey::DERIVED);
+    out.beginMap(__builtin_popcount(d.validMask & ((1 << (uint8_t)DerivedField::COUNT) - 1)));
+    for (uint8_t f = 0; f < (uint8_t)DerivedField::COUNT; f++) {
+        if (!d.isValid((DerivedField)f)) continue;
+        out.writeUnsigned(f);
+        writeScaled(out, values[f], CBOR_VALUE_SCALE);
+    }
+}
+
+void writeWindRose(CborWriter& out, const WindRose& rose) {
+    out.writeUnsigned((uint8_t)CborKey::WIND_ROSE);
+    out.beginArray(1 + WindRose::SECTORS);
+    out.writeUnsigned(rose.calm);
+    for (uint8_t s = 0; s < WindRose::SECTORS; s++) {
+        uint8_t used = WindRose::SPEED_CLASSES;
+        while (used > 0 && rose.counts[s][used - 1] == 0) used--;
+        out.beginArray(used);
+        for (uint8_t c = 0; c < used; c++) out.writeUnsigned(rose.counts[s][c]);
+    }
+}
+
+}  // namespace
+
+#define CBOR_VALUES_QUANTILES 7
+#define CBOR_VALUES_NONE 4
+#define CBOR_STATS(type, p, scale, quant) \
+    out.beginArray(CBOR_VALUES_##quant); \
+    writeScaled(out, (float)data.p##Avg, scale); \
+    writeScaled(out, (float)data.p##Min, scale); \
+    writeScaled(out, (float)data.p##Max, scale); \
+    writeScaled(out, data.p##StdDev, scale);
+#define CBOR_CIRCULAR(type, p, scale, quant) writeScaled(out, (float)data.p##Avg, scale);
+#define CBOR_LATEST(type, p, scale, quant) writeScaled(out, (float)data.p, scale);
+#define CBOR_QUANT_QUANTILES(p, scale) \
+    writeScaled(out, data.p##P05, scale); \
+    writeScaled(out, data.p##Median, scale); \
+    writeScaled(out, data.p##P95, scale);
+#define CBOR_QUANT_NONE(p, scale)
+
+static void writeCBORPayload(CborWriter& out, const char* stationId, const AggregatedData& data,
+                             const WindProductsData* wind, const DerivedData* derived,
+                             const ReportSelection* selection) {
+    uint32_t fieldMask = selection ? selection->fieldMask & QC_ALL_FIELDS : QC_ALL_FIELDS;
+    bool full = !selection || selection->keyframe;
+    bool gust = wind && wind->gustValid;
+    bool mean2min = wind && wind->mean2min.valid;
+    bool mean10min = wind && wind->mean10min.valid;
+    bool derivedValues = derived && full && derived->validMask != 0;
+    bool rose = data.windRose.total() > 0 && full;
+    uint8_t rejected = 0;
+    for (uint8_t f = 0; f < WEATHER_FIELD_COUNT; f++) {
+        if (data.qcRejected[f] > 0) rejected++;
+    }
+
+    // Station, timestamp, samples, window, fields and QC are always present
+    out.beginMap(6 + (selection ? 1 : 0) + gust + mean2min + mean10min + derivedValues + rose +
+                 (rejected > 0));
+
+    out.writeUnsigned((uint8_t)CborKey::STATION_ID);
+    out.writeText(stationId);
+    out.writeUnsigned((uint8_t)CborKey::TIMESTAMP);
+    out.writeUnsigned(data.timestamp);
+    out.writeUnsigned((uint8_t)CborKey::SAMPLES);
+    out.writeUnsigned(data.sampleCount);
+    out.writeUnsigned((uint8_t)CborKey::WINDOW_MS);
+    out.writeUnsigned(data.windowDurationMs);
+    if (selection) {
+        out.writeUnsigned((uint8_t)CborKey::KEYFRAME);
+        out.writeBool(selection->keyframe);
+    }
+
+    out.writeUnsigned((uint8_t)CborKey::FIELDS);
+    out.beginMap(__builtin_popcount(fieldMask));
+#define CBOR_AGG_FIELD(id, member, prefix, type, kind, quant, key, shortKey, unit, wireType, wireScale, ...) \
+    if (fieldMask & FIELD_BIT(id)) { \
+        out.writeUnsigned((uint8_t)DataField::id); \
+        CBOR_##kind(type, prefix, wireScale, quant) \
+        CBOR_QUANT_##quant(prefix, wireScale) \
+    }
+    WEATHER_FIELDS(CBOR_AGG_FIELD)
+
+    if (gust) {
+        out.writeUnsigned((uint8_t)CborKey::WIND_GUST);
+        out.beginArray(2);
+        writeScaled(out, wind->gust, CBOR_VALUE_SCALE);
+        out.writeUnsigned(wind->gustDirection);
+    }
+    if (mean2min) writeWindMean(out, CborKey::WIND_2MIN, wind->mean2min);
+    if (mean10min) writeWindMean(out, CborKey::WIND_10MIN, wind->mean10min);
+    if (derivedValues) writeDerived(out, *derived);
+    if (rose) writeWindRose(out, data.windRose);
+
+    out.writeUnsigned((uint8_t)CborKey::QC);
+    out.beginArray(QC_CHECK_COUNT);
+    for (uint8_t c = 0; c < QC_CHECK_COUNT; c++) out.writeUnsigned(data.qcFlagCounts[c]);
+    if (rejected > 0) {
+        out.writeUnsigned((uint8_t)CborKey::REJECTED);
+        out.beginMap(rejected);
+        for (uint8_t f = 0; f < WEATHER_FIELD_COUNT; f++) {
+            if (data.qcRejected[f] == 0) continue;
+            out.writeUnsigned(f);
+            out.writeUnsigned(data.qcRejected[f]);
+        }
+    }
+}
+
+size_t DataFormatter::toCBORPayload(const char* stationId, const AggregatedData& data,
+                                    uint8_t* buffer, size_t bufferSize,
+                                    const WindProductsData* wind,
+                                    const DerivedData* derived,
+                                    const ReportSelection* selection) {
+    CborWriter out(buffer, bufferSize);
+    writeCBORPayload(out, stationId, data, wind, derived, selection);
+    return out.length();
+}
+
+size_t DataFormatter::toCBORPayload(const char* stationId, const AggregatedData& data,
+                                    OutputSink& sink, const WindProductsData* wind,
+                                    const DerivedData* derived,
+                                    const ReportSelection* selection) {
+    uint8_t chunk[SINK_CHUNK_BYTES];
+    CborWriter out(sink, chunk, sizeof(chunk));
+    writeCBORPayload(out, stationId, data, wind, derived, selection);
+    return out.length();
+}
+
+static void writeEventPayload(BufferWriter& out, const char* stationId, const WeatherEvent& event,
+                              const EventRule& rule) {
+    uint8_t f = (uint8_t)rule.field;
+
+    out.printf("{\"station_id\":\"%s\",\"timestamp\":%lu,\"event\":\"%s\",\"field\":\"%s\","
+               "\"value\":%.2f,\"change\":%.2f,\"limit\":%.2f,\"unit\":\"%s\",\"suppressed\":%u}",
+               stationId, (unsigned long)event.timestamp, rule.name, FIELD_KEYS[f],
+               event.value, event.change, rule.limit, FIELD_UNITS[f], event.suppressed);
+}
+
+size_t DataFormatter::toEventPayload(const char* stationId, const WeatherEvent& event,
+                                     const EventRule& rule, char* buffer, size_t bufferSize) {
+    BufferWriter out(buffer, bufferSize);
+    writeEventPayload(out, stationId, event, rule);
+    return out.length();
+}
+
+size_t DataFormatter::toEventPayload(const char* stationId, const WeatherEvent& event,
+                                     const EventRule& rule, OutputSink& sink) {
+    char chunk[SINK_CHUNK_BYTES];
+    BufferWriter out(sink, chunk, sizeof(chunk));
+    writeEventPayload(out, stationId, event, rule);
+    return out.length();
+}
+
+size_t DataFormatter::toStatusPayload(const char* stationId, const StationHealth& health,
+                                      char* buffer, size_t bufferSize) {
+    BufferWriter out(buffer, bufferSize);
+    out.printf("{\"station_id\":\"%s\",\"uptime\":%lu,\"battery\":{\"voltage\":%.2f,"
+               "\"percent\":%u},\"spikes\":{\"wind_speed\":%lu,\"precipitation\":%lu},"
+               "\"events_dropped\":%lu}",
+               stationId, (unsigned long)health.uptimeSec, health.batteryVoltage,
+               health.batteryPercent, (unsigned long)health.windSpikes,
+               (unsigned long)health.precipSpikes, (unsigned long)health.eventsDropped);
+    return out.length();
+}
+
+static void writeAgroPayload(BufferWriter& out, const char* stationId, const AgroDaily& daily) {
+    int32_t year;
+    uint8_t month, day;
+    WallClock::civilFromDays(daily.day, year, month, day);
+
+    out.printf("{\"station_id\":\"%s\",\"date\":\"%04ld-%02u-%02u\",\"valid\":%s,\"hours\":%u,"
+               "\"et0\":%.2f,\"et0_hourly\":%.2f,\"gdd\":%.1f,\"gdd_hourly\":%.1f,"
+               "\"gdd_season\":%.1f,\"temp_min\":%.1f,\"temp_max\":%.1f,\"solar\":%.2f}",
+               stationId, (long)year, month, day, daily.valid ? "true" : "false", daily.hours,
+               daily.et0, daily.et0Hourly, daily.gdd, daily.gddHourly, daily.gddSeason,
+               daily.tempMin, daily.tempMax, daily.solar);
+}
+
+size_t DataFormatter::toAgroPayload(const char* stationId, const AgroDaily& daily,
+                                    char* buffer, size_t bufferSize) {
+    BufferWriter out(buffer, bufferSize);
+    writeAgroPayload(out, stationId, daily);
+    return out.length();
+}
+
+size_t DataFormatter::toAgroPayload(const char* stationId, const AgroDaily& daily,
+                                    OutputSink& sink) {
+    char chunk[SINK_CHUNK_BYTES];
+    BufferWriter out(sink, chunk, sizeof(chunk));
+    writeAgroPayload(out, stationId, daily);
+    return out.length();
+}
+
+static void writeSpatialPayload(BufferWriter& out, const char* siteId,
+                                const SpatialAggregator& site) {
+    out.printf("{\"site_id\":\"%s\",\"timestamp\":%lu,\"stations\":%u,\"samples\":%lu,\"data\":{",
+               siteId, (unsigned long)site.getTimestamp(), (unsigned)site.getStationCount(),
+               (unsigned long)site.getSampleCount());
+
+    const char* separator = "";
+    for (uint8_t f = 0; f < WEATHER_FIELD_COUNT; f++) {
+        SpatialField field;
+        if (!site.getField((DataField)f, field)) continue;
+
+        out.printf("%s\"%s\":{\"stations\":%u,\"mean\":%.2f", separator, FIELD_KEYS[f],
+                   (unsigned)field.stations, field.mean);
+        separator = ",";
+        if (field.hasExtremes) {
+            out.printf(",\"spread\":%.2f,\"min\":%.2f,\"min_station\":\"%s\","
+                       "\"max\":%.2f,\"max_station\":\"%s\"",
+                       field.spread, field.min, field.minStation, field.max, field.maxStation);
+        }
+        if (field.hasGradient) {
+            out.printf(",\"gradient\":%.4f,\"gradient_dir\":%.0f",
+                       field.gradient, field.gradientDir);
+        }
+        out.printf("}");
+    }
+
+    out.printf("}}");
+}
+
+size_t DataFormatter::toSpatialPayload(const char* siteId, const SpatialAggregator& site,
+                                       char* buffer, size_t bufferSize) {
+    BufferWriter out(buffer, bufferSize);
+    writeSpatialPayload(out, siteId, site);
+    return out.length();
+}
+
+size_t DataFormatter::toSpatialPayload(const char* siteId, const SpatialAggregator& site,
+                                       OutputSink& sink) {
+    char chunk[SINK_CHUNK_BYTES];
+    BufferWriter out(sink, chunk, sizeof(chunk));
+    writeSpatialPayload(out, siteId, site);
+    return out.length();
 }
 
 size_t DataFormatter::toInfluxLineProtocol(const char* measurement, const char* stationId,
                                             const AggregatedData& data, char* buffer,
-                                            size_t bufferSize) {
+                                            size_t bufferSize, uint64_t epochMs) {
     // InfluxDB line protocol format:
     // measurement,tag1=value1,tag2=value2 field1=value1,field2=value2 timestamp
+    BufferWriter out(buffer, bufferSize);
+
+    out.printf("%s,station=%s ", measurement, stationId);
 
-    return snprintf(buffer, bufferSize,
-        "%s,station=%s "
-        "temp_avg=%.2f,temp_min=%.2f,temp_max=%.2f,"
-        "humidity_avg=%.2f,humidity_min=%.2f,humidity_max=%.2f,"
-        "pressure_avg=%.2f,pressure_min=%.2f,pressure_max=%.2f,"
-        "gas_avg=%.2f,gas_min=%.2f,gas_max=%.2f,"
-        "wind_speed_avg=%.2f,wind_speed_max=%.2f,wind_dir=%u,"
-        "precipitation=%.2f,"
-        "lux_avg=%lu,lux_max=%lu,solar_avg=%.2f,"
-        "co2_avg=%u,co2_max=%u,tvoc_avg=%u,tvoc_max=%u,"
-        "samples=%u "
-        "%lu000000",  // Convert ms to ns (InfluxDB default)
-        measurement,
-        stationId,
-        data.tempAvg, data.tempMin, data.tempMax,
-        data.humidityAvg, data.humidityMin, data.humidityMax,
-        data.pressureAvg, data.pressureMin, data.pressureMax,
-        data.gasResistanceAvg, data.gasResistanceMin, data.gasResistanceMax,
-        data.windSpeedAvg, data.windSpeedMax, data.windDirAvg,
-        data.precipitation,
-        data.luxAvg, data.luxMax, data.solarAvg,
-        data.co2Avg, data.co2Max, data.tvocAvg, data.tvocMax,
-        data.sampleCount,
-        data.timestamp
-    );
+#define INFLUX_STATS(type, extrema, k) \
+    STATS_FMT(type, extrema, ",", k "_avg=", k "_min=", k "_max=", k "_std=")
+#define INFLUX_CIRCULAR(type, extrema, k) k "=" FMT_##type
+#define INFLUX_LATEST(type, extrema, k) k "=" FMT_##type
+#define INFLUX_QUANT_QUANTILES(k) "," k "_p05=%.2f," k "_p50=%.2f," k "_p95=%.2f"
+#define INFLUX_QUANT_NONE(k) ""
+#define INFLUX_FIELD(id, member, prefix, type, kind, quant, key, shortKey, unit, wireType, \
+                     wireScale, qcMin, qcMax, qcStep, qcPersist, deadband, deadbandPct, \
+                     extrema, ...) \
+    out.printf(INFLUX_##kind(type, extrema, shortKey) INFLUX_QUANT_##quant(shortKey) ",", \
+               kind##_ARGS(type, extrema, prefix) QUANT_ARGS_##quant(prefix));
+    WEATHER_FIELDS(INFLUX_FIELD)
+
+    // data.timestamp is millis(), not epoch time; without one the server
+    // stamps the line on arrival
+    out.printf("samples=%lu", (unsigned long)data.sampleCount);
+    if (epochMs > 0) {
+        out.printf(" %llu000000", (unsigned long long)epochMs);  // ms to ns (InfluxDB default)
+    }
+    return out.length();
 }
 
+// ============================================
+// Serial Debug Output
+// ============================================
+
 void DataFormatter::printReading(const WeatherReading& reading) {
     Serial.println("--- Weather Reading ---");
-    Serial.printf("Timestamp: %lu ms\n", reading.timestamp);
-    Serial.printf("Temperature: %.2f °C\n", reading.temperature);
-    Serial.printf("Humidity: %.2f %%\n", reading.humidity);
-    Serial.printf("Pressure: %.2f hPa\n", reading.pressure);
-    Serial.printf("Gas Resistance: %.2f KOhms\n", reading.gasResistance);
-    Serial.printf("Wind: %.2f m/s @ %u°\n", reading.windSpeed, reading.windDirection);
-    Serial.printf("Precipitation: %.2f mm\n", reading.precipitation);
-    Serial.printf("Light: %lu lux (%.2f W/m²)\n", reading.lux, reading.solarIrradiance);
-    Serial.printf("CO2: %u ppm, TVOC: %u ppb\n", reading.co2, reading.tvoc);
+    Serial.printf("Timestamp: %lu ms\n", (unsigned long)reading.timestamp);
+
+#define PRINT_READING_FIELD(id, member, prefix, type, kind, quant, key, shortKey, unit, ...) \
+    Serial.printf(key ": " FMT_##type " %s\n", ARG_##type(reading.member), unit);
+    WEATHER_FIELDS(PRINT_READING_FIELD)
+
     Serial.printf("Valid: %s\n", reading.isValid ? "Yes" : "No");
     Serial.println("-----------------------");
 }
 
 void DataFormatter::printAggregated(const AggregatedData& data) {
     Serial.println("=== Aggregated Data ===");
-    Serial.printf("Window: %lu ms, Samples: %u\n", data.windowDurationMs, data.sampleCount);
-    Serial.printf("Temperature: %.2f °C (min: %.2f, max: %.2f)\n",
-                  data.tempAvg, data.tempMin, data.tempMax);
-    Serial.printf("Humidity: %.2f %% (min: %.2f, max: %.2f)\n",
-                  data.humidityAvg, data.humidityMin, data.humidityMax);
-    Serial.printf("Pressure: %.2f hPa (min: %.2f, max: %.2f)\n",
-                  data.pressureAvg, data.pressureMin, data.pressureMax);
-    Serial.printf("Gas Resistance: %.2f KOhms (min: %.2f, max: %.2f)\n",
-                  data.gasResistanceAvg, data.gasResistanceMin, data.gasResistanceMax);
-    Serial.printf("Wind: %.2f m/s avg (max: %.2f) @ %u°\n",
-                  data.windSpeedAvg, data.windSpeedMax, data.windDirAvg);
-    Serial.printf("Precipitation: %.2f mm\n", data.precipitation);
-    Serial.printf("Solar: %.2f W/m² avg\n", data.solarAvg);
-    Serial.printf("CO2: %u ppm avg (max: %u)\n", data.co2Avg, data.co2Max);
-    Serial.printf("TVOC: %u ppb avg (max: %u)\n", data.tvocAvg, data.tvocMax);
+    Serial.printf("Window: %lu ms, Samples: %lu\n",
+                  (unsigned long)data.windowDurationMs, (unsigned long)data.sampleCount);
+
+    // Debug output shows every statistic, whatever the published extrema
+#define PRINT_STATS(type) STATS_FMT(type, MINMAX, "", "", " (min: ", ", max: ", ", std: ") ")"
+#define PRINT_CIRCULAR(type) FMT_##type
+#define PRINT_LATEST(type) FMT_##type
+#define PRINT_QUANT_QUANTILES " [p05 %.2f, median %.2f, p95 %.2f]"
+#define PRINT_QUANT_NONE ""
+#define PRINT_AGG_FIELD(id, member, prefix, type, kind, quant, key, shortKey, unit, ...) \
+    Serial.printf(key " (%s): " PRINT_##kind(type) PRINT_QUANT_##quant "\n", \
+                  unit, kind##_ARGS(type, MINMAX, prefix) QUANT_ARGS_##quant(prefix));
+    WEATHER_FIELDS(PRINT_AGG_FIELD)
+
+    for (uint8_t f = 0; f < WEATHER_FIELD_COUNT; f++) {
+        if (data.qcRejected[f] > 0) {
+            Serial.printf("QC rejected %s: %lu\n", FIELD_KEYS[f], (unsigned long)data.qcRejected[f]);
+        }
+    }
+
+    if (data.windRose.total() > 0) {
+        Serial.printf("Wind rose: calm %u", data.windRose.calm);
+        for (uint8_t s = 0; s < WindRose::SECTORS; s++) {
+            uint32_t n = data.windRose.sectorTotal(s);
+            if (n > 0) Serial.printf(", %s %lu", WindRose::sectorName(s), (unsigned long)n);
+        }
+        Serial.println();
+    }
+
     Serial.println("=======================");
 }
-
@@ -0,0 +1,211 @@
+/**
+ * COW-Bois Weather Station - Derived Variables Implementation
+ *
+ * Saturation vapor pressure: Bolton (1980) form of the Magnus formula.
+ * Heat index: NWS Rothfusz regression with the NWS low-range and
+ * humidity adjustments. Wind chill: Environment Canada / NWS (2001).
+ * Sea-level pressure: hypsometric reduction with the standard lapse rate.
+ * exp/log/pow go through the fast_math kernels (errors bounded in fast_math.h).
+ */
+
+#include "data/derived_variables.h"
+#include <math.h>
+#include "util/fast_math.h"
+
+// Inputs each derived value depends on
+#define INPUT_TEMP      (1 << 0)
+#define INPUT_HUMIDITY  (1 << 1)
+#define INPUT_PRESSURE  (1 << 2)
+#define INPUT_WIND      (1 << 3)
+#define INPUT_ELEVATION (1 << 4)
+
+static const uint8_t DEPENDS_ON[(uint8_t)DerivedField::COUNT] = {
+    INPUT_TEMP | INPUT_HUMIDITY,                        // DEW_POINT
+    INPUT_TEMP | INPUT_HUMIDITY,                        // HEAT_INDEX
+    INPUT_TEMP | INPUT_WIND,                            // WIND_CHILL
+    INPUT_TEMP | INPUT_HUMIDITY,                        // ABSOLUTE_HUMIDITY
+    INPUT_TEMP | INPUT_PRESSURE | INPUT_ELEVATION       // SEA_LEVEL_PRESSURE
+};
+
+// Inverse Magnus: dew point (C) from vapor pressure (hPa)
+static float dewPointFromVapor(float e) {
+    if (e <= 0) return 0;
+    float g = fastLog(e / 6.112f);
+    return 243.5f * g / (17.67f - g);
+}
+
+// AH = e / (Rv * T) with Rv = 461.5 J/(kg K), in g/m3
+static float absoluteHumidityFromVapor(float e, float tempC) {
+    return e * 216.74f / (273.15f + tempC);
+}
+
+DerivedVariables::DerivedVariables()
+    : _temp(0)
+    , _humidity(0)
+    , _pressure(0)
+    , _windSpeed(0)
+    , _elevation(0)
+    , _available(INPUT_ELEVATION)
+    , _vaporPressure(0)
+    , _cached(0)
+    , _vaporCached(false) {
+    for (uint8_t i = 0; i < (uint8_t)DerivedField::COUNT; i++) {
+        _values[i] = 0;
+    }
+}
+
+void DerivedVariables::invalidate(uint8_t inputs) {
+    if (!inputs) return;
+    for (uint8_t i = 0; i < (uint8_t)DerivedField::COUNT; i++) {
+        if (DEPENDS_ON[i] & inputs) _cached &= ~(1 << i);
+    }
+    if (inputs & (INPUT_TEMP | INPUT_HUMIDITY)) _vaporCached = false;
+}
+
+void DerivedVariables::update(float tempC, float relHumidity, float pressureHpa,
+                              float windSpeedMps) {
+    uint8_t changed = 0;
+    if (tempC != _temp) changed |= INPUT_TEMP;
+    if (relHumidity != _humidity) changed |= INPUT_HUMIDITY;
+    if (pressureHpa != _pressure) changed |= INPUT_PRESSURE;
+    if (windSpeedMps != _windSpeed) changed |= INPUT_WIND;
+
+    _temp = tempC;
+    _humidity = relHumidity;
+    _pressure = pressureHpa;
+    _windSpeed = windSpeedMps;
+
+    changed |= (uint8_t)(~_available & (INPUT_TEMP | INPUT_HUMIDITY | INPUT_PRESSURE | INPUT_WIND));
+    _available = INPUT_TEMP | INPUT_HUMIDITY | INPUT_PRESSURE | INPUT_WIND | INPUT_ELEVATION;
+    invalidate(changed);
+}
+
+void DerivedVariables::update(const AggregatedData& data) {
+    update(data.tempAvg, data.humidityAvg, data.pressureAvg, data.windSpeedAvg);
+
+    // A field rejected for the whole window has no meaningful average
+    _available = INPUT_ELEVATION;
+    if (data.sampleCount > data.qcRejected[(uint8_t)DataField::TEMPERATURE]) _available |= INPUT_TEMP;
+    if (data.sampleCount > data.qcRejected[(uint8_t)DataField::HUMIDITY]) _available |= INPUT_HUMIDITY;
+    if (data.sampleCount > data.qcRejected[(uint8_t)DataField::PRESSURE]) _available |= INPUT_PRESSURE;
+    if (data.sampleCount > data.qcRejected[(uint8_t)DataField::WIND_SPEED]) _available |= INPUT_WIND;
+}
+
+void DerivedVariables::setElevation(int elevationM) {
+    if (elevationM == _elevation) return;
+    _elevation = elevationM;
+    invalidate(INPUT_ELEVATION);
+}
+
+float DerivedVariables::vapor() {
+    if (!_vaporCached) {
+        _vaporPressure = vaporPressure(_temp, _humidity);
+        _vaporCached = true;
+    }
+    return _vaporPressure;
+}
+
+float DerivedVariables::get(DerivedField field) {
+    uint8_t i = (uint8_t)field;
+    if (i >= (uint8_t)DerivedField::COUNT) return 0;
+    if ((DEPENDS_ON[i] & _available) != DEPENDS_ON[i]) return 0;
+    if (_cached & (1 << i)) return _values[i];
+
+    float value = 0;
+    switch (field) {
+        case DerivedField::DEW_POINT:
+            value = dewPointFromVapor(vapor());
+            break;
+        case DerivedField::HEAT_INDEX:
+            value = heatIndex(_temp, _humidity);
+            break;
+        case DerivedField::WIND_CHILL:
+            value = windChill(_temp, _windSpeed);
+            break;
+        case DerivedField::ABSOLUTE_HUMIDITY:
+            value = absoluteHumidityFromVapor(vapor(), _temp);
+            break;
+        case DerivedField::SEA_LEVEL_PRESSURE:
+            value = seaLevelPressure(_pressure, _temp, _elevation);
+            break;
+        default:
+            break;
+    }
+
+    _values[i] = value;
+    _cached |= 1 << i;
+    return value;
+}
+
+DerivedData DerivedVariables::getAll() {
+    DerivedData data;
+    data.dewPoint = get(DerivedField::DEW_POINT);
+    data.heatIndex = get(DerivedField::HEAT_INDEX);
+    data.windChill = get(DerivedField::WIND_CHILL);
+    data.absoluteHumidity = get(DerivedField::ABSOLUTE_HUMIDITY);
+    data.seaLevelPressure = get(DerivedField::SEA_LEVEL_PRESSURE);
+
+    for (uint8_t i = 0; i < (uint8_t)DerivedField::COUNT; i++) {
+        if ((DEPENDS_ON[i] & _available) == DEPENDS_ON[i]) data.validMask |= 1 << i;
+    }
+    return data;
+}
+
+// ============================================
+// Formulas
+// ============================================
+
+float DerivedVariables::vaporPressure(float tempC, float relHumidity) {
+    // Saturation vapor pressure (hPa) scaled by relative humidity
+    float es = 6.112f * fastExp((17.67f * tempC) / (tempC + 243.5f));
+    return es * relHumidity / 100.0f;
+}
+
+float DerivedVariables::dewPoint(float tempC, float relHumidity) {
+    return dewPointFromVapor(vaporPressure(tempC, relHumidity));
+}
+
+float DerivedVariables::absoluteHumidity(float tempC, float relHumidity) {
+    return absoluteHumidityFromVapor(vaporPressure(tempC, relHumidity), tempC);
+}
+
+float DerivedVariables::heatIndex(float tempC, float relHumidity) {
+    // Below 80 F the index is the air temperature
+    if (tempC < 26.7f) return tempC;
+
+    float t = tempC * 1.8f + 32.0f;
+    float rh = relHumidity;
+
+    // Steadman's simple form; the regression applies from 80 F
+    float hi = 0.5f * (t + 61.0f + (t - 68.0f) * 1.2f + rh * 0.094f);
+    if ((hi + t) * 0.5f >= 80.0f) {
+        hi = -42.379f + 2.04901523f * t + 10.14333127f * rh
+             - 0.22475541f * t * rh - 0.00683783f * t * t
+             - 0.05481717f * rh * rh + 0.00122874f * t * t * rh
+             + 0.00085282f * t * rh * rh - 0.00000199f * t * t * rh * rh;
+
+        if (rh < 13.0f && t >= 80.0f && t <= 112.0f) {
+            hi -= ((13.0f - rh) / 4.0f) * sqrtf((17.0f - fabsf(t - 95.0f)) / 17.0f);
+        } else if (rh > 85.0f && t >= 80.0f && t <= 87.0f) {
+            hi += ((rh - 85.0f) / 10.0f) * ((87.0f - t) / 5.0f);
+        }
+    }
+
+    return (hi - 32.0f) / 1.8f;
+}
+
+float DerivedVariables::windChill(float tempC, float windSpeedMps) {
+    // Valid for temp <= 10 C and wind >= 1.3 m/s (4.8 km/h)
+    if (tempC > 10.0f || windSpeedMps < 1.3f) {
+        return tempC;
+    }
+
+    float v016 = fastPow(windSpeedMps * 3.6f, 0.16f);
+    return 13.12f + 0.6215f * tempC - 11.37f * v016 + 0.3965f * tempC * v016;
+}
+
+float DerivedVariables::seaLevelPressure(float pressureHpa, float tempC, int elevationM) {
+    if (elevationM == 0) return pressureHpa;
+    float lapse = 0.0065f * (float)elevationM;
+    return pressureHpa * fastPow(1.0f - lapse / (tempC + lapse + 273.15f), -5.257f);
+}
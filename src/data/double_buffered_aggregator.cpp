@@ -0,0 +1,66 @@
+/**
+ * COW-Bois Weather Station - Double-Buffered Aggregator Implementation
+ */
+
+#include "data/double_buffered_aggregator.h"
+
+DoubleBufferedAggregator::DoubleBufferedAggregator(uint32_t windowMs)
+    : _activeSamples(0)
+    , _windowMs(windowMs)
+    , _windowStart(millis())
+    , _closedStart(0)
+    , _closedEnd(0)
+    , _hasClosed(false) {
+}
+
+void DoubleBufferedAggregator::addSample(const WeatherReading& reading) {
+    _windows.beginWrite().addSample(reading);
+    _windows.endWrite();
+    _activeSamples.fetch_add(1, std::memory_order_relaxed);
+}
+
+void DoubleBufferedAggregator::addSample(const WeatherReading& reading, const QCResult& qc) {
+    _windows.beginWrite().addSample(reading, qc);
+    _windows.endWrite();
+    _activeSamples.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool DoubleBufferedAggregator::close() {
+    if (_hasClosed) return false;
+
+    uint32_t now = millis();
+    _windows.swap();
+    _activeSamples.store(0, std::memory_order_relaxed);
+    _closedStart = _windowStart;
+    _closedEnd = now;
+    _windowStart = now;
+    _hasClosed = true;
+    return true;
+}
+
+AggregatedData DoubleBufferedAggregator::getClosed() {
+    if (!_hasClosed) return AggregatedData();
+
+    AggregatedData data = _windows.standby().getAggregatedData();
+    data.timestamp = _closedEnd;
+    data.windowDurationMs = _closedEnd - _closedStart;
+    return data;
+}
+
+void DoubleBufferedAggregator::release() {
+    if (!_hasClosed) return;
+    _windows.standby().reset();
+    _hasClosed = false;
+}
+
+AggregatedData DoubleBufferedAggregator::getAndReset() {
+    release();
+    close();
+    AggregatedData data = getClosed();
+    release();
+    return data;
+}
+
+bool DoubleBufferedAggregator::isWindowComplete() const {
+    return (millis() - _windowStart) >= _windowMs;
+}
@@ -0,0 +1,202 @@
+/**
+ * COW-Bois Weather Station - Event Detector Implementation
+ *
+ * Heavy rain threshold (7.6 mm/h) follows the AMS Glossary; the gust
+ * threshold sits at the top of Beaufort force 8 (gale).
+ */
+
+#include "data/event_detector.h"
+
+static const EventRule DEFAULT_RULES[] = {
+    { "gust",             DataField::WIND_SPEED,    EventRuleType::THRESHOLD, EVENT_GUST_MS,           0 },
+    { "rain_onset",       DataField::PRECIPITATION, EventRuleType::ONSET,     EVENT_RAIN_ONSET_MM,     EVENT_RAIN_DRY_MS },
+    { "heavy_rain",       DataField::PRECIPITATION, EventRuleType::RISE,      EVENT_HEAVY_RAIN_MM,     EVENT_HEAVY_RAIN_MS },
+    { "pressure_jump",    DataField::PRESSURE,      EventRuleType::CHANGE,    EVENT_PRESSURE_JUMP_HPA, EVENT_PRESSURE_JUMP_MS },
+    { "temperature_drop", DataField::TEMPERATURE,   EventRuleType::DROP,      EVENT_TEMP_DROP_C,       EVENT_TEMP_DROP_MS }
+};
+
+static_assert(sizeof(DEFAULT_RULES) / sizeof(DEFAULT_RULES[0]) <= EventDetector::MAX_RULES,
+              "Too many built-in event rules");
+
+// Field value of a reading as float
+static float fieldValue(const WeatherReading& reading, DataField field) {
+#define FIELD_VALUE(id, member, ...) case DataField::id: return (float)reading.member;
+    switch (field) {
+        WEATHER_FIELDS(FIELD_VALUE)
+        default:
+            return 0;
+    }
+}
+
+EventDetector::EventDetector(const EventRule* rules, uint8_t ruleCount)
+    : _rules(rules ? rules : DEFAULT_RULES)
+    , _ruleCount(rules ? ruleCount : sizeof(DEFAULT_RULES) / sizeof(DEFAULT_RULES[0]))
+    , _bucket(EVENT_BUCKET_SIZE, EVENT_BUCKET_REFILL_MS)
+    , _suppressed(0)
+    , _dropped(0) {
+    _lock = portMUX_INITIALIZER_UNLOCKED;
+    if (_ruleCount > MAX_RULES) _ruleCount = MAX_RULES;
+    reset();
+}
+
+void EventDetector::reset() {
+    for (uint8_t i = 0; i < MAX_RULES; i++) {
+        RuleState& s = _state[i];
+        s.lastSnapshot = 0;
+        s.head = 0;
+        s.count = 0;
+        s.active = false;
+        s.fired = false;
+        s.lastFired = 0;
+        s.base = 0;
+        s.lastRise = 0;
+        s.primed = false;
+    }
+
+    portENTER_CRITICAL(&_lock);
+    _queueHead = 0;
+    _queueCount = 0;
+    _suppressed = 0;
+    portEXIT_CRITICAL(&_lock);
+}
+
+const EventRule* EventDetector::getRule(uint8_t index) const {
+    return index < _ruleCount ? &_rules[index] : nullptr;
+}
+
+uint8_t EventDetector::check(const WeatherReading& reading, uint32_t validMask, uint32_t now) {
+    uint8_t raised = 0;
+
+    for (uint8_t i = 0; i < _ruleCount; i++) {
+        // QC-flagged values (spikes, stuck sensors) never raise events
+        if (!(validMask & (1UL << (uint8_t)_rules[i].field))) continue;
+
+        float value = fieldValue(reading, _rules[i].field);
+        float change;
+        if (!evaluate(i, value, now, change)) continue;
+
+        WeatherEvent event;
+        event.timestamp = reading.timestamp;
+        event.rule = i;
+        event.value = value;
+        event.change = change;
+        emit(event, now);
+        raised++;
+    }
+
+    return raised;
+}
+
+bool EventDetector::evaluate(uint8_t index, float value, uint32_t now, float& change) {
+    const EventRule& rule = _rules[index];
+    RuleState& s = _state[index];
+    bool condition = false;
+    change = 0;
+
+    switch (rule.type) {
+        case EventRuleType::THRESHOLD:
+            condition = value >= rule.limit;
+            break;
+
+        case EventRuleType::RISE:
+        case EventRuleType::DROP:
+        case EventRuleType::CHANGE: {
+            // Compare against the oldest snapshot, at most windowMs old
+            if (s.count > 0) change = value - s.history[s.head];
+
+            if (s.count == 0 || now - s.lastSnapshot >= rule.windowMs / EVENT_HISTORY_SLOTS) {
+                s.lastSnapshot = now;
+                if (s.count < EVENT_HISTORY_SLOTS) {
+                    s.history[(s.head + s.count) % EVENT_HISTORY_SLOTS] = value;
+                    s.count++;
+                } else {
+                    s.history[s.head] = value;
+                    s.head = (s.head + 1) % EVENT_HISTORY_SLOTS;
+                }
+            }
+
+            if (rule.type == EventRuleType::RISE) {
+                condition = change >= rule.limit;
+            } else if (rule.type == EventRuleType::DROP) {
+                condition = change <= -rule.limit;
+            } else {
+                condition = change >= rule.limit || change <= -rule.limit;
+            }
+            break;
+        }
+
+        case EventRuleType::ONSET:
+            // Quiet until proven otherwise: no onset in the first window
+            if (!s.primed) {
+                s.primed = true;
+                s.base = value;
+                s.lastRise = now;
+            } else if (value < s.base) {
+                s.base = value;             // Accumulator was reset
+            } else if (value - s.base >= rule.limit) {
+                change = value - s.base;
+                condition = now - s.lastRise >= rule.windowMs;
+                s.base = value;
+                s.lastRise = now;
+            }
+            break;
+    }
+
+    // Edge-triggered, then silent for the holdoff
+    bool rising = condition && !s.active;
+    s.active = condition;
+    if (!rising) return false;
+    if (s.fired && now - s.lastFired < EVENT_HOLDOFF_MS) return false;
+
+    s.fired = true;
+    s.lastFired = now;
+    return true;
+}
+
+bool EventDetector::enqueue(const WeatherEvent& event, uint32_t now) {
+    return emit(event, now);
+}
+
+bool EventDetector::emit(const WeatherEvent& event, uint32_t now) {
+    portENTER_CRITICAL(&_lock);
+
+    bool accepted = _queueCount < EVENT_QUEUE_SIZE && _bucket.take(now);
+    if (accepted) {
+        WeatherEvent& slot = _queue[(_queueHead + _queueCount) % EVENT_QUEUE_SIZE];
+        slot = event;
+        uint32_t suppressed = (uint32_t)event.suppressed + _suppressed;
+        slot.suppressed = suppressed > 0xFFFF ? 0xFFFF : (uint16_t)suppressed;
+        _suppressed = 0;
+        _queueCount++;
+    } else {
+        if (_suppressed < 0xFFFF) _suppressed++;
+        _dropped++;
+    }
+
+    portEXIT_CRITICAL(&_lock);
+    return accepted;
+}
+
+bool EventDetector::pop(WeatherEvent& event) {
+    portENTER_CRITICAL(&_lock);
+
+    bool available = _queueCount > 0;
+    if (available) {
+        event = _queue[_queueHead];
+        _queueHead = (_queueHead + 1) % EVENT_QUEUE_SIZE;
+        _queueCount--;
+    }
+
+    portEXIT_CRITICAL(&_lock);
+    return available;
+}
+
+bool EventDetector::peek(WeatherEvent& event) {
+    portENTER_CRITICAL(&_lock);
+
+    bool available = _queueCount > 0;
+    if (available) event = _queue[_queueHead];
+
+    portEXIT_CRITICAL(&_lock);
+    return available;
+}
@@ -0,0 +1,179 @@
+/**
+ * COW-Bois Weather Station - Fixed-Point Aggregator Implementation
+ *
+ * Per-field code is generated from the WEATHER_FIELDS registry, like
+ * DataAggregator; wireScale converts between packet and engineering units.
+ */
+
+#include "data/fixed_point_aggregator.h"
+#include "util/fast_math.h"
+#include <math.h>
+
+// The wind rose classes speeds in cm/s (WindRose::addScaled)
+#define SCALE_OF(id, member, prefix, type, kind, quant, key, shortKey, unit, wireType, wireScale, ...) \
+    wireScale,
+static constexpr float FIELD_SCALES[WEATHER_FIELD_COUNT] = { WEATHER_FIELDS(SCALE_OF) };
+#undef SCALE_OF
+static_assert(FIELD_SCALES[(uint8_t)DataField::WIND_SPEED] == 100.0f,
+              "WindRose::addScaled expects wind speed in cm/s");
+
+// A wind rose sample needs speed and direction from the same reading
+static const uint32_t WIND_ROSE_FIELDS = FIELD_BIT(WIND_SPEED) | FIELD_BIT(WIND_DIRECTION);
+
+FixedPointAggregator::FixedPointAggregator(uint32_t windowMs)
+    : _windowMs(windowMs)
+    , _sampleCount(0)
+    , _windowStartTime(0) {
+    reset();
+}
+
+void FixedPointAggregator::reset() {
+    _sampleCount = 0;
+    _windowStartTime = millis();
+
+#define FIXED_RESET_STATS(p) _##p.reset();
+#define FIXED_RESET_CIRCULAR(p) _##p##Sin = 0; _##p##Cos = 0;
+#define FIXED_RESET_LATEST(p) _##p = 0;
+#define FIXED_RESET_QUANTILES(p) _##p##Quantiles.reset();
+#define FIXED_RESET_NONE(p)
+#define FIXED_RESET_FIELD(id, member, prefix, type, kind, quant, ...) \
+    FIXED_RESET_##kind(prefix) FIXED_RESET_##quant(prefix)
+
+    WEATHER_FIELDS(FIXED_RESET_FIELD)
+
+    for (uint8_t f = 0; f < WEATHER_FIELD_COUNT; f++) _qcRejected[f] = 0;
+    for (uint8_t c = 0; c < QC_CHECK_COUNT; c++) _qcFlagCounts[c] = 0;
+    _windRose.reset();
+}
+
+void FixedPointAggregator::scale(const WeatherReading& reading, ScaledReading& scaled) {
+    scaled.timestamp = reading.timestamp;
+
+#define SCALE_FIELD(id, member, prefix, type, kind, quant, key, shortKey, unit, wireType, wireScale, ...) \
+    scaled.member = toWire<int32_t>((float)reading.member, wireScale);
+    WEATHER_FIELDS(SCALE_FIELD)
+#undef SCALE_FIELD
+
+    scaled.isValid = reading.isValid;
+}
+
+void FixedPointAggregator::addSample(const WeatherReading& reading) {
+    if (!reading.isValid) return;
+    ScaledReading scaled;
+    scale(reading, scaled);
+    addSample(scaled, QC_ALL_FIELDS);
+}
+
+void FixedPointAggregator::addSample(const WeatherReading& reading, const QCResult& qc) {
+    if (!reading.isValid) return;
+    countRejections(qc);
+    ScaledReading scaled;
+    scale(reading, scaled);
+    addSample(scaled, qc.validMask);
+}
+
+void FixedPointAggregator::countRejections(const QCResult& qc) {
+    if (qc.validMask == QC_ALL_FIELDS) return;
+    for (uint8_t f = 0; f < WEATHER_FIELD_COUNT; f++) {
+        if (qc.validMask & (1UL << f)) continue;
+        _qcRejected[f]++;
+        for (uint8_t c = 0; c < QC_CHECK_COUNT; c++) {
+            if (qc.flags[f] & (1 << c)) _qcFlagCounts[c]++;
+        }
+    }
+}
+
+void FixedPointAggregator::addSample(const ScaledReading& reading, uint32_t validMask) {
+    if (!reading.isValid) return;
+    _sampleCount++;
+
+#define FIXED_ADD_STATS(p, v, scale) _##p.add(v);
+    // Directions are whole degrees (wireScale 1)
+#define FIXED_ADD_CIRCULAR(p, v, scale) { \
+        int16_t sinQ15, cosQ15; \
+        fastSinCosDeg((uint16_t)(v), sinQ15, cosQ15); \
+        _##p##Sin += sinQ15; \
+        _##p##Cos += cosQ15; \
+    }
+#define FIXED_ADD_LATEST(p, v, scale) _##p = (v);
+#define FIXED_ADD_QUANTILES(p, v, scale) _##p##Quantiles.add((float)(v) / (scale));
+#define FIXED_ADD_NONE(p, v, scale)
+#define FIXED_ADD_FIELD(id, member, prefix, type, kind, quant, key, shortKey, unit, wireType, wireScale, ...) \
+    if (validMask & (1UL << (uint8_t)DataField::id)) { \
+        FIXED_ADD_##kind(prefix, reading.member, wireScale) \
+        FIXED_ADD_##quant(prefix, reading.member, wireScale) \
+    }
+
+    WEATHER_FIELDS(FIXED_ADD_FIELD)
+
+    if ((validMask & WIND_ROSE_FIELDS) == WIND_ROSE_FIELDS) {
+        _windRose.addScaled(reading.windSpeed, (uint16_t)reading.windDirection);
+    }
+}
+
+bool FixedPointAggregator::isWindowComplete() const {
+    return (millis() - _windowStartTime) >= _windowMs;
+}
+
+uint32_t FixedPointAggregator::getWindowElapsedMs() const {
+    return millis() - _windowStartTime;
+}
+
+AggregatedData FixedPointAggregator::getAggregatedData() {
+    AggregatedData data;
+
+    data.timestamp = millis();
+    data.sampleCount = _sampleCount;
+    data.windowDurationMs = millis() - _windowStartTime;
+
+    for (uint8_t f = 0; f < WEATHER_FIELD_COUNT; f++) data.qcRejected[f] = _qcRejected[f];
+    for (uint8_t c = 0; c < QC_CHECK_COUNT; c++) data.qcFlagCounts[c] = _qcFlagCounts[c];
+    data.windRose = _windRose;
+
+    if (_sampleCount == 0) return data;
+
+    // Back to engineering units once per window
+#define FIXED_FINAL_STATS(type, p, scale) \
+    if (_##p.count > 0) { \
+        data.p##Avg = fieldCast<type>((float)(_##p.mean() / (scale))); \
+        data.p##Min = fieldCast<type>((float)_##p.min / (scale)); \
+        data.p##Max = fieldCast<type>((float)_##p.max / (scale)); \
+        data.p##StdDev = (float)(_##p.stddev() / (scale)); \
+    }
+#define FIXED_FINAL_CIRCULAR(type, p, scale) \
+    data.p##Avg = (type)fastAtan2Deg((float)_##p##Sin, (float)_##p##Cos);
+#define FIXED_FINAL_LATEST(type, p, scale) data.p = fieldCast<type>((float)_##p / (scale));
+#define FIXED_FINAL_QUANTILES(p) \
+    data.p##P05 = _##p##Quantiles.p05.getValue(); \
+    data.p##Median = _##p##Quantiles.p50.getValue(); \
+    data.p##P95 = _##p##Quantiles.p95.getValue();
+#define FIXED_FINAL_NONE(p)
+#define FIXED_FINAL_FIELD(id, member, prefix, type, kind, quant, key, shortKey, unit, wireType, wireScale, ...) \
+    FIXED_FINAL_##kind(type, prefix, wireScale) FIXED_FINAL_##quant(prefix)
+
+    WEATHER_FIELDS(FIXED_FINAL_FIELD)
+
+    return data;
+}
+
+AggregatedData FixedPointAggregator::getAndReset() {
+    AggregatedData data = getAggregatedData();
+    reset();
+    return data;
+}
+
+float FixedPointAggregator::getCurrentAverage(DataField field) const {
+    if (_sampleCount == 0) return 0;
+
+#define FIXED_CURRENT_STATS(p, scale) (float)(_##p.mean() / (scale))
+#define FIXED_CURRENT_CIRCULAR(p, scale) fastAtan2Deg((float)_##p##Sin, (float)_##p##Cos)
+#define FIXED_CURRENT_LATEST(p, scale) (float)_##p / (scale)
+#define FIXED_CURRENT_FIELD(id, member, prefix, type, kind, quant, key, shortKey, unit, wireType, wireScale, ...) \
+    case DataField::id: return FIXED_CURRENT_##kind(prefix, wireScale);
+
+    switch (field) {
+        WEATHER_FIELDS(FIXED_CURRENT_FIELD)
+        default:
+            return 0;
+    }
+}
@@ -0,0 +1,115 @@
+/**
+ * COW-Bois Weather Station - Hampel Filter Implementation
+ *
+ * F. R. Hampel, "The influence curve and its role in robust estimation",
+ * JASA 69(346), 1974; causal (trailing-window) form. 1.4826 makes the MAD
+ * a consistent estimate of sigma for Gaussian noise.
+ */
+
+#include "data/hampel_filter.h"
+#include <math.h>
+
+static const float MAD_TO_SIGMA = 1.4826f;
+
+HampelFilter::HampelFilter(uint8_t windowSize, float minDeviation, float threshold)
+    : _minDeviation(minDeviation)
+    , _threshold(threshold) {
+    if (windowSize < 3) windowSize = 3;
+    if (windowSize > HAMPEL_MAX_WINDOW) windowSize = HAMPEL_MAX_WINDOW;
+    _windowSize = windowSize | 1;         // Odd: the median is a window value
+    if (_windowSize > HAMPEL_MAX_WINDOW) _windowSize -= 2;
+    reset();
+}
+
+void HampelFilter::reset() {
+    _head = 0;
+    _count = 0;
+    _rejected = 0;
+    _total = 0;
+}
+
+float HampelFilter::filter(float x) {
+    if (isnan(x)) return x;               // Left to QC; would break the sort
+    _total++;
+
+    // Slide the window: the oldest value leaves, the raw value enters
+    if (_count == _windowSize) {
+        removeSorted(_ring[_head]);
+        _ring[_head] = x;
+        _head = (_head + 1) % _windowSize;
+    } else {
+        _ring[(_head + _count) % _windowSize] = x;
+        _count++;
+    }
+    insertSorted(x);
+
+    // Too few values for a robust spread yet
+    if (_count < 3) return x;
+
+    float med = median();
+    float limit = _threshold * MAD_TO_SIGMA * medianAbsDeviation(med);
+    if (limit < _minDeviation) limit = _minDeviation;
+
+    if (fabsf(x - med) > limit) {
+        _rejected++;
+        return med;
+    }
+    return x;
+}
+
+void HampelFilter::insertSorted(float x) {
+    // _count already includes x; the sorted copy holds _count - 1 values
+    uint8_t n = _count - 1;
+    uint8_t lo = 0, hi = n;
+    while (lo < hi) {
+        uint8_t mid = (lo + hi) / 2;
+        if (_sorted[mid] < x) lo = mid + 1;
+        else hi = mid;
+    }
+    memmove(&_sorted[lo + 1], &_sorted[lo], (n - lo) * sizeof(float));
+    _sorted[lo] = x;
+}
+
+void HampelFilter::removeSorted(float x) {
+    // Called with a full window; x is present (bitwise, it came from _ring)
+    uint8_t n = _count;
+    uint8_t lo = 0, hi = n - 1;
+    while (lo < hi) {
+        uint8_t mid = (lo + hi) / 2;
+        if (_sorted[mid] < x) lo = mid + 1;
+        else hi = mid;
+    }
+    memmove(&_sorted[lo], &_sorted[lo + 1], (n - 1 - lo) * sizeof(float));
+}
+
+float HampelFilter::median() const {
+    uint8_t mid = _count / 2;
+    if (_count & 1) return _sorted[mid];
+    return 0.5f * (_sorted[mid - 1] + _sorted[mid]);
+}
+
+float HampelFilter::medianAbsDeviation(float med) const {
+    // Deviations below the median ascend walking left, those above
+    // ascend walking right: merge the two runs up to the middle rank
+    int8_t left = 0;
+    while (left < _count && _sorted[left] < med) left++;
+    int8_t right = left;
+    left--;
+
+    uint8_t target = (_count - 1) / 2;
+    float previous = 0, current = 0;
+    for (uint8_t rank = 0; rank <= _count / 2; rank++) {
+        float dl = left >= 0 ? med - _sorted[left] : INFINITY;
+        float dr = right < _count ? _sorted[right] - med : INFINITY;
+        previous = current;
+        if (dl < dr) {
+            current = dl;
+            left--;
+        } else {
+            current = dr;
+            right++;
+        }
+        if (rank == target && (_count & 1)) return current;
+    }
+    return 0.5f * (previous + current);
+}
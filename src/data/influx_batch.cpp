@@ -0,0 +1,60 @@
+/**
+ * COW-Bois Weather Station - InfluxDB Batch Implementation
+ */
+
+#include "data/influx_batch.h"
+#include "data/data_formatter.h"
+
+InfluxBatch::InfluxBatch(char* buffer, size_t size)
+    : _buffer(buffer), _size(size), _length(0), _records(0), _series() {
+    if (_size > 0) _buffer[0] = '\0';
+}
+
+void InfluxBatch::begin(const char* measurement, const char* siteId) {
+    _length = 0;
+    _records = 0;
+    if (_size > 0) _buffer[0] = '\0';
+
+    char site[INFLUX_TAG_LENGTH + 1];
+    escapeTag(siteId, site, sizeof(site));
+    snprintf(_series, sizeof(_series), "%s,site=%s", measurement, site);
+}
+
+bool InfluxBatch::add(const char* stationId, const AggregatedData& data, uint64_t epochMs) {
+    char station[INFLUX_TAG_LENGTH + 1];
+    escapeTag(stationId, station, sizeof(station));
+
+    // Lines after the first start with the newline separating them
+    size_t start = _length + (_records > 0 ? 1 : 0);
+    if (start + 1 >= _size || _records == UINT16_MAX) return false;
+
+    size_t room = _size - start;
+    size_t written = DataFormatter::toInfluxLineProtocol(_series, station, data,
+                                                         _buffer + start, room, epochMs);
+    if (written >= room) {
+        _buffer[_length] = '\0';
+        return false;
+    }
+
+    if (_records > 0) _buffer[_length] = '\n';
+    _length = start + written;
+    _records++;
+    return true;
+}
+
+// Tag values escape ',', '=' and ' '; backslashes and control characters
+// (a newline would end the line) are dropped. Truncated to fit, never
+// mid-escape.
+size_t InfluxBatch::escapeTag(const char* value, char* out, size_t size) {
+    size_t length = 0;
+    for (; *value; value++) {
+        char c = *value;
+        if ((uint8_t)c < 0x20 || c == 0x7F || c == '\\') continue;
+        bool escaped = c == ',' || c == '=' || c == ' ';
+        if (length + (escaped ? 2 : 1) >= size) break;
+        if (escaped) out[length++] = '\\';
+        out[length++] = c;
+    }
+    out[length] = '\0';
+    return length;
+}
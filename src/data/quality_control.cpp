@@ -0,0 +1,104 @@
+/**
+ * COW-Bois Weather Station - Quality Control Implementation
+ *
+ * Check types follow the AASC Recommendations and Best Practices for
+ * Mesonets (range, step, persistence, internal consistency).
+ */
+
+#include "data/quality_control.h"
+#include <math.h>
+
+QualityControl::QualityControl() {
+    reset();
+}
+
+void QualityControl::reset() {
+    for (uint8_t f = 0; f < WEATHER_FIELD_COUNT; f++) {
+        _last[f] = 0;
+        _lastTime[f] = 0;
+        _unchangedSince[f] = 0;
+    }
+    _seen = 0;
+}
+
+QCResult QualityControl::check(const WeatherReading& reading, uint32_t sensorMask) {
+    QCResult result;
+
+#define QC_FIELD(id, member, prefix, type, kind, quant, key, shortKey, unit, wireType, wireScale, \
+                 qcMin, qcMax, qcStep, qcPersist, ...) \
+    result.flags[(uint8_t)DataField::id] = (sensorMask & FIELD_BIT(id)) \
+        ? checkField((uint8_t)DataField::id, (float)reading.member, reading.timestamp, \
+                     qcMin, qcMax, qcStep, qcPersist) \
+        : (uint8_t)QC_MISSING;
+    WEATHER_FIELDS(QC_FIELD)
+
+    checkConsistency(reading, result);
+
+    result.validMask = 0;
+    for (uint8_t f = 0; f < WEATHER_FIELD_COUNT; f++) {
+        if (result.flags[f] == 0) result.validMask |= 1UL << f;
+    }
+    return result;
+}
+
+uint8_t QualityControl::checkField(uint8_t field, float value, uint32_t timestamp,
+                                   float qcMin, float qcMax, float qcStep, uint32_t qcPersist) {
+    // Out-of-range values don't become the reference for later checks
+    if (value < qcMin || value > qcMax) return QC_RANGE;
+
+    uint32_t bit = 1UL << field;
+    if (!(_seen & bit)) {
+        _seen |= bit;
+        _last[field] = value;
+        _lastTime[field] = timestamp;
+        _unchangedSince[field] = timestamp;
+        return 0;
+    }
+
+    uint8_t flags = 0;
+    float delta = fabsf(value - _last[field]);
+    uint32_t elapsed = timestamp - _lastTime[field];
+
+    // Allowed change grows with the time since the previous value, so a
+    // gap in the data does not flag the first sample after it
+    if (qcStep > 0) {
+        if (elapsed < QC_MIN_STEP_MS) elapsed = QC_MIN_STEP_MS;
+        if (delta > qcStep * (float)elapsed / 60000.0f) flags |= QC_STEP;
+    }
+
+    // Values pinned at a limit (calm, saturated, dark) legitimately persist
+    if (delta != 0 || value == qcMin || value == qcMax) {
+        _unchangedSince[field] = timestamp;
+    } else if (qcPersist > 0 && timestamp - _unchangedSince[field] >= qcPersist * 60000UL) {
+        flags |= QC_PERSISTENCE;
+    }
+
+    _last[field] = value;
+    _lastTime[field] = timestamp;
+    return flags;
+}
+
+void QualityControl::checkConsistency(const WeatherReading& reading, QCResult& result) {
+    const uint8_t temp = (uint8_t)DataField::TEMPERATURE;
+    const uint8_t speed = (uint8_t)DataField::WIND_SPEED;
+    const uint8_t dir = (uint8_t)DataField::WIND_DIRECTION;
+
+    // The vane only tracks the wind above calm; a still vane is expected
+    if (reading.windSpeed <= QC_CALM_WIND_MS) {
+        result.flags[dir] &= ~QC_PERSISTENCE;
+        _unchangedSince[dir] = reading.timestamp;
+    }
+
+    // Direction is meaningless without a good speed from the same sensor
+    if (result.flags[speed] & (QC_MISSING | QC_RANGE)) {
+        result.flags[dir] |= QC_CONSISTENCY;
+    }
+
+    // A BME680 temperature outside physical limits means a corrupt
+    // measurement cycle; the other channels of that read are suspect
+    if (result.flags[temp] & QC_RANGE) {
+        result.flags[(uint8_t)DataField::HUMIDITY] |= QC_CONSISTENCY;
+        result.flags[(uint8_t)DataField::PRESSURE] |= QC_CONSISTENCY;
+        result.flags[(uint8_t)DataField::GAS_RESISTANCE] |= QC_CONSISTENCY;
+    }
+}
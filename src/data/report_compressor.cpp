@@ -0,0 +1,87 @@
+/**
+ * COW-Bois Weather Station - Report Compressor Implementation
+ *
+ * Dead-band (deadband / deadbandPct registry columns) per field. The
+ * swinging-door variant would need to hold reports back until the door
+ * closes; a dead-band decides each report on its own, so reports are
+ * never delayed.
+ */
+
+#include "data/report_compressor.h"
+#include <math.h>
+
+// Dead-band columns by DataField index
+#define FIELD_DEADBAND(id, member, prefix, type, kind, quant, key, shortKey, unit, \
+                       wireType, wireScale, qcMin, qcMax, qcStep, qcPersist, \
+                       deadband, deadbandPct, ...) deadband,
+#define FIELD_DEADBAND_PCT(id, member, prefix, type, kind, quant, key, shortKey, unit, \
+                           wireType, wireScale, qcMin, qcMax, qcStep, qcPersist, \
+                           deadband, deadbandPct, ...) deadbandPct,
+static const float DEADBAND[WEATHER_FIELD_COUNT] = { WEATHER_FIELDS(FIELD_DEADBAND) };
+static const float DEADBAND_PCT[WEATHER_FIELD_COUNT] = { WEATHER_FIELDS(FIELD_DEADBAND_PCT) };
+
+static bool exceeds(DataField field, float value, float sent) {
+    return fabsf(value - sent) > ReportCompressor::tolerance(field, sent);
+}
+
+// Shortest angular distance for directions
+static bool exceedsAngle(DataField field, float value, float sent) {
+    float delta = fmodf(fabsf(value - sent), 360.0f);
+    if (delta > 180.0f) delta = 360.0f - delta;
+    return delta > ReportCompressor::tolerance(field, sent);
+}
+
+ReportCompressor::ReportCompressor(uint8_t keyframeInterval)
+    : _keyframeInterval(keyframeInterval > 0 ? keyframeInterval : 1)
+    , _sinceKeyframe(0) {
+}
+
+void ReportCompressor::reset() {
+    _sinceKeyframe = 0;
+}
+
+float ReportCompressor::tolerance(DataField field, float reference) {
+    uint8_t f = (uint8_t)field;
+    float relative = DEADBAND_PCT[f] * 0.01f * fabsf(reference);
+    return relative > DEADBAND[f] ? relative : DEADBAND[f];
+}
+
+ReportSelection ReportCompressor::select(const AggregatedData& data) {
+    ReportSelection selection;
+    selection.keyframe = _sinceKeyframe == 0;
+    selection.fieldMask = 0;
+
+#define CHANGED_STATS(id, p) \
+    exceeds(DataField::id, (float)data.p##Avg, (float)_sent.p##Avg) || \
+    exceeds(DataField::id, (float)data.p##Min, (float)_sent.p##Min) || \
+    exceeds(DataField::id, (float)data.p##Max, (float)_sent.p##Max)
+#define CHANGED_CIRCULAR(id, p) \
+    exceedsAngle(DataField::id, (float)data.p##Avg, (float)_sent.p##Avg)
+#define CHANGED_LATEST(id, p) \
+    exceeds(DataField::id, (float)data.p, (float)_sent.p)
+#define CHANGED_QUANTILES(id, p) || \
+    exceeds(DataField::id, data.p##P05, _sent.p##P05) || \
+    exceeds(DataField::id, data.p##Median, _sent.p##Median) || \
+    exceeds(DataField::id, data.p##P95, _sent.p##P95)
+#define CHANGED_NONE(id, p)
+
+#define SENT_STATS(p) \
+    _sent.p##Avg = data.p##Avg; _sent.p##Min = data.p##Min; \
+    _sent.p##Max = data.p##Max; _sent.p##StdDev = data.p##StdDev;
+#define SENT_CIRCULAR(p) _sent.p##Avg = data.p##Avg;
+#define SENT_LATEST(p) _sent.p = data.p;
+#define SENT_QUANTILES(p) \
+    _sent.p##P05 = data.p##P05; _sent.p##Median = data.p##Median; _sent.p##P95 = data.p##P95;
+#define SENT_NONE(p)
+
+#define SELECT_FIELD(id, member, prefix, type, kind, quant, ...) \
+    if (selection.keyframe || CHANGED_##kind(id, prefix) CHANGED_##quant(id, prefix)) { \
+        selection.fieldMask |= FIELD_BIT(id); \
+        SENT_##kind(prefix) SENT_##quant(prefix) \
+    }
+
+    WEATHER_FIELDS(SELECT_FIELD)
+
+    if (++_sinceKeyframe >= _keyframeInterval) _sinceKeyframe = 0;
+    return selection;
+}
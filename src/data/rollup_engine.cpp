@@ -0,0 +1,94 @@
+/**
+ * COW-Bois Weather Station - Rollup Engine Implementation
+ */
+
+#include "data/rollup_engine.h"
+
+// Number of lower-tier records merged into each tier
+static const uint8_t RECORDS_PER_TIER[] = {
+    1,                       // MINUTE_1 (fed by samples)
+    ROLLUP_5MIN_RECORDS,     // MINUTE_5
+    ROLLUP_HOURLY_RECORDS,   // HOURLY
+    ROLLUP_DAILY_RECORDS     // DAILY
+};
+
+RollupEngine::RollupEngine()
+    : _base(ROLLUP_BASE_WINDOW_MS) {
+    reset();
+}
+
+void RollupEngine::reset() {
+    _base.reset();
+
+    for (uint8_t i = 0; i < TIER_COUNT; i++) {
+        _partial[i] = AggregatedData();
+        _partialRecords[i] = 0;
+        _latest[i] = AggregatedData();
+        _hasLatest[i] = false;
+    }
+}
+
+void RollupEngine::addSample(const WeatherReading& reading) {
+    _base.addSample(reading);
+}
+
+void RollupEngine::addSample(const WeatherReading& reading, const QCResult& qc) {
+    _base.addSample(reading, qc);
+}
+
+uint8_t RollupEngine::update() {
+    if (!_base.isWindowComplete()) return 0;
+
+    AggregatedData minute = _base.getAndReset();
+    return cascade(RollupTier::MINUTE_1, minute);
+}
+
+uint8_t RollupEngine::cascade(RollupTier tier, const AggregatedData& record) {
+    uint8_t index = (uint8_t)tier;
+
+    _latest[index] = record;
+    _hasLatest[index] = true;
+    uint8_t closedMask = 1 << index;
+
+    uint8_t next = index + 1;
+    if (next >= TIER_COUNT) return closedMask;
+
+    // Higher tiers are built from lower-tier records, never from samples
+    if (_partialRecords[next] == 0) {
+        _partial[next] = record;
+    } else {
+        DataAggregator::merge(_partial[next], record);
+    }
+    _partialRecords[next]++;
+
+    if (_partialRecords[next] >= RECORDS_PER_TIER[next]) {
+        AggregatedData full = _partial[next];
+        _partialRecords[next] = 0;
+        closedMask |= cascade((RollupTier)next, full);
+    }
+
+    return closedMask;
+}
+
+bool RollupEngine::getLatest(RollupTier tier, AggregatedData& data) const {
+    uint8_t index = (uint8_t)tier;
+    if (index >= TIER_COUNT || !_hasLatest[index]) return false;
+
+    data = _latest[index];
+    return true;
+}
+
+const char* RollupEngine::tierName(RollupTier tier) {
+    switch (tier) {
+        case RollupTier::MINUTE_1:
+            return "1min";
+        case RollupTier::MINUTE_5:
+            return "5min";
+        case RollupTier::HOURLY:
+            return "hourly";
+        case RollupTier::DAILY:
+            return "daily";
+        default:
+            return "unknown";
+    }
+}
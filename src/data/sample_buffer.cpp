@@ -0,0 +1,131 @@
+/**
+ * COW-Bois Weather Station - Raw Sample Buffer Implementation
+ */
+
+#include "data/sample_buffer.h"
+
+SampleBuffer::SampleBuffer() {
+    clear();
+}
+
+void SampleBuffer::clear() {
+    _head = 0;
+    _count = 0;
+    _overflowed = false;
+    memset(_valid, 0, sizeof(_valid));
+}
+
+void SampleBuffer::push(const WeatherReading& reading) {
+    push(reading, reading.isValid ? 0xFFFFFFFFUL : 0);
+}
+
+void SampleBuffer::push(const WeatherReading& reading, uint32_t validMask) {
+    size_t s;
+    if (_count < CAPACITY) {
+        s = slot(_count);
+        _count++;
+    } else {
+        // Full - overwrite the oldest sample
+        s = _head;
+        _head = slot(1);
+        _overflowed = true;
+    }
+
+    _timestamp[s] = reading.timestamp;
+#define SAMPLE_STORE(id, member, ...) _##member[s] = reading.member;
+    WEATHER_FIELDS(SAMPLE_STORE)
+#undef SAMPLE_STORE
+
+    uint32_t bit = 1UL << (s & 31);
+    for (uint8_t f = 0; f < WEATHER_FIELD_COUNT; f++) {
+        if (validMask & (1UL << f)) {
+            _valid[f][s >> 5] |= bit;
+        } else {
+            _valid[f][s >> 5] &= ~bit;
+        }
+    }
+}
+
+uint32_t SampleBuffer::getTimestamp(size_t index) const {
+    if (index >= _count) return 0;
+    return _timestamp[slot(index)];
+}
+
+float SampleBuffer::getValue(DataField field, size_t index) const {
+    if (index >= _count) return 0;
+    size_t s = slot(index);
+
+    switch (field) {
+#define SAMPLE_VALUE(id, member, ...) \
+        case DataField::id: return (float)_##member[s];
+        WEATHER_FIELDS(SAMPLE_VALUE)
+#undef SAMPLE_VALUE
+        default:
+            return 0;
+    }
+}
+
+bool SampleBuffer::isValid(DataField field, size_t index) const {
+    if (index >= _count || field >= DataField::COUNT) return false;
+    return validAt((uint8_t)field, slot(index));
+}
+
+void SampleBuffer::invalidate(DataField field, size_t index) {
+    if (index >= _count || field >= DataField::COUNT) return;
+    size_t s = slot(index);
+    _valid[(uint8_t)field][s >> 5] &= ~(1UL << (s & 31));
+}
+
+bool SampleBuffer::getReading(size_t index, WeatherReading& reading) const {
+    if (index >= _count) return false;
+    size_t s = slot(index);
+
+    reading.timestamp = _timestamp[s];
+    reading.isValid = false;
+#define SAMPLE_LOAD(id, member, ...) \
+    reading.member = _##member[s]; \
+    if (validAt((uint8_t)DataField::id, s)) reading.isValid = true;
+    WEATHER_FIELDS(SAMPLE_LOAD)
+#undef SAMPLE_LOAD
+
+    return true;
+}
+
+size_t SampleBuffer::getLatest(DataField field, size_t n, float* out) const {
+    if (field >= DataField::COUNT) return 0;
+
+    // Walk back from the newest sample to find the first of the last n valid
+    size_t found = 0;
+    size_t index = _count;
+    while (index > 0 && found < n) {
+        index--;
+        if (validAt((uint8_t)field, slot(index))) found++;
+    }
+
+    size_t copied = 0;
+    for (; index < _count && copied < found; index++) {
+        if (validAt((uint8_t)field, slot(index))) {
+            out[copied++] = getValue(field, index);
+        }
+    }
+    return copied;
+}
+
+void SampleBuffer::dump(Print& out) const {
+    out.print("timestamp");
+#define DUMP_HEADER(id, member, prefix, type, kind, quant, key, ...) out.print("," key);
+    WEATHER_FIELDS(DUMP_HEADER)
+#undef DUMP_HEADER
+    out.println();
+
+    for (size_t i = 0; i < _count; i++) {
+        size_t s = slot(i);
+        out.print(_timestamp[s]);
+#define DUMP_FIELD(id, member, ...) \
+        out.print(','); \
+        if (validAt((uint8_t)DataField::id, s)) out.print(_##member[s]);
+        WEATHER_FIELDS(DUMP_FIELD)
+#undef DUMP_FIELD
+        out.println();
+    }
+}
@@ -0,0 +1,282 @@
+/**
+ * COW-Bois Weather Station - Sliding Window Aggregator Implementation
+ */
+
+#include "data/sliding_window.h"
+#include "util/fast_math.h"
+#include <math.h>
+#include <algorithm>
+
+// ============================================
+// Rolling Statistics
+// ============================================
+
+void RollingStats::add(float x, size_t slot) {
+    values[slot] = x;
+
+    // First value of an empty window: restart the sums around it
+    if (++count == 1) {
+        shift = x;
+        sum = 0;
+        sumSq = 0;
+        evictions = 0;
+    }
+
+    float d = x - shift;
+    sum += d;
+    sumSq += d * d;
+
+    // Drop samples that can no longer be the extreme, then append
+    while (minCount > 0 && values[minQ[(minHead + minCount - 1) % CAPACITY]] >= x) minCount--;
+    minQ[(minHead + minCount) % CAPACITY] = (RollingSlot)slot;
+    minCount++;
+
+    while (maxCount > 0 && values[maxQ[(maxHead + maxCount - 1) % CAPACITY]] <= x) maxCount--;
+    maxQ[(maxHead + maxCount) % CAPACITY] = (RollingSlot)slot;
+    maxCount++;
+}
+
+void RollingStats::evict(size_t slot, size_t head, size_t samples) {
+    if (isnan(values[slot])) return;
+
+    float d = values[slot] - shift;
+    sum -= d;
+    sumSq -= d * d;
+    count--;
+
+    // The evicted sample is the oldest, so it can only be at the front
+    if (minCount > 0 && minQ[minHead] == slot) {
+        minHead = (minHead + 1) % CAPACITY;
+        minCount--;
+    }
+    if (maxCount > 0 && maxQ[maxHead] == slot) {
+        maxHead = (maxHead + 1) % CAPACITY;
+        maxCount--;
+    }
+
+    if (++evictions >= CAPACITY) {
+        rebuild(head, samples);
+    }
+}
+
+void RollingStats::rebuild(size_t head, size_t samples) {
+    evictions = 0;
+    sum = 0;
+    sumSq = 0;
+    if (count == 0) return;
+
+    // Re-centre on the current mean so the squared sums stay small
+    float m = 0;
+    for (size_t i = 0, s = head; i < samples; i++, s = (s + 1) % CAPACITY) {
+        if (!isnan(values[s])) m += values[s];
+    }
+    shift = m / (float)count;
+
+    for (size_t i = 0, s = head; i < samples; i++, s = (s + 1) % CAPACITY) {
+        if (isnan(values[s])) continue;
+        float d = values[s] - shift;
+        sum += d;
+        sumSq += d * d;
+    }
+}
+
+void RollingStats::quantiles(size_t head, size_t samples, float* scratch,
+                             float& p05, float& p50, float& p95) const {
+    p05 = p50 = p95 = 0;
+    if (count == 0) return;
+
+    for (size_t i = 0, n = 0, s = head; i < samples; i++, s = (s + 1) % CAPACITY) {
+        if (!isnan(values[s])) scratch[n++] = values[s];
+    }
+
+    // Ascending ranks: each selection only searches above the last one
+    size_t r05 = (size_t)(0.05f * (count - 1) + 0.5f);
+    size_t r50 = (size_t)(0.50f * (count - 1) + 0.5f);
+    size_t r95 = (size_t)(0.95f * (count - 1) + 0.5f);
+    std::nth_element(scratch, scratch + r05, scratch + count);
+    if (r50 > r05) std::nth_element(scratch + r05 + 1, scratch + r50, scratch + count);
+    if (r95 > r50) std::nth_element(scratch + r50 + 1, scratch + r95, scratch + count);
+    p05 = scratch[r05];
+    p50 = scratch[r50];
+    p95 = scratch[r95];
+}
+
+float RollingStats::stddev() const {
+    if (count < 2) return 0;
+    float variance = (sumSq - sum * sum / (float)count) / (float)(count - 1);
+    return variance > 0 ? sqrtf(variance) : 0;
+}
+
+// ============================================
+// Rolling Circular Mean
+// ============================================
+
+void RollingCircular::add(uint16_t degrees, size_t slot) {
+    int16_t s, c;
+    fastSinCosDeg(degrees, s, c);
+    values[slot] = degrees;
+    sinSum += s;
+    cosSum += c;
+}
+
+void RollingCircular::evict(size_t slot) {
+    if (values[slot] == SKIPPED) return;
+
+    int16_t s, c;
+    fastSinCosDeg(values[slot], s, c);
+    sinSum -= s;
+    cosSum -= c;
+}
+
+float RollingCircular::mean() const {
+    return fastAtan2Deg((float)sinSum, (float)cosSum);
+}
+
+// ============================================
+// Sliding Window
+// ============================================
+
+SlidingWindow::SlidingWindow(uint32_t windowMs)
+    : _windowMs(windowMs)
+    , _head(0)
+    , _count(0) {
+    reset();
+}
+
+void SlidingWindow::reset() {
+    _head = 0;
+    _count = 0;
+
+#define ROLLING_RESET_STATS(p) _##p.reset();
+#define ROLLING_RESET_CIRCULAR(p) _##p.reset();
+#define ROLLING_RESET_LATEST(p) _##p = 0;
+#define ROLLING_RESET(id, member, prefix, type, kind, ...) ROLLING_RESET_##kind(prefix)
+    WEATHER_FIELDS(ROLLING_RESET)
+}
+
+void SlidingWindow::setWindowMs(uint32_t windowMs) {
+    _windowMs = windowMs;
+    reset();
+}
+
+void SlidingWindow::evictOldest() {
+    size_t slot = _head;
+    _head = (_head + 1) % CAPACITY;
+    _count--;
+
+#define ROLLING_EVICT_STATS(p) _##p.evict(slot, _head, _count);
+#define ROLLING_EVICT_CIRCULAR(p) _##p.evict(slot);
+#define ROLLING_EVICT_LATEST(p)
+#define ROLLING_EVICT(id, member, prefix, type, kind, ...) ROLLING_EVICT_##kind(prefix)
+    WEATHER_FIELDS(ROLLING_EVICT)
+}
+
+void SlidingWindow::addSample(const WeatherReading& reading) {
+    if (!reading.isValid) return;
+    add(reading, QC_ALL_FIELDS);
+}
+
+void SlidingWindow::addSample(const WeatherReading& reading, const QCResult& qc) {
+    if (!reading.isValid) return;
+    add(reading, qc.validMask);
+}
+
+void SlidingWindow::add(const WeatherReading& reading, uint32_t validMask) {
+    while (_count > 0 && reading.timestamp - _timestamps[_head] >= _windowMs) {
+        evictOldest();
+    }
+    if (_count == CAPACITY) {
+        evictOldest();
+    }
+
+    size_t slot = (_head + _count) % CAPACITY;
+    _count++;
+    _timestamps[slot] = reading.timestamp;
+
+#define ROLLING_ADD_STATS(p, v) _##p.add((float)(v), slot);
+#define ROLLING_ADD_CIRCULAR(p, v) _##p.add((uint16_t)(v), slot);
+#define ROLLING_ADD_LATEST(p, v) _##p = (v);  // Sensor value is already cumulative
+#define ROLLING_SKIP_STATS(p) _##p.skip(slot);
+#define ROLLING_SKIP_CIRCULAR(p) _##p.skip(slot);
+#define ROLLING_SKIP_LATEST(p)                // Keeps the last accepted total
+#define ROLLING_ADD(id, member, prefix, type, kind, ...) \
+    if (validMask & FIELD_BIT(id)) { \
+        ROLLING_ADD_##kind(prefix, reading.member) \
+    } else { \
+        ROLLING_SKIP_##kind(prefix) \
+    }
+    WEATHER_FIELDS(ROLLING_ADD)
+}
+
+AggregatedData SlidingWindow::getAggregatedData() const {
+    AggregatedData data;
+    data.sampleCount = _count;
+    if (_count == 0) return data;
+
+    size_t newest = (_head + _count - 1) % CAPACITY;
+    data.timestamp = _timestamps[newest];
+    data.windowDurationMs = _timestamps[newest] - _timestamps[_head];
+
+#define ROLLING_FINAL_STATS(type, p) \
+    data.p##Avg = fieldCast<type>(_##p.mean()); \
+    data.p##Min = fieldCast<type>(_##p.min()); \
+    data.p##Max = fieldCast<type>(_##p.max()); \
+    data.p##StdDev = _##p.stddev();
+#define ROLLING_FINAL_CIRCULAR(type, p) data.p##Avg = (type)_##p.mean();
+#define ROLLING_FINAL_LATEST(type, p) data.p = fieldCast<type>(_##p);
+#define ROLLING_FINAL_QUANTILES(p) \
+    _##p.quantiles(_head, _count, scratch, data.p##P05, data.p##Median, data.p##P95);
+#define ROLLING_FINAL_NONE(p)
+#define ROLLING_FINAL(id, member, prefix, type, kind, quant, ...) \
+    ROLLING_FINAL_##kind(type, prefix) ROLLING_FINAL_##quant(prefix)
+    float scratch[CAPACITY];
+    WEATHER_FIELDS(ROLLING_FINAL)
+
+    return data;
+}
+
+float SlidingWindow::getAverage(DataField field) const {
+    if (_count == 0) return 0;
+
+#define ROLLING_AVG_STATS(p) _##p.mean()
+#define ROLLING_AVG_CIRCULAR(p) _##p.mean()
+#define ROLLING_AVG_LATEST(p) _##p
+#define ROLLING_AVG(id, member, prefix, type, kind, ...) \
+    case DataField::id: return ROLLING_AVG_##kind(prefix);
+
+    switch (field) {
+        WEATHER_FIELDS(ROLLING_AVG)
+        default:
+            return 0;
+    }
+}
+
+#define ROLLING_EXTREME_STATS(p, fn) return _##p.fn();
+#define ROLLING_EXTREME_CIRCULAR(p, fn) return 0;
+#define ROLLING_EXTREME_LATEST(p, fn) return 0;
+
+float SlidingWindow::getMin(DataField field) const {
+    if (_count == 0) return 0;
+
+#define ROLLING_MIN(id, member, prefix, type, kind, ...) \
+    case DataField::id: ROLLING_EXTREME_##kind(prefix, min)
+
+    switch (field) {
+        WEATHER_FIELDS(ROLLING_MIN)
+        default:
+            return 0;
+    }
+}
+
+float SlidingWindow::getMax(DataField field) const {
+    if (_count == 0) return 0;
+
+#define ROLLING_MAX(id, member, prefix, type, kind, ...) \
+    case DataField::id: ROLLING_EXTREME_##kind(prefix, max)
+
+    switch (field) {
+        WEATHER_FIELDS(ROLLING_MAX)
+        default:
+            return 0;
+    }
+}
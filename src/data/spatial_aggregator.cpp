@@ -0,0 +1,234 @@
+/**
+ * COW-Bois Weather Station - Spatial Aggregator Implementation
+ */
+
+#include "data/spatial_aggregator.h"
+#include "util/fast_math.h"
+#include <float.h>
+#include <math.h>
+
+// Mean Earth radius (6371 km) over one degree
+static const double KM_PER_DEG = 111.195;
+
+static void copyStationId(char* target, const char* stationId) {
+    strncpy(target, stationId, 8);
+    target[8] = '\0';
+}
+
+SpatialAggregator::SpatialAggregator()
+    : _refLatitude(0)
+    , _refLongitude(0)
+    , _kmPerDegLon(0)
+    , _refFixed(false)
+    , _refValid(false) {
+    reset();
+}
+
+void SpatialAggregator::setReference(float latitude, float longitude) {
+    useReference(latitude, longitude);
+    _refFixed = true;
+}
+
+void SpatialAggregator::useReference(float latitude, float longitude) {
+    _refLatitude = latitude;
+    _refLongitude = longitude;
+    _kmPerDegLon = (float)(KM_PER_DEG * cos(latitude * M_PI / 180.0));
+    _refValid = true;
+}
+
+void SpatialAggregator::reset() {
+    for (uint8_t f = 0; f < WEATHER_FIELD_COUNT; f++) {
+        FieldState& state = _fields[f];
+        state.count = 0;
+        state.sum = 0;
+        state.sumSq = 0;
+        state.min = FLT_MAX;
+        state.max = -FLT_MAX;
+        state.minStation[0] = '\0';
+        state.maxStation[0] = '\0';
+        state.planeCount = 0;
+        state.sx = state.sy = state.sxx = state.sxy = state.syy = 0;
+        state.sv = state.sxv = state.syv = 0;
+    }
+    _stations = 0;
+    _samples = 0;
+    _timestamp = 0;
+    if (!_refFixed) _refValid = false;
+}
+
+// ============================================
+// Accumulation
+// ============================================
+
+void SpatialAggregator::addValue(FieldState& state, const char* stationId, float mean,
+                                 float min, float max, bool positioned, double x, double y) {
+    state.count++;
+    state.sum += mean;
+    state.sumSq += (double)mean * mean;
+
+    if (min < state.min) {
+        state.min = min;
+        copyStationId(state.minStation, stationId);
+    }
+    if (max > state.max) {
+        state.max = max;
+        copyStationId(state.maxStation, stationId);
+    }
+
+    if (positioned) {
+        state.planeCount++;
+        state.sx += x;
+        state.sy += y;
+        state.sxx += x * x;
+        state.sxy += x * y;
+        state.syy += y * y;
+        state.sv += mean;
+        state.sxv += x * mean;
+        state.syv += y * mean;
+    }
+}
+
+void SpatialAggregator::addDirection(FieldState& state, uint16_t direction) {
+    int16_t sinQ15, cosQ15;
+    fastSinCosDeg(direction, sinQ15, cosQ15);
+    state.count++;
+    state.sum += sinQ15;
+    state.sumSq += cosQ15;
+}
+
+void SpatialAggregator::addStation(const char* stationId, const AggregatedData& data,
+                                   float latitude, float longitude) {
+    if (_stations == UINT16_MAX) return;
+    _stations++;
+    _samples += data.sampleCount;
+    if (data.timestamp > _timestamp) _timestamp = data.timestamp;
+
+    bool positioned = latitude != 0 || longitude != 0;
+    if (positioned && !_refValid) useReference(latitude, longitude);
+
+    // Local tangent plane (equirectangular): fine over a farm or county
+    double x = 0, y = 0;
+    if (positioned) {
+        x = (double)(longitude - _refLongitude) * _kmPerDegLon;
+        y = (double)(latitude - _refLatitude) * KM_PER_DEG;
+    }
+
+    // Extremes come from the window min / max, gradients from the means
+#define SPATIAL_ADD_STATS(state, p) \
+    addValue(state, stationId, (float)data.p##Avg, (float)data.p##Min, (float)data.p##Max, \
+             positioned, x, y);
+#define SPATIAL_ADD_CIRCULAR(state, p) addDirection(state, (uint16_t)data.p##Avg);
+#define SPATIAL_ADD_LATEST(state, p) \
+    addValue(state, stationId, (float)data.p, (float)data.p, (float)data.p, positioned, x, y);
+#define SPATIAL_ADD_FIELD(id, member, prefix, type, kind, ...) \
+    if (data.sampleCount > data.qcRejected[(uint8_t)DataField::id]) { \
+        SPATIAL_ADD_##kind(_fields[(uint8_t)DataField::id], prefix) \
+    }
+    WEATHER_FIELDS(SPATIAL_ADD_FIELD)
+#undef SPATIAL_ADD_FIELD
+#undef SPATIAL_ADD_STATS
+#undef SPATIAL_ADD_CIRCULAR
+#undef SPATIAL_ADD_LATEST
+}
+
+bool SpatialAggregator::merge(const SpatialAggregator& other) {
+    if ((uint32_t)_stations + other._stations > UINT16_MAX) return false;
+    if (_refValid && other._refValid &&
+        (_refLatitude != other._refLatitude || _refLongitude != other._refLongitude)) {
+        return false;
+    }
+    if (!_refValid && other._refValid) {
+        useReference(other._refLatitude, other._refLongitude);
+    }
+
+    for (uint8_t f = 0; f < WEATHER_FIELD_COUNT; f++) {
+        FieldState& state = _fields[f];
+        const FieldState& more = other._fields[f];
+        state.count += more.count;
+        state.sum += more.sum;
+        state.sumSq += more.sumSq;
+        if (more.min < state.min) {
+            state.min = more.min;
+            copyStationId(state.minStation, more.minStation);
+        }
+        if (more.max > state.max) {
+            state.max = more.max;
+            copyStationId(state.maxStation, more.maxStation);
+        }
+        state.planeCount += more.planeCount;
+        state.sx += more.sx;
+        state.sy += more.sy;
+        state.sxx += more.sxx;
+        state.sxy += more.sxy;
+        state.syy += more.syy;
+        state.sv += more.sv;
+        state.sxv += more.sxv;
+        state.syv += more.syv;
+    }
+
+    _stations += other._stations;
+    _samples += other._samples;
+    if (other._timestamp > _timestamp) _timestamp = other._timestamp;
+    return true;
+}
+
+// ============================================
+// Summary
+// ============================================
+
+// CIRCULAR fields have a vector mean only
+#define SPATIAL_KIND(id, member, prefix, type, kind, ...) SPATIAL_IS_##kind,
+#define SPATIAL_IS_STATS false
+#define SPATIAL_IS_CIRCULAR true
+#define SPATIAL_IS_LATEST false
+static const bool FIELD_IS_CIRCULAR[WEATHER_FIELD_COUNT] = { WEATHER_FIELDS(SPATIAL_KIND) };
+
+bool SpatialAggregator::getField(DataField field, SpatialField& summary) const {
+    const FieldState& state = _fields[(uint8_t)field];
+    summary = SpatialField();
+    if (state.count == 0) return false;
+
+    summary.stations = state.count;
+
+    if (FIELD_IS_CIRCULAR[(uint8_t)field]) {
+        summary.mean = fastAtan2Deg((float)state.sum, (float)state.sumSq);
+        return true;
+    }
+
+    double n = state.count;
+    double mean = state.sum / n;
+    summary.mean = (float)mean;
+    if (state.count > 1) {
+        double variance = (state.sumSq - n * mean * mean) / (n - 1);
+        summary.spread = variance > 0 ? (float)sqrt(variance) : 0;
+    }
+    summary.min = state.min;
+    summary.max = state.max;
+    copyStationId(summary.minStation, state.minStation);
+    copyStationId(summary.maxStation, state.maxStation);
+    summary.hasExtremes = true;
+
+    if (state.planeCount < SPATIAL_MIN_GRADIENT_STATIONS) return true;
+
+    // Normal equations of the plane fit, centered on the station centroid
+    double m = state.planeCount;
+    double mx = state.sx / m, my = state.sy / m, mv = state.sv / m;
+    double cxx = state.sxx - m * mx * mx;
+    double cyy = state.syy - m * my * my;
+    double cxy = state.sxy - m * mx * my;
+    double cxv = state.sxv - m * mx * mv;
+    double cyv = state.syv - m * my * mv;
+
+    // Stations (nearly) on one line fix the gradient along it only
+    double det = cxx * cyy - cxy * cxy;
+    double trace = cxx + cyy;
+    if (trace <= 0 || det <= SPATIAL_COLLINEAR_RATIO * trace * trace) return true;
+
+    double east = (cyy * cxv - cxy * cyv) / det;
+    double north = (cxx * cyv - cxy * cxv) / det;
+    summary.gradient = (float)sqrt(east * east + north * north);
+    float direction = (float)(atan2(east, north) * 180.0 / M_PI);
+    summary.gradientDir = direction < 0 ? direction + 360.0f : direction;
+    summary.hasGradient = true;
+    return true;
+}
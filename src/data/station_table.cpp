@@ -0,0 +1,203 @@
+/**
+ * COW-Bois Weather Station - Microstation Table Implementation
+ */
+
+#include "data/station_table.h"
+
+StationTable::StationTable()
+    : _count(0)
+    , _pendingHead(0)
+    , _pendingCount(0)
+    , _dropped(0)
+    , _lookups(0)
+    , _probes(0) {
+    _lock = portMUX_INITIALIZER_UNLOCKED;
+    clear();
+}
+
+void StationTable::clear() {
+    portENTER_CRITICAL(&_lock);
+    _pendingHead = 0;
+    _pendingCount = 0;
+    portEXIT_CRITICAL(&_lock);
+
+    for (size_t i = 0; i < STATION_TABLE_SIZE; i++) {
+        _entries[i].key = 0;
+    }
+    _count = 0;
+}
+
+uint64_t StationTable::macToKey(const uint8_t* mac) {
+    uint64_t key = 0;
+    for (int i = 0; i < 6; i++) {
+        key = (key << 8) | mac[i];
+    }
+    // Keep 0 free as the empty marker (MAC 00:00:00:00:00:00 is not valid)
+    return key ? key : 1;
+}
+
+void StationTable::keyToMac(uint64_t key, uint8_t* mac) {
+    for (int i = 5; i >= 0; i--) {
+        mac[i] = key & 0xFF;
+        key >>= 8;
+    }
+}
+
+size_t StationTable::home(uint64_t key) {
+    // Fibonacci hashing: the top bits of key * 2^64/phi are well mixed,
+    // so MACs from one vendor (same OUI) spread across the table
+    uint64_t hash = key * 0x9E3779B97F4A7C15ULL;
+    return (size_t)(hash >> 32) & (STATION_TABLE_SIZE - 1);
+}
+
+int StationTable::find(uint64_t key, bool insert) {
+    size_t slot = home(key);
+    _lookups++;
+
+    for (size_t i = 0; i < STATION_TABLE_SIZE; i++) {
+        _probes++;
+        Entry& entry = _entries[slot];
+        if (entry.key == key) return (int)slot;
+        if (entry.key == 0) {
+            if (!insert || _count >= STATION_TABLE_MAX_STATIONS) return -1;
+            entry.key = key;
+            entry.stationId[0] = '\0';
+            entry.latitude = 0;
+            entry.longitude = 0;
+            entry.emptyFlushes = 0;
+            entry.aggregator.reset();
+            _count++;
+            return (int)slot;
+        }
+        slot = (slot + 1) & (STATION_TABLE_SIZE - 1);
+    }
+    return -1;
+}
+
+void StationTable::remove(size_t slot) {
+    // Backward-shift deletion: pull later entries of the same probe run
+    // into the hole so lookups never need tombstones
+    size_t hole = slot;
+    size_t next = (hole + 1) & (STATION_TABLE_SIZE - 1);
+
+    while (_entries[next].key != 0) {
+        size_t ideal = home(_entries[next].key);
+        // Move if the hole lies cyclically within [ideal, next)
+        if (((next - ideal) & (STATION_TABLE_SIZE - 1)) >=
+            ((next - hole) & (STATION_TABLE_SIZE - 1))) {
+            _entries[hole] = _entries[next];
+            hole = next;
+        }
+        next = (next + 1) & (STATION_TABLE_SIZE - 1);
+    }
+
+    _entries[hole].key = 0;
+    _count--;
+}
+
+bool StationTable::addReading(const uint8_t* mac, const char* stationId,
+                              const WeatherReading& reading, float latitude, float longitude,
+                              uint32_t fieldMask) {
+    uint64_t key = macToKey(mac);
+
+    // WiFi task: copy and return, aggregation waits for drain()
+    portENTER_CRITICAL(&_lock);
+    bool queued = _pendingCount < STATION_QUEUE_SIZE;
+    if (queued) {
+        Pending& pending = _pending[(_pendingHead + _pendingCount) % STATION_QUEUE_SIZE];
+        pending.key = key;
+        strncpy(pending.stationId, stationId, sizeof(pending.stationId) - 1);
+        pending.stationId[sizeof(pending.stationId) - 1] = '\0';
+        pending.latitude = latitude;
+        pending.longitude = longitude;
+        pending.fieldMask = fieldMask;
+        pending.reading = reading;
+        _pendingCount++;
+    } else {
+        _dropped++;
+    }
+    portEXIT_CRITICAL(&_lock);
+
+    return queued;
+}
+
+size_t StationTable::drain() {
+    size_t aggregated = 0;
+    Pending pending;
+
+    while (true) {
+        portENTER_CRITICAL(&_lock);
+        bool available = _pendingCount > 0;
+        if (available) {
+            pending = _pending[_pendingHead];
+            _pendingHead = (_pendingHead + 1) % STATION_QUEUE_SIZE;
+            _pendingCount--;
+        }
+        portEXIT_CRITICAL(&_lock);
+        if (!available) break;
+
+        int slot = find(pending.key, true);
+        if (slot < 0) {
+            portENTER_CRITICAL(&_lock);
+            _dropped++;
+            portEXIT_CRITICAL(&_lock);
+            continue;
+        }
+
+        // Fields an older packet version lacks are reported as missing
+        QCResult qc;
+        if (pending.fieldMask != QC_ALL_FIELDS) {
+            for (uint8_t f = 0; f < WEATHER_FIELD_COUNT; f++) {
+                if (!(pending.fieldMask & (1UL << f))) qc.flags[f] = QC_MISSING;
+            }
+            qc.validMask = pending.fieldMask;
+        }
+
+        Entry& entry = _entries[slot];
+        memcpy(entry.stationId, pending.stationId, sizeof(entry.stationId));
+        entry.latitude = pending.latitude;
+        entry.longitude = pending.longitude;
+        entry.aggregator.addSample(pending.reading, qc);
+        aggregated++;
+    }
+
+    return aggregated;
+}
+
+size_t StationTable::flush(StationFlushCallback callback) {
+    drain();
+    size_t reported = 0;
+
+    for (size_t slot = 0; slot < STATION_TABLE_SIZE; slot++) {
+        Entry& entry = _entries[slot];
+        if (entry.key == 0) continue;
+
+        if (entry.aggregator.getSampleCount() > 0) {
+            AggregatedData data = entry.aggregator.getAndReset();
+            uint8_t mac[6];
+            keyToMac(entry.key, mac);
+            entry.emptyFlushes = 0;
+            if (callback) callback(mac, entry.stationId, data, entry.latitude, entry.longitude);
+            reported++;
+        } else if (entry.emptyFlushes < STATION_STALE_FLUSHES) {
+            entry.emptyFlushes++;
+        }
+    }
+
+    // Drop stale stations in a separate pass: backward shifts can move an
+    // entry across the end of the table into a slot not yet visited
+    size_t slot = 0;
+    while (slot < STATION_TABLE_SIZE) {
+        if (_entries[slot].key != 0 && _entries[slot].emptyFlushes >= STATION_STALE_FLUSHES) {
+            remove(slot);  // A shifted entry may now occupy this slot
+        } else {
+            slot++;
+        }
+    }
+
+    return reported;
+}
+
+float StationTable::getAverageProbes() const {
+    return _lookups ? (float)_probes / _lookups : 0;
+}
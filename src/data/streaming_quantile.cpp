@@ -0,0 +1,111 @@
+/**
+ * COW-Bois Weather Station - Streaming Quantile Estimator Implementation
+ *
+ * P-square algorithm: R. Jain and I. Chlamtac, "The P2 algorithm for dynamic
+ * calculation of quantiles and histograms without storing observations",
+ * CACM 28(10), 1985.
+ */
+
+#include "data/streaming_quantile.h"
+
+P2Quantile::P2Quantile(float quantile)
+    : _p(quantile) {
+    reset();
+}
+
+void P2Quantile::reset() {
+    _count = 0;
+    for (int i = 0; i < 5; i++) {
+        _heights[i] = 0;
+        _positions[i] = i + 1;
+    }
+    _desired[0] = 1.0f;
+    _desired[1] = 1.0f + 2.0f * _p;
+    _desired[2] = 1.0f + 4.0f * _p;
+    _desired[3] = 3.0f + 2.0f * _p;
+    _desired[4] = 5.0f;
+}
+
+void P2Quantile::add(float x) {
+    // Fill the first five markers with sorted observations
+    if (_count < 5) {
+        int i = _count;
+        while (i > 0 && _heights[i - 1] > x) {
+            _heights[i] = _heights[i - 1];
+            i--;
+        }
+        _heights[i] = x;
+        _count++;
+        return;
+    }
+
+    _count++;
+
+    // Find the cell containing x, extending the extremes if needed
+    int k;
+    if (x < _heights[0]) {
+        _heights[0] = x;
+        k = 0;
+    } else if (x >= _heights[4]) {
+        _heights[4] = x;
+        k = 3;
+    } else {
+        k = 0;
+        while (x >= _heights[k + 1]) k++;
+    }
+
+    // Shift the positions of the markers above the cell
+    for (int i = k + 1; i < 5; i++) {
+        _positions[i]++;
+    }
+
+    // Advance the desired positions
+    _desired[1] += _p * 0.5f;
+    _desired[2] += _p;
+    _desired[3] += (1.0f + _p) * 0.5f;
+    _desired[4] += 1.0f;
+
+    // Move the three middle markers towards their desired positions
+    for (int i = 1; i <= 3; i++) {
+        float offset = _desired[i] - _positions[i];
+        if ((offset >= 1.0f && _positions[i + 1] - _positions[i] > 1) ||
+            (offset <= -1.0f && _positions[i - 1] - _positions[i] < -1)) {
+            int d = offset > 0 ? 1 : -1;
+            float candidate = parabolic(i, d);
+            if (_heights[i - 1] < candidate && candidate < _heights[i + 1]) {
+                _heights[i] = candidate;
+            } else {
+                _heights[i] = linear(i, d);
+            }
+            _positions[i] += d;
+        }
+    }
+}
+
+float P2Quantile::parabolic(int i, int d) const {
+    float n0 = _positions[i - 1];
+    float n1 = _positions[i];
+    float n2 = _positions[i + 1];
+
+    return _heights[i] + d / (n2 - n0) *
+        ((n1 - n0 + d) * (_heights[i + 1] - _heights[i]) / (n2 - n1) +
+         (n2 - n1 - d) * (_heights[i] - _heights[i - 1]) / (n1 - n0));
+}
+
+float P2Quantile::linear(int i, int d) const {
+    return _heights[i] + d * (_heights[i + d] - _heights[i]) /
+        (float)(_positions[i + d] - _positions[i]);
+}
+
+float P2Quantile::getValue() const {
+    if (_count == 0) return 0;
+
+    if (_count <= 5) {
+        // Exact quantile of the sorted startup samples (nearest rank); the
+        // markers only move apart from the sixth sample on
+        int idx = (int)(_p * (_count - 1) + 0.5f);
+        return _heights[idx];
+    }
+
+    return _heights[2];
+}
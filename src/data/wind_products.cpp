@@ -0,0 +1,177 @@
+/**
+ * COW-Bois Weather Station - Wind Products Implementation
+ *
+ * Follows WMO-No. 8 (CIMO Guide), Vol. I Ch. 5: the gust is the highest
+ * 3-second running mean, and the 2- and 10-minute means are built from
+ * equally weighted samples over the period.
+ */
+
+#include "data/wind_products.h"
+#include "data/weather_fields.h"
+#include "util/fast_math.h"
+#include <math.h>
+
+// Fraction of expected samples required for a valid mean
+#define WIND_MEAN_MIN_COVERAGE 0.75f
+
+WindProducts::WindProducts() {
+    reset();
+}
+
+void WindProducts::reset() {
+    _gustSum = 0;
+    _gustSinSum = 0;
+    _gustCosSum = 0;
+    _gustHead = 0;
+    _gustCount = 0;
+    _lastTimestamp = 0;
+
+    for (size_t i = 0; i < BLOCKS; i++) {
+        clearBlock(_blocks[i]);
+    }
+    _blockHead = 0;
+    _blockCount = 0;
+    clearBlock(_current);
+    _currentIndex = 0;
+    _started = false;
+}
+
+void WindProducts::clearBlock(Block& block) {
+    block.speedSum = 0;
+    block.uSum = 0;
+    block.vSum = 0;
+    block.count = 0;
+    block.gust = -1.0f;           // No complete 3-s window yet
+    block.gustDirection = 0;
+}
+
+void WindProducts::closeBlock() {
+    if (_blockCount < BLOCKS) {
+        _blocks[(_blockHead + _blockCount) % BLOCKS] = _current;
+        _blockCount++;
+    } else {
+        _blocks[_blockHead] = _current;
+        _blockHead = (_blockHead + 1) % BLOCKS;
+    }
+    clearBlock(_current);
+}
+
+void WindProducts::addSample(float speed, uint16_t direction, uint32_t timestamp) {
+    uint32_t index = timestamp / WIND_BLOCK_MS;
+
+    // millis() wrapped or time went backwards: start over
+    if (_started && index < _currentIndex) {
+        reset();
+    }
+
+    if (!_started) {
+        _currentIndex = index;
+        _started = true;
+    }
+
+    // Close finished blocks; missing blocks are recorded empty so the
+    // means know the period is not covered
+    if (index - _currentIndex > BLOCKS) {
+        _blockHead = 0;
+        _blockCount = 0;
+        clearBlock(_current);
+        _currentIndex = index;
+    }
+    while (_currentIndex < index) {
+        closeBlock();
+        _currentIndex++;
+    }
+
+    // A gap longer than the gust window breaks the running mean
+    if (_gustCount > 0 && timestamp - _lastTimestamp > WIND_GUST_WINDOW_MS) {
+        _gustSum = 0;
+        _gustSinSum = 0;
+        _gustCosSum = 0;
+        _gustHead = 0;
+        _gustCount = 0;
+    }
+    _lastTimestamp = timestamp;
+
+    int16_t s, c;
+    fastSinCosDeg(direction, s, c);
+
+    // 3-s running mean: replace the oldest sample once the ring is full
+    size_t slot = (_gustHead + _gustCount) % GUST_SAMPLES;
+    if (_gustCount == GUST_SAMPLES) {
+        slot = _gustHead;
+        _gustSum -= _gustSpeed[slot];
+        _gustSinSum -= _gustSin[slot];
+        _gustCosSum -= _gustCos[slot];
+        _gustHead = (_gustHead + 1) % GUST_SAMPLES;
+    } else {
+        _gustCount++;
+    }
+    _gustSpeed[slot] = speed;
+    _gustSin[slot] = s;
+    _gustCos[slot] = c;
+    _gustSum += speed;
+    _gustSinSum += s;
+    _gustCosSum += c;
+
+    // Block sub-averages
+    _current.speedSum += speed;
+    _current.uSum += speed * (float)s / FAST_TRIG_ONE;
+    _current.vSum += speed * (float)c / FAST_TRIG_ONE;
+    _current.count++;
+
+    if (_gustCount == GUST_SAMPLES) {
+        float gust = _gustSum / (float)GUST_SAMPLES;
+        if (gust > _current.gust) {
+            _current.gust = gust;
+            _current.gustDirection = fieldCast<uint16_t>(
+                fastAtan2Deg((float)_gustSinSum, (float)_gustCosSum)) % 360;
+        }
+    }
+}
+
+WindMean WindProducts::mean(size_t blocks) const {
+    WindMean result;
+    if (_blockCount < blocks) return result;
+
+    float speedSum = 0, uSum = 0, vSum = 0;
+    uint32_t count = 0;
+    for (size_t i = _blockCount - blocks; i < _blockCount; i++) {
+        const Block& b = _blocks[(_blockHead + i) % BLOCKS];
+        speedSum += b.speedSum;
+        uSum += b.uSum;
+        vSum += b.vSum;
+        count += b.count;
+    }
+
+    const uint32_t expected = blocks * (WIND_BLOCK_MS / WIND_SAMPLE_INTERVAL_MS);
+    if (count == 0 || count < (uint32_t)(expected * WIND_MEAN_MIN_COVERAGE)) return result;
+
+    result.scalarSpeed = speedSum / count;
+    float u = uSum / count;
+    float v = vSum / count;
+    result.vectorSpeed = sqrtf(u * u + v * v);
+    result.direction = fieldCast<uint16_t>(fastAtan2Deg(u, v)) % 360;
+    result.valid = true;
+    return result;
+}
+
+WindProductsData WindProducts::getProducts() const {
+    WindProductsData data;
+
+    float best = -1.0f;
+    for (size_t i = 0; i < _blockCount; i++) {
+        const Block& b = _blocks[(_blockHead + i) % BLOCKS];
+        if (b.gust > best) {
+            best = b.gust;
+            data.gustDirection = b.gustDirection;
+        }
+    }
+    if (best >= 0) {
+        data.gust = best;
+        data.gustValid = true;
+    }
+
+    data.mean2min = mean(SHORT_BLOCKS);
+    data.mean10min = mean(BLOCKS);
+    return data;
+}
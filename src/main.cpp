@@ -31,7 +31,22 @@
 
 // Data processing modules
 #include "data/data_aggregator.h"
+#include "data/double_buffered_aggregator.h"
+#include "data/fixed_point_aggregator.h"
+#include "data/quality_control.h"
 #include "data/data_formatter.h"
+#include "data/rollup_engine.h"
+#include "data/station_table.h"
+#include "data/sliding_window.h"
+#include "data/wind_products.h"
+#include "data/derived_variables.h"
+#include "data/report_compressor.h"
+#include "data/event_detector.h"
+#include "data/agro_products.h"
+#include "data/spatial_aggregator.h"
+#include "data/batch_codec.h"
+#include "data/influx_batch.h"
+#include "util/wall_clock.h"
 
 // System modules
 #include "system/power_manager.h"
@@ -42,7 +57,50 @@
 // ============================================
 
 SensorManager sensors;
+QualityControl qualityControl;
+#if AGGREGATION_DOUBLE_BUFFER
+#if AGGREGATION_SAMPLE_BUFFER
+#error "AGGREGATION_DOUBLE_BUFFER does not support AGGREGATION_SAMPLE_BUFFER"
+#endif
+DoubleBufferedAggregator aggregator;  // Window handoff safe across tasks
+#elif AGGREGATION_FIXED_POINT
+#if AGGREGATION_SAMPLE_BUFFER
+#error "AGGREGATION_FIXED_POINT does not support AGGREGATION_SAMPLE_BUFFER"
+#endif
+FixedPointAggregator aggregator;      // Scaled-integer accumulators
+#else
 DataAggregator aggregator;
+#endif
+RollupEngine rollups;
+StationTable microstations;           // Main station: per-microstation windows
+#if AGGREGATION_ROLLING
+SlidingWindow rolling;                // Rolling 10-minute statistics
+#endif
+#if AGGREGATION_SAMPLE_BUFFER
+SampleBuffer sampleBuffer;            // Raw samples of the current window
+#endif
+WindProducts windProducts;            // Main station: gusts and 2/10-min means
+DerivedVariables derived;             // Dew point, heat index, ... from window averages
+#if REPORT_COMPRESSION
+ReportCompressor reportCompressor;    // Main station: dead-band field selection
+#endif
+EventDetector events;                 // Priority lane: gusts, rain onset, pressure jumps
+#if AGRO_PRODUCTS
+AgroProducts agro;                    // Main station: daily ET0 and growing degree days
+#endif
+#if SPATIAL_AGGREGATION
+SpatialAggregator spatial;            // Main station: site summary across all stations
+#endif
+#if INFLUX_BATCH
+char influxBuffer[INFLUX_BATCH_BYTES];
+InfluxBatch influx(influxBuffer, sizeof(influxBuffer));  // Main station: line-protocol POST body
+bool influxStalled = false;  // Last POST failed; retried next interval
+#endif
+#if MQTT_BACKLOG_BATCH
+uint8_t backlogBuffer[MQTT_BACKLOG_BYTES];
+BatchEncoder backlog(backlogBuffer, sizeof(backlogBuffer));  // Main station: unsent windows
+#endif
+WallClock wallClock;                  // UTC from the cellular network
 PowerManager power;
 StationModeManager stationMode;
 MQTTHandler mqtt;
@@ -54,8 +112,10 @@ CellularModem modem;
 // ============================================
 
 unsigned long lastSampleTime = 0;
+unsigned long lastWindSampleTime = 0;
 unsigned long lastTransmitTime = 0;
 unsigned long lastStatusTime = 0;
+unsigned long lastTimeSync = 0;
 
 // Main station peer address (set this to your main station's MAC)
 uint8_t mainStationMAC[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
@@ -68,34 +128,219 @@ void onESPNowReceive(const uint8_t* mac, const uint8_t* data, int len) {
     DEBUG_PRINTF("Received ESP-NOW data from %02X:%02X:%02X:%02X:%02X:%02X\n",
                  mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
 
+    // Microstation events skip the report schedule
+    if (len > 0 && data[0] == ESPNOW_PACKET_EVENT) {
+        WeatherEvent event;
+        if (stationMode.isMainStation() && espNow.parseEventPacket(data, len, event)) {
+            if (!events.enqueue(event, millis())) {
+                DEBUG_PRINTLN("  Event dropped (rate limit)");
+            }
+        }
+        return;
+    }
+
     // Parse incoming weather packet
     ESPNowPacket packet;
     if (espNow.parseWeatherPacket(data, len, packet)) {
         DEBUG_PRINTF("  Station: %s, Temp: %.2f°C\n",
                      packet.stationId, packet.temperature / 100.0f);
 
-        // If we're the main station, forward this data via MQTT
-        if (stationMode.isMainStation() && mqtt.isConnected()) {
-            char payload[512];
-            snprintf(payload, sizeof(payload),
-                "{\"station_id\":\"%s\",\"temperature\":%.2f,\"humidity\":%.2f,"
-                "\"pressure\":%.2f,\"gas_resistance\":%.2f,\"wind_speed\":%.2f,\"wind_direction\":%u}",
-                packet.stationId,
-                packet.temperature / 100.0f,
-                packet.humidity / 100.0f,
-                packet.pressure / 10.0f,
-                packet.gasResistance / 10.0f,
-                packet.windSpeed / 100.0f,
-                packet.windDirection);
-
-            char topic[64];
-            snprintf(topic, sizeof(topic), "%s/%s/weather",
-                     MQTT_TOPIC_PREFIX, packet.stationId);
-            mqtt.publish(topic, payload);
+        // Main station aggregates per microstation and publishes on its own schedule
+        if (stationMode.isMainStation()) {
+            WeatherReading reading;
+            uint32_t fieldMask = ESPNowHandler::unpackWeatherPacket(packet, reading);
+
+            float latitude, longitude;
+            ESPNowHandler::unpackPosition(packet, latitude, longitude);
+
+            if (!microstations.addReading(mac, packet.stationId, reading, latitude, longitude,
+                                          fieldMask)) {
+                DEBUG_PRINTLN("  Station queue full - reading dropped");
+            }
         }
     }
 }
 
+// ============================================
+// Helper Functions
+// ============================================
+
+void sendEvents() {
+    WeatherEvent event;
+    // Peek, send, then pop: while the link is down events wait in the
+    // queue, and once it fills further events are counted as dropped
+    while (events.peek(event)) {
+        const EventRule* rule = events.getRule(event.rule);
+        if (rule) {
+            bool sent = false;
+            if (stationMode.isMicrostation()) {
+                sent = espNow.sendEvent(mainStationMAC, event);
+            } else if (mqtt.isConnected()) {
+                // Forwarded events keep the microstation's ID
+                const char* stationId = event.stationId[0] ? event.stationId
+                                                           : stationMode.getStationId();
+                char payload[256];
+                DataFormatter::toEventPayload(stationId, event, *rule, payload, sizeof(payload));
+                sent = mqtt.publishEvent(stationId, payload);
+            }
+            if (!sent) return;   // Retried on the next loop
+            DEBUG_PRINTF("Event: %s (%.2f)\n", rule->name, event.value);
+        }
+        events.pop(event);
+    }
+}
+
+// Window report as JSON on topic, or as CBOR on topic + MQTT_CBOR_SUFFIX,
+// written straight into the MQTT client
+bool publishReport(const char* topic, bool cbor, const char* stationId,
+                   const AggregatedData& data, const WindProductsData* wind = nullptr,
+                   const DerivedData* derived = nullptr,
+                   const ReportSelection* selection = nullptr) {
+    if (cbor) {
+        char binaryTopic[72];
+        snprintf(binaryTopic, sizeof(binaryTopic), "%s" MQTT_CBOR_SUFFIX, topic);
+        return mqtt.publishStreamed(binaryTopic, [&](OutputSink& out) {
+            DataFormatter::toCBORPayload(stationId, data, out, wind, derived, selection);
+        });
+    }
+
+    return mqtt.publishStreamed(topic, [&](OutputSink& out) {
+        DataFormatter::toMQTTPayload(stationId, data, out, wind, derived, selection);
+    });
+}
+
+#if MQTT_BACKLOG_BATCH
+// Send the windows missed while offline as one batch; kept for the next try on failure
+void publishBacklog() {
+    if (backlog.getRecordCount() == 0) return;
+
+    char topic[64];
+    snprintf(topic, sizeof(topic), "%s/%s/weather/batch",
+             MQTT_TOPIC_PREFIX, stationMode.getStationId());
+
+    if (mqtt.publish(topic, backlog.data(), backlog.length())) {
+        DEBUG_PRINTF("Backlog of %u windows sent (%u bytes)\n",
+                     backlog.getRecordCount(), (unsigned)backlog.length());
+        backlog.begin(stationMode.getStationId());
+    }
+}
+#endif
+
+void publishRollup(uint8_t closedTiers, RollupTier tier) {
+    AggregatedData summary;
+    if (!RollupEngine::closed(closedTiers, tier) || !rollups.getLatest(tier, summary)) {
+        return;
+    }
+
+    char topic[64];
+    snprintf(topic, sizeof(topic), "%s/%s/weather/%s",
+             MQTT_TOPIC_PREFIX, stationMode.getStationId(), RollupEngine::tierName(tier));
+
+    publishReport(topic, MQTT_CBOR_ROLLUPS, stationMode.getStationId(), summary);
+}
+
+void syncClock() {
+    lastTimeSync = millis();
+    uint32_t unixTime;
+    if (modem.getNetworkTime(unixTime)) {
+        wallClock.sync(unixTime, lastTimeSync);
+    }
+}
+
+#if AGRO_PRODUCTS
+void updateAgro(uint8_t closedTiers) {
+    AggregatedData hour;
+    if (!RollupEngine::closed(closedTiers, RollupTier::HOURLY) ||
+        !rollups.getLatest(RollupTier::HOURLY, hour)) {
+        return;
+    }
+
+    // Accumulate even while MQTT is down; only the closed day is sent
+    AgroDaily daily;
+    if (!agro.addHour(hour, wallClock.unixTime(millis())) || !agro.getDaily(daily)) {
+        return;
+    }
+    DEBUG_PRINTF("Agro: ET0 %.2f mm, GDD %.1f (%u h)\n", daily.et0, daily.gdd, daily.hours);
+    if (!mqtt.isConnected()) return;
+
+    char topic[64];
+    snprintf(topic, sizeof(topic), "%s/%s/agro", MQTT_TOPIC_PREFIX, stationMode.getStationId());
+    mqtt.publishStreamed(topic, [&](OutputSink& out) {
+        DataFormatter::toAgroPayload(stationMode.getStationId(), daily, out);
+    });
+}
+#endif
+
+#if INFLUX_BATCH
+// POST the batch and start the next one. A failed POST keeps the batch,
+// like the MQTT backlog; later windows are added to it and it is retried
+// each interval. Until that retry, a full batch drops new windows rather
+// than blocking on another POST per window.
+bool postInflux() {
+    influxStalled = false;
+    if (influx.getRecordCount() == 0) return true;
+    if (!modem.isConnected()) {
+        influxStalled = true;
+        return false;
+    }
+
+    #ifdef INFLUX_WRITE_URL
+    if (!modem.sendHTTPPost(INFLUX_WRITE_URL, influx.data(), nullptr, 0,
+                            "text/plain; charset=utf-8")) {
+        DEBUG_PRINTF("InfluxDB: POST failed, %u windows kept\n", influx.getRecordCount());
+        influxStalled = true;
+        return false;
+    }
+    DEBUG_PRINTF("InfluxDB: %u windows posted (%u bytes)\n",
+                 influx.getRecordCount(), (unsigned)influx.length());
+    #else
+    DEBUG_PRINTLN("InfluxDB: INFLUX_WRITE_URL not configured. Check secrets.h");
+    #endif
+    influx.begin(INFLUX_MEASUREMENT, stationMode.getStationId());
+    return true;
+}
+
+void addInflux(const char* stationId, const AggregatedData& data) {
+    uint64_t epochMs = wallClock.unixMillis(data.timestamp);
+    if (influx.add(stationId, data, epochMs)) return;
+
+    // Batch full: send it and start the next with this window
+    if (influxStalled || !postInflux()) {
+        DEBUG_PRINTLN("InfluxDB: batch full, window dropped");
+    } else if (!influx.add(stationId, data, epochMs)) {
+        DEBUG_PRINTLN("InfluxDB: window larger than INFLUX_BATCH_BYTES");
+    }
+}
+#endif
+
+void publishMicrostation(const uint8_t* mac, const char* stationId,
+                         const AggregatedData& data, float latitude, float longitude) {
+    #if SPATIAL_AGGREGATION
+    spatial.addStation(stationId, data, latitude, longitude);
+    #endif
+    #if INFLUX_BATCH
+    addInflux(stationId, data);
+    #endif
+    if (!mqtt.isConnected()) return;
+
+    char topic[64];
+    snprintf(topic, sizeof(topic), "%s/%s/weather", MQTT_TOPIC_PREFIX, stationId);
+
+    publishReport(topic, MQTT_CBOR_MICROSTATIONS, stationId, data);
+}
+
+#if SPATIAL_AGGREGATION
+void publishSite() {
+    if (spatial.getStationCount() < SPATIAL_MIN_STATIONS || !mqtt.isConnected()) return;
+
+    char topic[64];
+    snprintf(topic, sizeof(topic), "%s/%s/site", MQTT_TOPIC_PREFIX, stationMode.getStationId());
+    mqtt.publishStreamed(topic, [](OutputSink& out) {
+        DataFormatter::toSpatialPayload(stationMode.getStationId(), spatial, out);
+    });
+}
+#endif
+
 // ============================================
 // Setup
 // ============================================
@@ -111,7 +356,27 @@ void setup() {
 
     // Detect station mode
     StationMode mode = stationMode.begin(STATION_MODE_PIN);
+    #ifdef STATION_ELEVATION_M
+    stationMode.setLocation(STATION_LAT, STATION_LON, STATION_ELEVATION_M);
+    #endif
+    derived.setElevation(stationMode.getElevation());
+    #if AGRO_PRODUCTS
+    agro.setLocation(stationMode.getLatitude(), stationMode.getLongitude(),
+                     stationMode.getElevation());
+    #endif
+    espNow.setLocation(stationMode.getLatitude(), stationMode.getLongitude());
+    #if SPATIAL_AGGREGATION
+    if (stationMode.getLatitude() != 0 || stationMode.getLongitude() != 0) {
+        spatial.setReference(stationMode.getLatitude(), stationMode.getLongitude());
+    }
+    #endif
     stationMode.printConfig();
+    #if MQTT_BACKLOG_BATCH
+    backlog.begin(stationMode.getStationId());
+    #endif
+    #if INFLUX_BATCH
+    influx.begin(INFLUX_MEASUREMENT, stationMode.getStationId());
+    #endif
 
     // Initialize I2C
     Wire.begin(I2C_SDA, I2C_SCL);
@@ -137,6 +402,20 @@ void setup() {
     Serial.printf("  Wind: %s\n", status.windSensor_ok ? "OK" : "FAILED");
     Serial.printf("  Precipitation: %s\n", status.precipitation_ok ? "OK" : "FAILED");
 
+    #if AGGREGATION_SAMPLE_BUFFER
+    aggregator.attachBuffer(&sampleBuffer);
+    Serial.printf("Sample buffer: %u samples, %u bytes\n",
+                  (unsigned)SampleBuffer::CAPACITY, (unsigned)sizeof(SampleBuffer));
+    #endif
+
+    // Static RAM of the aggregation state
+    Serial.printf("Memory: aggregator %u, rollups %u, station table %u bytes\n",
+                  (unsigned)sizeof(aggregator), (unsigned)sizeof(rollups),
+                  (unsigned)sizeof(microstations));
+    #if AGGREGATION_ROLLING
+    Serial.printf("  rolling window: %u bytes\n", (unsigned)sizeof(rolling));
+    #endif
+
     // Run sensor self-test
     Serial.println("\nRunning sensor self-test...");
     sensors.selfTest();
@@ -174,6 +453,7 @@ void setup() {
             if (modem.connect(CELLULAR_APN, CELLULAR_USER, CELLULAR_PASS)) {
                 Serial.printf("Connected to cellular network. Signal: %d dBm\n",
                               modem.getSignalQuality());
+                syncClock();
             }
             #else
             Serial.println("WARNING: Cellular APN not configured. Check secrets.h");
@@ -202,15 +482,29 @@ void loop() {
         mqtt.loop();
     }
 
+    #if AGGREGATION_SAMPLE_BUFFER
+    // 'd' on the serial console dumps the raw samples of the current window
+    if (Serial.available() && Serial.read() == 'd') {
+        sampleBuffer.dump(Serial);
+    }
+    #endif
+
     // Take samples at configured interval
     if (currentTime - lastSampleTime >= stationMode.getRecommendedSampleInterval()) {
         lastSampleTime = currentTime;
 
         // Read all sensors
         WeatherReading reading;
-        if (sensors.readAll(reading)) {
-            // Add to aggregator
-            aggregator.addSample(reading);
+        uint32_t sensorMask;
+        if (sensors.readAll(reading, sensorMask)) {
+            // QC, then add to aggregator and rollup tiers (flagged fields excluded)
+            QCResult qc = qualityControl.check(reading, sensorMask);
+            events.check(reading, qc.validMask, currentTime);
+            aggregator.addSample(reading, qc);
+            rollups.addSample(reading, qc);
+            #if AGGREGATION_ROLLING
+            rolling.addSample(reading, qc);
+            #endif
 
             #if DEBUG_ENABLED
             DataFormatter::printReading(reading);
@@ -218,6 +512,45 @@ void loop() {
         }
     }
 
+    // Microstation readings queued by the ESP-NOW callback
+    if (stationMode.isMainStation()) {
+        microstations.drain();
+    }
+
+    // Events go out ahead of the report schedule
+    sendEvents();
+
+    // Fast wind sampling for WMO gusts and mean wind (main station only)
+    if (stationMode.isMainStation() &&
+        currentTime - lastWindSampleTime >= WIND_SAMPLE_INTERVAL_MS) {
+        lastWindSampleTime = currentTime;
+
+        float speed;
+        uint16_t direction;
+        if (sensors.getWindSensor().readAll(speed, direction, true)) {
+            windProducts.addSample(speed, direction, currentTime);
+        }
+    }
+
+    // Close rollup windows; main station publishes hourly and daily summaries
+    uint8_t closedTiers = rollups.update();
+    if (closedTiers && stationMode.isMainStation() && mqtt.isConnected()) {
+        publishRollup(closedTiers, RollupTier::HOURLY);
+        publishRollup(closedTiers, RollupTier::DAILY);
+    }
+    #if AGRO_PRODUCTS
+    if (closedTiers && stationMode.isMainStation()) {
+        updateAgro(closedTiers);
+    }
+    #endif
+
+    // Network time for day boundaries and solar position
+    if (stationMode.useCellular() && modem.isInitialized() &&
+        currentTime - lastTimeSync >= (wallClock.isSynced() ? TIME_SYNC_INTERVAL_MS
+                                                             : TIME_SYNC_RETRY_MS)) {
+        syncClock();
+    }
+
     // Transmit aggregated data at configured interval
     if (currentTime - lastTransmitTime >= stationMode.getRecommendedTransmitInterval()) {
         lastTransmitTime = currentTime;
@@ -233,20 +566,7 @@ void loop() {
             // Transmit based on station mode
             if (stationMode.isMicrostation()) {
                 // Send via ESP-NOW to main station
-                WeatherReading lastReading;
-                lastReading.timestamp = data.timestamp;
-                lastReading.temperature = data.tempAvg;
-                lastReading.humidity = data.humidityAvg;
-                lastReading.pressure = data.pressureAvg;
-                lastReading.gasResistance = data.gasResistanceAvg;
-                lastReading.windSpeed = data.windSpeedAvg;
-                lastReading.windDirection = data.windDirAvg;
-                lastReading.precipitation = data.precipitation;
-                lastReading.lux = data.luxAvg;
-                lastReading.solarIrradiance = data.solarAvg;
-                lastReading.co2 = data.co2Avg;
-                lastReading.tvoc = data.tvocAvg;
-                lastReading.isValid = true;
+                WeatherReading lastReading = DataAggregator::toReading(data);
 
                 if (espNow.sendWeatherData(mainStationMAC, lastReading)) {
                     DEBUG_PRINTLN("Data sent via ESP-NOW");
@@ -255,22 +575,68 @@ void loop() {
                 }
             } else if (stationMode.isMainStation()) {
                 // Send via MQTT (through cellular modem)
-                char payload[1024];
-                DataFormatter::toMQTTPayload(stationMode.getStationId(), data,
-                                             payload, sizeof(payload));
+                WindProductsData wind = windProducts.getProducts();
+                derived.update(data);
+                DerivedData derivedData = derived.getAll();
+                #if REPORT_COMPRESSION
+                ReportSelection selection = reportCompressor.select(data);
+                const ReportSelection* report = &selection;
+                #else
+                const ReportSelection* report = nullptr;
+                #endif
 
                 char topic[64];
                 snprintf(topic, sizeof(topic), "%s/%s/weather",
                          MQTT_TOPIC_PREFIX, stationMode.getStationId());
 
-                if (mqtt.isConnected()) {
-                    mqtt.publish(topic, payload);
+                bool sent = mqtt.isConnected() &&
+                            publishReport(topic, MQTT_CBOR_WEATHER, stationMode.getStationId(),
+                                          data, &wind, &derivedData, report);
+                if (sent) {
                     DEBUG_PRINTLN("Data sent via MQTT");
                 } else {
-                    DEBUG_PRINTLN("MQTT not connected, data not sent");
+                    DEBUG_PRINTLN("MQTT not connected or publish failed, data not sent");
                 }
+
+                #if MQTT_BACKLOG_BATCH
+                if (sent) {
+                    publishBacklog();
+                } else if (!backlog.add(data)) {
+                    DEBUG_PRINTLN("Backlog full, window dropped");
+                }
+                #endif
+
+                #if REPORT_COMPRESSION
+                // The backend missed this report; resynchronize with a keyframe
+                if (!sent) reportCompressor.reset();
+                #endif
             }
         }
+
+        // Publish microstation windows on the main station's schedule
+        if (stationMode.isMainStation()) {
+            #if SPATIAL_AGGREGATION
+            // The site summary covers the main station and every microstation
+            spatial.reset();
+            if (data.sampleCount > 0) {
+                spatial.addStation(stationMode.getStationId(), data,
+                                   stationMode.getLatitude(), stationMode.getLongitude());
+            }
+            #endif
+            #if INFLUX_BATCH
+            if (data.sampleCount > 0) addInflux(stationMode.getStationId(), data);
+            #endif
+            size_t stations = microstations.flush(publishMicrostation);
+            if (stations > 0) {
+                DEBUG_PRINTF("Published %u microstation windows\n", (unsigned)stations);
+            }
+            #if SPATIAL_AGGREGATION
+            publishSite();
+            #endif
+            #if INFLUX_BATCH
+            postInflux();
+            #endif
+        }
     }
 
     // Periodic status update
@@ -288,11 +654,40 @@ void loop() {
             Serial.println("WARNING: Battery low");
         }
 
+        StationHealth health;
+        health.batteryVoltage = power.readBatteryVoltage();
+        health.batteryPercent = power.readBatteryPercent();
+        health.uptimeSec = currentTime / 1000;
+        health.windSpikes = sensors.getWindSensor().getSpikeCount();
+        health.precipSpikes = sensors.getPrecipitation().getSpikeCount();
+        health.eventsDropped = events.getDroppedCount();
+
         // Print status
-        DEBUG_PRINTF("Status - Battery: %.2fV (%d%%), Samples: %u\n",
-                     power.readBatteryVoltage(),
-                     power.readBatteryPercent(),
-                     aggregator.getSampleCount());
+        DEBUG_PRINTF("Status - Battery: %.2fV (%d%%), Samples: %lu, Spikes: %lu wind, %lu precip\n",
+                     health.batteryVoltage,
+                     health.batteryPercent,
+                     (unsigned long)aggregator.getSampleCount(),
+                     (unsigned long)health.windSpikes,
+                     (unsigned long)health.precipSpikes);
+
+        // Main station publishes its health (retained)
+        if (stationMode.isMainStation() && mqtt.isConnected()) {
+            char payload[192];
+            DataFormatter::toStatusPayload(stationMode.getStationId(), health,
+                                           payload, sizeof(payload));
+            mqtt.publishStatus(stationMode.getStationId(), payload);
+        }
+
+        #if AGGREGATION_ROLLING
+        DEBUG_PRINTF("Rolling %lu min - Temp: %.2f C (%.2f..%.2f), Wind: %.2f m/s (max %.2f) @ %.0f deg\n",
+                     (unsigned long)(ROLLING_WINDOW_MS / 60000),
+                     rolling.getAverage(DataField::TEMPERATURE),
+                     rolling.getMin(DataField::TEMPERATURE),
+                     rolling.getMax(DataField::TEMPERATURE),
+                     rolling.getAverage(DataField::WIND_SPEED),
+                     rolling.getMax(DataField::WIND_SPEED),
+                     rolling.getAverage(DataField::WIND_DIRECTION));
+        #endif
     }
 
     // Small delay to prevent tight looping
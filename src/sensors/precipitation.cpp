@@ -11,7 +11,8 @@ PrecipitationSensor::PrecipitationSensor()
     , _calibrationFactor(PRECIP_CALIBRATION_FACTOR)
     , _tareOffset(0)
     , _collectorArea(PRECIP_COLLECTOR_AREA)
-    , _lastWeight(0) {
+    , _lastWeight(0)
+    , _spikeFilter(PRECIP_SPIKE_WINDOW, PRECIP_SPIKE_MIN_MM) {
 }
 
 bool PrecipitationSensor::begin(uint8_t dataPin, uint8_t clockPin) {
@@ -82,6 +83,11 @@ float PrecipitationSensor::readPrecipitation() {
     if (precipitation < 0) precipitation = 0;
     if (precipitation > 500) precipitation = 500;  // Max 500mm seems reasonable
 
+    #if SPIKE_FILTER
+    // Knocks on the gauge read as sudden rain and stay in the window total
+    precipitation = _spikeFilter.filter(precipitation);
+    #endif
+
     return precipitation;
 }
 
@@ -94,6 +100,7 @@ void PrecipitationSensor::tare() {
         _hx711.tare(10);
         _tareOffset = _hx711.get_offset();
         _lastWeight = 0;
+        _spikeFilter.reset();     // Emptied gauge: the drop is not a spike
         DEBUG_PRINTLN("Precipitation: Tare complete");
     } else {
         DEBUG_PRINTLN("Precipitation: HX711 not ready for tare");
@@ -5,7 +5,10 @@
 #include "sensors/sensor_manager.h"
 #include "config.h"
 
-SensorManager::SensorManager() : _initialized(false) {
+SensorManager::SensorManager()
+    : _initialized(false)
+    , _compensated(false)
+    , _lastCompensationTime(0) {
     _status = {false, false, false, false, false};
 }
 
@@ -62,6 +65,12 @@ bool SensorManager::begin() {
 }
 
 bool SensorManager::readAll(WeatherReading& reading) {
+    uint32_t validMask;
+    return readAll(reading, validMask);
+}
+
+bool SensorManager::readAll(WeatherReading& reading, uint32_t& validMask) {
+    validMask = 0;
     if (!_initialized) {
         reading.isValid = false;
         return false;
@@ -78,6 +87,9 @@ bool SensorManager::readAll(WeatherReading& reading) {
             reading.humidity = 0;
             reading.pressure = 0;
             reading.gasResistance = 0;
+        } else {
+            validMask |= FIELD_BIT(TEMPERATURE) | FIELD_BIT(HUMIDITY) |
+                         FIELD_BIT(PRESSURE) | FIELD_BIT(GAS_RESISTANCE);
         }
     }
 
@@ -85,20 +97,28 @@ bool SensorManager::readAll(WeatherReading& reading) {
     if (_status.tsl2591_ok) {
         reading.lux = _tsl2591.readLux();
         reading.solarIrradiance = _tsl2591.readIrradiance();
+        validMask |= FIELD_BIT(LUX) | FIELD_BIT(SOLAR_IRRADIANCE);
     }
 
     // Read SGP30
     if (_status.sgp30_ok) {
-        // Set humidity compensation if available
-        if (_status.bme680_ok && reading.humidity > 0) {
+        // Refresh humidity compensation from a good BME680 read; absolute
+        // humidity changes slowly, so keep exp() off the per-sample path
+        bool humidityValid = (validMask & FIELD_BIT(HUMIDITY)) && reading.humidity > 0;
+        if (humidityValid && (!_compensated ||
+            reading.timestamp - _lastCompensationTime >= SGP30_COMPENSATION_INTERVAL_MS)) {
             float absHumidity = SGP30Sensor::calculateAbsoluteHumidity(
                 reading.temperature, reading.humidity);
             _sgp30.setHumidityCompensation(absHumidity);
+            _lastCompensationTime = reading.timestamp;
+            _compensated = true;
         }
 
         if (!_sgp30.readAll(reading.co2, reading.tvoc)) {
             reading.co2 = 0;
             reading.tvoc = 0;
+        } else {
+            validMask |= FIELD_BIT(CO2) | FIELD_BIT(TVOC);
         }
     }
 
@@ -107,12 +127,15 @@ bool SensorManager::readAll(WeatherReading& reading) {
         if (!_wind.readAll(reading.windSpeed, reading.windDirection)) {
             reading.windSpeed = 0;
             reading.windDirection = 0;
+        } else {
+            validMask |= FIELD_BIT(WIND_SPEED) | FIELD_BIT(WIND_DIRECTION);
         }
     }
 
     // Read Precipitation
     if (_status.precipitation_ok) {
         reading.precipitation = _precip.readPrecipitation();
+        validMask |= FIELD_BIT(PRECIPITATION);
     }
 
     return reading.isValid;
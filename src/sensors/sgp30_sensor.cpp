@@ -4,6 +4,7 @@
 
 #include "sensors/sgp30_sensor.h"
 #include "config.h"
+#include "data/derived_variables.h"
 #include <math.h>
 
 SGP30Sensor::SGP30Sensor()
@@ -85,14 +86,7 @@ void SGP30Sensor::setHumidityCompensation(float humidity) {
 }
 
 float SGP30Sensor::calculateAbsoluteHumidity(float tempC, float relHumidity) {
-    // Calculate absolute humidity using the formula:
-    // AH = (6.112 * e^((17.67 * T) / (T + 243.5)) * RH * 2.1674) / (273.15 + T)
-    // where T is temperature in °C and RH is relative humidity in %
-
-    float es = 6.112f * exp((17.67f * tempC) / (tempC + 243.5f));
-    float ah = (es * relHumidity * 2.1674f) / (273.15f + tempC);
-
-    return ah;  // Returns g/m³
+    return DerivedVariables::absoluteHumidity(tempC, relHumidity);  // g/m³
 }
 
 bool SGP30Sensor::getBaseline(uint16_t& co2Baseline, uint16_t& tvocBaseline) {
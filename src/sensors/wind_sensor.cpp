@@ -5,14 +5,30 @@
 
 #include "sensors/wind_sensor.h"
 #include "config.h"
+#include "data/derived_variables.h"
+#include "data/wind_rose.h"
 #include <math.h>
 
+// 12-bit ADC count to volts (one multiply instead of a divide per sample)
+static const float ADC_TO_VOLTS = 3.3f / 4095.0f;
+
+// Flex sensor response above the ~1.5 V rest voltage: quadratic, typical
+// for drag-based sensors (coefficients need calibration). Horner form,
+// one multiply-add on the FPU.
+static float flexSpeed(float voltage) {
+    if (voltage <= 1.5f) return 0;
+    float deflection = voltage - 1.5f;
+    return deflection * (10.0f + 5.0f * deflection);
+}
+
 WindSensor::WindSensor()
     : _initialized(false)
     , _speedCalibrationFactor(1.0f)
     , _directionOffset(0)
     , _lastSpeedRaw(0)
-    , _lastDirRaw(0) {
+    , _lastDirRaw(0)
+    , _sampleFilter(WIND_SAMPLE_SPIKE_WINDOW, WIND_SPIKE_MIN_MS)
+    , _fastFilter(WIND_SPIKE_WINDOW, WIND_SPIKE_MIN_MS) {
 }
 
 bool WindSensor::begin(uint8_t speedPin, uint8_t dirPin) {
@@ -20,6 +36,8 @@ bool WindSensor::begin(uint8_t speedPin, uint8_t dirPin) {
 
     _speedPin = speedPin;
     _dirPin = dirPin;
+    _sampleFilter.reset();
+    _fastFilter.reset();
 
     // Configure ADC pins
     pinMode(_speedPin, INPUT);
@@ -58,7 +76,7 @@ bool WindSensor::isConnected() {
     return (speed > 10 && speed < 4085 && dir > 10 && dir < 4085);
 }
 
-float WindSensor::readWindSpeed() {
+float WindSensor::readWindSpeed(bool fast) {
     if (!_initialized) return 0;
 
     _lastSpeedRaw = analogRead(_speedPin);
@@ -72,18 +90,10 @@ float WindSensor::readWindSpeed() {
     // Assuming flex sensor gives ~1.5V at rest, ~3V at max deflection
     // Map to 0-50 m/s wind speed range
 
-    float voltage = (_lastSpeedRaw / 4095.0f) * 3.3f;
+    float voltage = _lastSpeedRaw * ADC_TO_VOLTS;
 
     // Flex sensor typically has non-linear response
-    // Using polynomial approximation (coefficients need calibration)
-    float speed = 0;
-
-    if (voltage > 1.5f) {
-        // Above rest voltage - wind is blowing
-        float deflection = voltage - 1.5f;
-        // Quadratic response (typical for drag-based sensors)
-        speed = 10.0f * deflection + 5.0f * deflection * deflection;
-    }
+    float speed = flexSpeed(voltage);
 
     // Apply calibration factor
     speed *= _speedCalibrationFactor;
@@ -92,6 +102,11 @@ float WindSensor::readWindSpeed() {
     if (speed < 0) speed = 0;
     if (speed > 100) speed = 100;
 
+    #if SPIKE_FILTER
+    // A single spike would otherwise set the window maximum and the gust
+    speed = fast ? _fastFilter.filter(speed) : _sampleFilter.filter(speed);
+    #endif
+
     return speed;
 }
 
@@ -112,14 +127,14 @@ uint16_t WindSensor::readWindDirection() {
     return direction;
 }
 
-bool WindSensor::readAll(float& speed, uint16_t& direction) {
+bool WindSensor::readAll(float& speed, uint16_t& direction, bool fast) {
     if (!_initialized) {
         speed = 0;
         direction = 0;
         return false;
     }
 
-    speed = readWindSpeed();
+    speed = readWindSpeed(fast);
     direction = readWindDirection();
 
     return true;
@@ -146,13 +161,8 @@ void WindSensor::calibrateSpeed(float referenceMps, uint16_t rawReading) {
 
     if (rawReading > 0 && referenceMps > 0) {
         // Calculate what the current conversion would give
-        float voltage = (rawReading / 4095.0f) * 3.3f;
-        float calculatedSpeed = 0;
-
-        if (voltage > 1.5f) {
-            float deflection = voltage - 1.5f;
-            calculatedSpeed = 10.0f * deflection + 5.0f * deflection * deflection;
-        }
+        float voltage = rawReading * ADC_TO_VOLTS;
+        float calculatedSpeed = flexSpeed(voltage);
 
         // Adjust calibration factor
         if (calculatedSpeed > 0) {
@@ -172,37 +182,12 @@ void WindSensor::calibrateDirection(uint16_t trueNorthRaw) {
 }
 
 const char* WindSensor::directionToCardinal(uint16_t degrees) {
-    // Convert degrees to 16-point compass direction
-    static const char* cardinals[] = {
-        "N", "NNE", "NE", "ENE",
-        "E", "ESE", "SE", "SSE",
-        "S", "SSW", "SW", "WSW",
-        "W", "WNW", "NW", "NNW"
-    };
-
-    // Each direction spans 22.5 degrees
-    // Add 11.25 to center the ranges
-    int index = ((degrees + 11) % 360) / 22;
-    if (index > 15) index = 15;
-
-    return cardinals[index];
+    // 16-point compass, same 22.5-degree sectors as the aggregated wind rose
+    return WindRose::sectorName(WindRose::sectorOf(degrees));
 }
 
 float WindSensor::calculateWindChill(float tempC, float windSpeedMps) {
-    // Wind chill calculation (valid for temp <= 10°C and wind >= 1.3 m/s)
-    // Uses Environment Canada formula
-
-    if (tempC > 10 || windSpeedMps < 1.3) {
-        return tempC;  // Wind chill not applicable
-    }
-
-    // Convert m/s to km/h for the formula
-    float windKmh = windSpeedMps * 3.6f;
-
-    float windChill = 13.12f + 0.6215f * tempC
-                    - 11.37f * pow(windKmh, 0.16f)
-                    + 0.3965f * tempC * pow(windKmh, 0.16f);
-
-    return windChill;
+    // Environment Canada formula, shared with the published derived values
+    return DerivedVariables::windChill(tempC, windSpeedMps);
 }
 
@@ -0,0 +1,418 @@
+/**
+ * COW-Bois Weather Station - Buffer Writer Implementation
+ */
+
+#include "util/buffer_writer.h"
+#include <stdio.h>
+#include <string.h>
+
+bool BufferWriter::_libc = false;
+
+static const uint32_t POW10[10] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+// ============================================
+// Number Conversion
+// Digits are written backwards from the end of a scratch buffer
+// ============================================
+
+// 32-bit division where the value allows it (64-bit division is a
+// library call on the ESP32)
+static char* unsignedDigits(char* end, uint64_t value) {
+    uint32_t low;
+    while (value > 0xFFFFFFFFULL) {
+        *--end = (char)('0' + value % 10);
+        value /= 10;
+    }
+    low = (uint32_t)value;
+    do {
+        *--end = (char)('0' + low % 10);
+        low /= 10;
+    } while (low);
+    return end;
+}
+
+static char* hexDigits(char* end, uint64_t value, bool upper) {
+    const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    do {
+        *--end = digits[value & 0xF];
+        value >>= 4;
+    } while (value);
+    return end;
+}
+
+static uint8_t bitLength(uint64_t value) {
+    return value ? (uint8_t)(64 - __builtin_clzll(value)) : 0;
+}
+
+// value * 10^decimals rounded to nearest, ties to even - what the C
+// library's %f prints. A double is m * 2^e, so the product is an exact
+// integer fraction; false if it does not fit 64 bits (or NaN / inf).
+static bool scaledRound(double value, uint8_t decimals, uint64_t& result, bool& negative) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    negative = (bits >> 63) != 0;
+    int exponent = (int)((bits >> 52) & 0x7FF);
+    uint64_t mantissa = bits & 0xFFFFFFFFFFFFFULL;
+
+    if (exponent == 0x7FF) return false;
+    if (exponent == 0) {
+        exponent = 1;                 // Subnormal
+    } else {
+        mantissa |= 1ULL << 52;
+    }
+    if (mantissa == 0) {
+        result = 0;
+        return true;
+    }
+
+    int shift = exponent - 1075;      // value = mantissa * 2^shift
+    uint8_t zeros = (uint8_t)__builtin_ctzll(mantissa);
+    mantissa >>= zeros;
+    shift += zeros;
+
+    uint64_t scale = POW10[decimals];
+    if (bitLength(mantissa) + bitLength(scale) > 64) return false;
+    uint64_t n = mantissa * scale;
+
+    if (shift >= 0) {
+        if (bitLength(n) + shift > 64) return false;
+        result = n << shift;
+        return true;
+    }
+
+    int right = -shift;
+    if (right > 64) {
+        result = 0;                   // Below half a unit of the last digit
+        return true;
+    }
+    if (right == 64) {
+        result = n > (1ULL << 63) ? 1 : 0;
+        return true;
+    }
+    uint64_t q = n >> right;
+    uint64_t r = n & ((1ULL << right) - 1);
+    uint64_t half = 1ULL << (right - 1);
+    if (r > half || (r == half && (q & 1))) q++;
+    result = q;
+    return true;
+}
+
+// %.<decimals>f without sign; returns the start of the text or nullptr
+static char* fixedDigits(char* end, double value, uint8_t decimals, bool& negative) {
+    uint64_t scaled;
+    if (!scaledRound(value, decimals, scaled, negative)) return nullptr;
+
+    uint64_t integer = decimals < 10 ? scaled / POW10[decimals] : 0;
+    if (decimals > 0) {
+        uint32_t fraction = (uint32_t)(scaled - integer * POW10[decimals]);
+        for (uint8_t i = 0; i < decimals; i++) {
+            *--end = (char)('0' + fraction % 10);
+            fraction /= 10;
+        }
+        *--end = '.';
+    }
+    return unsignedDigits(end, integer);
+}
+
+// ============================================
+// Output
+// ============================================
+
+BufferWriter::BufferWriter(char* buffer, size_t size)
+    : _buffer(buffer), _size(size), _length(0), _sink(nullptr), _staged(0) {
+    if (_size > 0) _buffer[0] = '\0';
+}
+
+BufferWriter::BufferWriter(OutputSink& sink, char* chunk, size_t chunkSize)
+    : _buffer(chunk), _size(chunkSize), _length(0), _sink(&sink), _staged(0) {}
+
+BufferWriter::~BufferWriter() {
+    if (_sink) drain();
+}
+
+void BufferWriter::drain() {
+    if (_staged == 0) return;
+    _sink->write((const uint8_t*)_buffer, _staged);
+    _staged = 0;
+}
+
+void BufferWriter::append(const char* text, size_t length) {
+    if (_sink) {
+        _length += length;
+        if (_staged + length > _size) {
+            drain();
+            if (length >= _size) {          // Larger than the chunk: straight through
+                _sink->write((const uint8_t*)text, length);
+                return;
+            }
+        }
+        memcpy(_buffer + _staged, text, length);
+        _staged += length;
+        return;
+    }
+
+    if (_length + 1 < _size) {
+        size_t room = _size - 1 - _length;
+        size_t copy = length < room ? length : room;
+        memcpy(_buffer + _length, text, copy);
+        _buffer[_length + copy] = '\0';
+    }
+    _length += length;
+}
+
+void BufferWriter::append(const char* text) {
+    append(text, strlen(text));
+}
+
+void BufferWriter::pad(char fill, size_t count) {
+    char run[16];
+    memset(run, fill, sizeof(run));
+    while (count > 0) {
+        size_t n = count < sizeof(run) ? count : sizeof(run);
+        append(run, n);
+        count -= n;
+    }
+}
+
+void BufferWriter::appendField(const char* text, size_t length, uint8_t width, bool left,
+                               bool zero) {
+    if (length >= width) {
+        append(text, length);
+    } else if (left) {
+        append(text, length);
+        pad(' ', width - length);
+    } else if (zero) {
+        // Zeros go between the sign and the digits
+        if (*text == '-') {
+            append(text, 1);
+            text++;
+            length--;
+            width--;
+        }
+        pad('0', width - length);
+        append(text, length);
+    } else {
+        pad(' ', width - length);
+        append(text, length);
+    }
+}
+
+void BufferWriter::appendUnsigned(uint64_t value) {
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    char* start = unsignedDigits(end, value);
+    append(start, end - start);
+}
+
+void BufferWriter::appendSigned(int64_t value) {
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+    char* start = unsignedDigits(end, magnitude);
+    if (value < 0) *--start = '-';
+    append(start, end - start);
+}
+
+void BufferWriter::appendFixed(double value, uint8_t decimals) {
+    char digits[40];
+    char* end = digits + sizeof(digits);
+    bool negative;
+    char* start = decimals <= 9 ? fixedDigits(end, value, decimals, negative) : nullptr;
+    if (!start) {
+        printf("%.*f", (int)decimals, value);   // Handed to the C library below
+        return;
+    }
+    if (negative) *--start = '-';
+    append(start, end - start);
+}
+
+// One conversion through the C library (rare formats only)
+template <typename T>
+static int libcConversion(char* buffer, size_t size, const char* spec, T value) {
+    return snprintf(buffer, size, spec, value);
+}
+
+void BufferWriter::printf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+void BufferWriter::vprintf(const char* format, va_list args) {
+    if (_libc && !_sink) {
+        size_t offset = _length < _size ? _length : _size;
+        int written = vsnprintf(_buffer + offset, _size - offset, format, args);
+        if (written > 0) _length += written;
+        return;
+    }
+
+    const char* p = format;
+    while (*p) {
+        const char* literal = p;
+        while (*p && *p != '%') p++;
+        if (p > literal) append(literal, p - literal);
+        if (!*p) break;
+        p++;
+
+        if (*p == '%') {
+            append("%", 1);
+            p++;
+            continue;
+        }
+
+        // %[flags][width][.precision][length]conversion
+        bool left = false, zero = false, unusual = false;
+        char flags[6];
+        uint8_t flagCount = 0;
+        for (;; p++) {
+            if (*p == '-') left = true;
+            else if (*p == '0') zero = true;
+            else if (*p == '+' || *p == ' ' || *p == '#') unusual = true;
+            else break;
+            if (flagCount < sizeof(flags)) flags[flagCount++] = *p;
+        }
+        int width = 0;
+        if (*p == '*') {
+            width = va_arg(args, int);
+            if (width < 0) {
+                left = true;
+                width = -width;
+            }
+            p++;
+        } else {
+            while (*p >= '0' && *p <= '9') width = width * 10 + (*p++ - '0');
+        }
+        int precision = -1;
+        if (*p == '.') {
+            p++;
+            precision = 0;
+            if (*p == '*') {
+                precision = va_arg(args, int);
+                p++;
+            } else {
+                while (*p >= '0' && *p <= '9') precision = precision * 10 + (*p++ - '0');
+            }
+        }
+        uint8_t longs = 0;
+        while (*p == 'l' || *p == 'h' || *p == 'z') {
+            if (*p == 'l') longs++;
+            else if (*p == 'z') longs = sizeof(size_t) == sizeof(long) ? 1 : 0;
+            p++;
+        }
+        char conversion = *p;
+        if (!conversion) break;
+        p++;
+        if (width > 255) unusual = true;
+
+        char digits[40];
+        char* end = digits + sizeof(digits);
+        char* start = nullptr;
+        bool integerConversion = conversion == 'd' || conversion == 'i' || conversion == 'u' ||
+                                 conversion == 'x' || conversion == 'X';
+
+        // Fast paths
+        if (!unusual && integerConversion && precision < 0) {
+            if (conversion == 'd' || conversion == 'i') {
+                int64_t value = longs >= 2 ? va_arg(args, long long)
+                              : longs == 1 ? va_arg(args, long) : va_arg(args, int);
+                uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+                start = unsignedDigits(end, magnitude);
+                if (value < 0) *--start = '-';
+            } else {
+                uint64_t value = longs >= 2 ? va_arg(args, unsigned long long)
+                               : longs == 1 ? va_arg(args, unsigned long)
+                               : va_arg(args, unsigned int);
+                start = conversion == 'u' ? unsignedDigits(end, value)
+                                          : hexDigits(end, value, conversion == 'X');
+            }
+            appendField(start, end - start, (uint8_t)width, left, zero);
+            continue;
+        }
+        if (conversion == 's') {
+            const char* text = va_arg(args, const char*);
+            if (!text) text = "(null)";
+            size_t length = precision < 0 ? strlen(text) : strnlen(text, (size_t)precision);
+            appendField(text, length, (uint8_t)(unusual ? 0 : width), left, false);
+            continue;
+        }
+        if (conversion == 'c' && !unusual) {
+            char c = (char)va_arg(args, int);
+            appendField(&c, 1, (uint8_t)width, left, false);
+            continue;
+        }
+
+        double floatValue = 0;
+        if (conversion == 'f' || conversion == 'F') {
+            floatValue = va_arg(args, double);
+            bool negative;
+            if (!unusual && precision <= 9 &&
+                (start = fixedDigits(end, floatValue, precision < 0 ? 6 : (uint8_t)precision,
+                                     negative))) {
+                if (negative) *--start = '-';
+                appendField(start, end - start, (uint8_t)width, left, zero);
+                continue;
+            }
+        }
+
+        // Rebuild the conversion (widths from '*' included) for the C library
+        char spec[24];
+        char* s = spec;
+        *s++ = '%';
+        for (uint8_t i = 0; i < flagCount; i++) *s++ = flags[i];
+        if (width > 0) {
+            char* number = unsignedDigits(end, (uint64_t)(width > 999 ? 999 : width));
+            while (number < end) *s++ = *number++;
+        }
+        if (precision >= 0) {
+            *s++ = '.';
+            char* number = unsignedDigits(end, (uint64_t)(precision > 999 ? 999 : precision));
+            while (number < end) *s++ = *number++;
+        }
+        for (uint8_t i = 0; i < longs && i < 2; i++) *s++ = 'l';
+        *s++ = conversion;
+        *s = '\0';
+
+        // The C library writes in place: after the text in the buffer, or
+        // into the emptied chunk when streaming
+        if (_sink) drain();
+        size_t offset = _sink ? 0 : _length < _size ? _length : _size;
+        char* out = _buffer + offset;
+        size_t room = _size - offset;
+        int written = 0;
+        switch (conversion) {
+            case 'f': case 'F':
+                written = libcConversion(out, room, spec, floatValue);
+                break;
+            case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                written = libcConversion(out, room, spec, va_arg(args, double));
+                break;
+            case 'd': case 'i':
+                written = longs >= 2 ? libcConversion(out, room, spec, va_arg(args, long long))
+                        : longs == 1 ? libcConversion(out, room, spec, va_arg(args, long))
+                        : libcConversion(out, room, spec, va_arg(args, int));
+                break;
+            case 'u': case 'x': case 'X': case 'o':
+                written = longs >= 2
+                    ? libcConversion(out, room, spec, va_arg(args, unsigned long long))
+                    : longs == 1 ? libcConversion(out, room, spec, va_arg(args, unsigned long))
+                    : libcConversion(out, room, spec, va_arg(args, unsigned int));
+                break;
+            case 'c':
+                written = libcConversion(out, room, spec, va_arg(args, int));
+                break;
+            case 'p':
+                written = libcConversion(out, room, spec, va_arg(args, void*));
+                break;
+            default:
+                break;                    // Unknown conversion: nothing written
+        }
+        if (written > 0 && _sink) {
+            written = (size_t)written < room ? written : (int)room - 1;
+            _staged = written;
+        }
+        if (written > 0) _length += written;
+    }
+}
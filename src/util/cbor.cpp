@@ -0,0 +1,260 @@
+/**
+ * COW-Bois Weather Station - CBOR Implementation
+ */
+
+#include "util/cbor.h"
+#include <string.h>
+
+// Major types (RFC 8949 section 3.1)
+static const uint8_t CBOR_UNSIGNED = 0;
+static const uint8_t CBOR_NEGATIVE = 1;
+static const uint8_t CBOR_BYTES = 2;
+static const uint8_t CBOR_TEXT = 3;
+static const uint8_t CBOR_ARRAY = 4;
+static const uint8_t CBOR_MAP = 5;
+static const uint8_t CBOR_SIMPLE = 7;
+
+// Simple values
+static const uint8_t CBOR_FALSE = 20;
+static const uint8_t CBOR_TRUE = 21;
+static const uint8_t CBOR_NULL = 22;
+
+// Deepest nesting skip() follows (the report schema uses three levels)
+static const uint8_t MAX_SKIP_DEPTH = 8;
+
+// ============================================
+// Writer
+// ============================================
+
+CborWriter::CborWriter(uint8_t* buffer, size_t size)
+    : _buffer(buffer), _size(size), _length(0), _sink(nullptr), _staged(0) {}
+
+CborWriter::CborWriter(OutputSink& sink, uint8_t* chunk, size_t chunkSize)
+    : _buffer(chunk), _size(chunkSize), _length(0), _sink(&sink), _staged(0) {}
+
+CborWriter::~CborWriter() {
+    if (_sink) drain();
+}
+
+void CborWriter::drain() {
+    if (_staged == 0) return;
+    _sink->write(_buffer, _staged);
+    _staged = 0;
+}
+
+void CborWriter::put(uint8_t byte) {
+    if (_sink) {
+        if (_staged == _size) drain();
+        _buffer[_staged++] = byte;
+    } else if (_length < _size) {
+        _buffer[_length] = byte;
+    }
+    _length++;
+}
+
+void CborWriter::putBytes(const uint8_t* bytes, size_t length) {
+    if (_sink) {
+        if (_staged + length > _size) {
+            drain();
+            if (length >= _size) {            // Larger than the chunk: straight through
+                _sink->write(bytes, length);
+                _length += length;
+                return;
+            }
+        }
+        memcpy(_buffer + _staged, bytes, length);
+        _staged += length;
+    } else if (_length < _size) {
+        size_t room = _size - _length;
+        memcpy(_buffer + _length, bytes, length < room ? length : room);
+    }
+    _length += length;
+}
+
+// Initial byte, then the argument in the shortest big-endian form
+void CborWriter::writeHead(uint8_t major, uint64_t argument) {
+    uint8_t type = major << 5;
+    if (argument < 24) {
+        put(type | (uint8_t)argument);
+        return;
+    }
+    uint8_t bytes;
+    if (argument <= 0xFF) {
+        put(type | 24);
+        bytes = 1;
+    } else if (argument <= 0xFFFF) {
+        put(type | 25);
+        bytes = 2;
+    } else if (argument <= 0xFFFFFFFFULL) {
+        put(type | 26);
+        bytes = 4;
+    } else {
+        put(type | 27);
+        bytes = 8;
+    }
+    while (bytes-- > 0) put((uint8_t)(argument >> (8 * bytes)));
+}
+
+void CborWriter::beginMap(uint32_t pairs) {
+    writeHead(CBOR_MAP, pairs);
+}
+
+void CborWriter::beginArray(uint32_t count) {
+    writeHead(CBOR_ARRAY, count);
+}
+
+void CborWriter::writeUnsigned(uint64_t value) {
+    writeHead(CBOR_UNSIGNED, value);
+}
+
+void CborWriter::writeInt(int64_t value) {
+    // Negative n is encoded as -1 - n
+    if (value < 0) {
+        writeHead(CBOR_NEGATIVE, (uint64_t)(-1 - value));
+    } else {
+        writeHead(CBOR_UNSIGNED, (uint64_t)value);
+    }
+}
+
+void CborWriter::writeText(const char* text) {
+    size_t length = strlen(text);
+    writeHead(CBOR_TEXT, length);
+    putBytes((const uint8_t*)text, length);
+}
+
+void CborWriter::writeBool(bool value) {
+    writeHead(CBOR_SIMPLE, value ? CBOR_TRUE : CBOR_FALSE);
+}
+
+void CborWriter::writeNull() {
+    writeHead(CBOR_SIMPLE, CBOR_NULL);
+}
+
+// ============================================
+// Reader
+// ============================================
+
+CborReader::CborReader(const uint8_t* data, size_t length)
+    : _data(data), _length(length), _position(0), _failed(false) {}
+
+bool CborReader::fail() {
+    _failed = true;
+    return false;
+}
+
+bool CborReader::readHead(uint8_t& major, uint64_t& argument) {
+    if (_failed || _position >= _length) return fail();
+    uint8_t initial = _data[_position++];
+    major = initial >> 5;
+    uint8_t info = initial & 0x1F;
+
+    if (info < 24) {
+        argument = info;
+        return true;
+    }
+    if (info > 27) return fail();     // Reserved or indefinite length
+
+    uint8_t bytes = (uint8_t)(1 << (info - 24));
+    if (_length - _position < bytes) return fail();
+    argument = 0;
+    while (bytes-- > 0) argument = (argument << 8) | _data[_position++];
+    return true;
+}
+
+bool CborReader::expect(uint8_t major, uint64_t& argument) {
+    uint8_t actual;
+    if (!readHead(actual, argument)) return false;
+    return actual == major ? true : fail();
+}
+
+bool CborReader::readMap(uint32_t& pairs) {
+    uint64_t argument;
+    if (!expect(CBOR_MAP, argument) || argument > UINT32_MAX) return fail();
+    pairs = (uint32_t)argument;
+    return true;
+}
+
+bool CborReader::readArray(uint32_t& count) {
+    uint64_t argument;
+    if (!expect(CBOR_ARRAY, argument) || argument > UINT32_MAX) return fail();
+    count = (uint32_t)argument;
+    return true;
+}
+
+bool CborReader::readUnsigned(uint64_t& value) {
+    return expect(CBOR_UNSIGNED, value);
+}
+
+bool CborReader::readInt(int64_t& value) {
+    uint8_t major;
+    uint64_t argument;
+    if (!readHead(major, argument)) return false;
+    if ((major != CBOR_UNSIGNED && major != CBOR_NEGATIVE) || argument > INT64_MAX) {
+        return fail();
+    }
+    value = major == CBOR_UNSIGNED ? (int64_t)argument : -1 - (int64_t)argument;
+    return true;
+}
+
+bool CborReader::readText(char* text, size_t size) {
+    uint64_t length;
+    if (!expect(CBOR_TEXT, length)) return false;
+    if (_length - _position < length) return fail();
+    if (size > 0) {
+        size_t copy = length < size - 1 ? (size_t)length : size - 1;
+        memcpy(text, _data + _position, copy);
+        text[copy] = '\0';
+    }
+    _position += (size_t)length;
+    return true;
+}
+
+bool CborReader::readBool(bool& value) {
+    uint64_t argument;
+    if (!expect(CBOR_SIMPLE, argument)) return false;
+    if (argument != CBOR_TRUE && argument != CBOR_FALSE) return fail();
+    value = argument == CBOR_TRUE;
+    return true;
+}
+
+bool CborReader::readNull() {
+    if (_failed || _position >= _length) return false;
+    if (_data[_position] != ((CBOR_SIMPLE << 5) | CBOR_NULL)) return false;
+    _position++;
+    return true;
+}
+
+bool CborReader::skip() {
+    return skipItem(0);
+}
+
+bool CborReader::skipItem(uint8_t depth) {
+    if (depth > MAX_SKIP_DEPTH) return fail();
+    uint8_t major;
+    uint64_t argument;
+    if (!readHead(major, argument)) return false;
+
+    switch (major) {
+        case CBOR_BYTES:
+        case CBOR_TEXT:
+            if (_length - _position < argument) return fail();
+            _position += (size_t)argument;
+            return true;
+        case CBOR_ARRAY:
+        case CBOR_MAP: {
+            // Each element takes at least one byte: bounds the loop
+            uint64_t items = major == CBOR_MAP ? argument * 2 : argument;
+            if (argument > _length || items > _length - _position) return fail();
+            for (uint64_t i = 0; i < items; i++) {
+                if (!skipItem(depth + 1)) return false;
+            }
+            return true;
+        }
+        case CBOR_SIMPLE:
+            // Simple values and floats: the argument was the whole payload
+            return true;
+        default:
+            // Integers; tags (major 6) are not used by the schema
+            return major == CBOR_UNSIGNED || major == CBOR_NEGATIVE ? true : fail();
+    }
+}
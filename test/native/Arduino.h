@@ -0,0 +1,110 @@
+/**
+ * COW-Bois Weather Station - Host Arduino Shim
+ * Just enough of the Arduino core for the benchmark sketches to run on
+ * a PC (pio run -e native_aggregator). Cycle counts come from the host
+ * timestamp counter, so compare them between paths, not with the ESP32.
+ */
+
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+using std::min;
+using std::max;
+typedef uint8_t byte;
+
+// Fixed time for tests that step the clock (-1 = real time)
+inline long long g_fakeMs = -1;
+
+inline unsigned long millis() {
+    if (g_fakeMs >= 0) return (unsigned long)g_fakeMs;
+    static auto t0 = std::chrono::steady_clock::now();
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+}
+
+inline unsigned long micros() {
+    static auto t0 = std::chrono::steady_clock::now();
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+}
+
+inline void delay(unsigned long) {}
+inline void yield() {}
+inline uint32_t getCpuFrequencyMhz() { return 0; }   // Not known on the host
+
+// ============================================
+// Print / Serial (stdout)
+// ============================================
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) { return fwrite(&c, 1, 1, stdout); }
+    virtual size_t write(const uint8_t* data, size_t length) {
+        return fwrite(data, 1, length, stdout);
+    }
+    virtual void flush() { fflush(stdout); }
+
+    size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v) { return printf("%d", v); }
+    size_t print(unsigned int v) { return printf("%u", v); }
+    size_t print(long v) { return printf("%ld", v); }
+    size_t print(unsigned long v) { return printf("%lu", v); }
+    size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+    size_t println(const char* s = "") { return print(s) + print("\n"); }
+
+    size_t printf(const char* format, ...) {
+        char buffer[2048];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        return print(buffer);
+    }
+};
+
+class HostSerial : public Print {
+public:
+    void begin(unsigned long) {}
+    int available() { return 0; }
+    int read() { return -1; }
+};
+extern HostSerial Serial;
+
+// ============================================
+// ESP / FreeRTOS stand-ins
+// ============================================
+class HostEsp {
+public:
+    uint32_t getCycleCount() {
+#if defined(__x86_64__) || defined(__i386__)
+        return (uint32_t)__rdtsc();
+#else
+        return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+    uint32_t getFreeHeap() { return 0; }
+};
+extern HostEsp ESP;
+
+// Single-threaded host: the spinlocks guarding ISR / WiFi-task state are no-ops
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
+#endif // NATIVE_ARDUINO_H
@@ -0,0 +1,17 @@
+/**
+ * COW-Bois Weather Station - Host Entry Point
+ * Runs a benchmark sketch's setup() once (every benchmark) and exits
+ */
+
+#include <Arduino.h>
+
+HostSerial Serial;
+HostEsp ESP;
+
+void setup();
+
+int main() {
+    setup();
+    fflush(stdout);
+    return 0;
+}
@@ -0,0 +1,2944 @@
+/**
+ * COW-Bois Weather Station - Data Aggregator Benchmark
+ *
+ * Measures per-sample cost and numerical accuracy of the aggregation code:
+ * - accumulators against a double-precision reference
+ * - streaming quantile estimators against exact sorting
+ * - registry-generated code against hand-written equivalents
+ * - raw sample buffer scans and window recompute
+ * - trig-free wind direction path against libm
+ * - per-microstation table insert/update cost
+ * - sliding window cost and accuracy against a full rescan
+ * - WMO wind products (gust, 2/10-min means) against known inputs
+ * - quality control cost and detection of injected faults
+ * - derived variables: cold vs cached cost and reference values
+ * - wind rose cost, merge exactness and payload size
+ * - report compression: bytes saved on a calm day, reconstruction error
+ * - event lane: detection latency, QC gating, holdoff and rate limit
+ * - Hampel spike filter: cost at 1 Hz and 50 Hz, spikes removed, real
+ *   gusts kept
+ * - agronomic products: FAO-56 worked examples, day boundaries, cost
+ * - spatial aggregation: cost against station count, extremes and
+ *   merge against a direct scan, recovered gradient of a known field
+ * - fixed-point aggregation: cost against the float path, results
+ *   within field resolution
+ * - formatter writer: cost and stack against the C library's printf,
+ *   byte-identical output
+ * - CBOR payload: bytes and cost against JSON, decoder round trip
+ * - backlog batches: a day of windows against JSON / CBOR, round trip,
+ *   bounded buffer
+ * - InfluxDB batches: bytes and records per second for a full site,
+ *   epoch-ns timestamps, tag escaping
+ * - streaming sinks: byte-identical output, publish cost and stack
+ *   against a payload buffer
+ * Uses the production DataAggregator / RunningStats / P2Quantile /
+ * DataFormatter / SampleBuffer / StationTable / SlidingWindow /
+ * WindProducts / QualityControl / DerivedVariables / WindRose /
+ * ReportCompressor / EventDetector / HampelFilter / AgroProducts /
+ * SpatialAggregator / FixedPointAggregator / BufferWriter / CborPayload /
+ * BatchEncoder / InfluxBatch / fast math code.
+ *
+ * Upload: pio run -e test_aggregator -t upload
+ * Monitor: pio device monitor
+ * Host: pio run -e native_aggregator, then run
+ *       .pio/build/native_aggregator/program (test/native shims the
+ *       Arduino core; cycles are host TSC ticks, only comparable
+ *       between paths of the same run)
+ *
+ * No sensors required - samples are generated from a fixed-seed
+ * pseudo-random sequence so results are repeatable between runs.
+ */
+
+#include <Arduino.h>
+#include <math.h>
+
+// Include project headers - using production code
+#include "config.h"
+#include "data/weather_data.h"
+#include "data/running_stats.h"
+#include "data/streaming_quantile.h"
+#include "data/data_aggregator.h"
+#include "data/data_formatter.h"
+#include "data/sample_buffer.h"
+#include "data/station_table.h"
+#include "data/sliding_window.h"
+#include "data/wind_products.h"
+#include "data/quality_control.h"
+#include "data/derived_variables.h"
+#include "data/wind_rose.h"
+#include "data/report_compressor.h"
+#include "data/event_detector.h"
+#include "data/hampel_filter.h"
+#include "data/agro_products.h"
+#include "data/spatial_aggregator.h"
+#include "data/fixed_point_aggregator.h"
+#include "data/cbor_payload.h"
+#include "data/batch_codec.h"
+#include "data/influx_batch.h"
+#include "util/wall_clock.h"
+#include "util/fast_math.h"
+#include "util/buffer_writer.h"
+
+// ============================================
+// Benchmark Configuration
+// ============================================
+#define BENCH_SAMPLES 1000000UL
+
+// Cycles to microseconds at the CPU clock; 0 on the host, whose shim
+// reports no clock (cycle counts only)
+float cyclesToUs(float cycles) {
+    uint32_t mhz = getCpuFrequencyMhz();
+    return mhz > 0 ? cycles / mhz : 0.0f;
+}
+
+// ============================================
+// Deterministic Sample Generator
+// ============================================
+static uint32_t rngState = 1;
+
+void seedSamples(uint32_t seed) {
+    rngState = seed;
+}
+
+// Uniform noise in [-1, 1)
+float nextNoise() {
+    rngState = rngState * 1664525UL + 1013904223UL;
+    return (float)(int32_t)rngState / 2147483648.0f;
+}
+
+// Slowly drifting signal around an offset (e.g. 1013 hPa pressure)
+float nextSample(float offset, float spread, uint32_t i) {
+    return offset + spread * (0.5f * nextNoise() + 0.5f * (float)((i >> 10) & 7) / 7.0f);
+}
+
+// ============================================
+// Benchmarks
+// ============================================
+struct BenchResult {
+    float cyclesPerSample;
+    double meanError;
+    double stddevError;
+};
+
+void printResult(const char* name, const BenchResult& r) {
+    Serial.printf("  %-22s %8.1f cyc/sample  mean err %.3e  std err %.3e\n",
+                  name, r.cyclesPerSample, r.meanError, r.stddevError);
+}
+
+// Cost of generating samples alone, subtracted from the other results
+uint32_t benchGeneratorCycles(float offset, float spread) {
+    seedSamples(42);
+    volatile float sink = 0;
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        sink = nextSample(offset, spread, i);
+    }
+    (void)sink;
+    return ESP.getCycleCount() - start;
+}
+
+void benchAccumulators(const char* label, float offset, float spread) {
+    Serial.printf("\n--- %s (offset %.2f, spread %.2f, n=%lu) ---\n",
+                  label, offset, spread, BENCH_SAMPLES);
+
+    uint32_t genCycles = benchGeneratorCycles(offset, spread);
+
+    // Double-precision reference (Welford)
+    seedSamples(42);
+    double refMean = 0, refM2 = 0;
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        double x = nextSample(offset, spread, i);
+        double delta = x - refMean;
+        refMean += delta / (double)(i + 1);
+        refM2 += delta * (x - refMean);
+    }
+    double refStd = sqrt(refM2 / (double)(BENCH_SAMPLES - 1));
+    Serial.printf("  Reference: mean %.6f std %.6f\n", refMean, refStd);
+
+    // Legacy path: plain float sum and sum of squares
+    seedSamples(42);
+    float sum = 0, sumSq = 0;
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        float x = nextSample(offset, spread, i);
+        sum += x;
+        sumSq += x * x;
+    }
+    uint32_t cycles = ESP.getCycleCount() - start - genCycles;
+    float naiveMean = sum / BENCH_SAMPLES;
+    float naiveVar = (sumSq - sum * naiveMean) / (BENCH_SAMPLES - 1);
+    BenchResult naive = {
+        (float)cycles / BENCH_SAMPLES,
+        fabs(naiveMean - refMean),
+        fabs(sqrt(naiveVar > 0 ? naiveVar : 0) - refStd)
+    };
+    printResult("float sum (legacy)", naive);
+
+    // Production accumulator
+    seedSamples(42);
+    RunningStats stats;
+    start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        stats.add(nextSample(offset, spread, i));
+    }
+    cycles = ESP.getCycleCount() - start - genCycles;
+    BenchResult welford = {
+        (float)cycles / BENCH_SAMPLES,
+        fabs(stats.mean - refMean),
+        fabs(stats.stddev() - refStd)
+    };
+    printResult(AGGREGATION_HIGH_RATE ? "RunningStats (Kahan)" : "RunningStats", welford);
+}
+
+void benchAddSample() {
+    Serial.println("\n--- DataAggregator::addSample (all fields) ---");
+
+    DataAggregator aggregator;
+    WeatherReading reading;
+    reading.isValid = true;
+
+    const uint32_t n = 100000;
+    seedSamples(7);
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < n; i++) {
+        reading.temperature = 20.0f + nextNoise();
+        reading.humidity = 50.0f + nextNoise();
+        reading.pressure = 1013.25f + nextNoise();
+        reading.gasResistance = 100.0f + nextNoise();
+        reading.windSpeed = 5.0f + nextNoise();
+        reading.windDirection = (uint16_t)(i % 360);
+        reading.lux = 20000 + (i & 0xFF);
+        reading.solarIrradiance = 158.0f + nextNoise();
+        reading.co2 = 400 + (i & 0x1F);
+        reading.tvoc = 10 + (i & 0x0F);
+        aggregator.addSample(reading);
+    }
+    uint32_t cycles = ESP.getCycleCount() - start;
+
+    Serial.printf("  %.1f cycles/sample (%.2f us at %lu MHz), %lu samples\n",
+                  (float)cycles / n, cyclesToUs((float)cycles / n),
+                  (unsigned long)getCpuFrequencyMhz(), aggregator.getSampleCount());
+
+    AggregatedData data = aggregator.getAndReset();
+    Serial.printf("  temp avg %.3f std %.3f, pressure avg %.3f std %.3f\n",
+                  data.tempAvg, data.tempStdDev, data.pressureAvg, data.pressureStdDev);
+}
+
+int compareFloat(const void* a, const void* b) {
+    float fa = *(const float*)a;
+    float fb = *(const float*)b;
+    return (fa > fb) - (fa < fb);
+}
+
+// Skewed, wind-like distribution (Weibull k=2, c=6 m/s)
+float nextWindSample() {
+    float u = 0.5f * (nextNoise() + 1.0f);
+    if (u < 1e-6f) u = 1e-6f;
+    return 6.0f * sqrtf(-logf(u));
+}
+
+// Near-normal, temperature-like distribution (sum of uniforms)
+float nextTempSample() {
+    return 20.0f + 2.0f * (nextNoise() + nextNoise() + nextNoise());
+}
+
+void benchQuantileCase(const char* label, float (*gen)(), uint32_t n) {
+    float* samples = (float*)malloc(n * sizeof(float));
+    if (!samples) {
+        Serial.printf("  %s n=%lu: allocation failed\n", label, n);
+        return;
+    }
+
+    seedSamples(1234);
+    for (uint32_t i = 0; i < n; i++) {
+        samples[i] = gen();
+    }
+
+    WindowQuantiles quantiles;
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < n; i++) {
+        quantiles.add(samples[i]);
+    }
+    uint32_t cycles = ESP.getCycleCount() - start;
+
+    start = ESP.getCycleCount();
+    qsort(samples, n, sizeof(float), compareFloat);
+    uint32_t sortCycles = ESP.getCycleCount() - start;
+
+    const float probs[3] = {0.05f, 0.50f, 0.95f};
+    const P2Quantile* est[3] = {&quantiles.p05, &quantiles.p50, &quantiles.p95};
+
+    Serial.printf("  %-5s n=%-6lu P2 %6.1f cyc/sample, sort %7.1f cyc/sample\n",
+                  label, n, (float)cycles / n, (float)sortCycles / n);
+    for (int q = 0; q < 3; q++) {
+        float exact = samples[(uint32_t)(probs[q] * (n - 1) + 0.5f)];
+        float value = est[q]->getValue();
+
+        // Rank error: fraction of samples below the estimate vs target
+        uint32_t below = 0;
+        while (below < n && samples[below] < value) below++;
+        float rankErr = (float)below / n - probs[q];
+
+        Serial.printf("        p%02d exact %7.3f est %7.3f abs err %.4f rank err %+.4f\n",
+                      (int)(probs[q] * 100 + 0.5f), exact, value,
+                      fabsf(value - exact), rankErr);
+    }
+
+    free(samples);
+}
+
+void benchQuantiles() {
+    Serial.println("\n--- Streaming quantiles (P2) vs exact sort ---");
+    Serial.printf("  Memory: %u bytes per quantile, %u bytes per field (p05/p50/p95)\n",
+                  (unsigned)sizeof(P2Quantile), (unsigned)sizeof(WindowQuantiles));
+
+    const uint32_t sizes[3] = {100, 1000, 10000};
+    for (int i = 0; i < 3; i++) {
+        benchQuantileCase("temp", nextTempSample, sizes[i]);
+        benchQuantileCase("wind", nextWindSample, sizes[i]);
+    }
+
+    // Up to five samples the markers are the sorted samples: nearest rank
+    bool smallOk = true;
+    const float values[5] = {3.0f, 1.0f, 5.0f, 2.0f, 4.0f};
+    for (uint8_t n = 1; n <= 5; n++) {
+        WindowQuantiles small;
+        for (uint8_t i = 0; i < n; i++) small.add(values[i]);
+        float sorted[5];
+        memcpy(sorted, values, n * sizeof(float));
+        qsort(sorted, n, sizeof(float), compareFloat);
+        smallOk = smallOk && small.p05.getValue() == sorted[(int)(0.05f * (n - 1) + 0.5f)] &&
+                  small.p50.getValue() == sorted[(int)(0.5f * (n - 1) + 0.5f)] &&
+                  small.p95.getValue() == sorted[(int)(0.95f * (n - 1) + 0.5f)];
+    }
+    Serial.printf("  1-5 samples: exact nearest rank %s\n", smallOk ? "OK" : "FAIL");
+}
+
+void benchMerge() {
+    Serial.println("\n--- Rollup merge vs single window ---");
+
+    // One aggregator sees every sample; the other window is split in
+    // twelve and merged the way the rollup tiers build hourly records
+    DataAggregator whole;
+    DataAggregator part;
+    AggregatedData merged;
+    WeatherReading reading;
+    reading.isValid = true;
+
+    seedSamples(99);
+    uint32_t mergeCycles = 0;
+    for (int window = 0; window < 12; window++) {
+        for (int i = 0; i < 20 + window * 7; i++) {
+            reading.temperature = 15.0f + window * 0.5f + nextNoise();
+            reading.pressure = 1000.0f + window + nextNoise();
+            reading.windSpeed = 3.0f + 2.0f * nextNoise();
+            reading.windDirection = (uint16_t)(350 + window * 2) % 360;
+            whole.addSample(reading);
+            part.addSample(reading);
+        }
+
+        AggregatedData record = part.getAndReset();
+        uint32_t start = ESP.getCycleCount();
+        if (window == 0) {
+            merged = record;
+        } else {
+            DataAggregator::merge(merged, record);
+        }
+        mergeCycles += ESP.getCycleCount() - start;
+    }
+
+    AggregatedData exact = whole.getAndReset();
+    Serial.printf("  samples %lu/%lu, %lu cycles per merge\n",
+                  merged.sampleCount, exact.sampleCount, mergeCycles / 11);
+    Serial.printf("  temp avg %.4f/%.4f std %.4f/%.4f min %.2f/%.2f max %.2f/%.2f\n",
+                  merged.tempAvg, exact.tempAvg, merged.tempStdDev, exact.tempStdDev,
+                  merged.tempMin, exact.tempMin, merged.tempMax, exact.tempMax);
+    Serial.printf("  pressure avg %.4f/%.4f std %.4f/%.4f\n",
+                  merged.pressureAvg, exact.pressureAvg,
+                  merged.pressureStdDev, exact.pressureStdDev);
+    Serial.printf("  wind dir %u/%u, median speed %.3f/%.3f (approx.)\n",
+                  merged.windDirAvg, exact.windDirAvg,
+                  merged.windSpeedMedian, exact.windSpeedMedian);
+}
+
+// ============================================
+// Registry-Generated vs Hand-Written Code
+// ============================================
+
+// Per-field code as written before the WEATHER_FIELDS registry
+struct HandWrittenAggregator {
+    RunningStats temp, humidity, pressure, gasResistance, windSpeed;
+    RunningStats lux, solar, co2, tvoc;
+    WindowQuantiles tempQuantiles, windSpeedQuantiles;
+    WindRose windRose;
+    int64_t windDirSin = 0, windDirCos = 0;
+    float precipitation = 0;
+    uint32_t sampleCount = 0;
+
+    void addSample(const WeatherReading& reading) {
+        if (!reading.isValid) return;
+        sampleCount++;
+
+        temp.add(reading.temperature);
+        tempQuantiles.add(reading.temperature);
+        humidity.add(reading.humidity);
+        pressure.add(reading.pressure);
+        gasResistance.add(reading.gasResistance);
+        windSpeed.add(reading.windSpeed);
+        windSpeedQuantiles.add(reading.windSpeed);
+
+        int16_t sinQ15, cosQ15;
+        fastSinCosDeg(reading.windDirection, sinQ15, cosQ15);
+        windDirSin += sinQ15;
+        windDirCos += cosQ15;
+
+        precipitation = reading.precipitation;
+        lux.add((float)reading.lux);
+        solar.add(reading.solarIrradiance);
+        co2.add((float)reading.co2);
+        tvoc.add((float)reading.tvoc);
+        windRose.add(reading.windSpeed, reading.windDirection);
+    }
+};
+
+// The MQTT payload as one format string, byte-identical to
+// DataFormatter::toMQTTPayload (for windows without QC rejections or wind
+// rose); written with snprintf and with a single BufferWriter call
+#define HAND_WRITTEN_FORMAT \
+        "{\"station_id\":\"%s\",\"timestamp\":%lu,\"data\":{" \
+        "\"temperature\":{\"value\":%.2f,\"min\":%.2f,\"max\":%.2f,\"std\":%.2f," \
+        "\"p05\":%.2f,\"p50\":%.2f,\"p95\":%.2f,\"unit\":\"C\"}," \
+        "\"humidity\":{\"value\":%.2f,\"min\":%.2f,\"max\":%.2f,\"std\":%.2f,\"unit\":\"%%\"}," \
+        "\"pressure\":{\"value\":%.2f,\"min\":%.2f,\"max\":%.2f,\"std\":%.2f,\"unit\":\"hPa\"}," \
+        "\"gas_resistance\":{\"value\":%.2f,\"min\":%.2f,\"max\":%.2f,\"std\":%.2f,\"unit\":\"KOhms\"}," \
+        "\"wind_speed\":{\"value\":%.2f,\"max\":%.2f,\"std\":%.2f," \
+        "\"p05\":%.2f,\"p50\":%.2f,\"p95\":%.2f,\"unit\":\"m/s\"}," \
+        "\"wind_direction\":{\"value\":%u,\"unit\":\"deg\"}," \
+        "\"precipitation\":{\"value\":%.2f,\"unit\":\"mm\"}," \
+        "\"solar_radiation\":{\"value\":%.2f,\"std\":%.2f,\"unit\":\"W/m2\"}," \
+        "\"co2\":{\"value\":%u,\"max\":%u,\"std\":%.2f,\"unit\":\"ppm\"}," \
+        "\"tvoc\":{\"value\":%u,\"max\":%u,\"std\":%.2f,\"unit\":\"ppb\"}" \
+        "},\"meta\":{\"samples\":%lu,\"window_ms\":%lu," \
+        "\"qc\":{\"missing\":%lu,\"range\":%lu,\"step\":%lu,\"persistence\":%lu," \
+        "\"consistency\":%lu,\"rejected\":{}}}}"
+#define HAND_WRITTEN_ARGS(stationId, d) \
+        stationId, (unsigned long)d.timestamp, \
+        d.tempAvg, d.tempMin, d.tempMax, d.tempStdDev, d.tempP05, d.tempMedian, d.tempP95, \
+        d.humidityAvg, d.humidityMin, d.humidityMax, d.humidityStdDev, \
+        d.pressureAvg, d.pressureMin, d.pressureMax, d.pressureStdDev, \
+        d.gasResistanceAvg, d.gasResistanceMin, d.gasResistanceMax, d.gasResistanceStdDev, \
+        d.windSpeedAvg, d.windSpeedMax, d.windSpeedStdDev, \
+        d.windSpeedP05, d.windSpeedMedian, d.windSpeedP95, \
+        d.windDirAvg, \
+        d.precipitation, \
+        d.solarAvg, d.solarStdDev, \
+        d.co2Avg, d.co2Max, d.co2StdDev, \
+        d.tvocAvg, d.tvocMax, d.tvocStdDev, \
+        (unsigned long)d.sampleCount, (unsigned long)d.windowDurationMs, \
+        (unsigned long)d.qcFlagCounts[0], (unsigned long)d.qcFlagCounts[1], \
+        (unsigned long)d.qcFlagCounts[2], (unsigned long)d.qcFlagCounts[3], \
+        (unsigned long)d.qcFlagCounts[4]
+
+// The aggregated JSON record in its original layout (wind, light and
+// air quality nested), with the std and quantile members added since
+#define HAND_WRITTEN_JSON_FORMAT \
+        "{\"timestamp\":%lu,\"window_duration_ms\":%lu,\"sample_count\":%lu," \
+        "\"temperature\":{\"avg\":%.2f,\"min\":%.2f,\"max\":%.2f,\"std\":%.2f," \
+        "\"p05\":%.2f,\"p50\":%.2f,\"p95\":%.2f}," \
+        "\"humidity\":{\"avg\":%.2f,\"min\":%.2f,\"max\":%.2f,\"std\":%.2f}," \
+        "\"pressure\":{\"avg\":%.2f,\"min\":%.2f,\"max\":%.2f,\"std\":%.2f}," \
+        "\"gas_resistance\":{\"avg\":%.2f,\"min\":%.2f,\"max\":%.2f,\"std\":%.2f}," \
+        "\"wind\":{\"speed_avg\":%.2f,\"speed_max\":%.2f,\"speed_std\":%.2f," \
+        "\"speed_p05\":%.2f,\"speed_p50\":%.2f,\"speed_p95\":%.2f,\"direction_avg\":%u}," \
+        "\"precipitation\":%.2f," \
+        "\"light\":{\"lux_avg\":%lu,\"lux_max\":%lu,\"lux_std\":%.2f," \
+        "\"solar_avg\":%.2f,\"solar_std\":%.2f}," \
+        "\"air_quality\":{\"co2_avg\":%u,\"co2_max\":%u,\"co2_std\":%.2f," \
+        "\"tvoc_avg\":%u,\"tvoc_max\":%u,\"tvoc_std\":%.2f}}"
+#define HAND_WRITTEN_JSON_ARGS(d) \
+        (unsigned long)d.timestamp, (unsigned long)d.windowDurationMs, \
+        (unsigned long)d.sampleCount, \
+        d.tempAvg, d.tempMin, d.tempMax, d.tempStdDev, d.tempP05, d.tempMedian, d.tempP95, \
+        d.humidityAvg, d.humidityMin, d.humidityMax, d.humidityStdDev, \
+        d.pressureAvg, d.pressureMin, d.pressureMax, d.pressureStdDev, \
+        d.gasResistanceAvg, d.gasResistanceMin, d.gasResistanceMax, d.gasResistanceStdDev, \
+        d.windSpeedAvg, d.windSpeedMax, d.windSpeedStdDev, \
+        d.windSpeedP05, d.windSpeedMedian, d.windSpeedP95, d.windDirAvg, \
+        d.precipitation, \
+        (unsigned long)d.luxAvg, (unsigned long)d.luxMax, d.luxStdDev, d.solarAvg, d.solarStdDev, \
+        d.co2Avg, d.co2Max, d.co2StdDev, d.tvocAvg, d.tvocMax, d.tvocStdDev
+
+// Original CSV columns; newer ones follow them
+static const char HAND_WRITTEN_CSV_HEADER[] =
+    "timestamp,window_ms,samples,"
+    "temp_avg,temp_min,temp_max,"
+    "humidity_avg,humidity_min,humidity_max,"
+    "pressure_avg,pressure_min,pressure_max,"
+    "gas_avg,gas_min,gas_max,"
+    "wind_speed_avg,wind_speed_max,wind_dir_avg,"
+    "precipitation,"
+    "lux_avg,lux_max,solar_avg,"
+    "co2_avg,co2_max,tvoc_avg,tvoc_max,";
+
+size_t handWrittenPayload(const char* stationId, const AggregatedData& d,
+                          char* buffer, size_t bufferSize) {
+    return snprintf(buffer, bufferSize, HAND_WRITTEN_FORMAT, HAND_WRITTEN_ARGS(stationId, d));
+}
+
+size_t handWrittenWriterPayload(const char* stationId, const AggregatedData& d,
+                                char* buffer, size_t bufferSize) {
+    BufferWriter out(buffer, bufferSize);
+    out.printf(HAND_WRITTEN_FORMAT, HAND_WRITTEN_ARGS(stationId, d));
+    return out.length();
+}
+
+void fillReading(WeatherReading& reading, uint32_t i) {
+    reading.temperature = 20.0f + nextNoise();
+    reading.humidity = 50.0f + nextNoise();
+    reading.pressure = 1013.25f + nextNoise();
+    reading.gasResistance = 100.0f + nextNoise();
+    reading.windSpeed = 5.0f + nextNoise();
+    reading.windDirection = (uint16_t)(i % 360);
+    reading.precipitation = i * 0.01f;
+    reading.lux = 20000 + (i & 0xFF);
+    reading.solarIrradiance = 158.0f + nextNoise();
+    reading.co2 = 400 + (i & 0x1F);
+    reading.tvoc = 10 + (i & 0x0F);
+}
+
+// The generated code must be at least as fast as the hand-written code.
+// Both run interleaved in rounds and the best round of each counts, so
+// an interrupt or cache miss in one round doesn't decide; REGISTRY_SLACK
+// is what remains of the run-to-run noise.
+#define REGISTRY_ROUNDS 10
+#define REGISTRY_SLACK 1.02f
+
+const char* registryVerdict(uint32_t generated, uint32_t hand) {
+    return generated <= hand * REGISTRY_SLACK ? "OK" : "FAIL (slower)";
+}
+
+void benchRegistry() {
+    Serial.println("\n--- Registry-generated vs hand-written ---");
+
+    const uint32_t n = 10000;         // Samples per round
+    WeatherReading reading;
+    reading.isValid = true;
+
+    static DataAggregator generated;
+    static HandWrittenAggregator hand;
+    generated.reset();
+    hand = HandWrittenAggregator();
+    uint32_t generatedBest = UINT32_MAX, handBest = UINT32_MAX;
+    for (uint32_t round = 0; round < REGISTRY_ROUNDS; round++) {
+        seedSamples(11 + round);
+        uint32_t start = ESP.getCycleCount();
+        for (uint32_t i = 0; i < n; i++) {
+            fillReading(reading, i);
+            generated.addSample(reading);
+        }
+        uint32_t cycles = ESP.getCycleCount() - start;
+        if (cycles < generatedBest) generatedBest = cycles;
+
+        seedSamples(11 + round);
+        start = ESP.getCycleCount();
+        for (uint32_t i = 0; i < n; i++) {
+            fillReading(reading, i);
+            hand.addSample(reading);
+        }
+        cycles = ESP.getCycleCount() - start;
+        if (cycles < handBest) handBest = cycles;
+    }
+
+    AggregatedData data = generated.getAggregatedData();
+    bool same = data.tempAvg == hand.temp.mean &&
+                data.pressureStdDev == hand.pressure.stddev() &&
+                data.windSpeedMedian == hand.windSpeedQuantiles.p50.getValue() &&
+                data.luxAvg == (uint32_t)(hand.lux.mean + 0.5f);
+    Serial.printf("  addSample: generated %.1f, hand-written %.1f cyc/sample "
+                  "(incl. input generation), results %s %s\n",
+                  (float)generatedBest / n, (float)handBest / n,
+                  same ? "identical" : "DIFFER", registryVerdict(generatedBest, handBest));
+
+    // MQTT payload formatting (the hand-written payload predates the rose)
+    data.windRose.reset();
+    const int iterations = 200;
+    static char generatedPayload[MQTT_MAX_PACKET_SIZE];
+    static char writerPayload[MQTT_MAX_PACKET_SIZE];
+    static char handPayload[MQTT_MAX_PACKET_SIZE];
+    uint32_t writerBest = UINT32_MAX, snprintfBest = UINT32_MAX;
+    generatedBest = UINT32_MAX;
+
+    for (uint32_t round = 0; round < REGISTRY_ROUNDS; round++) {
+        uint32_t start = ESP.getCycleCount();
+        for (int i = 0; i < iterations; i++) {
+            DataFormatter::toMQTTPayload("BENCH001", data, generatedPayload,
+                                         sizeof(generatedPayload));
+        }
+        uint32_t cycles = ESP.getCycleCount() - start;
+        if (cycles < generatedBest) generatedBest = cycles;
+
+        start = ESP.getCycleCount();
+        for (int i = 0; i < iterations; i++) {
+            handWrittenWriterPayload("BENCH001", data, writerPayload, sizeof(writerPayload));
+        }
+        cycles = ESP.getCycleCount() - start;
+        if (cycles < writerBest) writerBest = cycles;
+
+        start = ESP.getCycleCount();
+        for (int i = 0; i < iterations; i++) {
+            handWrittenPayload("BENCH001", data, handPayload, sizeof(handPayload));
+        }
+        cycles = ESP.getCycleCount() - start;
+        if (cycles < snprintfBest) snprintfBest = cycles;
+    }
+
+    bool identical = strcmp(generatedPayload, handPayload) == 0 &&
+                     strcmp(writerPayload, handPayload) == 0;
+    Serial.printf("  toMQTTPayload: generated %lu, hand-written %lu (one BufferWriter call) / "
+                  "%lu (snprintf) cyc/payload, %u bytes, output %s %s\n",
+                  (unsigned long)(generatedBest / iterations),
+                  (unsigned long)(writerBest / iterations),
+                  (unsigned long)(snprintfBest / iterations),
+                  (unsigned)strlen(generatedPayload), identical ? "identical" : "DIFFERS",
+                  registryVerdict(generatedBest, writerBest));
+
+    // JSON record and CSV row keep their original layout
+    static char json[1024], handJson[1024], csv[1024];
+    DataFormatter::toJSON(data, json, sizeof(json));
+    snprintf(handJson, sizeof(handJson), HAND_WRITTEN_JSON_FORMAT, HAND_WRITTEN_JSON_ARGS(data));
+    DataFormatter::toCSV(data, csv, sizeof(csv), true);
+    bool csvOk = strncmp(csv, HAND_WRITTEN_CSV_HEADER, sizeof(HAND_WRITTEN_CSV_HEADER) - 1) == 0;
+    Serial.printf("  toJSON nested objects %s, toCSV original columns first %s\n",
+                  strcmp(json, handJson) == 0 ? "OK" : "FAIL", csvOk ? "OK" : "FAIL");
+}
+
+// ============================================
+// Raw Sample Buffer
+// ============================================
+void benchSampleBuffer() {
+    Serial.printf("\n--- Sample buffer (%u samples, %u bytes) ---\n",
+                  (unsigned)SampleBuffer::CAPACITY, (unsigned)sizeof(SampleBuffer));
+
+    static SampleBuffer buffer;
+    static WeatherReading readings[SampleBuffer::CAPACITY];  // Array-of-structs comparison
+    DataAggregator aggregator;
+    aggregator.attachBuffer(&buffer);
+
+    seedSamples(5);
+    for (size_t i = 0; i < SampleBuffer::CAPACITY; i++) {
+        readings[i].isValid = true;
+        fillReading(readings[i], i);
+        aggregator.addSample(readings[i]);
+    }
+    AggregatedData live = aggregator.getAggregatedData();
+
+    // Single-field statistics: SoA scan vs strided array-of-structs scan
+    const int iterations = 1000;
+    RunningStats soa, aos;
+    uint32_t start = ESP.getCycleCount();
+    for (int k = 0; k < iterations; k++) {
+        soa.reset();
+        buffer.forEachValid(DataField::PRESSURE, [&soa](float v) { soa.add(v); });
+    }
+    uint32_t soaCycles = ESP.getCycleCount() - start;
+
+    start = ESP.getCycleCount();
+    for (int k = 0; k < iterations; k++) {
+        aos.reset();
+        for (size_t i = 0; i < SampleBuffer::CAPACITY; i++) {
+            if (readings[i].isValid) aos.add(readings[i].pressure);
+        }
+    }
+    uint32_t aosCycles = ESP.getCycleCount() - start;
+
+    Serial.printf("  pressure stats: SoA %lu, AoS %lu cycles/window (mean %.3f/%.3f)\n",
+                  (unsigned long)(soaCycles / iterations), (unsigned long)(aosCycles / iterations),
+                  soa.mean, aos.mean);
+
+    // Late QC decision: drop the hottest sample and rebuild the window
+    size_t hottest = 0;
+    for (size_t i = 1; i < buffer.size(); i++) {
+        if (buffer.getValue(DataField::TEMPERATURE, i) >
+            buffer.getValue(DataField::TEMPERATURE, hottest)) {
+            hottest = i;
+        }
+    }
+    buffer.invalidate(DataField::TEMPERATURE, hottest);
+
+    start = ESP.getCycleCount();
+    bool complete = aggregator.recompute();
+    uint32_t cycles = ESP.getCycleCount() - start;
+    AggregatedData rebuilt = aggregator.getAggregatedData();
+
+    Serial.printf("  recompute: %lu cycles (%s), temp max %.3f -> %.3f, pressure avg %.3f/%.3f\n",
+                  (unsigned long)cycles, complete ? "complete" : "partial",
+                  live.tempMax, rebuilt.tempMax, live.pressureAvg, rebuilt.pressureAvg);
+
+    // Window longer than the buffer: the count stays the true sample count
+    const size_t extra = 20;
+    WeatherReading reading;
+    reading.isValid = true;
+    for (size_t i = 0; i < extra; i++) {
+        fillReading(reading, SampleBuffer::CAPACITY + i);
+        aggregator.addSample(reading);
+    }
+    complete = aggregator.recompute();
+    Serial.printf("  overflow: %u samples, %u buffered, recompute %s %s\n",
+                  (unsigned)aggregator.getSampleCount(), (unsigned)buffer.size(),
+                  complete ? "complete" : "partial",
+                  !complete && aggregator.getSampleCount() == SampleBuffer::CAPACITY + extra &&
+                  buffer.size() == SampleBuffer::CAPACITY ? "OK" : "FAIL");
+}
+
+// ============================================
+// Wind Direction: Table/Polynomial vs libm
+// ============================================
+void benchWindDirection() {
+    Serial.println("\n--- Wind direction vector mean: fast path vs libm ---");
+
+    const uint32_t n = 100000;
+
+    // Per-sample accumulation, same direction sequence for both paths
+    seedSamples(3);
+    float sinSum = 0, cosSum = 0;
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < n; i++) {
+        uint16_t dir = (uint16_t)(200.0f + 60.0f * nextNoise());
+        float dirRad = dir * M_PI / 180.0f;
+        sinSum += sin(dirRad);
+        cosSum += cos(dirRad);
+    }
+    uint32_t libmCycles = ESP.getCycleCount() - start;
+
+    seedSamples(3);
+    int64_t sinQ = 0, cosQ = 0;
+    start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < n; i++) {
+        uint16_t dir = (uint16_t)(200.0f + 60.0f * nextNoise());
+        int16_t s, c;
+        fastSinCosDeg(dir, s, c);
+        sinQ += s;
+        cosQ += c;
+    }
+    uint32_t fastCycles = ESP.getCycleCount() - start;
+
+    Serial.printf("  accumulate: libm %.1f, table %.1f cyc/sample (incl. input generation)\n",
+                  (float)libmCycles / n, (float)fastCycles / n);
+
+    // atan2 over vectors at every 0.1 degree, radius 0.01 to 1000
+    const int steps = 3600;
+    volatile float sink = 0;
+    start = ESP.getCycleCount();
+    for (int i = 0; i < steps; i++) {
+        float a = i * 0.1f * M_PI / 180.0f;
+        sink = atan2(sinf(a), cosf(a));
+    }
+    uint32_t libmAtan = ESP.getCycleCount() - start;
+
+    start = ESP.getCycleCount();
+    for (int i = 0; i < steps; i++) {
+        float a = i * 0.1f * M_PI / 180.0f;
+        sink = fastAtan2Deg(sinf(a), cosf(a));
+    }
+    uint32_t fastAtan = ESP.getCycleCount() - start;
+    (void)sink;
+
+    float maxError = 0;
+    for (int i = 0; i < steps; i++) {
+        double deg = i * 0.1;
+        for (float radius = 0.01f; radius <= 1000.0f; radius *= 10.0f) {
+            float y = radius * sin(deg * M_PI / 180.0);
+            float x = radius * cos(deg * M_PI / 180.0);
+            double err = fabs(fastAtan2Deg(y, x) - deg);
+            if (err > 180.0) err = 360.0 - err;
+            if (err > maxError) maxError = err;
+        }
+    }
+
+    Serial.printf("  atan2: libm %lu, fast %lu cycles/call (incl. sinf/cosf input)\n",
+                  (unsigned long)(libmAtan / steps), (unsigned long)(fastAtan / steps));
+    Serial.printf("  fastAtan2Deg max error %.4f deg (bound %.2f, sensor %.1f)\n",
+                  maxError, FAST_ATAN2_MAX_ERROR_DEG, WIND_DIR_ACCURACY_DEG);
+
+    float libmMean = atan2(sinSum, cosSum) * 180.0f / M_PI;
+    if (libmMean < 0) libmMean += 360.0f;
+    Serial.printf("  window mean: libm %.3f deg, fast %.3f deg\n",
+                  libmMean, fastAtan2Deg((float)sinQ, (float)cosQ));
+}
+
+// ============================================
+// Microstation Table
+// ============================================
+static uint32_t flushedStations = 0;
+
+void countFlushed(const uint8_t*, const char*, const AggregatedData&, float, float) {
+    flushedStations++;
+}
+
+void benchStationTable() {
+    const int peers = STATION_TABLE_MAX_STATIONS;
+    const int rounds = 20;
+    Serial.printf("\n--- Station table (%d peers, %d slots, %u bytes) ---\n",
+                  peers, STATION_TABLE_SIZE, (unsigned)sizeof(StationTable));
+
+    static StationTable table;
+    table.clear();
+
+    // Simulated peers share one vendor prefix, like a batch of ESP32 boards
+    uint8_t macs[peers][6];
+    char ids[peers][9];
+    seedSamples(21);
+    for (int p = 0; p < peers; p++) {
+        uint32_t r = (uint32_t)((nextNoise() + 1.0f) * 0x7FFFFF);
+        uint8_t mac[6] = {0x24, 0x6F, 0x28, (uint8_t)(r >> 16), (uint8_t)(r >> 8), (uint8_t)p};
+        memcpy(macs[p], mac, 6);
+        snprintf(ids[p], sizeof(ids[p]), "%02X%02X%02X%02X", mac[2], mac[3], mac[4], mac[5]);
+    }
+
+    WeatherReading reading;
+    reading.isValid = true;
+
+    // Readings arrive in bursts smaller than the queue, drained by loop()
+    const int burst = STATION_QUEUE_SIZE;
+    uint32_t queueCycles = 0, drainCycles = 0;
+    for (int p = 0; p < peers; p++) {
+        fillReading(reading, p);
+        uint32_t start = ESP.getCycleCount();
+        table.addReading(macs[p], ids[p], reading);
+        queueCycles += ESP.getCycleCount() - start;
+        if ((p + 1) % burst == 0 || p + 1 == peers) {
+            start = ESP.getCycleCount();
+            table.drain();
+            drainCycles += ESP.getCycleCount() - start;
+        }
+    }
+    uint32_t insertCycles = drainCycles;
+
+    drainCycles = 0;
+    for (int r = 0; r < rounds; r++) {
+        for (int p = 0; p < peers; p++) {
+            fillReading(reading, p);
+            uint32_t start = ESP.getCycleCount();
+            table.addReading(macs[p], ids[p], reading);
+            queueCycles += ESP.getCycleCount() - start;
+            if ((p + 1) % burst == 0 || p + 1 == peers) {
+                start = ESP.getCycleCount();
+                table.drain();
+                drainCycles += ESP.getCycleCount() - start;
+            }
+        }
+    }
+    uint32_t updateCycles = drainCycles;
+
+    flushedStations = 0;
+    uint32_t start = ESP.getCycleCount();
+    table.flush(countFlushed);
+    uint32_t flushCycles = ESP.getCycleCount() - start;
+
+    Serial.printf("  callback (queue) %lu, insert %lu, update %lu cycles/reading "
+                  "(incl. addSample), avg probes %.2f\n",
+                  (unsigned long)(queueCycles / ((rounds + 1) * peers)),
+                  (unsigned long)(insertCycles / peers),
+                  (unsigned long)(updateCycles / (rounds * peers)),
+                  table.getAverageProbes());
+    Serial.printf("  flush %lu cycles for %lu stations, %u tracked, %lu dropped %s\n",
+                  (unsigned long)flushCycles, (unsigned long)flushedStations,
+                  (unsigned)table.getStationCount(), (unsigned long)table.getDroppedCount(),
+                  flushedStations == (uint32_t)peers && table.getDroppedCount() == 0 ? "OK" : "FAIL");
+
+    // A burst larger than the queue: the overflow is counted
+    for (int p = 0; p < STATION_QUEUE_SIZE + 4; p++) {
+        table.addReading(macs[p % peers], ids[p % peers], reading);
+    }
+    uint32_t overflow = table.getDroppedCount();
+    flushedStations = 0;
+    table.flush(countFlushed);
+    Serial.printf("  burst of %d: %lu dropped %s\n", STATION_QUEUE_SIZE + 4,
+                  (unsigned long)overflow, overflow == 4 ? "OK" : "FAIL");
+
+    // Stations go quiet: all are dropped after STATION_STALE_FLUSHES empty flushes
+    for (int f = 0; f < STATION_STALE_FLUSHES; f++) {
+        table.flush(countFlushed);
+    }
+    Serial.printf("  after %d empty flushes: %u tracked\n",
+                  STATION_STALE_FLUSHES, (unsigned)table.getStationCount());
+}
+
+// ============================================
+// Sliding Window
+// ============================================
+void benchSlidingCase(uint32_t windowMs) {
+    static SlidingWindow window;
+    window.setWindowMs(windowMs);
+
+    // Keep the raw pressure and temperature streams to check against a full rescan
+    static float history[4 * ROLLING_WINDOW_SAMPLES];
+    static float tempHistory[4 * ROLLING_WINDOW_SAMPLES];
+    const uint32_t n = 4 * ROLLING_WINDOW_SAMPLES;
+    WeatherReading reading;
+    reading.isValid = true;
+
+    seedSamples(17);
+    uint32_t cycles = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        fillReading(reading, i);
+        reading.timestamp = i * SAMPLE_INTERVAL_MS;
+        history[i] = reading.pressure;
+        tempHistory[i] = reading.temperature;
+
+        uint32_t start = ESP.getCycleCount();
+        window.addSample(reading);
+        cycles += ESP.getCycleCount() - start;
+    }
+
+    size_t count = window.getSampleCount();
+    double ref = 0;
+    float refMin = history[n - count], refMax = history[n - count];
+    for (uint32_t i = n - count; i < n; i++) {
+        ref += history[i];
+        if (history[i] < refMin) refMin = history[i];
+        if (history[i] > refMax) refMax = history[i];
+    }
+    ref /= count;
+
+    // Nearest-rank quantiles of the sorted window
+    static float sorted[ROLLING_WINDOW_SAMPLES];
+    memcpy(sorted, tempHistory + n - count, count * sizeof(float));
+    std::sort(sorted, sorted + count);
+    float refP05 = sorted[(size_t)(0.05f * (count - 1) + 0.5f)];
+    float refP50 = sorted[(size_t)(0.50f * (count - 1) + 0.5f)];
+    float refP95 = sorted[(size_t)(0.95f * (count - 1) + 0.5f)];
+
+    uint32_t start = ESP.getCycleCount();
+    AggregatedData data = window.getAggregatedData();
+    uint32_t readCycles = ESP.getCycleCount() - start;
+    bool quantilesOk = data.tempP05 == refP05 && data.tempMedian == refP50 &&
+                       data.tempP95 == refP95;
+    Serial.printf("  %6lu ms window: %3u samples, %.1f cyc/sample, "
+                  "pressure avg err %.2e, min/max %s\n",
+                  (unsigned long)windowMs, (unsigned)count, (float)cycles / n,
+                  fabs(data.pressureAvg - ref),
+                  (data.pressureMin == refMin && data.pressureMax == refMax) ? "exact" : "WRONG");
+    Serial.printf("  %6s    report: %lu cyc, temperature quantiles %s\n", "",
+                  (unsigned long)readCycles, quantilesOk ? "OK" : "FAIL");
+}
+
+void benchSlidingWindow() {
+    Serial.printf("\n--- Sliding window (capacity %u, %u bytes) ---\n",
+                  (unsigned)SlidingWindow::CAPACITY, (unsigned)sizeof(SlidingWindow));
+
+    // Per-sample cost should not grow with the window length
+    benchSlidingCase(ROLLING_WINDOW_MS / 10);
+    benchSlidingCase(ROLLING_WINDOW_MS / 2);
+    benchSlidingCase(ROLLING_WINDOW_MS);
+
+    // QC-flagged spikes stay out of the flagged field only
+    static SlidingWindow flagged;
+    flagged.setWindowMs(ROLLING_WINDOW_MS);
+    WeatherReading reading;
+    reading.isValid = true;
+    seedSamples(19);
+    double tempSum = 0;
+    uint32_t tempCount = 0;
+    float tempMax = -1000;
+    for (uint32_t i = 0; i < ROLLING_WINDOW_SAMPLES; i++) {
+        fillReading(reading, i);
+        reading.timestamp = i * SAMPLE_INTERVAL_MS;
+        QCResult qc;
+        if (i % 10 == 5) {
+            reading.temperature = 85.0f;
+            qc.flags[(uint8_t)DataField::TEMPERATURE] = QC_RANGE;
+            qc.validMask &= ~FIELD_BIT(TEMPERATURE);
+        } else {
+            tempSum += reading.temperature;
+            tempCount++;
+            if (reading.temperature > tempMax) tempMax = reading.temperature;
+        }
+        flagged.addSample(reading, qc);
+    }
+    AggregatedData data = flagged.getAggregatedData();
+    bool flaggedOk = fabs(data.tempAvg - tempSum / tempCount) < 1e-3 && data.tempMax == tempMax &&
+                     data.tempP95 < 85.0f && data.sampleCount == ROLLING_WINDOW_SAMPLES &&
+                     data.pressureMax > 0;
+    Serial.printf("  QC-flagged temperature spikes: max %.2f, avg err %.2e %s\n",
+                  data.tempMax, fabs(data.tempAvg - tempSum / tempCount), flaggedOk ? "OK" : "FAIL");
+}
+
+// ============================================
+// Wind Products
+// ============================================
+void benchWindProducts() {
+    Serial.printf("\n--- Wind products (%u bytes, %u Hz) ---\n",
+                  (unsigned)sizeof(WindProducts), (unsigned)(1000 / WIND_SAMPLE_INTERVAL_MS));
+
+    static WindProducts wind;
+    wind.reset();
+
+    // 11 minutes of 5 m/s easterly wind with light noise and a 4-s,
+    // 15 m/s southerly burst 5 minutes in; the burst is the only
+    // complete 3-s window above 5.5 m/s, so the gust must equal it
+    const uint32_t n = (WIND_MEAN_LONG_MS + 60000) / WIND_SAMPLE_INTERVAL_MS;
+    const uint32_t burstStart = 300000 / WIND_SAMPLE_INTERVAL_MS;
+    const uint32_t burstLen = 4000 / WIND_SAMPLE_INTERVAL_MS;
+    double speedSum = 0;
+    uint32_t speedCount = 0;
+    uint32_t lastBlockEnd = (n * WIND_SAMPLE_INTERVAL_MS / WIND_BLOCK_MS) * WIND_BLOCK_MS;
+
+    seedSamples(23);
+    uint32_t cycles = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        bool burst = i >= burstStart && i < burstStart + burstLen;
+        float speed = burst ? 15.0f : 5.0f + 0.5f * nextNoise();
+        uint16_t direction = burst ? 180 : 90;
+        uint32_t t = i * WIND_SAMPLE_INTERVAL_MS;
+
+        // Reference scalar mean over the last complete 10-minute period
+        if (t < lastBlockEnd && t >= lastBlockEnd - WIND_MEAN_LONG_MS) {
+            speedSum += speed;
+            speedCount++;
+        }
+
+        uint32_t start = ESP.getCycleCount();
+        wind.addSample(speed, direction, t);
+        cycles += ESP.getCycleCount() - start;
+    }
+
+    uint32_t start = ESP.getCycleCount();
+    WindProductsData data = wind.getProducts();
+    uint32_t productCycles = ESP.getCycleCount() - start;
+
+    Serial.printf("  addSample: %.1f cyc/sample, getProducts: %lu cyc\n",
+                  (float)cycles / n, (unsigned long)productCycles);
+    Serial.printf("  gust %.2f m/s from %u deg (expect 15.00 from 180) %s\n",
+                  data.gust, data.gustDirection,
+                  (data.gustValid && fabsf(data.gust - 15.0f) < 0.01f &&
+                   data.gustDirection == 180) ? "OK" : "WRONG");
+    Serial.printf("  2-min:  scalar %.2f vector %.2f m/s from %u deg (expect ~5 from 90) %s\n",
+                  data.mean2min.scalarSpeed, data.mean2min.vectorSpeed, data.mean2min.direction,
+                  (data.mean2min.valid && data.mean2min.direction == 90) ? "OK" : "WRONG");
+    Serial.printf("  10-min: scalar %.3f m/s (reference %.3f), vector %.2f m/s from %u deg\n",
+                  data.mean10min.scalarSpeed, speedSum / speedCount,
+                  data.mean10min.vectorSpeed, data.mean10min.direction);
+
+    // Opposing winds: the vector mean cancels, the scalar mean does not
+    wind.reset();
+    for (uint32_t i = 0; i < WIND_MEAN_SHORT_MS / WIND_SAMPLE_INTERVAL_MS + 40; i++) {
+        wind.addSample(5.0f, (i & 1) ? 0 : 180, i * WIND_SAMPLE_INTERVAL_MS);
+    }
+    data = wind.getProducts();
+    Serial.printf("  N/S alternating: scalar %.2f, vector %.3f m/s %s\n",
+                  data.mean2min.scalarSpeed, data.mean2min.vectorSpeed,
+                  (data.mean2min.valid && data.mean2min.vectorSpeed < 0.01f) ? "OK" : "WRONG");
+}
+
+// ============================================
+// Quality Control
+// ============================================
+
+// Slow triangle wave so step and persistence checks see a healthy signal
+float triangle(uint32_t i) {
+    uint32_t p = i % 1000;
+    return 0.001f * (float)(p < 500 ? p : 1000 - p);
+}
+
+// Healthy readings: fillReading() noise is too fast for the step limits
+void fillSmooth(WeatherReading& reading, uint32_t i) {
+    fillReading(reading, i);
+    reading.timestamp = i * SAMPLE_INTERVAL_MS;
+    reading.temperature = 20.0f + triangle(i);
+    reading.humidity = 50.0f + triangle(i + 250);
+    reading.pressure = 1013.25f + triangle(i);
+    reading.gasResistance = 100.0f + triangle(i + 500);
+    reading.solarIrradiance = 158.0f + triangle(i + 750);
+}
+
+void benchQualityControl() {
+    Serial.println("\n--- Quality control ---");
+
+    static QualityControl qc;
+    WeatherReading reading;
+    reading.isValid = true;
+
+    // Per-sample cost of check() on clean data
+    const uint32_t n = 100000;
+    qc.reset();
+    seedSamples(29);
+    uint32_t qcCycles = 0;
+    uint32_t flagged = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        fillSmooth(reading, i);
+
+        uint32_t start = ESP.getCycleCount();
+        QCResult result = qc.check(reading, QC_ALL_FIELDS);
+        qcCycles += ESP.getCycleCount() - start;
+        if (result.validMask != QC_ALL_FIELDS) flagged++;
+    }
+    Serial.printf("  check(): %.1f cyc/sample, %lu of %lu clean samples flagged\n",
+                  (float)qcCycles / n, (unsigned long)flagged, (unsigned long)n);
+
+    // Injected faults:
+    //   i = 100        temperature spike to -99 C   -> RANGE, CONSISTENCY on the other BME680 fields
+    //   i = 200..      temperature jumps +5 C       -> one STEP flag
+    //   i = 300..2299  pressure stuck for 100 min   -> PERSISTENCE after 60 minutes
+    //   i = 2500       wind sensor read fails       -> MISSING speed and direction,
+    //                                                  CONSISTENCY on direction
+    static DataAggregator aggregator;
+    aggregator.reset();
+    qc.reset();
+    const uint32_t m = 3000;
+    // The healthy value at i = 2300 equals the stuck one, so 2001 samples persist
+    const uint32_t expectPersist = 2001 - 60UL * 60000UL / SAMPLE_INTERVAL_MS;
+    double tempSum = 0;
+    uint32_t tempCount = 0;
+    uint32_t cycles = 0;
+    for (uint32_t i = 0; i < m; i++) {
+        fillSmooth(reading, i);
+        if (i >= 200) reading.temperature += 5.0f;
+        if (i == 100) reading.temperature = -99.0f;
+        if (i >= 300 && i < 2300) reading.pressure = 1013.25f + triangle(300);
+
+        uint32_t mask = QC_ALL_FIELDS;
+        if (i == 2500) mask &= ~(FIELD_BIT(WIND_SPEED) | FIELD_BIT(WIND_DIRECTION));
+
+        uint32_t start = ESP.getCycleCount();
+        QCResult result = qc.check(reading, mask);
+        aggregator.addSample(reading, result);
+        cycles += ESP.getCycleCount() - start;
+
+        if (result.passed(DataField::TEMPERATURE)) {
+            tempSum += reading.temperature;
+            tempCount++;
+        }
+    }
+
+    AggregatedData data = aggregator.getAggregatedData();
+    Serial.printf("  check() + addSample(): %.1f cyc/sample\n", (float)cycles / m);
+    Serial.printf("  flags: missing %lu (expect 2), range %lu (expect 1), step %lu (expect 1),\n"
+                  "         persistence %lu (expect %lu), consistency %lu (expect 4)\n",
+                  (unsigned long)data.qcFlagCounts[0], (unsigned long)data.qcFlagCounts[1],
+                  (unsigned long)data.qcFlagCounts[2], (unsigned long)data.qcFlagCounts[3],
+                  (unsigned long)expectPersist, (unsigned long)data.qcFlagCounts[4]);
+    Serial.printf("  temp rejected %lu, avg %.4f (reference %.4f), min %.2f %s\n",
+                  (unsigned long)data.qcRejected[(uint8_t)DataField::TEMPERATURE],
+                  data.tempAvg, tempSum / tempCount, data.tempMin,
+                  data.tempMin > 0 ? "OK" : "WRONG");
+}
+
+// ============================================
+// Derived Variables
+// ============================================
+void benchDerived() {
+    Serial.println("\n--- Derived variables ---");
+
+    static DerivedVariables derived;
+    derived.setElevation(320);
+
+    // Cold: every value recomputed after new inputs; cached: repeat request
+    const uint32_t n = 1000;
+    uint32_t coldCycles = 0, cachedCycles = 0;
+    volatile float sink = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        derived.update(20.0f + 0.001f * i, 50.0f, 980.0f, 3.0f);
+
+        uint32_t start = ESP.getCycleCount();
+        sink = derived.getAll().dewPoint;
+        coldCycles += ESP.getCycleCount() - start;
+
+        start = ESP.getCycleCount();
+        sink = derived.getAll().dewPoint;
+        cachedCycles += ESP.getCycleCount() - start;
+    }
+
+    // What the SGP30 humidity compensation used to cost on every sample
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < n; i++) {
+        sink = DerivedVariables::absoluteHumidity(20.0f + 0.001f * i, 50.0f);
+    }
+    uint32_t ahCycles = ESP.getCycleCount() - start;
+    (void)sink;
+
+    Serial.printf("  getAll(): %lu cyc after new inputs, %lu cyc cached\n",
+                  (unsigned long)(coldCycles / n), (unsigned long)(cachedCycles / n));
+    Serial.printf("  absolute humidity (formerly per sample): %lu cyc\n",
+                  (unsigned long)(ahCycles / n));
+
+    // Reference values: NWS heat index table, Environment Canada wind
+    // chill table, Magnus dew point, hypsometric reduction
+    derived.update(30.0f, 70.0f, 1000.0f, 0.0f);
+    DerivedData hot = derived.getAll();
+    derived.update(-10.0f, 50.0f, 1000.0f, 20.0f / 3.6f);
+    DerivedData cold = derived.getAll();
+
+    Serial.printf("  30 C / 70%%: dew point %.2f (ref 23.93), heat index %.2f (ref 35.0)\n",
+                  hot.dewPoint, hot.heatIndex);
+    Serial.printf("  30 C / 70%%: abs. humidity %.2f g/m3 (ref 21.2), "
+                  "1000 hPa at 320 m -> %.2f hPa (ref 1036.6)\n",
+                  hot.absoluteHumidity, hot.seaLevelPressure);
+    Serial.printf("  -10 C / 20 km/h: wind chill %.2f (ref -17.9)\n", cold.windChill);
+}
+
+// ============================================
+// Wind Rose
+// ============================================
+
+void benchWindRose() {
+    Serial.println("\n--- Wind rose ---");
+
+    // Per-sample cost inside addSample (rose on) vs the bare rose update
+    const uint32_t n = 100000;
+    static WindRose rose;
+    seedSamples(23);
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < n; i++) {
+        rose.add(6.0f + 6.0f * nextNoise(), (uint16_t)(i % 360));
+    }
+    uint32_t roseCycles = ESP.getCycleCount() - start;
+    Serial.printf("  add: %.1f cyc/sample, %u bytes\n",
+                  (float)roseCycles / n, (unsigned)sizeof(WindRose));
+
+    // Sector boundaries: 22.5-degree sectors centred on the compass points
+    static const uint16_t DIRS[] = { 0, 11, 12, 33, 34, 320, 326, 327, 348, 349, 359 };
+    static const uint8_t SECTORS[] = { 0, 0, 1, 1, 2, 14, 14, 15, 15, 0, 0 };
+    bool sectorsOk = true;
+    for (uint8_t i = 0; i < sizeof(DIRS) / sizeof(DIRS[0]); i++) {
+        if (WindRose::sectorOf(DIRS[i]) != SECTORS[i]) sectorsOk = false;
+    }
+    Serial.printf("  sector boundaries %s\n", sectorsOk ? "OK" : "WRONG");
+
+    // Bimodal wind: N and S alternating. The vector mean is meaningless,
+    // the rose shows both lobes. Two windows merged equal one long window.
+    DataAggregator first, second, whole;
+    WeatherReading reading;
+    reading.isValid = true;
+    for (uint32_t i = 0; i < 200; i++) {
+        reading.windSpeed = (i % 2) ? 3.0f : 7.0f;
+        reading.windDirection = (i % 2) ? 180 : 0;
+        if (i % 10 == 0) reading.windSpeed = 0.2f;    // Calm
+        (i < 100 ? first : second).addSample(reading);
+        whole.addSample(reading);
+    }
+    AggregatedData merged = first.getAggregatedData();
+    DataAggregator::merge(merged, second.getAggregatedData());
+    AggregatedData exact = whole.getAggregatedData();
+    bool mergeOk = memcmp(&merged.windRose, &exact.windRose, sizeof(WindRose)) == 0;
+    Serial.printf("  N %lu (7 m/s class %u), S %lu (3 m/s class %u), calm %u; "
+                  "merge %s\n",
+                  (unsigned long)exact.windRose.sectorTotal(0), exact.windRose.counts[0][3],
+                  (unsigned long)exact.windRose.sectorTotal(8), exact.windRose.counts[8][1],
+                  exact.windRose.calm, mergeOk ? "exact" : "DIFFERS");
+    Serial.printf("  (expect N 80 / class 80, S 100 / class 100, calm 20)\n");
+
+    // Payload size. Worst case: a day of samples spread over every bin,
+    // with realistic field values, wind products and derived values
+    static AggregatedData full;
+    WeatherReading typicalReading;
+    fillReading(typicalReading, 0);
+    typicalReading.isValid = true;
+    DataAggregator filler;
+    for (uint32_t i = 0; i < 100; i++) filler.addSample(typicalReading);
+    full = filler.getAggregatedData();
+    const uint16_t perBin = (uint16_t)(86400000UL / SAMPLE_INTERVAL_MS /
+                                       (WindRose::SECTORS * WindRose::SPEED_CLASSES + 1));
+    for (uint8_t s = 0; s < WindRose::SECTORS; s++) {
+        for (uint8_t c = 0; c < WindRose::SPEED_CLASSES; c++) full.windRose.counts[s][c] = perBin;
+    }
+    full.windRose.calm = perBin;
+
+    WindProductsData wind;
+    wind.gust = 12.5f;
+    wind.gustDirection = 270;
+    wind.gustValid = true;
+    wind.mean2min.scalarSpeed = 5.25f;
+    wind.mean2min.vectorSpeed = 4.75f;
+    wind.mean2min.direction = 265;
+    wind.mean2min.valid = true;
+    wind.mean10min = wind.mean2min;
+    DerivedData derivedData;
+    derivedData.validMask = (1 << (uint8_t)DerivedField::COUNT) - 1;
+
+    static char payload[MQTT_MAX_PACKET_SIZE];
+    size_t typical = DataFormatter::toMQTTPayload("BENCH001", exact, payload, sizeof(payload));
+    size_t worst = DataFormatter::toMQTTPayload("BENCH001", full, payload, sizeof(payload),
+                                                &wind, &derivedData);
+    Serial.printf("  payload: bimodal window %u bytes, full day rose + products %u bytes "
+                  "(limit %u) %s\n", (unsigned)typical, (unsigned)worst,
+                  (unsigned)MQTT_MAX_PACKET_SIZE, worst < MQTT_MAX_PACKET_SIZE ? "OK" : "TOO LARGE");
+}
+
+// ============================================
+// Report Compression
+// ============================================
+
+// One window of a calm day: slow diurnal cycles plus sensor noise
+void fillCalmWindow(DataAggregator& aggregator, uint32_t window) {
+    WeatherReading reading;
+    reading.isValid = true;
+    for (uint32_t i = 0; i < MAX_SAMPLES_PER_INTERVAL; i++) {
+        float hour = (window * MAX_SAMPLES_PER_INTERVAL + i) * (SAMPLE_INTERVAL_MS / 3600000.0f);
+        float day = sinf((hour - 9.0f) * (float)M_PI / 12.0f);  // Peaks at 15:00
+        float sun = sinf((hour - 6.0f) * (float)M_PI / 12.0f);
+        if (sun < 0) sun = 0;
+
+        reading.temperature = 15.0f + 6.0f * day + 0.1f * nextNoise();
+        reading.humidity = 60.0f - 15.0f * day + 0.5f * nextNoise();
+        reading.pressure = 1012.0f + 0.8f * sinf(hour * (float)M_PI / 6.0f) + 0.05f * nextNoise();
+        reading.gasResistance = 120.0f + 2.0f * nextNoise();
+        reading.windSpeed = 1.0f + 0.1f * nextNoise();
+        reading.windDirection = (uint16_t)(200 + (int)(2.0f * nextNoise()));
+        reading.precipitation = 0;
+        reading.lux = (uint32_t)(60000.0f * sun);
+        reading.solarIrradiance = 60000.0f * sun * LUX_TO_WM2;
+        reading.co2 = (uint16_t)(415 + (int)(3.0f * nextNoise()));
+        reading.tvoc = (uint16_t)(12 + (int)(2.0f * nextNoise()));
+        aggregator.addSample(reading);
+    }
+}
+
+void benchReportCompression() {
+    Serial.println("\n--- Report compression (calm day, 5-min reports) ---");
+
+    const uint32_t windows = 86400000UL / AGGREGATION_WINDOW_MS;
+    ReportCompressor compressor;
+    DerivedVariables derived;
+    DataAggregator aggregator;
+    static AggregatedData held;                   // What the backend holds
+    static char payload[MQTT_MAX_PACKET_SIZE];
+
+    uint32_t fullBytes = 0, compressedBytes = 0, keyframes = 0, fieldsSent = 0;
+    uint32_t selectCycles = 0;
+    float worstRatio = 0;                         // Max |error| / dead-band
+    seedSamples(31);
+
+    for (uint32_t w = 0; w < windows; w++) {
+        aggregator.reset();
+        fillCalmWindow(aggregator, w);
+        AggregatedData data = aggregator.getAggregatedData();
+        derived.update(data);
+        DerivedData derivedData = derived.getAll();
+
+        fullBytes += DataFormatter::toMQTTPayload("BENCH001", data, payload, sizeof(payload),
+                                                  nullptr, &derivedData);
+
+        uint32_t start = ESP.getCycleCount();
+        ReportSelection selection = compressor.select(data);
+        selectCycles += ESP.getCycleCount() - start;
+        compressedBytes += DataFormatter::toMQTTPayload("BENCH001", data, payload,
+                                                        sizeof(payload), nullptr,
+                                                        &derivedData, &selection);
+        if (selection.keyframe) keyframes++;
+
+        // Backend: take the sent fields, keep the rest, then compare
+#define HOLD_STATS(p) held.p##Avg = data.p##Avg; held.p##Min = data.p##Min; held.p##Max = data.p##Max;
+#define HOLD_CIRCULAR(p) held.p##Avg = data.p##Avg;
+#define HOLD_LATEST(p) held.p = data.p;
+#define HOLD_QUANTILES(p) held.p##P05 = data.p##P05; held.p##Median = data.p##Median; held.p##P95 = data.p##P95;
+#define HOLD_NONE(p)
+#define RATIO(id, a, b) { \
+        float err = fabsf((float)(a) - (float)(b)); \
+        if ((DataField::id) == DataField::WIND_DIRECTION && err > 180.0f) err = 360.0f - err; \
+        float ratio = err / ReportCompressor::tolerance(DataField::id, (float)(b)); \
+        if (ratio > worstRatio) worstRatio = ratio; \
+    }
+#define CHECK_STATS(id, p) RATIO(id, data.p##Avg, held.p##Avg) RATIO(id, data.p##Min, held.p##Min) \
+    RATIO(id, data.p##Max, held.p##Max)
+#define CHECK_CIRCULAR(id, p) RATIO(id, data.p##Avg, held.p##Avg)
+#define CHECK_LATEST(id, p) RATIO(id, data.p, held.p)
+#define CHECK_QUANTILES(id, p) RATIO(id, data.p##P05, held.p##P05) \
+    RATIO(id, data.p##Median, held.p##Median) RATIO(id, data.p##P95, held.p##P95)
+#define CHECK_NONE(id, p)
+#define RECONSTRUCT(id, member, prefix, type, kind, quant, ...) \
+        if (selection.fieldMask & FIELD_BIT(id)) { \
+            fieldsSent++; \
+            HOLD_##kind(prefix) HOLD_##quant(prefix) \
+        } \
+        CHECK_##kind(id, prefix) CHECK_##quant(id, prefix)
+        WEATHER_FIELDS(RECONSTRUCT)
+    }
+
+    Serial.printf("  %lu reports: full %lu bytes, compressed %lu bytes (%.0f%% saved)\n",
+                  (unsigned long)windows, (unsigned long)fullBytes,
+                  (unsigned long)compressedBytes,
+                  100.0f * (1.0f - (float)compressedBytes / fullBytes));
+    Serial.printf("  %lu keyframes, %.1f of %u fields per report, select %lu cyc\n",
+                  (unsigned long)keyframes, (float)fieldsSent / windows,
+                  WEATHER_FIELD_COUNT, (unsigned long)(selectCycles / windows));
+    Serial.printf("  worst reconstruction error: %.2f x dead-band %s\n",
+                  worstRatio, worstRatio <= 1.0f ? "OK" : "EXCEEDED");
+}
+
+// ============================================
+// Event Lane
+// ============================================
+
+// Count queued events of one rule, emptying the queue
+uint32_t drainEvents(EventDetector& detector, const char* name, WeatherEvent* last = nullptr) {
+    uint32_t count = 0;
+    WeatherEvent event;
+    while (detector.pop(event)) {
+        if (strcmp(detector.getRule(event.rule)->name, name) == 0) count++;
+        if (last) *last = event;
+    }
+    return count;
+}
+
+void benchEvents() {
+    Serial.println("\n--- Event lane (detection, holdoff, rate limit) ---");
+
+    EventDetector detector;
+    WeatherReading reading;
+    seedSamples(37);
+    fillSmooth(reading, 0);
+    reading.precipitation = 0;
+    uint32_t now = 0;
+
+    // Gust: 10 min of breeze, then 2 min above EVENT_GUST_MS
+    uint32_t gustAt = 600000, firstGust = 0, gusts = 0;
+    for (; now < 720000; now += SAMPLE_INTERVAL_MS) {
+        reading.windSpeed = now < gustAt ? 6.0f + nextNoise() : EVENT_GUST_MS + 2.0f;
+        detector.check(reading, QC_ALL_FIELDS, now);
+        uint32_t n = drainEvents(detector, "gust");
+        if (n && !gusts) firstGust = now;
+        gusts += n;
+    }
+    Serial.printf("  gust: %lu event(s), latency %lu ms %s\n", (unsigned long)gusts,
+                  (unsigned long)(firstGust - gustAt),
+                  gusts == 1 && firstGust == gustAt ? "OK" : "FAIL");
+
+    // Same gust flagged by QC (spike): no event
+    EventDetector gated;
+    uint32_t flagged = 0;
+    for (uint32_t t = 0; t < 720000; t += SAMPLE_INTERVAL_MS) {
+        reading.windSpeed = t < gustAt ? 6.0f : EVENT_GUST_MS + 2.0f;
+        uint32_t mask = t < gustAt ? QC_ALL_FIELDS : QC_ALL_FIELDS & ~FIELD_BIT(WIND_SPEED);
+        gated.check(reading, mask, t);
+        flagged += drainEvents(gated, "gust");
+    }
+    Serial.printf("  QC-flagged gust: %lu event(s) %s\n", (unsigned long)flagged,
+                  flagged == 0 ? "OK" : "FAIL");
+
+    // Rain onset: dry for two hours, then one tip every minute for 30 min
+    reading.windSpeed = 3.0f;
+    uint32_t rainAt = now + 2 * EVENT_RAIN_DRY_MS, onsets = 0, firstOnset = 0;
+    float lastTip = 0;
+    for (; now < rainAt + 1800000; now += SAMPLE_INTERVAL_MS) {
+        if (now >= rainAt && now - lastTip >= 60000) {
+            reading.precipitation += PRECIP_RESOLUTION_MM;
+            lastTip = now;
+        }
+        detector.check(reading, QC_ALL_FIELDS, now);
+        uint32_t n = drainEvents(detector, "rain_onset");
+        if (n && !onsets) firstOnset = now;
+        onsets += n;
+    }
+    Serial.printf("  rain onset: %lu event(s), latency %lu ms %s\n", (unsigned long)onsets,
+                  (unsigned long)(firstOnset - rainAt),
+                  onsets == 1 && firstOnset == rainAt ? "OK" : "FAIL");
+
+    // Pressure jump: 2 hPa over 10 min (squall line)
+    uint32_t jumpAt = now + 1800000, jumps = 0;
+    float base = reading.pressure;
+    for (; now < jumpAt + 1800000; now += SAMPLE_INTERVAL_MS) {
+        float ramp = now < jumpAt ? 0 : (now - jumpAt) / 600000.0f;
+        reading.pressure = base + 2.0f * (ramp > 1.0f ? 1.0f : ramp);
+        detector.check(reading, QC_ALL_FIELDS, now);
+        jumps += drainEvents(detector, "pressure_jump");
+    }
+    Serial.printf("  pressure jump: %lu event(s) %s\n", (unsigned long)jumps,
+                  jumps == 1 ? "OK" : "FAIL");
+
+    // Flapping gust: holdoff limits it to one event per EVENT_HOLDOFF_MS
+    uint32_t flapEnd = now + 3600000, flaps = 0;
+    for (; now < flapEnd; now += SAMPLE_INTERVAL_MS) {
+        reading.windSpeed = (now / SAMPLE_INTERVAL_MS) % 2 ? EVENT_GUST_MS + 1.0f : 5.0f;
+        detector.check(reading, QC_ALL_FIELDS, now);
+        flaps += drainEvents(detector, "gust");
+    }
+    uint32_t flapLimit = 3600000 / EVENT_HOLDOFF_MS;
+    Serial.printf("  flapping gust, 1 h: %lu event(s), limit %lu %s\n", (unsigned long)flaps,
+                  (unsigned long)flapLimit, flaps <= flapLimit ? "OK" : "FAIL");
+
+    // Storm of forwarded events: bucket passes a burst, counts the rest
+    now += EVENT_BUCKET_SIZE * EVENT_BUCKET_REFILL_MS;   // Refill
+    WeatherEvent forwarded;
+    strcpy(forwarded.stationId, "A1B2C3D4");
+    uint32_t accepted = 0;
+    for (uint32_t i = 0; i < 100; i++) {
+        if (detector.enqueue(forwarded, now + i * 100)) accepted++;
+        drainEvents(detector, "gust");
+    }
+    now += EVENT_BUCKET_REFILL_MS;
+    detector.enqueue(forwarded, now);
+    WeatherEvent next;
+    drainEvents(detector, "gust", &next);
+    Serial.printf("  100 events in 10 s: %lu sent, next carries %u suppressed %s\n",
+                  (unsigned long)accepted, next.suppressed,
+                  accepted == EVENT_BUCKET_SIZE && next.suppressed == 100 - accepted ? "OK" : "FAIL");
+
+    // Link down: peek() keeps events queued, the overflow is counted
+    EventDetector offline;
+    uint32_t offlineAt = EVENT_BUCKET_SIZE * EVENT_BUCKET_REFILL_MS;
+    WeatherEvent head, first;
+    forwarded.timestamp = 1;
+    offline.enqueue(forwarded, offlineAt);
+    forwarded.timestamp = 2;
+    for (uint32_t i = 0; i < 2 * EVENT_QUEUE_SIZE; i++) {
+        offline.enqueue(forwarded, offlineAt + (i + 1) * EVENT_BUCKET_REFILL_MS);
+        offline.peek(head);
+    }
+    uint32_t queued = 0;
+    offline.pop(first);
+    while (offline.pop(next)) queued++;
+    bool kept = head.timestamp == 1 && first.timestamp == 1 && queued + 1 == EVENT_QUEUE_SIZE;
+    Serial.printf("  link down: %lu queued, %lu dropped, oldest kept %s\n",
+                  (unsigned long)(queued + 1), (unsigned long)offline.getDroppedCount(),
+                  kept && offline.getDroppedCount() == EVENT_QUEUE_SIZE + 1 ? "OK" : "FAIL");
+
+    // Per-sample cost on quiet samples
+    EventDetector quiet;
+    const uint32_t n = 10000;
+    reading.windSpeed = 3.0f;
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < n; i++) {
+        reading.temperature = 20.0f + 0.01f * (i % 100);
+        quiet.check(reading, QC_ALL_FIELDS, i * SAMPLE_INTERVAL_MS);
+    }
+    uint32_t cycles = ESP.getCycleCount() - start;
+    uint8_t rules = 0;
+    while (quiet.getRule(rules)) rules++;
+    Serial.printf("  check(): %lu cyc/sample (%u rules)\n", (unsigned long)(cycles / n), rules);
+}
+
+// ============================================
+// Spike Filter
+// ============================================
+
+// Ten minutes of wind at rateHz: 5 m/s breeze, a real 6-s gust to 14 m/s
+// at 5 min, and a flex-sensor spike to 60 m/s every 37 s (two readings
+// long every other time when there is more than one reading per second)
+void benchSpikeCase(uint32_t rateHz, uint8_t window) {
+    HampelFilter filter(window, WIND_SPIKE_MIN_MS);
+    const uint32_t n = 600 * rateHz;
+    const uint32_t spikeEvery = 37 * rateHz;
+    uint32_t cycles = 0, injected = 0, caught = 0, falseRejects = 0;
+    float cleanMax = 0, rawMax = 0, filteredMax = 0;
+    seedSamples(41);
+
+    for (uint32_t i = 0; i < n; i++) {
+        float t = (float)i / rateHz;
+        float clean = 5.0f + 0.3f * nextNoise();
+        if (t >= 300.0f && t < 306.0f) clean = 14.0f + 0.3f * nextNoise();
+
+        float raw = clean;
+        uint32_t phase = i % spikeEvery;
+        bool spike = phase == spikeEvery / 2 ||
+                     (rateHz > 1 && (i / spikeEvery) % 2 && phase == spikeEvery / 2 + 1);
+        if (spike) {
+            raw = 60.0f;
+            injected++;
+        }
+
+        uint32_t start = ESP.getCycleCount();
+        float out = filter.filter(raw);
+        cycles += ESP.getCycleCount() - start;
+
+        if (spike && out != raw) caught++;
+        if (!spike && out != raw) falseRejects++;
+        if (clean > cleanMax) cleanMax = clean;
+        if (raw > rawMax) rawMax = raw;
+        if (out > filteredMax) filteredMax = out;
+    }
+
+    float perValue = (float)cycles / n;
+    Serial.printf("  %2lu Hz, window %2u: %.0f cyc/value, %.4f%% CPU\n",
+                  (unsigned long)rateHz, window, perValue,
+                  cyclesToUs(perValue) * rateHz / 1e4f);
+    Serial.printf("    spikes %lu/%lu removed, %lu clean values replaced (gust edges), "
+                  "max raw %.1f / filtered %.1f / clean %.1f %s\n",
+                  (unsigned long)caught, (unsigned long)injected, (unsigned long)falseRejects,
+                  rawMax, filteredMax, cleanMax,
+                  caught == injected && filteredMax >= cleanMax - 0.5f &&
+                  filteredMax <= cleanMax + 0.5f ? "OK" : "FAIL");
+}
+
+void benchSpikeFilter() {
+    Serial.println("\n--- Hampel spike filter (wind speed) ---");
+    benchSpikeCase(1, WIND_SAMPLE_SPIKE_WINDOW);
+    benchSpikeCase(1000 / WIND_SAMPLE_INTERVAL_MS, WIND_SPIKE_WINDOW);
+    benchSpikeCase(50, HAMPEL_MAX_WINDOW);
+
+    // Load cell: a knock on the gauge during light rain, then emptying
+    HampelFilter precip(PRECIP_SPIKE_WINDOW, PRECIP_SPIKE_MIN_MM);
+    float total = 0, filteredMax = 0;
+    for (uint32_t i = 0; i < 600; i++) {
+        if (i % 20 == 0) total += PRECIP_RESOLUTION_MM;       // 4.6 mm/h
+        float raw = i == 300 ? total + 25.0f : total;
+        float out = precip.filter(raw);
+        if (out > filteredMax) filteredMax = out;
+    }
+    Serial.printf("  load cell: %lu rejected, window max %.2f mm (rain %.2f mm) %s\n",
+                  (unsigned long)precip.getRejectedCount(), filteredMax, total,
+                  precip.getRejectedCount() == 1 && filteredMax <= total ? "OK" : "FAIL");
+}
+
+// ============================================
+// Agronomic Products
+// ============================================
+
+void checkClose(const char* label, float value, float expected, float tolerance) {
+    Serial.printf("  %-36s %8.3f (expected %.3f) %s\n", label, value, expected,
+                  fabsf(value - expected) <= tolerance ? "OK" : "FAIL");
+}
+
+void benchAgro() {
+    Serial.println("\n--- Agronomic products (FAO-56 ET0, GDD) ---");
+
+    // Worked examples of FAO Irrigation and Drainage Paper 56
+    float deg = (float)M_PI / 180.0f;
+    checkClose("Ra, 20 S, 3 Sep (ex. 8)",
+               AgroProducts::extraterrestrialDaily(-20.0f * deg, 246), 32.2f, 0.1f);
+    checkClose("daily ET0, Uccle, 6 Jul (ex. 18)",
+               AgroProducts::dailyET0(12.3f, 21.5f, 63.0f, 84.0f, 2.078f, 22.07f,
+                                      30.90f, 100.1f), 3.9f, 0.1f);
+    float ratio = 0.8f;
+    checkClose("hourly ET0, 14-15 h (ex. 19)",
+               AgroProducts::hourlyET0(38.0f, 52.0f, 3.3f, 2.450f, 2.658f, 101.3f,
+                                       ratio, 1.0f), 0.63f, 0.01f);
+    checkClose("hourly ET0, 02-03 h (ex. 19)",
+               AgroProducts::hourlyET0(28.0f, 90.0f, 1.9f, 0.0f, 0.0f, 101.3f,
+                                       ratio = 0.8f, 1.0f), 0.0f, 0.01f);
+    checkClose("wind 10 m -> 2 m (ex. 14)", AgroProducts::windAt2m(3.2f, 10.0f), 2.4f, 0.05f);
+
+    // Hourly Ra over a day matches the daily formula
+    float raSum = 0;
+    for (uint8_t h = 0; h < 24; h++) {
+        raSum += AgroProducts::extraterrestrialPeriod(39.18f * deg, -96.57f, 172, h + 0.5f, 1.0f);
+    }
+    checkClose("sum of hourly Ra, Manhattan KS, Jun",
+               raSum, AgroProducts::extraterrestrialDaily(39.18f * deg, 172), 0.2f);
+    checkClose("GDD, Tmin 5 C, Tmax 35 C", AgroProducts::degreeDays(5.0f, 35.0f), 10.0f, 0.001f);
+
+    // Three summer days of hourly records, the first closing 17 min past
+    // the clock hour (rollups follow boot time)
+    AgroProducts agro;
+    agro.setLocation(39.1836f, -96.5717f, 320);
+    const int32_t offset = agro.getUtcOffsetMin() * 60L;
+    uint32_t start = (uint32_t)WallClock::daysFromCivil(2026, 6, 21) * 86400UL
+                     - offset + 17 * 60;
+    AggregatedData hour;
+    hour.sampleCount = 1200;
+    hour.windowDurationMs = 3600000;
+    uint32_t closedDays = 0, cycles = 0;
+    AgroDaily daily;
+    bool allValid = true;
+    float worstRatio = 1.0f;
+    for (uint32_t h = 1; h <= 3 * 24; h++) {
+        uint32_t end = start + h * 3600;
+        float local = fmodf((end - 1800 + offset) / 3600.0f, 24.0f);
+        float day = sinf((local - 9.0f) * (float)M_PI / 12.0f);     // Warmest at 15:00
+        float sun = sinf((local - 6.5f) * (float)M_PI / 14.0f);     // 06:30 - 20:30
+        hour.tempAvg = 26.0f + 7.0f * day;
+        hour.tempMin = hour.tempAvg - 1.0f;
+        hour.tempMax = hour.tempAvg + 1.0f;
+        hour.humidityAvg = 60.0f - 20.0f * day;
+        hour.humidityMin = hour.humidityAvg - 2.0f;
+        hour.humidityMax = hour.humidityAvg + 2.0f;
+        hour.windSpeedAvg = 3.0f + day;
+        hour.pressureAvg = 975.0f;
+        hour.solarAvg = sun > 0 ? 850.0f * sun : 0;
+
+        uint32_t t0 = ESP.getCycleCount();
+        bool closed = agro.addHour(hour, end);
+        cycles += ESP.getCycleCount() - t0;
+
+        if (closed && agro.getDaily(daily)) {
+            closedDays++;
+            int32_t y;
+            uint8_t m, d;
+            WallClock::civilFromDays(daily.day, y, m, d);
+            Serial.printf("  %04ld-%02u-%02u: ET0 %.2f mm (hourly sum %.2f), GDD %.1f "
+                          "(hourly %.1f, season %.1f), Rs %.1f MJ, %u h\n",
+                          (long)y, m, d, daily.et0, daily.et0Hourly, daily.gdd,
+                          daily.gddHourly, daily.gddSeason, daily.solar, daily.hours);
+            allValid = allValid && daily.valid && daily.hours == 24;
+            float r = daily.et0Hourly / daily.et0;
+            if (fabsf(r - 1.0f) > fabsf(worstRatio - 1.0f)) worstRatio = r;
+        }
+    }
+    Serial.printf("  %lu days closed, hourly/daily ET0 within %.0f%%, addHour %lu cyc %s\n",
+                  (unsigned long)closedDays, 100.0f * fabsf(worstRatio - 1.0f),
+                  (unsigned long)(cycles / 72),
+                  closedDays == 3 && allValid && fabsf(worstRatio - 1.0f) < 0.15f ? "OK" : "FAIL");
+
+    // Day boundaries follow the station's zone: UTC-6 here, UTC+1 in Europe
+    AgroProducts europe;
+    europe.setLocation(52.52f, 13.40f, 34);
+    Serial.printf("  UTC offset from longitude: %d / %d min %s\n", agro.getUtcOffsetMin(),
+                  europe.getUtcOffsetMin(),
+                  agro.getUtcOffsetMin() == -360 && europe.getUtcOffsetMin() == 60 ? "OK" : "FAIL");
+
+    // No clock, no products
+    AgroProducts unsynced;
+    Serial.printf("  unsynced clock: %s\n",
+                  !unsynced.addHour(hour, 0) && !unsynced.getDaily(daily) ? "skipped OK" : "FAIL");
+}
+
+// ============================================
+// Spatial Aggregation
+// ============================================
+
+// Reference point and synthetic field: 0.05 C/km warmer to the east,
+// 0.10 C/km cooler to the north (0.112 C/km toward 153 deg)
+static const float SITE_LAT = 39.1836f;
+static const float SITE_LON = -96.5717f;
+static const float GRAD_EAST = 0.05f;
+static const float GRAD_NORTH = -0.10f;
+
+struct SyntheticStation {
+    char id[9];
+    float latitude;
+    float longitude;
+    AggregatedData data;
+};
+
+void makeStation(SyntheticStation& station, uint32_t index, float eastKm, float northKm) {
+    snprintf(station.id, sizeof(station.id), "ST%06lu", (unsigned long)(index % 1000000));
+    station.latitude = SITE_LAT + northKm / 111.195f;
+    station.longitude = SITE_LON + eastKm / (111.195f * cosf(SITE_LAT * (float)M_PI / 180.0f));
+
+    AggregatedData& data = station.data;
+    data = AggregatedData();
+    data.timestamp = 300000 + index;
+    data.sampleCount = 60;
+    float temp = 20.0f + GRAD_EAST * eastKm + GRAD_NORTH * northKm + 0.02f * nextNoise();
+    data.tempAvg = temp;
+    data.tempMin = temp - 0.5f - 0.5f * (nextNoise() + 1.0f);
+    data.tempMax = temp + 0.5f + 0.5f * (nextNoise() + 1.0f);
+    data.humidityAvg = 55.0f + 5.0f * nextNoise();
+    data.humidityMin = data.humidityAvg - 1.0f;
+    data.humidityMax = data.humidityAvg + 1.0f;
+    data.pressureAvg = 975.0f - 0.12f * northKm;
+    data.pressureMin = data.pressureAvg - 0.1f;
+    data.pressureMax = data.pressureAvg + 0.1f;
+    data.windSpeedAvg = 4.0f + nextNoise();
+    data.windSpeedMin = 0;
+    data.windSpeedMax = data.windSpeedAvg * 2.0f;
+    data.windDirAvg = (uint16_t)((350 + 20 * (index & 1)) % 360);  // 350 / 10 deg
+    data.precipitation = 0.25f * (index % 4);
+    data.solarAvg = 600.0f + 50.0f * nextNoise();
+    data.solarMin = data.solarAvg - 100.0f;
+    data.solarMax = data.solarAvg + 100.0f;
+    data.gasResistanceAvg = 120.0f + 10.0f * nextNoise();
+    data.gasResistanceMin = data.gasResistanceAvg - 5.0f;
+    data.gasResistanceMax = data.gasResistanceAvg + 5.0f;
+    // Every third station's gas sensor was rejected by QC all window
+    if (index % 3 == 0) data.qcRejected[(uint8_t)DataField::GAS_RESISTANCE] = data.sampleCount;
+}
+
+static SpatialAggregator mixedSite;
+static uint32_t mixedMissing;
+
+void addMixedStation(const uint8_t*, const char* stationId, const AggregatedData& data,
+                     float latitude, float longitude) {
+    mixedSite.addStation(stationId, data, latitude, longitude);
+    mixedMissing += data.qcFlagCounts[0];
+}
+
+void benchSpatial() {
+    Serial.println("\n--- Spatial aggregation (site summary) ---");
+
+    const uint32_t maxStations = STATION_TABLE_MAX_STATIONS + 1;   // + main station
+    static SyntheticStation stations[maxStations];
+    seedSamples(29);
+    for (uint32_t i = 0; i < maxStations; i++) {
+        // 8 x 8 grid, 1.5 km spacing, jittered by up to 300 m
+        float east = 1.5f * (i % 8) - 5.25f + 0.3f * nextNoise();
+        float north = 1.5f * (i / 8) - 5.25f + 0.3f * nextNoise();
+        makeStation(stations[i], i, east, north);
+    }
+
+    // Cost grows linearly with the number of stations
+    static SpatialAggregator site;
+    site.setReference(SITE_LAT, SITE_LON);
+    const uint32_t counts[] = {8, 16, 32, maxStations};
+    static char payload[MQTT_MAX_PACKET_SIZE];
+    size_t length = 0;
+    for (uint32_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        uint32_t n = counts[c];
+        site.reset();
+        uint32_t start = ESP.getCycleCount();
+        for (uint32_t i = 0; i < n; i++) {
+            site.addStation(stations[i].id, stations[i].data,
+                            stations[i].latitude, stations[i].longitude);
+        }
+        uint32_t addCycles = ESP.getCycleCount() - start;
+        start = ESP.getCycleCount();
+        length = DataFormatter::toSpatialPayload("MAIN0001", site, payload, sizeof(payload));
+        uint32_t formatCycles = ESP.getCycleCount() - start;
+        Serial.printf("  %2lu stations: add %lu cyc total (%lu/station), summary + JSON %lu cyc\n",
+                      (unsigned long)n, (unsigned long)addCycles,
+                      (unsigned long)(addCycles / n), (unsigned long)formatCycles);
+    }
+    Serial.printf("  payload %u bytes (buffer %u) %s\n", (unsigned)length,
+                  (unsigned)MQTT_MAX_PACKET_SIZE, length < MQTT_MAX_PACKET_SIZE ? "OK" : "FAIL");
+
+    // Extremes, mean and spread against a direct scan
+    float sum = 0, sumSq = 0, lo = FLT_MAX, hi = -FLT_MAX;
+    const char* loId = "";
+    const char* hiId = "";
+    for (uint32_t i = 0; i < maxStations; i++) {
+        const AggregatedData& d = stations[i].data;
+        sum += d.tempAvg;
+        sumSq += d.tempAvg * d.tempAvg;
+        if (d.tempMin < lo) { lo = d.tempMin; loId = stations[i].id; }
+        if (d.tempMax > hi) { hi = d.tempMax; hiId = stations[i].id; }
+    }
+    float mean = sum / maxStations;
+    float spread = sqrtf((sumSq - maxStations * mean * mean) / (maxStations - 1));
+    SpatialField temp;
+    site.getField(DataField::TEMPERATURE, temp);
+    bool scanOk = temp.stations == maxStations && fabsf(temp.mean - mean) < 1e-3f &&
+                  fabsf(temp.spread - spread) < 1e-2f && temp.min == lo && temp.max == hi &&
+                  strcmp(temp.minStation, loId) == 0 && strcmp(temp.maxStation, hiId) == 0;
+    Serial.printf("  temperature: mean %.3f spread %.3f, min %.2f @ %s, max %.2f @ %s %s\n",
+                  temp.mean, temp.spread, temp.min, temp.minStation, temp.max, temp.maxStation,
+                  scanOk ? "OK" : "FAIL");
+
+    // Recovered gradient of the synthetic field
+    float expected = sqrtf(GRAD_EAST * GRAD_EAST + GRAD_NORTH * GRAD_NORTH);
+    float expectedDir = atan2f(GRAD_EAST, GRAD_NORTH) * 180.0f / (float)M_PI;
+    if (expectedDir < 0) expectedDir += 360.0f;
+    Serial.printf("  gradient %.4f C/km toward %.1f deg (true %.4f toward %.1f) %s\n",
+                  temp.gradient, temp.gradientDir, expected, expectedDir,
+                  temp.hasGradient && fabsf(temp.gradient - expected) < 0.005f &&
+                  fabsf(temp.gradientDir - expectedDir) < 2.0f ? "OK" : "FAIL");
+
+    SpatialField field;
+    site.getField(DataField::PRESSURE, field);
+    Serial.printf("  pressure gradient %.3f hPa/km toward %.0f deg (true 0.120 toward 180) %s\n",
+                  field.gradient, field.gradientDir,
+                  field.hasGradient && fabsf(field.gradient - 0.12f) < 0.001f &&
+                  fabsf(field.gradientDir - 180.0f) < 0.5f ? "OK" : "FAIL");
+    site.getField(DataField::WIND_DIRECTION, field);
+    Serial.printf("  wind direction (350 / 10 deg stations): mean %.1f deg, no extremes %s\n",
+                  field.mean, (field.mean < 0.5f || field.mean > 359.5f) && !field.hasExtremes &&
+                  !field.hasGradient ? "OK" : "FAIL");
+    site.getField(DataField::GAS_RESISTANCE, field);
+    uint32_t gasStations = maxStations - (maxStations + 2) / 3;
+    Serial.printf("  gas resistance: %u of %lu stations (QC rejected skipped) %s\n",
+                  field.stations, (unsigned long)maxStations,
+                  field.stations == gasStations ? "OK" : "FAIL");
+
+    // Two partial aggregators merge to the same summary
+    static SpatialAggregator west, east;
+    west.setReference(SITE_LAT, SITE_LON);
+    east.setReference(SITE_LAT, SITE_LON);
+    west.reset();
+    east.reset();
+    for (uint32_t i = 0; i < maxStations; i++) {
+        SpatialAggregator& half = (i % 8) < 4 ? west : east;
+        half.addStation(stations[i].id, stations[i].data,
+                        stations[i].latitude, stations[i].longitude);
+    }
+    bool merged = west.merge(east);
+    west.getField(DataField::TEMPERATURE, field);
+    Serial.printf("  merged halves: %u stations, mean diff %.2e, gradient diff %.2e, "
+                  "extremes %s %s\n", west.getStationCount(), fabsf(field.mean - temp.mean),
+                  fabsf(field.gradient - temp.gradient),
+                  strcmp(field.maxStation, temp.maxStation) == 0 ? "same" : "differ",
+                  merged && west.getStationCount() == maxStations &&
+                  fabsf(field.mean - temp.mean) < 1e-4f &&
+                  fabsf(field.gradient - temp.gradient) < 1e-4f &&
+                  strcmp(field.minStation, temp.minStation) == 0 &&
+                  strcmp(field.maxStation, temp.maxStation) == 0 ? "OK" : "FAIL");
+
+    // Plane sums about another origin do not add up: refused, unchanged
+    east.setReference(SITE_LAT + 0.1f, SITE_LON);
+    east.reset();
+    east.addStation(stations[0].id, stations[0].data, stations[0].latitude, stations[0].longitude);
+    bool refused = !west.merge(east) && west.getStationCount() == maxStations;
+    Serial.printf("  merge with another reference: refused %s\n", refused ? "OK" : "FAIL");
+
+    // Stations along one road, or without a position: no gradient
+    SpatialAggregator line;
+    line.setReference(SITE_LAT, SITE_LON);
+    for (uint32_t i = 0; i < 6; i++) {
+        makeStation(stations[i], i, 2.0f * i, 0);
+        line.addStation(stations[i].id, stations[i].data,
+                        stations[i].latitude, stations[i].longitude);
+    }
+    line.getField(DataField::TEMPERATURE, field);
+    bool lineOk = !field.hasGradient && field.stations == 6;
+    SpatialAggregator unplaced;
+    for (uint32_t i = 0; i < 6; i++) {
+        unplaced.addStation(stations[i].id, stations[i].data, 0, 0);
+    }
+    unplaced.getField(DataField::TEMPERATURE, field);
+    Serial.printf("  collinear stations / no positions: no gradient %s\n",
+                  lineOk && !field.hasGradient && field.stations == 6 ? "OK" : "FAIL");
+
+    // Older microstation firmware (version 1 packets: no position, no
+    // solar) next to a current one, through the station table as received
+    static StationTable table;
+    mixedSite.reset();
+    mixedMissing = 0;
+    const uint8_t macV2[6] = {0x24, 0x0A, 0xC4, 0x00, 0x00, 0x02};
+    const uint8_t macV1[6] = {0x24, 0x0A, 0xC4, 0x00, 0x00, 0x01};
+    WeatherReading reading;
+    for (uint32_t i = 0; i < 10; i++) {
+        fillReading(reading, i);
+        reading.isValid = true;
+        table.addReading(macV2, "MICRO_V2", reading, SITE_LAT, SITE_LON);
+        table.addReading(macV1, "MICRO_V1", reading, 0, 0,
+                         QC_ALL_FIELDS & ~FIELD_BIT(SOLAR_IRRADIANCE));
+        table.drain();
+    }
+    table.flush(addMixedStation);
+    SpatialField solar;
+    mixedSite.getField(DataField::TEMPERATURE, field);
+    mixedSite.getField(DataField::SOLAR_IRRADIANCE, solar);
+    Serial.printf("  version 1 station: temperature %u stations, solar %u, missing %lu %s\n",
+                  field.stations, solar.stations, (unsigned long)mixedMissing,
+                  mixedSite.getStationCount() == 2 && field.stations == 2 &&
+                  solar.stations == 1 && mixedMissing == 10 ? "OK" : "FAIL");
+}
+
+// ============================================
+// Fixed-Point Aggregation
+// ============================================
+static bool fixedAllOk;
+
+// Difference of two statistics against the field resolution (float
+// path error allowed on top: relative 1e-5)
+void compareFixed(const char* name, float resolution, const float* a, const float* b,
+                  uint8_t count) {
+    float worst = 0;
+    bool ok = true;
+    for (uint8_t i = 0; i < count; i++) {
+        float diff = fabsf(a[i] - b[i]);
+        if (diff > worst) worst = diff;
+        if (diff > 0.5f * resolution + 1e-5f * fabsf(a[i]) + 1e-6f) ok = false;
+    }
+    if (!ok) fixedAllOk = false;
+    Serial.printf("  %-16s float %10.3f fixed %10.3f  max diff %.4f (resolution %g) %s\n",
+                  name, a[0], b[0], worst, resolution, ok ? "OK" : "FAIL");
+}
+
+void benchFixedPoint() {
+    Serial.println("\n--- Fixed-point aggregation vs float ---");
+
+    // Cost: a ring of prepared readings, fed to each path
+    const uint32_t ring = 64;
+    static WeatherReading readings[ring];
+    static ScaledReading scaled[ring];
+    seedSamples(31);
+    for (uint32_t i = 0; i < ring; i++) {
+        fillReading(readings[i], i);
+        readings[i].windDirection = (uint16_t)(200 + i % 61 - 30);
+        readings[i].isValid = true;
+        FixedPointAggregator::scale(readings[i], scaled[i]);
+    }
+
+    static DataAggregator floatPath;
+    static FixedPointAggregator fixedPath;
+    const uint32_t n = 20000;
+    floatPath.reset();
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < n; i++) floatPath.addSample(readings[i % ring]);
+    uint32_t floatCycles = ESP.getCycleCount() - start;
+
+    fixedPath.reset();
+    start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < n; i++) fixedPath.addSample(readings[i % ring]);
+    uint32_t convertCycles = ESP.getCycleCount() - start;
+
+    fixedPath.reset();
+    start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < n; i++) fixedPath.addSample(scaled[i % ring]);
+    uint32_t fixedCycles = ESP.getCycleCount() - start;
+
+    start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < n; i++) FixedPointAggregator::scale(readings[i % ring], scaled[i % ring]);
+    uint32_t scaleCycles = ESP.getCycleCount() - start;
+
+    Serial.printf("  addSample: float %lu cyc, fixed %lu cyc (incl. scaling), "
+                  "fixed from packet units %lu cyc; scaling alone %lu cyc\n",
+                  (unsigned long)(floatCycles / n), (unsigned long)(convertCycles / n),
+                  (unsigned long)(fixedCycles / n), (unsigned long)(scaleCycles / n));
+    Serial.printf("  state: float %u bytes, fixed %u bytes (high-rate mode %s)\n",
+                  (unsigned)sizeof(DataAggregator), (unsigned)sizeof(FixedPointAggregator),
+                  AGGREGATION_HIGH_RATE ? "ON" : "OFF");
+
+    // Accuracy: one long window (a day at 1 Hz) through both paths
+    const uint32_t day = 86400;
+    floatPath.reset();
+    fixedPath.reset();
+    WeatherReading reading;
+    reading.isValid = true;
+    const float bounds[] = {QC_CALM_WIND_MS, 2.1f, 3.6f, 5.7f, 8.8f, 11.1f};
+    uint32_t nearBound = 0;
+    seedSamples(37);
+    for (uint32_t i = 0; i < day; i++) {
+        fillReading(reading, i);
+        reading.temperature += 8.0f * sinf(i * (2.0f * (float)M_PI / day));
+        reading.windDirection = (uint16_t)(200 + i % 61 - 30);
+        reading.precipitation = i * 0.0001f;
+        for (uint8_t k = 0; k < sizeof(bounds) / sizeof(bounds[0]); k++) {
+            if (fabsf(reading.windSpeed - bounds[k]) <= 0.005f) nearBound++;
+        }
+        floatPath.addSample(reading);
+        fixedPath.addSample(reading);
+    }
+    AggregatedData a = floatPath.getAndReset();
+    AggregatedData b = fixedPath.getAndReset();
+
+    fixedAllOk = true;
+#define FIXED_COMPARE_STATS(key, p, scale) {         float fa[4] = {(float)a.p##Avg, (float)a.p##Min, (float)a.p##Max, a.p##StdDev};         float fb[4] = {(float)b.p##Avg, (float)b.p##Min, (float)b.p##Max, b.p##StdDev};         compareFixed(key, 1.0f / (scale), fa, fb, 4);     }
+    // Both use the Q15 table and fastAtan2Deg: the same whole degree
+#define FIXED_COMPARE_CIRCULAR(key, p, scale) {         float fa = (float)a.p##Avg, fb = (float)b.p##Avg;         compareFixed(key, 1.0f, &fa, &fb, 1);     }
+#define FIXED_COMPARE_LATEST(key, p, scale) {         float fa = (float)a.p, fb = (float)b.p;         compareFixed(key, 1.0f / (scale), &fa, &fb, 1);     }
+#define FIXED_COMPARE(id, member, prefix, type, kind, quant, key, shortKey, unit, wireType, wireScale, ...)     FIXED_COMPARE_##kind(key, prefix, wireScale)
+    WEATHER_FIELDS(FIXED_COMPARE)
+
+    // Speeds within half a resolution step of a class bound may change
+    // class (each such sample moves one count: two cells differ by one)
+    uint32_t cellDiff = a.windRose.calm > b.windRose.calm ? a.windRose.calm - b.windRose.calm
+                                                          : b.windRose.calm - a.windRose.calm;
+    for (uint8_t sector = 0; sector < WindRose::SECTORS; sector++) {
+        for (uint8_t c = 0; c < WindRose::SPEED_CLASSES; c++) {
+            int32_t d = (int32_t)a.windRose.counts[sector][c] - b.windRose.counts[sector][c];
+            cellDiff += d < 0 ? -d : d;
+        }
+    }
+    bool roseOk = a.windRose.total() == b.windRose.total() && cellDiff <= 2 * nearBound;
+    Serial.printf("  wind rose: %lu samples each, %lu moved across a class bound "
+                  "(%lu within 0.005 m/s of one) %s\n",
+                  (unsigned long)b.windRose.total(), (unsigned long)(cellDiff / 2),
+                  (unsigned long)nearBound, roseOk ? "OK" : "FAIL");
+    Serial.printf("  %lu samples: all fields within resolution %s\n",
+                  (unsigned long)day, fixedAllOk && roseOk ? "OK" : "FAIL");
+}
+
+// ============================================
+// Formatter Writer
+// ============================================
+#ifdef ARDUINO
+static const size_t STACK_PROBE_BYTES = 3072;
+#else
+static const size_t STACK_PROBE_BYTES = 16384;
+#endif
+static const uint8_t STACK_PAINT = 0xA5;
+
+// Fill the stack below the caller with a pattern...
+__attribute__((noinline)) void paintStack() {
+    volatile uint8_t probe[STACK_PROBE_BYTES];
+    for (size_t i = 0; i < STACK_PROBE_BYTES; i++) probe[i] = STACK_PAINT;
+    (void)probe;
+}
+
+// ...and count how much of it a call overwrote (the stack grows down)
+__attribute__((noinline)) size_t scanStack() {
+    uint8_t probe[STACK_PROBE_BYTES];
+    volatile uint8_t* left = probe;   // Deliberately read as left behind
+    size_t untouched = 0;
+    while (untouched < STACK_PROBE_BYTES && left[untouched] == STACK_PAINT) untouched++;
+    return STACK_PROBE_BYTES - untouched;
+}
+
+enum FormatterOutput : uint8_t { OUT_JSON, OUT_MQTT, OUT_INFLUX, OUT_CSV, OUT_COUNT };
+static const char* const OUTPUT_NAMES[OUT_COUNT] = {
+    "toJSON", "toMQTTPayload", "toInfluxLineProtocol", "toCSV"
+};
+
+static const AggregatedData* formatData;
+static const WindProductsData* formatWind;
+static const DerivedData* formatDerived;
+
+__attribute__((noinline)) size_t formatOnce(uint8_t output, char* buffer, size_t size) {
+    switch (output) {
+        case OUT_JSON:
+            return DataFormatter::toJSON(*formatData, buffer, size);
+        case OUT_MQTT:
+            return DataFormatter::toMQTTPayload("BENCH001", *formatData, buffer, size,
+                                                formatWind, formatDerived);
+        case OUT_INFLUX:
+            return DataFormatter::toInfluxLineProtocol("weather", "BENCH001", *formatData,
+                                                       buffer, size);
+        default:
+            return DataFormatter::toCSV(*formatData, buffer, size, true);
+    }
+}
+
+size_t formatStack(uint8_t output, char* buffer, size_t size) {
+    paintStack();
+    formatOnce(output, buffer, size);
+    return scanStack();
+}
+
+// A realistic window: QC rejections, a wind rose, wind products and
+// derived values, so every writer in DataFormatter runs
+void makeReportWindow(AggregatedData& data, WindProductsData& wind, DerivedData& derived) {
+    static DataAggregator aggregator;
+    aggregator.reset();
+    WeatherReading reading;
+    reading.isValid = true;
+    QCResult qc;
+    seedSamples(41);
+    for (uint32_t i = 0; i < 3600; i++) {
+        fillReading(reading, i);
+        reading.temperature -= 25.0f;
+        reading.windSpeed = 6.0f + 5.0f * nextNoise();
+        qc.validMask = QC_ALL_FIELDS;
+        for (uint8_t f = 0; f < WEATHER_FIELD_COUNT; f++) qc.flags[f] = 0;
+        if (i % 97 == 0) {
+            qc.validMask &= ~FIELD_BIT(HUMIDITY);
+            qc.flags[(uint8_t)DataField::HUMIDITY] = QC_RANGE;
+        }
+        aggregator.addSample(reading, qc);
+    }
+    data = aggregator.getAndReset();
+
+    wind.gust = 12.5f;
+    wind.gustDirection = 270;
+    wind.gustValid = true;
+    wind.mean2min.scalarSpeed = 5.25f;
+    wind.mean2min.vectorSpeed = 4.75f;
+    wind.mean2min.direction = 265;
+    wind.mean2min.valid = true;
+    wind.mean10min = wind.mean2min;
+    DerivedVariables variables;
+    variables.setElevation(320);
+    variables.update(data);
+    derived = variables.getAll();
+}
+
+void benchFormatter() {
+    Serial.println("\n--- Formatter writer vs C library printf ---");
+
+    static AggregatedData data;
+    WindProductsData wind;
+    DerivedData derived;
+    makeReportWindow(data, wind, derived);
+
+    formatData = &data;
+    formatWind = &wind;
+    formatDerived = &derived;
+
+    static char fast[MQTT_MAX_PACKET_SIZE];
+    static char libc[MQTT_MAX_PACKET_SIZE];
+    const int iterations = 200;
+    bool allOk = true;
+
+    for (uint8_t output = 0; output < OUT_COUNT; output++) {
+        BufferWriter::setLibcFormatting(false);
+        size_t fastLength = formatOnce(output, fast, sizeof(fast));
+        uint32_t start = ESP.getCycleCount();
+        for (int i = 0; i < iterations; i++) formatOnce(output, fast, sizeof(fast));
+        uint32_t fastCycles = ESP.getCycleCount() - start;
+        size_t fastStack = formatStack(output, fast, sizeof(fast));
+
+        BufferWriter::setLibcFormatting(true);
+        size_t libcLength = formatOnce(output, libc, sizeof(libc));
+        start = ESP.getCycleCount();
+        for (int i = 0; i < iterations; i++) formatOnce(output, libc, sizeof(libc));
+        uint32_t libcCycles = ESP.getCycleCount() - start;
+        size_t libcStack = formatStack(output, libc, sizeof(libc));
+        BufferWriter::setLibcFormatting(false);
+
+        bool same = fastLength == libcLength && strcmp(fast, libc) == 0;
+        if (!same) allOk = false;
+        Serial.printf("  %-21s %4u bytes: writer %6lu cyc, printf %6lu cyc (%.1fx); "
+                      "stack %u vs %u bytes, output %s\n",
+                      OUTPUT_NAMES[output], (unsigned)fastLength,
+                      (unsigned long)(fastCycles / iterations),
+                      (unsigned long)(libcCycles / iterations),
+                      fastCycles ? (float)libcCycles / fastCycles : 0.0f,
+                      (unsigned)fastStack, (unsigned)libcStack,
+                      same ? "identical" : "DIFFERS");
+    }
+
+    // Truncation: a short buffer holds the same prefix and reports the
+    // same full length as snprintf
+    char shortFast[100], shortLibc[100];
+    size_t fullLength = formatOnce(OUT_MQTT, shortFast, sizeof(shortFast));
+    BufferWriter::setLibcFormatting(true);
+    size_t libcFull = formatOnce(OUT_MQTT, shortLibc, sizeof(shortLibc));
+    BufferWriter::setLibcFormatting(false);
+    bool truncOk = fullLength == libcFull && strcmp(shortFast, shortLibc) == 0 &&
+                   strlen(shortFast) == sizeof(shortFast) - 1;
+    Serial.printf("  truncated to %u bytes: prefix and length %s\n",
+                  (unsigned)sizeof(shortFast), truncOk ? "OK" : "FAIL");
+
+    // %.2f over values the sensors produce, including exact ties
+    const uint32_t n = 50000;
+    uint32_t mismatches = 0;
+    char a[48], b[48];
+    seedSamples(43);
+    for (uint32_t i = 0; i < n; i++) {
+        double value;
+        switch (i & 3) {
+            case 0: value = (float)(nextNoise() * 2000.0f); break;          // Sensor range
+            case 1: value = (int32_t)(nextNoise() * 200000.0f) / 100.0 + 0.005; break;
+            case 2: value = (int32_t)(nextNoise() * 4000.0f) / 8.0; break;  // Binary ties
+            default: value = ldexp(nextNoise(), (int)(i % 80) - 20); break;
+        }
+        BufferWriter writer(a, sizeof(a));
+        writer.printf("%.2f|%5.1f|%-8.3f|%.0f", value, value, value, value);
+        snprintf(b, sizeof(b), "%.2f|%5.1f|%-8.3f|%.0f", value, value, value, value);
+        if (strcmp(a, b) != 0) mismatches++;
+    }
+    Serial.printf("  %lu random values through %%.2f %%5.1f %%-8.3f %%.0f: "
+                  "%lu differ from snprintf %s\n",
+                  (unsigned long)n, (unsigned long)mismatches, mismatches == 0 ? "OK" : "FAIL");
+    Serial.printf("  all outputs byte-identical %s\n", allOk && truncOk ? "OK" : "FAIL");
+}
+
+// ============================================
+// Binary (CBOR) Payload
+// ============================================
+static bool cborAllOk;
+
+// Decoded value against the original, within half the scale step
+void checkDecoded(const char* name, float original, float decoded, float scale,
+                  float& worst) {
+    float diff = fabsf(original - decoded);
+    if (diff > worst) worst = diff;
+    if (diff > 0.5f / scale + 1e-6f * fabsf(original)) {
+        cborAllOk = false;
+        Serial.printf("  %s: %.4f decoded as %.4f FAIL\n", name, original, decoded);
+    }
+}
+
+void benchCbor() {
+    Serial.println("\n--- CBOR payload vs JSON ---");
+
+    static AggregatedData data;
+    WindProductsData wind;
+    DerivedData derived;
+    makeReportWindow(data, wind, derived);
+
+    static char json[MQTT_MAX_PACKET_SIZE];
+    static uint8_t cbor[MQTT_MAX_PACKET_SIZE];
+    cborAllOk = true;
+
+    // Bytes per report: plain window, full report, compressed report
+    ReportSelection compressed;
+    compressed.keyframe = false;
+    compressed.fieldMask = FIELD_BIT(TEMPERATURE) | FIELD_BIT(WIND_SPEED) |
+                           FIELD_BIT(WIND_DIRECTION);
+    struct Variant {
+        const char* name;
+        const WindProductsData* wind;
+        const DerivedData* derived;
+        const ReportSelection* selection;
+    };
+    const Variant variants[] = {
+        {"window only", nullptr, nullptr, nullptr},
+        {"window + products", &wind, &derived, nullptr},
+        {"compressed (3 fields)", &wind, &derived, &compressed},
+    };
+    for (const Variant& v : variants) {
+        size_t jsonBytes = DataFormatter::toMQTTPayload("BENCH001", data, json, sizeof(json),
+                                                        v.wind, v.derived, v.selection);
+        size_t cborBytes = DataFormatter::toCBORPayload("BENCH001", data, cbor, sizeof(cbor),
+                                                        v.wind, v.derived, v.selection);
+        Serial.printf("  %-22s JSON %4u bytes, CBOR %4u bytes (%.0f%%), "
+                      "%lu vs %lu KB/day at 5 min\n",
+                      v.name, (unsigned)jsonBytes, (unsigned)cborBytes,
+                      100.0f * cborBytes / jsonBytes,
+                      (unsigned long)(jsonBytes * 288 / 1024),
+                      (unsigned long)(cborBytes * 288 / 1024));
+    }
+
+    // Encode and decode cost, full report
+    const int iterations = 500;
+    uint32_t start = ESP.getCycleCount();
+    for (int i = 0; i < iterations; i++) {
+        DataFormatter::toMQTTPayload("BENCH001", data, json, sizeof(json), &wind, &derived);
+    }
+    uint32_t jsonCycles = ESP.getCycleCount() - start;
+
+    size_t length = 0;
+    start = ESP.getCycleCount();
+    for (int i = 0; i < iterations; i++) {
+        length = DataFormatter::toCBORPayload("BENCH001", data, cbor, sizeof(cbor),
+                                              &wind, &derived);
+    }
+    uint32_t cborCycles = ESP.getCycleCount() - start;
+
+    static CborReport report;
+    bool decoded = true;
+    start = ESP.getCycleCount();
+    for (int i = 0; i < iterations; i++) {
+        decoded = CborPayload::decode(cbor, length, report) && decoded;
+    }
+    uint32_t decodeCycles = ESP.getCycleCount() - start;
+    Serial.printf("  encode: JSON %lu cyc, CBOR %lu cyc; decode %lu cyc\n",
+                  (unsigned long)(jsonCycles / iterations),
+                  (unsigned long)(cborCycles / iterations),
+                  (unsigned long)(decodeCycles / iterations));
+
+    // Round trip: every field within half its wire step
+    float worst = 0;
+    if (!decoded || strcmp(report.stationId, "BENCH001") != 0 ||
+        report.fieldMask != QC_ALL_FIELDS || report.hasKeyframe ||
+        report.data.timestamp != data.timestamp || report.data.sampleCount != data.sampleCount ||
+        report.data.windowDurationMs != data.windowDurationMs) {
+        cborAllOk = false;
+    }
+#define CBOR_CHECK_STATS(key, p, scale) \
+    checkDecoded(key, (float)data.p##Avg, (float)report.data.p##Avg, scale, worst); \
+    checkDecoded(key, (float)data.p##Min, (float)report.data.p##Min, scale, worst); \
+    checkDecoded(key, (float)data.p##Max, (float)report.data.p##Max, scale, worst); \
+    checkDecoded(key, data.p##StdDev, report.data.p##StdDev, scale, worst);
+#define CBOR_CHECK_CIRCULAR(key, p, scale) \
+    checkDecoded(key, (float)data.p##Avg, (float)report.data.p##Avg, scale, worst);
+#define CBOR_CHECK_LATEST(key, p, scale) \
+    checkDecoded(key, (float)data.p, (float)report.data.p, scale, worst);
+#define CBOR_CHECK_QUANTILES(key, p, scale) \
+    checkDecoded(key, data.p##P05, report.data.p##P05, scale, worst); \
+    checkDecoded(key, data.p##Median, report.data.p##Median, scale, worst); \
+    checkDecoded(key, data.p##P95, report.data.p##P95, scale, worst);
+#define CBOR_CHECK_NONE(key, p, scale)
+#define CBOR_CHECK(id, member, prefix, type, kind, quant, key, shortKey, unit, wireType, wireScale, ...) \
+    CBOR_CHECK_##kind(key, prefix, wireScale) CBOR_CHECK_##quant(key, prefix, wireScale)
+    WEATHER_FIELDS(CBOR_CHECK)
+
+    checkDecoded("gust", wind.gust, report.wind.gust, CBOR_VALUE_SCALE, worst);
+    checkDecoded("wind_2min", wind.mean2min.vectorSpeed, report.wind.mean2min.vectorSpeed,
+                 CBOR_VALUE_SCALE, worst);
+    checkDecoded("dew_point", derived.dewPoint, report.derived.dewPoint, CBOR_VALUE_SCALE, worst);
+    checkDecoded("sea_level_pressure", derived.seaLevelPressure,
+                 report.derived.seaLevelPressure, CBOR_VALUE_SCALE, worst);
+    bool exactOk = report.wind.gustValid && report.wind.gustDirection == wind.gustDirection &&
+                   report.wind.mean10min.valid && report.derived.validMask == derived.validMask &&
+                   memcmp(&report.data.windRose, &data.windRose, sizeof(WindRose)) == 0 &&
+                   memcmp(report.data.qcRejected, data.qcRejected, sizeof(data.qcRejected)) == 0 &&
+                   memcmp(report.data.qcFlagCounts, data.qcFlagCounts,
+                          sizeof(data.qcFlagCounts)) == 0;
+    if (!exactOk) cborAllOk = false;
+    Serial.printf("  round trip: worst error %.4f, rose / QC / directions exact %s\n",
+                  worst, cborAllOk ? "OK" : "FAIL");
+
+    // Compressed report: selected fields and the keyframe flag only
+    size_t compressedLength = DataFormatter::toCBORPayload("BENCH001", data, cbor, sizeof(cbor),
+                                                           &wind, &derived, &compressed);
+    bool compressedOk = CborPayload::decode(cbor, compressedLength, report) &&
+                        report.fieldMask == compressed.fieldMask && report.hasKeyframe &&
+                        !report.keyframe && report.derived.validMask == 0 &&
+                        report.data.windRose.total() == 0;
+    Serial.printf("  compressed report decodes to its 3 fields, no rose / derived %s\n",
+                  compressedOk ? "OK" : "FAIL");
+
+    // Truncation is reported, and damaged payloads are rejected, not misread
+    uint8_t small[64];
+    size_t needed = DataFormatter::toCBORPayload("BENCH001", data, small, sizeof(small),
+                                                 &wind, &derived);
+    length = DataFormatter::toCBORPayload("BENCH001", data, cbor, sizeof(cbor), &wind, &derived);
+    bool truncOk = needed == length && !CborPayload::decode(small, sizeof(small), report);
+    uint32_t rejected = 0;
+    for (size_t cut = 0; cut < length; cut++) {
+        if (!CborPayload::decode(cbor, cut, report)) rejected++;
+    }
+    truncOk = truncOk && rejected == length;
+    Serial.printf("  truncated buffer: length %u reported, all %u prefixes rejected %s\n",
+                  (unsigned)needed, (unsigned)length, truncOk ? "OK" : "FAIL");
+
+    // Random corruption must never read out of bounds (run under a
+    // sanitizer on the host); count how many still parse
+    static uint8_t damaged[MQTT_MAX_PACKET_SIZE];
+    uint32_t parsed = 0;
+    const uint32_t trials = 2000;
+    seedSamples(47);
+    for (uint32_t t = 0; t < trials; t++) {
+        memcpy(damaged, cbor, length);
+        for (uint8_t k = 0; k < 4; k++) {
+            size_t at = (size_t)((nextNoise() + 1.0f) * 0.5f * (length - 1));
+            damaged[at] ^= (uint8_t)(1 + (t * 37 + k * 11) % 255);
+        }
+        if (CborPayload::decode(damaged, length, report)) parsed++;
+    }
+    Serial.printf("  %lu corrupted payloads: %lu rejected, %lu still well-formed\n",
+                  (unsigned long)trials, (unsigned long)(trials - parsed), (unsigned long)parsed);
+
+    Serial.printf("  all checks %s\n",
+                  cborAllOk && compressedOk && truncOk ? "OK" : "FAIL");
+}
+
+// ============================================
+// Backlog Batch
+// ============================================
+
+// A day of 5-minute windows at 1 Hz: diurnal cycles plus sensor noise
+void makeBacklogDay(AggregatedData* windows, uint16_t count) {
+    static DataAggregator aggregator;
+    WeatherReading reading;
+    reading.isValid = true;
+    const uint32_t perWindow = 300;
+    seedSamples(53);
+    for (uint16_t w = 0; w < count; w++) {
+        aggregator.reset();
+        for (uint32_t i = 0; i < perWindow; i++) {
+            uint32_t t = w * perWindow + i;
+            float phase = sinf(t * (2.0f * (float)M_PI / 86400.0f));
+            fillReading(reading, t);
+            reading.temperature = 15.0f + 8.0f * phase + 0.1f * nextNoise();
+            reading.humidity = 60.0f - 20.0f * phase + 0.5f * nextNoise();
+            reading.pressure = 1013.0f + 2.0f * phase + 0.05f * nextNoise();
+            reading.windSpeed = 4.0f + 2.0f * phase + 1.5f * nextNoise();
+            reading.windDirection = (uint16_t)(220 + 25.0f * nextNoise());
+            reading.precipitation = t > 50000 ? 2.4f : 0.0f;
+            reading.solarIrradiance = phase > 0 ? 800.0f * phase + 5.0f * nextNoise() : 0.0f;
+            reading.lux = (uint32_t)(reading.solarIrradiance * 110.0f);
+            aggregator.addSample(reading);
+        }
+        windows[w] = aggregator.getAndReset();
+        // Window ends a few ms late now and then, as loop() does
+        windows[w].timestamp = 300000UL * (w + 1) + (w % 7 == 0 ? 3 : 0);
+        windows[w].windowDurationMs = 300000;
+    }
+}
+
+static bool batchAllOk;
+
+void checkBatchRecord(const AggregatedData& original, const AggregatedData& decoded) {
+    bool ok = decoded.timestamp == original.timestamp &&
+              decoded.sampleCount == original.sampleCount &&
+              decoded.windowDurationMs == original.windowDurationMs &&
+              memcmp(&decoded.windRose, &original.windRose, sizeof(WindRose)) == 0 &&
+              memcmp(decoded.qcRejected, original.qcRejected, sizeof(original.qcRejected)) == 0 &&
+              memcmp(decoded.qcFlagCounts, original.qcFlagCounts,
+                     sizeof(original.qcFlagCounts)) == 0;
+#define BATCH_NEAR(a, b, scale) (fabsf((float)(a) - (float)(b)) <= 0.5f / (scale) + 1e-6f * fabsf((float)(a)))
+#define BATCH_CHECK_STATS(p, scale) \
+    ok = ok && BATCH_NEAR(original.p##Avg, decoded.p##Avg, scale) && \
+         BATCH_NEAR(original.p##Min, decoded.p##Min, scale) && \
+         BATCH_NEAR(original.p##Max, decoded.p##Max, scale) && \
+         BATCH_NEAR(original.p##StdDev, decoded.p##StdDev, scale);
+#define BATCH_CHECK_CIRCULAR(p, scale) ok = ok && original.p##Avg == decoded.p##Avg;
+#define BATCH_CHECK_LATEST(p, scale) ok = ok && BATCH_NEAR(original.p, decoded.p, scale);
+#define BATCH_CHECK_QUANTILES(p, scale) \
+    ok = ok && BATCH_NEAR(original.p##P05, decoded.p##P05, scale) && \
+         BATCH_NEAR(original.p##Median, decoded.p##Median, scale) && \
+         BATCH_NEAR(original.p##P95, decoded.p##P95, scale);
+#define BATCH_CHECK_NONE(p, scale)
+#define BATCH_CHECK(id, member, prefix, type, kind, quant, key, shortKey, unit, wireType, wireScale, ...) \
+    BATCH_CHECK_##kind(prefix, wireScale) BATCH_CHECK_##quant(prefix, wireScale)
+    WEATHER_FIELDS(BATCH_CHECK)
+    if (!ok) batchAllOk = false;
+}
+
+void benchBatch() {
+    Serial.println("\n--- Backlog batch encoding ---");
+
+    const uint16_t day = 288;
+    static AggregatedData windows[day];
+    makeBacklogDay(windows, day);
+
+    // Per-window JSON and CBOR, as the backlog would be sent one by one
+    static char json[MQTT_MAX_PACKET_SIZE];
+    static uint8_t cbor[MQTT_MAX_PACKET_SIZE];
+    uint32_t jsonBytes = 0, cborBytes = 0;
+    for (uint16_t w = 0; w < day; w++) {
+        jsonBytes += DataFormatter::toMQTTPayload("BENCH001", windows[w], json, sizeof(json));
+        cborBytes += DataFormatter::toCBORPayload("BENCH001", windows[w], cbor, sizeof(cbor));
+    }
+
+    static uint8_t batch[32768];
+    BatchEncoder encoder(batch, sizeof(batch));
+    encoder.begin("BENCH001");
+    bool added = true;
+    uint32_t start = ESP.getCycleCount();
+    for (uint16_t w = 0; w < day; w++) added = encoder.add(windows[w]) && added;
+    uint32_t encodeCycles = ESP.getCycleCount() - start;
+    size_t batchBytes = encoder.length();
+
+    Serial.printf("  %u windows: JSON %lu bytes, CBOR %lu bytes, batch %u bytes "
+                  "(%.1f bytes/window)\n", day, (unsigned long)jsonBytes,
+                  (unsigned long)cborBytes, (unsigned)batchBytes, (float)batchBytes / day);
+    Serial.printf("  reduction: %.1fx vs JSON, %.1fx vs CBOR; worst case %u bytes/window\n",
+                  (float)jsonBytes / batchBytes, (float)cborBytes / batchBytes,
+                  (unsigned)BatchEncoder::maxRecordBytes());
+
+    // Decode everything back
+    batchAllOk = added && encoder.getRecordCount() == day;
+    static AggregatedData decoded;
+    start = ESP.getCycleCount();
+    BatchDecoder decoder(encoder.data(), encoder.length());
+    uint16_t count = 0;
+    while (decoder.next(decoded)) {
+        if (count < day) checkBatchRecord(windows[count], decoded);
+        count++;
+    }
+    uint32_t decodeCycles = ESP.getCycleCount() - start;
+    batchAllOk = batchAllOk && decoder.isValid() && count == day &&
+                 strcmp(decoder.getStationId(), "BENCH001") == 0;
+    Serial.printf("  encode %lu cyc/window, decode %lu cyc/window\n",
+                  (unsigned long)(encodeCycles / day), (unsigned long)(decodeCycles / day));
+    Serial.printf("  round trip: %u windows within field resolution, rose / QC exact %s\n",
+                  count, batchAllOk ? "OK" : "FAIL");
+
+    // Bounded buffer: fills up, a rejected window leaves the batch intact
+    static uint8_t small[MQTT_MAX_PACKET_SIZE];
+    BatchEncoder bounded(small, sizeof(small));
+    bounded.begin("BENCH001");
+    uint16_t fitted = 0;
+    while (fitted < day && bounded.add(windows[fitted])) fitted++;
+    size_t full = bounded.length();
+    bool rejectOk = fitted < day && !bounded.add(windows[fitted]) && bounded.length() == full &&
+                    bounded.getRecordCount() == fitted;
+    BatchDecoder boundedDecoder(bounded.data(), bounded.length());
+    uint16_t boundedCount = 0;
+    bool boundedOk = true;
+    while (boundedDecoder.next(decoded)) {
+        if (decoded.timestamp != windows[boundedCount].timestamp) boundedOk = false;
+        boundedCount++;
+    }
+    boundedOk = boundedOk && rejectOk && boundedCount == fitted;
+    Serial.printf("  %u byte buffer: %u windows (%u bytes), full batch rejects more, "
+                  "decodes intact %s\n", (unsigned)sizeof(small), fitted, (unsigned)full,
+                  boundedOk ? "OK" : "FAIL");
+
+    // Damaged batch: decoding stops, never reads past the end
+    bool damagedOk = true;
+    for (size_t cut = 0; cut < full; cut += 7) {
+        BatchDecoder cutDecoder(small, cut);
+        uint16_t n = 0;
+        while (cutDecoder.next(decoded)) n++;
+        if (n >= fitted) damagedOk = false;
+    }
+    Serial.printf("  truncated batches decode fewer windows %s\n", damagedOk ? "OK" : "FAIL");
+    Serial.printf("  all checks %s\n", batchAllOk && boundedOk && damagedOk ? "OK" : "FAIL");
+}
+
+// ============================================
+// InfluxDB Batch
+// ============================================
+
+void benchInflux() {
+    Serial.println("\n--- InfluxDB line-protocol batch ---");
+
+    static AggregatedData data;
+    static WindProductsData wind;
+    static DerivedData derived;
+    makeReportWindow(data, wind, derived);
+
+    // Window end 5 minutes after a sync at a known UTC second
+    WallClock clock;
+    clock.sync(1760000000UL, 5000);
+    data.timestamp = 305000;
+    uint64_t epochMs = clock.unixMillis(data.timestamp);
+    bool epochOk = epochMs == 1760000300000ULL &&
+                   clock.unixMillis(4000) == 1759999999000ULL;
+
+    // A main station and 40 microstations, one POST
+    const uint8_t stations = 41;
+    static char body[INFLUX_BATCH_BYTES];
+    InfluxBatch batch(body, sizeof(body));
+    char stationId[12];
+    uint16_t posts = 1;
+    uint32_t cycles = 0;
+    const uint16_t rounds = 20;
+    for (uint16_t r = 0; r < rounds; r++) {
+        batch.begin(INFLUX_MEASUREMENT, "BENCH001");
+        uint32_t start = ESP.getCycleCount();
+        for (uint8_t s = 0; s < stations; s++) {
+            snprintf(stationId, sizeof(stationId), s == 0 ? "BENCH001" : "MICRO%03u", s);
+            if (!batch.add(stationId, data, epochMs)) {
+                if (r == 0) posts++;
+                batch.begin(INFLUX_MEASUREMENT, "BENCH001");
+                batch.add(stationId, data, epochMs);
+            }
+        }
+        cycles += ESP.getCycleCount() - start;
+    }
+    float perRecord = (float)cycles / (rounds * stations);
+    Serial.printf("  %u stations: %u POST(s) of up to %u bytes, %.0f bytes/record\n",
+                  stations, posts, (unsigned)sizeof(body),
+                  (float)batch.length() / batch.getRecordCount());
+    Serial.printf("  %.0f cyc/record, %.0f records/s at %lu MHz\n", perRecord,
+                  getCpuFrequencyMhz() ? 1e6f / cyclesToUs(perRecord) : 0,
+                  (unsigned long)getCpuFrequencyMhz());
+
+    // Re-batch everything into one large body and check every line
+    static char big[65536];
+    InfluxBatch all(big, sizeof(big));
+    all.begin(INFLUX_MEASUREMENT, "BENCH001");
+    for (uint8_t s = 0; s < stations; s++) {
+        snprintf(stationId, sizeof(stationId), s == 0 ? "BENCH001" : "MICRO%03u", s);
+        all.add(stationId, data, epochMs);
+    }
+    static char line[2048];
+    bool linesOk = all.getRecordCount() == stations && strlen(all.data()) == all.length();
+    const char* cursor = all.data();
+    for (uint8_t s = 0; s < stations && linesOk; s++) {
+        snprintf(stationId, sizeof(stationId), s == 0 ? "BENCH001" : "MICRO%03u", s);
+        size_t length = DataFormatter::toInfluxLineProtocol(INFLUX_MEASUREMENT ",site=BENCH001",
+                                                            stationId, data, line, sizeof(line),
+                                                            epochMs);
+        linesOk = strncmp(cursor, line, length) == 0 &&
+                  cursor[length] == (s + 1 < stations ? '\n' : '\0');
+        cursor += length + 1;
+    }
+    const char* suffix = " 1760000300000000000";
+    size_t lineLength = DataFormatter::toInfluxLineProtocol("weather", "BENCH001", data, line,
+                                                            sizeof(line), epochMs);
+    bool timestampOk = lineLength > strlen(suffix) &&
+                       strcmp(line + lineLength - strlen(suffix), suffix) == 0;
+    DataFormatter::toInfluxLineProtocol("weather", "BENCH001", data, line, sizeof(line));
+    bool serverTimeOk = strchr(strstr(line, "samples="), ' ') == nullptr;
+    Serial.printf("  lines match toInfluxLineProtocol, shared site tag %s\n",
+                  linesOk ? "OK" : "FAIL");
+    Serial.printf("  epoch-ns timestamps (%s without a clock) %s\n",
+                  serverTimeOk ? "server time" : "millis",
+                  epochOk && timestampOk && serverTimeOk ? "OK" : "FAIL");
+
+    // Full batch (room for one and a half lines) rejects a line and stays
+    // intact; tags are escaped
+    static char small[sizeof(line)];
+    InfluxBatch bounded(small, strlen(line) + strlen(line) / 2);
+    bounded.begin(INFLUX_MEASUREMENT, "BENCH 001");
+    bool boundedOk = bounded.add("MICRO001", data, epochMs);
+    size_t full = bounded.length();
+    boundedOk = boundedOk && !bounded.add("MICRO002", data, epochMs) &&
+                bounded.length() == full && bounded.getRecordCount() == 1 &&
+                strlen(bounded.data()) == full;
+    bounded.begin(INFLUX_MEASUREMENT, "BENCH,001");
+    bounded.add("A B=C\n", data, 0);
+    bool escapeOk = strncmp(bounded.data(), "weather,site=BENCH\\,001,station=A\\ B\\=C ",
+                            strlen("weather,site=BENCH\\,001,station=A\\ B\\=C ")) == 0 &&
+                    strchr(bounded.data(), '\n') == nullptr;
+    Serial.printf("  bounded buffer all-or-nothing %s, tag escaping %s\n",
+                  boundedOk ? "OK" : "FAIL", escapeOk ? "OK" : "FAIL");
+}
+
+// ============================================
+// Streaming Sinks
+// ============================================
+
+// Stands in for a transport: keeps the bytes and counts the writes
+class CollectSink : public OutputSink {
+public:
+    CollectSink(uint8_t* buffer, size_t size) : _buffer(buffer), _size(size), _length(0),
+                                                _writes(0) {}
+    void write(const uint8_t* data, size_t length) override {
+        if (_length + length <= _size) memcpy(_buffer + _length, data, length);
+        _length += length;
+        _writes++;
+    }
+    size_t length() const { return _length; }
+    uint32_t writes() const { return _writes; }
+
+private:
+    uint8_t* _buffer;
+    size_t _size;
+    size_t _length;
+    uint32_t _writes;
+};
+
+static volatile uint32_t sinkChecksum;
+
+// The old publish path: the whole payload on the stack, then copied
+__attribute__((noinline)) size_t publishBuffered() {
+    char payload[MQTT_MAX_PACKET_SIZE];
+    size_t length = DataFormatter::toMQTTPayload("BENCH001", *formatData, payload,
+                                                 sizeof(payload), formatWind, formatDerived);
+    sinkChecksum = sinkChecksum + payload[length / 2];
+    return length;
+}
+
+// The streamed path: a length pass, then the same writer into the transport
+__attribute__((noinline)) size_t publishStreamed(OutputSink& transport) {
+    CountingSink counter;
+    DataFormatter::toMQTTPayload("BENCH001", *formatData, counter, formatWind, formatDerived);
+    DataFormatter::toMQTTPayload("BENCH001", *formatData, transport, formatWind, formatDerived);
+    return counter.length();
+}
+
+void benchSinks() {
+    Serial.println("\n--- Streaming formatter sinks ---");
+
+    static AggregatedData data;
+    static WindProductsData wind;
+    static DerivedData derived;
+    makeReportWindow(data, wind, derived);
+    formatData = &data;
+    formatWind = &wind;
+    formatDerived = &derived;
+
+    static char text[MQTT_MAX_PACKET_SIZE];
+    static uint8_t bytes[MQTT_MAX_PACKET_SIZE];
+    static uint8_t streamed[8192];
+
+    // Same bytes through the sink as into a buffer
+    size_t jsonLength = DataFormatter::toMQTTPayload("BENCH001", data, text, sizeof(text),
+                                                     &wind, &derived);
+    CollectSink json(streamed, sizeof(streamed));
+    size_t jsonStreamed = DataFormatter::toMQTTPayload("BENCH001", data, json, &wind, &derived);
+    bool jsonOk = jsonStreamed == jsonLength && json.length() == jsonLength &&
+                  memcmp(streamed, text, jsonLength) == 0;
+
+    size_t cborLength = DataFormatter::toCBORPayload("BENCH001", data, bytes, sizeof(bytes),
+                                                     &wind, &derived);
+    CollectSink cbor(streamed, sizeof(streamed));
+    size_t cborStreamed = DataFormatter::toCBORPayload("BENCH001", data, cbor, &wind, &derived);
+    bool cborOk = cborStreamed == cborLength && cbor.length() == cborLength &&
+                  memcmp(streamed, bytes, cborLength) == 0;
+    Serial.printf("  JSON %u bytes in %lu writes, CBOR %u bytes in %lu writes "
+                  "(%u-byte chunks), identical %s\n",
+                  (unsigned)jsonLength, (unsigned long)json.writes(), (unsigned)cborLength,
+                  (unsigned long)cbor.writes(), (unsigned)SINK_CHUNK_BYTES,
+                  jsonOk && cborOk ? "OK" : "FAIL");
+
+    // Cost and stack of a publish: buffer + copy against length pass + stream
+    const int iterations = 200;
+    uint32_t start = ESP.getCycleCount();
+    for (int i = 0; i < iterations; i++) publishBuffered();
+    uint32_t bufferedCycles = ESP.getCycleCount() - start;
+    CountingSink transport;
+    start = ESP.getCycleCount();
+    for (int i = 0; i < iterations; i++) publishStreamed(transport);
+    uint32_t streamedCycles = ESP.getCycleCount() - start;
+
+    paintStack();
+    publishBuffered();
+    size_t bufferedStack = scanStack();
+    paintStack();
+    publishStreamed(transport);
+    size_t streamedStack = scanStack();
+    bool stackOk = streamedStack < bufferedStack;
+    Serial.printf("  publish: buffered %lu cyc, %u B stack; streamed (2 passes) %lu cyc, "
+                  "%u B stack %s\n",
+                  (unsigned long)(bufferedCycles / iterations), (unsigned)bufferedStack,
+                  (unsigned long)(streamedCycles / iterations), (unsigned)streamedStack,
+                  stackOk ? "OK" : "FAIL");
+
+    // Small chunks: long strings pass straight through, C library
+    // conversions land in the chunk; no size limit on the payload
+    static char longText[3000];
+    memset(longText, 'x', sizeof(longText) - 1);
+    longText[sizeof(longText) - 1] = '\0';
+    bool chunkOk = true;
+    const size_t chunkSizes[] = {16, 32, 64, SINK_CHUNK_BYTES};
+    static char expected[4096];
+    for (size_t chunkSize : chunkSizes) {
+        seedSamples(61);
+        for (int i = 0; i < 200 && chunkOk; i++) {
+            float value = nextNoise() * 1000.0f;
+            unsigned long count = (unsigned long)(nextNoise() * 1e6f + 1e6f);
+            const char* word = (i % 10 == 0) ? longText : "station";
+            size_t expectedLength = (size_t)snprintf(
+                expected, sizeof(expected), "{\"%s\":%.2f,\"n\":%lu,\"e\":%.3e,\"w\":\"%-12s\"}",
+                word, value, count, value, "pad");
+
+            char chunk[SINK_CHUNK_BYTES];
+            CollectSink sink(streamed, sizeof(streamed));
+            size_t length;
+            {
+                BufferWriter writer(sink, chunk, chunkSize);
+                writer.printf("{\"%s\":%.2f,\"n\":%lu,\"e\":%.3e,\"w\":\"%-12s\"}",
+                              word, value, count, value, "pad");
+                length = writer.length();
+            }
+            chunkOk = length == expectedLength && sink.length() == expectedLength &&
+                      memcmp(streamed, expected, expectedLength) == 0;
+        }
+    }
+    Serial.printf("  chunks of 16..%u bytes, payloads past %u bytes, identical to snprintf %s\n",
+                  (unsigned)SINK_CHUNK_BYTES, (unsigned)MQTT_MAX_PACKET_SIZE,
+                  chunkOk ? "OK" : "FAIL");
+    Serial.printf("  all checks %s\n", jsonOk && cborOk && stackOk && chunkOk ? "OK" : "FAIL");
+}
+
+void runAll() {
+    Serial.println("\n========================================");
+    Serial.println("Aggregator accumulator benchmark");
+    Serial.println("========================================");
+    benchAccumulators("Temperature", 20.0f, 5.0f);
+    benchAccumulators("Pressure", 1013.25f, 2.0f);
+    benchAddSample();
+    benchQuantiles();
+    benchMerge();
+    benchRegistry();
+    benchSampleBuffer();
+    benchWindDirection();
+    benchStationTable();
+    benchSlidingWindow();
+    benchWindProducts();
+    benchQualityControl();
+    benchDerived();
+    benchWindRose();
+    benchReportCompression();
+    benchEvents();
+    benchSpikeFilter();
+    benchAgro();
+    benchSpatial();
+    benchFixedPoint();
+    benchFormatter();
+    benchCbor();
+    benchBatch();
+    benchInflux();
+    benchSinks();
+    Serial.println("\nDone.");
+}
+
+void printHelp() {
+    Serial.println("\nCommands:");
+    Serial.println("  'b' - Run all benchmarks");
+    Serial.println("  'a' - Accumulator accuracy only");
+    Serial.println("  's' - addSample cost only");
+    Serial.println("  'q' - Streaming quantile accuracy");
+    Serial.println("  'm' - Rollup merge accuracy");
+    Serial.println("  'g' - Generated vs hand-written code");
+    Serial.println("  'r' - Raw sample buffer scan and recompute");
+    Serial.println("  'w' - Wind direction fast path vs libm");
+    Serial.println("  't' - Microstation table insert/update cost");
+    Serial.println("  'o' - Sliding window cost and accuracy");
+    Serial.println("  'p' - Wind products (gust, 2/10-min means)");
+    Serial.println("  'c' - Quality control cost and fault detection");
+    Serial.println("  'v' - Derived variables (dew point, heat index, ...)");
+    Serial.println("  'e' - Wind rose cost, merge and payload size");
+    Serial.println("  'k' - Report compression bytes and reconstruction error");
+    Serial.println("  'l' - Event lane detection and rate limit");
+    Serial.println("  'f' - Hampel spike filter cost and rejection");
+    Serial.println("  'n' - Agronomic products (ET0, GDD)");
+    Serial.println("  'x' - Spatial aggregation across stations");
+    Serial.println("  'i' - Fixed-point vs float aggregation");
+    Serial.println("  'j' - Formatter writer vs C library printf");
+    Serial.println("  'y' - CBOR payload size, cost and round trip");
+    Serial.println("  'z' - Backlog batch encoding size and round trip");
+    Serial.println("  'u' - InfluxDB batch bytes, records/s and line checks");
+    Serial.println("  'd' - Streaming sinks: output, cost and stack against buffers");
+    Serial.println("  'h' - Help");
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(2000);
+
+    Serial.println("\n========================================");
+    Serial.println("COW-Bois Aggregator Benchmark");
+    Serial.println("========================================");
+    Serial.printf("CPU: %lu MHz, high-rate mode: %s\n",
+                  (unsigned long)getCpuFrequencyMhz(),
+                  AGGREGATION_HIGH_RATE ? "ON" : "OFF");
+
+    runAll();
+    printHelp();
+}
+
+void loop() {
+    if (Serial.available()) {
+        char cmd = Serial.read();
+
+        switch (cmd) {
+            case 'b':
+            case 'B':
+                runAll();
+                break;
+            case 'a':
+            case 'A':
+                benchAccumulators("Temperature", 20.0f, 5.0f);
+                benchAccumulators("Pressure", 1013.25f, 2.0f);
+                break;
+            case 's':
+            case 'S':
+                benchAddSample();
+                break;
+            case 'q':
+            case 'Q':
+                benchQuantiles();
+                break;
+            case 'm':
+            case 'M':
+                benchMerge();
+                break;
+            case 'g':
+            case 'G':
+                benchRegistry();
+                break;
+            case 'r':
+            case 'R':
+                benchSampleBuffer();
+                break;
+            case 'w':
+            case 'W':
+                benchWindDirection();
+                break;
+            case 't':
+            case 'T':
+                benchStationTable();
+                break;
+            case 'o':
+            case 'O':
+                benchSlidingWindow();
+                break;
+            case 'p':
+            case 'P':
+                benchWindProducts();
+                break;
+            case 'c':
+            case 'C':
+                benchQualityControl();
+                break;
+            case 'v':
+            case 'V':
+                benchDerived();
+                break;
+            case 'e':
+            case 'E':
+                benchWindRose();
+                break;
+            case 'k':
+            case 'K':
+                benchReportCompression();
+                break;
+            case 'l':
+            case 'L':
+                benchEvents();
+                break;
+            case 'f':
+            case 'F':
+                benchSpikeFilter();
+                break;
+            case 'n':
+            case 'N':
+                benchAgro();
+                break;
+            case 'x':
+            case 'X':
+                benchSpatial();
+                break;
+            case 'i':
+            case 'I':
+                benchFixedPoint();
+                break;
+            case 'j':
+            case 'J':
+                benchFormatter();
+                break;
+            case 'y':
+            case 'Y':
+                benchCbor();
+                break;
+            case 'z':
+            case 'Z':
+                benchBatch();
+                break;
+            case 'u':
+            case 'U':
+                benchInflux();
+                break;
+            case 'd':
+            case 'D':
+                benchSinks();
+                break;
+            case 'h':
+            case 'H':
+            case '?':
+                printHelp();
+                break;
+        }
+    }
+
+    delay(10);
+}
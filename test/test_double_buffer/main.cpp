@@ -0,0 +1,334 @@
+/**
+ * COW-Bois Weather Station - Double Buffer Stress Test and Benchmark
+ *
+ * Runs a producer and a consumer concurrently (two FreeRTOS tasks on the
+ * two ESP32 cores, or two std::threads on the host) against the
+ * lock-free PingPong buffer behind DoubleBufferedAggregator:
+ * - stress: the producer writes a numbered sequence, the consumer swaps
+ *   as fast as it can and checks every closed window for torn, lost or
+ *   duplicated samples
+ * - throughput: samples per second with and without a swapping consumer,
+ *   swap latency
+ * - (ESP32) DoubleBufferedAggregator with the production DataAggregator:
+ *   sample conservation across closes, addSample overhead
+ *
+ * Upload: pio run -e test_double_buffer -t upload
+ * Monitor: pio device monitor
+ *
+ * Host: g++ -O2 -pthread -I include test/test_double_buffer/main.cpp
+ *       (PingPong is header-only; the DataAggregator part is ESP32 only)
+ */
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "data/double_buffered_aggregator.h"
+#else
+#include <stdio.h>
+#include <chrono>
+#include <thread>
+#endif
+#include <atomic>
+
+#include "config.h"
+#include "util/ping_pong.h"
+
+// ============================================
+// Test Configuration
+// ============================================
+#ifdef ARDUINO
+#define STRESS_SAMPLES 2000000UL
+#else
+#define STRESS_SAMPLES 50000000UL
+#endif
+#define THROUGHPUT_SAMPLES 1000000UL
+
+// ============================================
+// Platform Shims
+// ============================================
+#ifdef ARDUINO
+#define OUT(...) Serial.printf(__VA_ARGS__)
+
+static uint32_t nowMicros() {
+    return micros();
+}
+
+static void (*producerBody)();
+
+static void producerTask(void*) {
+    producerBody();
+    vTaskDelete(nullptr);
+}
+
+// loop() runs on core 1; the producer gets core 0
+static void startProducer(void (*body)()) {
+    producerBody = body;
+    xTaskCreatePinnedToCore(producerTask, "producer", 4096, nullptr, 1, nullptr, 0);
+}
+
+static void joinProducer() {}     // Consumers wait for producerDone instead
+#else
+#define OUT(...) printf(__VA_ARGS__)
+
+static uint32_t nowMicros() {
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<microseconds>(
+        steady_clock::now().time_since_epoch()).count();
+}
+
+static std::thread producerThread;
+
+static void startProducer(void (*body)()) {
+    producerThread = std::thread(body);
+}
+
+static void joinProducer() {
+    producerThread.join();
+}
+#endif
+
+static int failures = 0;
+
+// ============================================
+// Sequence Window
+// A window of consecutive sample numbers; any torn or lost write
+// breaks one of count / sum / contiguity
+// ============================================
+struct SequenceWindow {
+    uint64_t sum;
+    uint32_t count;
+    uint32_t first;
+    uint32_t last;
+    bool gap;
+
+    SequenceWindow() { reset(); }
+
+    void reset() {
+        sum = 0;
+        count = 0;
+        first = 0;
+        last = 0;
+        gap = false;
+    }
+
+    void add(uint32_t seq) {
+        if (count == 0) first = seq;
+        else if (seq != last + 1) gap = true;
+        last = seq;
+        sum += seq;
+        count++;
+    }
+
+    bool consistent() const {
+        if (count == 0) return true;
+        uint64_t expected = ((uint64_t)first + last) * count / 2;
+        return !gap && last - first + 1 == count && sum == expected;
+    }
+};
+
+static PingPong<SequenceWindow> windows;
+static std::atomic<bool> producerDone(false);
+static uint32_t producerMicros;
+
+static void sequenceProducer() {
+    uint32_t start = nowMicros();
+    for (uint32_t seq = 1; seq <= STRESS_SAMPLES; seq++) {
+        windows.beginWrite().add(seq);
+        windows.endWrite();
+    }
+    producerMicros = nowMicros() - start;
+    producerDone.store(true);
+}
+
+// ============================================
+// Stress Test
+// ============================================
+void stressPingPong() {
+    OUT("\n--- Stress: producer vs swapping consumer ---\n");
+
+    windows.buffer(0).reset();
+    windows.buffer(1).reset();
+    producerDone.store(false);
+
+    uint32_t swaps = 0, empty = 0, torn = 0, discontinuous = 0;
+    uint64_t received = 0;
+    uint32_t expectedFirst = 1;
+    uint32_t worstSwap = 0;
+
+    startProducer(sequenceProducer);
+
+    bool finished = false;
+    while (!finished) {
+        // One last swap after the producer stops collects the remainder
+        finished = producerDone.load();
+
+        uint32_t start = nowMicros();
+        SequenceWindow& closed = windows.swap();
+        uint32_t elapsed = nowMicros() - start;
+        if (elapsed > worstSwap) worstSwap = elapsed;
+        swaps++;
+
+        if (closed.count == 0) {
+            empty++;
+        } else {
+            if (!closed.consistent()) torn++;
+            if (closed.first != expectedFirst) discontinuous++;
+            expectedFirst = closed.last + 1;
+            received += closed.count;
+        }
+        closed.reset();
+    }
+    joinProducer();
+
+    bool pass = torn == 0 && discontinuous == 0 && received == STRESS_SAMPLES;
+    if (!pass) failures++;
+    OUT("  %lu samples, %lu swaps (%lu empty, %lu waited for a write)\n",
+        (unsigned long)STRESS_SAMPLES, (unsigned long)swaps, (unsigned long)empty,
+        (unsigned long)windows.getSwapWaits());
+    OUT("  received %llu, torn windows %lu, gaps between windows %lu %s\n",
+        (unsigned long long)received, (unsigned long)torn,
+        (unsigned long)discontinuous, pass ? "OK" : "FAIL");
+    OUT("  producer %.1f ns/sample under contention, worst swap %lu us\n",
+        1000.0 * producerMicros / STRESS_SAMPLES, (unsigned long)worstSwap);
+}
+
+// ============================================
+// Throughput
+// ============================================
+void benchThroughput() {
+    OUT("\n--- Throughput (producer alone) ---\n");
+
+    // Volatile step keeps the plain loop from being folded to a formula
+    static volatile uint32_t step = 1;
+    static SequenceWindow plain;
+    plain.reset();
+    uint32_t start = nowMicros();
+    for (uint32_t seq = 1; seq <= THROUGHPUT_SAMPLES; seq += step) {
+        plain.add(seq);
+    }
+    uint32_t plainMicros = nowMicros() - start;
+
+    static PingPong<SequenceWindow> local;
+    start = nowMicros();
+    for (uint32_t seq = 1; seq <= THROUGHPUT_SAMPLES; seq += step) {
+        local.beginWrite().add(seq);
+        local.endWrite();
+    }
+    uint32_t pingPongMicros = nowMicros() - start;
+
+    start = nowMicros();
+    const uint32_t swapCount = 100000;
+    for (uint32_t i = 0; i < swapCount; i++) {
+        local.swap().reset();
+    }
+    uint32_t swapMicros = nowMicros() - start;
+
+    OUT("  plain window:   %.1f ns/sample (%.1f M samples/s)\n",
+        1000.0 * plainMicros / THROUGHPUT_SAMPLES,
+        (double)THROUGHPUT_SAMPLES / (plainMicros > 0 ? plainMicros : 1));
+    OUT("  ping-pong:      %.1f ns/sample (%.1f M samples/s)\n",
+        1000.0 * pingPongMicros / THROUGHPUT_SAMPLES,
+        (double)THROUGHPUT_SAMPLES / (pingPongMicros > 0 ? pingPongMicros : 1));
+    OUT("  swap + reset:   %.1f ns (uncontended)\n", 1000.0 * swapMicros / swapCount);
+}
+
+#ifdef ARDUINO
+// ============================================
+// Production Aggregator (ESP32)
+// ============================================
+#define AGG_SAMPLES 200000UL
+
+static DoubleBufferedAggregator doubleBuffered;
+
+static void aggregatorProducer() {
+    WeatherReading reading;
+    reading.isValid = true;
+    for (uint32_t i = 0; i < AGG_SAMPLES; i++) {
+        reading.temperature = 20.0f + (i % 100) * 0.01f;
+        reading.windSpeed = 3.0f;
+        reading.windDirection = (uint16_t)(i % 360);
+        doubleBuffered.addSample(reading);
+    }
+    producerDone.store(true);
+}
+
+void stressAggregator() {
+    Serial.println("\n--- DoubleBufferedAggregator (two cores) ---");
+
+    producerDone.store(false);
+    doubleBuffered.getAndReset();
+    startProducer(aggregatorProducer);
+
+    uint32_t closes = 0;
+    uint64_t counted = 0;
+    bool rangeOk = true;
+    bool finished = false;
+    while (!finished) {
+        finished = producerDone.load();
+        AggregatedData data = doubleBuffered.getAndReset();
+        closes++;
+        counted += data.sampleCount;
+        if (data.sampleCount > 0 && (data.tempMin < 19.99f || data.tempMax > 21.0f)) {
+            rangeOk = false;
+        }
+        delay(1);
+    }
+
+    bool pass = counted == AGG_SAMPLES && rangeOk;
+    if (!pass) failures++;
+    Serial.printf("  %lu samples over %lu closes, counted %llu, ranges %s %s\n",
+                  (unsigned long)AGG_SAMPLES, (unsigned long)closes,
+                  (unsigned long long)counted, rangeOk ? "sane" : "CORRUPT",
+                  pass ? "OK" : "FAIL");
+
+    // addSample overhead of the handoff
+    static DataAggregator direct;
+    WeatherReading reading;
+    reading.isValid = true;
+    reading.temperature = 20.0f;
+    const uint32_t n = 10000;
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < n; i++) direct.addSample(reading);
+    uint32_t directCycles = ESP.getCycleCount() - start;
+    start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < n; i++) doubleBuffered.addSample(reading);
+    uint32_t bufferedCycles = ESP.getCycleCount() - start;
+    Serial.printf("  addSample: direct %lu cyc, double-buffered %lu cyc\n",
+                  (unsigned long)(directCycles / n), (unsigned long)(bufferedCycles / n));
+}
+#endif
+
+void runAll() {
+    failures = 0;
+    stressPingPong();
+    benchThroughput();
+    #ifdef ARDUINO
+    stressAggregator();
+    #endif
+    OUT("\n%s (%d failure%s)\n", failures ? "FAILED" : "PASSED", failures,
+        failures == 1 ? "" : "s");
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+    Serial.println("\n========================================");
+    Serial.println("Double buffer stress test");
+    Serial.println("========================================");
+    Serial.printf("CPU: %lu MHz, cores: 2\n", (unsigned long)getCpuFrequencyMhz());
+    runAll();
+    Serial.println("\nSend 'b' to run again");
+}
+
+void loop() {
+    if (Serial.available() && Serial.read() == 'b') {
+        runAll();
+    }
+    delay(10);
+}
+#else
+int main() {
+    runAll();
+    return failures ? 1 : 0;
+}
+#endif
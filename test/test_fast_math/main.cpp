@@ -0,0 +1,328 @@
+/**
+ * COW-Bois Weather Station - Fast Math Accuracy and Benchmark
+ *
+ * Sweeps every kernel in util/fast_math.h against double-precision libm,
+ * checks the measured error against the documented bound, and times the
+ * kernel against the float libm call:
+ * - fastExp / fastLog / fastPow
+ * - Q15 sine/cosine table
+ * - fastAtan2Deg
+ * - derived variables end to end (dew point, wind chill, sea-level
+ *   pressure) against the sensor accuracy thresholds in config.h
+ *
+ * Upload: pio run -e test_fast_math -t upload
+ * Monitor: pio device monitor
+ *
+ * Host: g++ -O2 -I include test/test_fast_math/main.cpp src/util/fast_math.cpp
+ *       (no Arduino.h needed; the kernels are header-only)
+ */
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdio.h>
+#include <chrono>
+#endif
+#include <math.h>
+
+#include "config.h"
+#include "util/fast_math.h"
+
+// ============================================
+// Benchmark Configuration
+// ============================================
+#define BENCH_ITERATIONS 200000UL
+
+// ============================================
+// Platform Shims
+// ============================================
+#ifdef ARDUINO
+#define OUT(...) Serial.printf(__VA_ARGS__)
+
+static uint32_t nowMicros() {
+    return micros();
+}
+#else
+#define OUT(...) printf(__VA_ARGS__)
+
+static uint32_t nowMicros() {
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<microseconds>(
+        steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+static volatile float sink;       // Keeps timed loops from being optimized out
+static int failures = 0;
+
+static void report(const char* name, double maxError, double bound, const char* unit) {
+    bool pass = maxError <= bound;
+    if (!pass) failures++;
+    OUT("  %-24s max error %.3g %s (bound %.3g) %s\n",
+        name, maxError, unit, bound, pass ? "PASS" : "FAIL");
+}
+
+static void reportTime(const char* name, uint32_t fastUs, uint32_t libmUs) {
+    OUT("  %-24s %7.1f ns vs libm %7.1f ns (%.1fx)\n", name,
+        fastUs * 1000.0 / BENCH_ITERATIONS, libmUs * 1000.0 / BENCH_ITERATIONS,
+        fastUs > 0 ? (double)libmUs / fastUs : 0.0);
+}
+
+// ============================================
+// Accuracy Sweeps
+// ============================================
+
+void sweepExp() {
+    double worst = 0;
+    for (int i = 0; i <= 200000; i++) {
+        float x = -80.0f + 160.0f * i / 200000.0f;
+        double ref = exp((double)x);
+        double err = fabs(fastExp(x) - ref) / ref;
+        if (err > worst) worst = err;
+    }
+    report("fastExp [-80, 80]", worst, FAST_EXP_MAX_REL_ERROR, "rel");
+}
+
+// Underflow: subnormal results are compared against the smallest normal
+// float (2^-126), below which relative error is meaningless
+void sweepExp2Underflow() {
+    const double smallest = ldexp(1.0, -126);
+    double worst = 0;
+    for (int i = 0; i <= 100000; i++) {
+        float x = -152.0f + 32.0f * i / 100000.0f;
+        double ref = exp2((double)x);
+        double err = fabs(fastExp2(x) - ref) / fmax(ref, smallest);
+        if (err > worst) worst = err;
+    }
+    report("fastExp2 [-152, -120]", worst, FAST_EXP_MAX_REL_ERROR, "rel");
+}
+
+void sweepLog() {
+    double worst = 0;
+    for (int i = 0; i <= 200000; i++) {
+        float x = (float)pow(10.0, -6.0 + 12.0 * i / 200000.0);
+        double err = fabs(fastLog(x) - log((double)x));
+        if (err > worst) worst = err;
+    }
+    report("fastLog [1e-6, 1e6]", worst, FAST_LOG_MAX_ABS_ERROR, "abs");
+}
+
+void sweepPow() {
+    // Exponents used on the derived-variable path plus a spread
+    static const float EXPONENTS[] = { 0.16f, -5.257f, 0.5f, 1.5f, -1.0f, 2.0f };
+    double worst = 0;
+    for (float y : EXPONENTS) {
+        for (int i = 0; i <= 50000; i++) {
+            float x = 0.5f + 399.5f * i / 50000.0f;
+            if (fabs(y * log2((double)x)) > 8.0) continue;
+            double ref = pow((double)x, (double)y);
+            double err = fabs(fastPow(x, y) - ref) / ref;
+            if (err > worst) worst = err;
+        }
+    }
+    report("fastPow |y log2 x| <= 8", worst, FAST_POW_MAX_REL_ERROR, "rel");
+}
+
+void sweepTrig() {
+    double worst = 0;
+    for (uint16_t d = 0; d < 720; d++) {
+        int16_t s, c;
+        fastSinCosDeg(d, s, c);
+        double rad = d * M_PI / 180.0;
+        double es = fabs(s / (double)FAST_TRIG_ONE - sin(rad));
+        double ec = fabs(c / (double)FAST_TRIG_ONE - cos(rad));
+        if (es > worst) worst = es;
+        if (ec > worst) worst = ec;
+    }
+    // Allow for double rounding of the reference itself
+    report("fastSinCosDeg 0..719", worst, FAST_TRIG_MAX_ERROR * 1.001, "abs");
+}
+
+void sweepAtan2() {
+    static const float RADII[] = { 0.01f, 1.0f, 1000.0f };
+    double worst = 0;
+    for (int i = 0; i < 36000; i++) {
+        double rad = i * M_PI / 18000.0;
+        for (float r : RADII) {
+            float y = (float)(r * sin(rad));
+            float x = (float)(r * cos(rad));
+            double ref = atan2((double)y, (double)x) * 180.0 / M_PI;
+            if (ref < 0) ref += 360.0;
+            double err = fabs(fastAtan2Deg(y, x) - ref);
+            if (err > 180.0) err = 360.0 - err;
+            if (err > worst) worst = err;
+        }
+    }
+    report("fastAtan2Deg", worst, FAST_ATAN2_MAX_ERROR_DEG, "deg");
+}
+
+// ============================================
+// Derived Variables End to End
+// Same formulas as derived_variables.cpp, fast kernels vs double libm
+// ============================================
+
+static double dewPointRef(double t, double rh) {
+    double e = 6.112 * exp(17.67 * t / (t + 243.5)) * rh / 100.0;
+    double g = log(e / 6.112);
+    return 243.5 * g / (17.67 - g);
+}
+
+static float dewPointFast(float t, float rh) {
+    float e = 6.112f * fastExp(17.67f * t / (t + 243.5f)) * rh / 100.0f;
+    float g = fastLog(e / 6.112f);
+    return 243.5f * g / (17.67f - g);
+}
+
+void sweepDerived() {
+    double worstDew = 0;
+    double worstChill = 0;
+    double worstSlp = 0;
+
+    for (int ti = 0; ti <= 200; ti++) {
+        float t = -40.0f + ti * 0.5f;
+
+        for (int h = 1; h <= 100; h++) {
+            double err = fabs(dewPointFast(t, (float)h) - dewPointRef(t, h));
+            if (err > worstDew) worstDew = err;
+        }
+
+        if (t <= 10.0f) {
+            for (int w = 13; w <= 750; w++) {
+                double v = w * 0.1 * 3.6;
+                double ref = pow(v, 0.16);
+                double fast = fastPow((float)v, 0.16f);
+                double err = fabs((fast - ref) * (0.3965 * t - 11.37));
+                if (err > worstChill) worstChill = err;
+            }
+        }
+
+        for (int elev = 0; elev <= 3000; elev += 100) {
+            double lapse = 0.0065 * elev;
+            double ratio = 1.0 - lapse / (t + lapse + 273.15);
+            double ref = 1100.0 * pow(ratio, -5.257);
+            double fast = 1100.0f * fastPow((float)ratio, -5.257f);
+            double err = fabs(fast - ref);
+            if (err > worstSlp) worstSlp = err;
+        }
+    }
+
+    report("dew point", worstDew, TEMP_ACCURACY_C, "C");
+    report("wind chill", worstChill, TEMP_ACCURACY_C, "C");
+    report("sea-level pressure", worstSlp, PRESSURE_ACCURACY_MB, "hPa");
+}
+
+// ============================================
+// Timing
+// ============================================
+
+void benchmark() {
+    uint32_t start, fastUs, libmUs;
+    float acc;
+
+    acc = 0;
+    start = nowMicros();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) acc += fastExp((float)(i & 1023) * 0.01f - 5.0f);
+    fastUs = nowMicros() - start;
+    sink = acc;
+    acc = 0;
+    start = nowMicros();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) acc += expf((float)(i & 1023) * 0.01f - 5.0f);
+    libmUs = nowMicros() - start;
+    sink = acc;
+    reportTime("exp", fastUs, libmUs);
+
+    acc = 0;
+    start = nowMicros();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) acc += fastLog((float)(i & 1023) + 0.5f);
+    fastUs = nowMicros() - start;
+    sink = acc;
+    acc = 0;
+    start = nowMicros();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) acc += logf((float)(i & 1023) + 0.5f);
+    libmUs = nowMicros() - start;
+    sink = acc;
+    reportTime("log", fastUs, libmUs);
+
+    acc = 0;
+    start = nowMicros();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) acc += fastPow((float)(i & 1023) + 0.5f, 0.16f);
+    fastUs = nowMicros() - start;
+    sink = acc;
+    acc = 0;
+    start = nowMicros();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) acc += powf((float)(i & 1023) + 0.5f, 0.16f);
+    libmUs = nowMicros() - start;
+    sink = acc;
+    reportTime("pow", fastUs, libmUs);
+
+    int32_t iacc = 0;
+    start = nowMicros();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+        int16_t s, c;
+        fastSinCosDeg((uint16_t)(i % 360), s, c);
+        iacc += s + c;
+    }
+    fastUs = nowMicros() - start;
+    sink = (float)iacc;
+    acc = 0;
+    start = nowMicros();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+        float rad = (float)(i % 360) * 0.0174532925f;
+        acc += sinf(rad) + cosf(rad);
+    }
+    libmUs = nowMicros() - start;
+    sink = acc;
+    reportTime("sin+cos", fastUs, libmUs);
+
+    acc = 0;
+    start = nowMicros();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+        acc += fastAtan2Deg((float)(i & 255) - 128.0f, (float)((i >> 8) & 255) - 128.0f);
+    }
+    fastUs = nowMicros() - start;
+    sink = acc;
+    acc = 0;
+    start = nowMicros();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+        acc += atan2f((float)(i & 255) - 128.0f, (float)((i >> 8) & 255) - 128.0f);
+    }
+    libmUs = nowMicros() - start;
+    sink = acc;
+    reportTime("atan2", fastUs, libmUs);
+}
+
+void runAll() {
+    OUT("\n=== Fast Math: accuracy against libm (double) ===\n");
+    sweepExp();
+    sweepExp2Underflow();
+    sweepLog();
+    sweepPow();
+    sweepTrig();
+    sweepAtan2();
+
+    OUT("\n=== Fast Math: derived variables against sensor accuracy ===\n");
+    sweepDerived();
+
+    OUT("\n=== Fast Math: cost per call (%lu iterations) ===\n", (unsigned long)BENCH_ITERATIONS);
+    benchmark();
+
+    OUT("\n%s (%d failure%s)\n", failures == 0 ? "ALL PASSED" : "FAILED",
+        failures, failures == 1 ? "" : "s");
+}
+
+#ifdef ARDUINO
+void setup() {
+    Serial.begin(115200);
+    delay(2000);
+    runAll();
+}
+
+void loop() {
+    delay(10000);
+}
+#else
+int main() {
+    runAll();
+    return failures == 0 ? 0 : 1;
+}
+#endif